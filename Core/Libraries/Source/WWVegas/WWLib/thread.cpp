@@ -31,6 +31,14 @@
 #include <windows.h>
 #endif
 
+ThreadClass::ExitHookType ThreadClass::ExitHook = NULL;
+
+#ifdef _WIN32
+static __declspec(thread) bool IsThreadClassThread = false;
+#else
+static bool IsThreadClassThread = false;
+#endif
+
 ThreadClass::ThreadClass(const char *thread_name, ExceptionHandlerType exception_handler) : handle(0), running(false), thread_priority(0)
 {
 	if (thread_name) {
@@ -53,6 +61,7 @@ void __cdecl ThreadClass::Internal_Thread_Function(void* params)
 	ThreadClass* tc=reinterpret_cast<ThreadClass*>(params);
 	tc->running=true;
 	tc->ThreadID = GetCurrentThreadId();
+	IsThreadClassThread = true;
 
 #ifdef _WIN32
 	Register_Thread_ID(tc->ThreadID, tc->ThreadName);
@@ -69,6 +78,10 @@ void __cdecl ThreadClass::Internal_Thread_Function(void* params)
 	tc->Thread_Function();
 #endif //_WIN32
 
+	if (ExitHook != NULL) {
+		ExitHook();
+	}
+
 #ifdef _WIN32
 	Unregister_Thread_ID(tc->ThreadID, tc->ThreadName);
 #endif // _WIN32
@@ -150,6 +163,11 @@ unsigned ThreadClass::_Get_Current_Thread_ID()
 	#endif
 }
 
+bool ThreadClass::Is_ThreadClass_Thread()
+{
+	return IsThreadClassThread;
+}
+
 bool ThreadClass::Is_Running()
 {
 	return !!handle;
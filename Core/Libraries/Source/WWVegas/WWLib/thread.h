@@ -47,6 +47,7 @@ class ThreadClass
 {
 public:
 	typedef int (*ExceptionHandlerType)(int exception_code, struct _EXCEPTION_POINTERS *e_info);
+	typedef void (*ExitHookType)();
 
 	ThreadClass(const char *name = NULL, ExceptionHandlerType exception_handler = NULL);
 	virtual ~ThreadClass();
@@ -78,6 +79,13 @@ public:
 	// Get info about a registered thread by it's index.
 	static int Get_Thread_By_Index(int index, char *name_ptr = NULL);
 
+	// Set a function for every thread to call, on that thread, when its Thread_Function() returns.
+	// Lets per-thread data be cleaned up. Not called for threads that Stop() has to kill.
+	static void Set_Exit_Hook(ExitHookType hook) {ExitHook=hook;}
+
+	// Returns true if the calling thread was started by a ThreadClass, so the exit hook will run on it.
+	static bool Is_ThreadClass_Thread();
+
 protected:
 
 	// User defined thread function. The thread function should check for "running" flag every now and then
@@ -96,6 +104,7 @@ protected:
 
 private:
 	static void __cdecl Internal_Thread_Function(void*);
+	static ExitHookType ExitHook;
 	volatile unsigned long handle;
 	int thread_priority;
 };
@@ -0,0 +1,415 @@
+// benchmark.cpp
+// CPU benchmark used to pick a static detail level on unknown machines. See benchmark.h.
+
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Bump this whenever a kernel or a reference time changes, so old cached results are measured again.
+#define BENCHMARK_CACHE_VERSION		2
+#define BENCHMARK_SIGNATURE_LENGTH	128
+#define BENCHMARK_DEFAULT_CACHE		"Benchmark.dat"
+#define BENCHMARK_RUNS						3		// each kernel is run this many times and the fastest run counts
+
+// Time each kernel took on the reference machine, in seconds. These were measured, not worked out:
+// the fastest of five measure() calls on one core of an Intel Xeon server, built with gcc -O2.
+// The scores are only ratios to that machine, so they are not in the units of the BenchProfile
+// entries in GameLOD.ini, which came from the original benchmark. Those have to be measured again
+// with -forceBenchmark (which writes the line to Benchmark.txt) on each profile's machine.
+#define REFERENCE_FLOAT_SECONDS		0.000708
+#define REFERENCE_INT_SECONDS			0.002218
+#define REFERENCE_MEM_SECONDS			0.004535
+
+// Kernel sizes. These are fixed so every machine does exactly the same work.
+#define FLOAT_NUM_VERTS						4096
+#define FLOAT_NUM_PASSES					64
+#define INT_TEXT_SIZE							(64*1024)
+#define INT_NUM_PASSES						16
+#define MEM_BUFFER_SIZE						(8*1024*1024)
+#define MEM_NUM_PASSES						4
+
+// Kernel results end up here so the compiler can't throw the kernels away.
+static volatile unsigned int theBenchmarkSink = 0;
+
+//-------------------------------------------------------------------------------------------------
+static unsigned int nextRandom(unsigned int &seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+static double getSeconds()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	if (QueryPerformanceFrequency(&freq) && QueryPerformanceCounter(&count) && freq.QuadPart != 0)
+		return (double)count.QuadPart / (double)freq.QuadPart;
+#endif
+	return (double)clock() / (double)CLOCKS_PER_SEC;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Float kernel
+//-------------------------------------------------------------------------------------------------
+
+/** Row-major 3x4 transform, laid out like WWMath's Matrix3D. */
+struct BenchMatrix
+{
+	float m[3][4];
+};
+
+//-------------------------------------------------------------------------------------------------
+static void multiplyMatrix(const BenchMatrix &a, const BenchMatrix &b, BenchMatrix &out)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		out.m[i][0] = a.m[i][0]*b.m[0][0] + a.m[i][1]*b.m[1][0] + a.m[i][2]*b.m[2][0];
+		out.m[i][1] = a.m[i][0]*b.m[0][1] + a.m[i][1]*b.m[1][1] + a.m[i][2]*b.m[2][1];
+		out.m[i][2] = a.m[i][0]*b.m[0][2] + a.m[i][1]*b.m[1][2] + a.m[i][2]*b.m[2][2];
+		out.m[i][3] = a.m[i][0]*b.m[0][3] + a.m[i][1]*b.m[1][3] + a.m[i][2]*b.m[2][3] + a.m[i][3];
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Concatenate a small bone hierarchy and push a vertex buffer through it, once per pass. */
+static double runFloatKernel(float *src, float *dst)
+{
+	BenchMatrix bones[4];
+	unsigned int seed = 0x3d3d;
+	int b, i, j;
+	for (b = 0; b < 4; ++b)
+	{
+		for (i = 0; i < 3; ++i)
+		{
+			for (j = 0; j < 4; ++j)
+				bones[b].m[i][j] = (i == j ? 1.0f : 0.0f) + (float)(nextRandom(seed) % 1000) * 0.0001f;
+		}
+	}
+	for (i = 0; i < FLOAT_NUM_VERTS * 3; ++i)
+		src[i] = (float)(nextRandom(seed) % 2000) * 0.01f - 10.0f;
+
+	double start = getSeconds();
+
+	float sum = 0.0f;
+	for (int pass = 0; pass < FLOAT_NUM_PASSES; ++pass)
+	{
+		BenchMatrix tm, tmp;
+		multiplyMatrix(bones[0], bones[1 + (pass & 1)], tmp);
+		multiplyMatrix(tmp, bones[3], tm);
+
+		const float *in = src;
+		float *out = dst;
+		for (i = 0; i < FLOAT_NUM_VERTS; ++i, in += 3, out += 3)
+		{
+			out[0] = tm.m[0][0]*in[0] + tm.m[0][1]*in[1] + tm.m[0][2]*in[2] + tm.m[0][3];
+			out[1] = tm.m[1][0]*in[0] + tm.m[1][1]*in[1] + tm.m[1][2]*in[2] + tm.m[1][3];
+			out[2] = tm.m[2][0]*in[0] + tm.m[2][1]*in[1] + tm.m[2][2]*in[2] + tm.m[2][3];
+		}
+		sum += dst[(pass * 7) % (FLOAT_NUM_VERTS * 3)];
+	}
+
+	double elapsed = getSeconds() - start;
+	theBenchmarkSink += (unsigned int)sum;
+	return elapsed;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Integer kernel
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+/** Fill the buffer with something that looks like an INI file: blocks of "Field = values ; comment" lines. */
+static void makeIniText(char *text, int size)
+{
+	static const char *fields[] = { "Side", "BuildCost", "BuildTime", "VisionRange", "ShroudClearingRange",
+		"ArmorSet", "WeaponSet", "Behavior", "Geometry", "GeometryMajorRadius", "KindOf", "Scale" };
+	const int numFields = sizeof(fields) / sizeof(fields[0]);
+	unsigned int seed = 0x1e1;
+	int len = 0;
+	char line[128];
+	while (true)
+	{
+		int n;
+		unsigned int r = nextRandom(seed);
+		switch (r % 4)
+		{
+			case 0:		n = sprintf(line, "Object Unit%u\r\n", r % 10000); break;
+			case 1:		n = sprintf(line, "  %s = %u ; tuned\r\n", fields[r % numFields], r % 5000); break;
+			case 2:		n = sprintf(line, "  %s = %u.%02u %u\r\n", fields[(r >> 4) % numFields], r % 100, r % 97, r % 31); break;
+			default:	n = sprintf(line, "End\r\n"); break;
+		}
+		if (len + n >= size)
+			break;
+		memcpy(text + len, line, n);
+		len += n;
+	}
+	memset(text + len, ' ', size - 1 - len);
+	text[size - 1] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Split each line into tokens the way INI does, hash every token, and parse the numeric ones. */
+static double runIntKernel(const char *text)
+{
+	double start = getSeconds();
+
+	unsigned int hash = 0;
+	unsigned int total = 0;
+	for (int pass = 0; pass < INT_NUM_PASSES; ++pass)
+	{
+		const char *p = text;
+		while (*p)
+		{
+			// skip separators
+			while (*p == ' ' || *p == '\t' || *p == '=' || *p == '\r' || *p == '\n')
+				++p;
+			if (*p == ';')
+			{
+				// comments run to the end of the line
+				while (*p && *p != '\n')
+					++p;
+				continue;
+			}
+			if (!*p)
+				break;
+
+			unsigned int tokenHash = 2166136261u;
+			unsigned int value = 0;
+			bool isNumber = true;
+			while (*p && *p != ' ' && *p != '\t' && *p != '=' && *p != '\r' && *p != '\n' && *p != ';')
+			{
+				char c = *p++;
+				tokenHash = (tokenHash ^ (unsigned char)c) * 16777619u;
+				if (c >= '0' && c <= '9')
+					value = value * 10 + (c - '0');
+				else if (c != '.')
+					isNumber = false;
+			}
+			hash ^= tokenHash + pass;
+			if (isNumber)
+				total += value;
+		}
+	}
+
+	double elapsed = getSeconds() - start;
+	theBenchmarkSink += hash + total;
+	return elapsed;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Memory kernel
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+/** Copy a buffer much larger than the caches back and forth. */
+static double runMemKernel(char *a, char *b)
+{
+	double start = getSeconds();
+
+	for (int pass = 0; pass < MEM_NUM_PASSES; ++pass)
+	{
+		if (pass & 1)
+			memcpy(a, b, MEM_BUFFER_SIZE);
+		else
+			memcpy(b, a, MEM_BUFFER_SIZE);
+	}
+
+	double elapsed = getSeconds() - start;
+	theBenchmarkSink += (unsigned char)a[MEM_BUFFER_SIZE / 3] + (unsigned char)b[MEM_BUFFER_SIZE / 2];
+	return elapsed;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Result cache
+//-------------------------------------------------------------------------------------------------
+
+struct BenchmarkCache
+{
+	char magic[4];
+	int version;
+	char signature[BENCHMARK_SIGNATURE_LENGTH];
+	float floatResult;
+	float intResult;
+	float memResult;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Describe the processor well enough that results measured on one machine aren't used on another. */
+static void getProcessorSignature(char *signature)
+{
+	memset(signature, 0, BENCHMARK_SIGNATURE_LENGTH);
+
+#ifdef _WIN32
+	char name[64];
+	DWORD mhz = 0;
+	name[0] = 0;
+
+	HKEY key;
+	if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", 0, KEY_READ, &key) == ERROR_SUCCESS)
+	{
+		DWORD size = sizeof(name) - 1;
+		DWORD type;
+		if (RegQueryValueExA(key, "ProcessorNameString", NULL, &type, (LPBYTE)name, &size) != ERROR_SUCCESS || type != REG_SZ)
+			size = 0;
+		name[size] = 0;
+
+		size = sizeof(mhz);
+		if (RegQueryValueExA(key, "~MHz", NULL, &type, (LPBYTE)&mhz, &size) != ERROR_SUCCESS || type != REG_DWORD)
+			mhz = 0;
+
+		RegCloseKey(key);
+	}
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	_snprintf(signature, BENCHMARK_SIGNATURE_LENGTH - 1, "%s|%lu|%u.%u|%lu", name, (unsigned long)info.dwNumberOfProcessors,
+		(unsigned int)info.wProcessorLevel, (unsigned int)info.wProcessorRevision, (unsigned long)mhz);
+#else
+	strcpy(signature, "unknown");
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+static bool readCache(const char *fileName, const char *signature, float *results)
+{
+	FILE *fp = fopen(fileName, "rb");
+	if (!fp)
+		return false;
+
+	BenchmarkCache cache;
+	bool ok = fread(&cache, sizeof(cache), 1, fp) == 1;
+	fclose(fp);
+
+	if (!ok || memcmp(cache.magic, "BNCH", 4) != 0 || cache.version != BENCHMARK_CACHE_VERSION)
+		return false;
+	if (memcmp(cache.signature, signature, BENCHMARK_SIGNATURE_LENGTH) != 0)
+		return false;
+	// "!(x > 0)" also catches NaN.
+	if (!(cache.floatResult > 0.0f) || !(cache.intResult > 0.0f) || !(cache.memResult > 0.0f))
+		return false;
+
+	results[0] = cache.floatResult;
+	results[1] = cache.intResult;
+	results[2] = cache.memResult;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void writeCache(const char *fileName, const char *signature, const float *results)
+{
+	BenchmarkCache cache;
+	memset(&cache, 0, sizeof(cache));
+	memcpy(cache.magic, "BNCH", 4);
+	cache.version = BENCHMARK_CACHE_VERSION;
+	memcpy(cache.signature, signature, BENCHMARK_SIGNATURE_LENGTH);
+	cache.floatResult = results[0];
+	cache.intResult = results[1];
+	cache.memResult = results[2];
+
+	FILE *fp = fopen(fileName, "wb");
+	if (!fp)
+		return;
+	fwrite(&cache, sizeof(cache), 1, fp);
+	fclose(fp);
+}
+
+//-------------------------------------------------------------------------------------------------
+static float makeScore(double referenceSeconds, double seconds)
+{
+	// anything faster than the timer can measure counts as one tick.
+	if (seconds < 1.0e-6)
+		seconds = 1.0e-6;
+	return (float)(referenceSeconds / seconds);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Run every kernel BENCHMARK_RUNS times and keep each one's fastest time. */
+static bool measure(float *results)
+{
+	float *verts = (float *)malloc(FLOAT_NUM_VERTS * 3 * 2 * sizeof(float));
+	char *text = (char *)malloc(INT_TEXT_SIZE);
+	char *memA = (char *)malloc(MEM_BUFFER_SIZE);
+	char *memB = (char *)malloc(MEM_BUFFER_SIZE);
+	bool ok = verts && text && memA && memB;
+
+	if (ok)
+	{
+		makeIniText(text, INT_TEXT_SIZE);
+		// touch every page up front so the first pass isn't timing page faults.
+		memset(memA, 0x5a, MEM_BUFFER_SIZE);
+		memset(memB, 0xa5, MEM_BUFFER_SIZE);
+
+		double bestFloat = 0.0, bestInt = 0.0, bestMem = 0.0;
+		for (int run = 0; run < BENCHMARK_RUNS; ++run)
+		{
+			double t;
+			t = runFloatKernel(verts, verts + FLOAT_NUM_VERTS * 3);
+			if (run == 0 || t < bestFloat)
+				bestFloat = t;
+			t = runIntKernel(text);
+			if (run == 0 || t < bestInt)
+				bestInt = t;
+			t = runMemKernel(memA, memB);
+			if (run == 0 || t < bestMem)
+				bestMem = t;
+		}
+
+		results[0] = makeScore(REFERENCE_FLOAT_SECONDS, bestFloat);
+		results[1] = makeScore(REFERENCE_INT_SECONDS, bestInt);
+		results[2] = makeScore(REFERENCE_MEM_SECONDS, bestMem);
+	}
+
+	free(verts);
+	free(text);
+	free(memA);
+	free(memB);
+	return ok;
+}
+
+//-------------------------------------------------------------------------------------------------
+int RunBenchmark(int argc, char *argv[], float *floatResult, float *intResult, float *memResult)
+{
+	const char *cacheFile = BENCHMARK_DEFAULT_CACHE;
+	bool readFromCache = true;
+	bool writeToCache = true;
+
+	for (int i = 0; i < argc; ++i)
+	{
+		if (!argv[i])
+			continue;
+		if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc && argv[i + 1])
+			cacheFile = argv[++i];
+		else if (strcmp(argv[i], "-force") == 0)
+			readFromCache = false;
+		else if (strcmp(argv[i], "-nocache") == 0)
+			readFromCache = writeToCache = false;
+	}
+
+	char signature[BENCHMARK_SIGNATURE_LENGTH];
+	getProcessorSignature(signature);
+
+	float results[3];
+	if (!(readFromCache && readCache(cacheFile, signature, results)))
+	{
+		if (!measure(results))
+			return 0;
+		if (writeToCache)
+			writeCache(cacheFile, signature, results);
+	}
+
+	if (floatResult)
+		*floatResult = results[0];
+	if (intResult)
+		*intResult = results[1];
+	if (memResult)
+		*memResult = results[2];
+	return 1;
+}
@@ -1,19 +1,21 @@
 #pragma once
 
-// Cheeky stub that just returns "good" results.
-inline int RunBenchmark(int argc, char *argv[], float *floatResult, float *intResult, float *memResult)
-{
-    if (floatResult) {
-        *floatResult = 10.0f;
-    }
-    
-    if (intResult) {
-        *intResult = 10.0f;
-    }
-    
-    if (memResult) {
-        *memResult = 10.0f;
-    }
-
-    return 1;
-}
+// CPU benchmark used to pick a static detail level on unknown machines.
+//
+// Runs three short, fixed-size kernels and reports how fast this machine ran each one
+// compared to a reference machine, so that 1.0 means "as fast as the reference" (see
+// REFERENCE_FLOAT_SECONDS in benchmark.cpp; BenchProfile entries must come from this benchmark):
+//   float - 3x4 matrix transforms and matrix concatenation, like WWMath's Matrix3D.
+//   int   - tokenizing and hashing INI-style text, and parsing the numbers in it.
+//   mem   - memcpy over buffers much larger than the caches.
+//
+// The results are cached on disk together with a signature of the processor they were
+// measured on, so only the first run on a machine pays for the benchmark.
+//
+// Options, in the usual argc/argv form (argv[0] is not skipped, so argc may be 0):
+//   -cache <file>   where to keep the cached results (default "Benchmark.dat")
+//   -force          ignore the cached results and measure again (the new results are still cached)
+//   -nocache        neither read nor write the cache
+//
+// Returns 1 if the results were measured or read from the cache, 0 otherwise.
+int RunBenchmark(int argc, char *argv[], float *floatResult, float *intResult, float *memResult);
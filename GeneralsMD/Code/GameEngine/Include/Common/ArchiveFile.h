@@ -55,6 +55,7 @@ public:
 
 	virtual Bool					getFileInfo( const AsciiString& filename, FileInfo *fileInfo) const = 0;	///< fill in the fileInfo struct with info about the file requested.
 	virtual File*					openFile( const Char *filename, Int access = 0) = 0;	///< Open the specified file within the archive file
+	virtual File*					openArchivedFile( const ArchivedFileInfo *fileInfo, const Char *filename, Int access = 0) = 0;	///< Open the file within the archive file that getArchivedFileInfo() returned
 	virtual void					closeAllFiles( void ) = 0;									///< Close all file opened in this archive file
 	virtual AsciiString		getName( void ) = 0;												///< Returns the name of the archive file
 	virtual AsciiString		getPath( void ) = 0;												///< Returns full path and name of archive file
@@ -67,9 +68,10 @@ public:
 
 	void									addFile(const AsciiString& path, const ArchivedFileInfo *fileInfo); ///< add this file to our directory tree.
 
-protected:
 	const ArchivedFileInfo *		getArchivedFileInfo(const AsciiString& filename) const;	///< return the ArchivedFileInfo from the directory tree.
 
+protected:
+
 	File *m_file; ///< file pointer to the archive file on disk.  Kept open so we don't have to continuously open and close the file all the time.
 	DetailedArchivedDirectoryInfo m_rootDirectory;
 };
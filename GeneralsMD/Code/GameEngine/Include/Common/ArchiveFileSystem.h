@@ -143,6 +143,30 @@ public:
 	}
 };
 
+/// where a file in the archive file system lives, as found by ArchiveFileSystem::findArchivedFile().
+struct ArchivedFileLocation
+{
+	ArchiveFile *m_archiveFile;							///< the archive that wins for this path
+	const ArchivedFileInfo *m_fileInfo;			///< offset and size of the file in m_archiveFile
+	const AsciiString *m_archiveFilename;		///< name of m_archiveFile, as it is in the archive file map
+};
+
+/// FNV-1a, over the lower case full paths the path index is keyed by.
+struct ArchivePathHash
+{
+	size_t operator()(const char *s) const
+	{
+		UnsignedInt hash = 2166136261U;
+		while (*s != 0)
+		{
+			hash ^= (UnsignedByte)*s++;
+			hash *= 16777619U;
+		}
+		return hash;
+	}
+};
+
+typedef std::hash_map<const char *, ArchivedFileLocation, ArchivePathHash, rts::equal_to<const char *> > ArchivedFilePathIndex;
 
 class ArchiveFileSystem : public SubsystemInterface
 {
@@ -174,11 +198,53 @@ class ArchiveFileSystem : public SubsystemInterface
 	AsciiString						getArchiveFilenameForFile(const AsciiString& filename) const;
 	void loadMods( void );
 
+	/// find a file through the path index without allocating anything. NULL if it isn't archived, or the index isn't built yet (see hasPathIndex()).
+	const ArchivedFileLocation *findArchivedFile(const Char *filename) const;
+	Bool					hasPathIndex( void ) const { return m_pathIndexBuilt; }
+
 protected:
 	virtual void					loadIntoDirectoryTree(const ArchiveFile *archiveFile, const AsciiString& archiveFilename, Bool overwrite = FALSE );	///< load the archive file's header information and apply it to the global archive directory tree.
 
+	/// add the files in the directory of the given BIG file to archiveFile, from the archive index if it is up to date. FALSE if it isn't a BIG file.
+	Bool									loadBigFileDirectory(ArchiveFile *archiveFile, File *fp, const Char *filename);
+
+	void									loadArchiveIndex( void );			///< read the archive index from the user data folder
+	void									saveArchiveIndex( void );			///< write the archive index back, if anything changed.  loadMods() does this, then drops the index.
+
+	void									buildPathIndex( void );				///< flatten the directory tree into the path index
+	void									updatePathIndex( void );			///< rebuild the path index if it has been built, after archives were added or closed
+
+	/**
+		The archive index keeps the raw directory block of every BIG file we've read, keyed by the
+		BIG file's name, size and timestamp, so that next time the directory tree can be rebuilt
+		without reading the BIG files.
+	*/
+	struct ArchiveIndexEntry
+	{
+		FileInfo m_fileInfo;							///< size and timestamp of the BIG file the directory came from
+		Int m_numFiles;
+		std::vector<char> m_directory;		///< the directory block, as it is in the BIG file
+		Bool m_used;											///< loaded during this run, so it goes back into the index file
+
+		ArchiveIndexEntry() : m_numFiles(0), m_used(FALSE) { memset(&m_fileInfo, 0, sizeof(m_fileInfo)); }
+	};
+	typedef std::map<AsciiString, ArchiveIndexEntry> ArchiveIndexMap;
+
 	ArchiveFileMap m_archiveFileMap;
 	ArchivedDirectoryInfo m_rootDirectory;
+	ArchiveIndexMap m_archiveIndex;					///< keyed by lower case BIG file name
+	AsciiString m_archiveIndexFilename;			///< empty if there is no index
+	Bool m_archiveIndexDirty;								///< an entry was added or replaced since the index file was read
+
+	/**
+		The path index maps the full lower case path of every file in the directory tree
+		(directories separated by '\\') to the archive that wins for it, so lookups are one hash
+		probe instead of a walk down the tree. It is built once the mods are loaded, and lookups
+		made before that walk the tree. The keys all live in m_pathIndexText.
+	*/
+	ArchivedFilePathIndex m_pathIndex;
+	std::vector<char> m_pathIndexText;
+	Bool m_pathIndexBuilt;
 };
 
 
@@ -40,9 +40,11 @@ extern PerfGather TheCritSecPerfGather;
 class CriticalSection
 {
 	CRITICAL_SECTION m_windowsCriticalSection;
+	UnsignedInt m_enterCount;				///< number of times the section was entered
+	UnsignedInt m_contendedCount;		///< number of those times another thread was holding it, so we had to wait
 
 	public:
-		CriticalSection()
+		CriticalSection() : m_enterCount(0), m_contendedCount(0)
 		{
 			#ifdef PERF_TIMERS
 			AutoPerfGather a(TheCritSecPerfGather);
@@ -64,7 +66,12 @@ class CriticalSection
 			#ifdef PERF_TIMERS
 			AutoPerfGather a(TheCritSecPerfGather);
 			#endif
-			EnterCriticalSection( &m_windowsCriticalSection );
+			if (!TryEnterCriticalSection( &m_windowsCriticalSection ))
+			{
+				EnterCriticalSection( &m_windowsCriticalSection );
+				++m_contendedCount;
+			}
+			++m_enterCount;	// we hold the section here, so these counts need no locking of their own
 		}
 		
 		void exit( void )
@@ -74,6 +81,10 @@ class CriticalSection
 			#endif
 			LeaveCriticalSection( &m_windowsCriticalSection );
 		}
+
+	public:	// Contention counters, for profiling.
+		UnsignedInt getEnterCount( void ) const { return m_enterCount; }
+		UnsignedInt getContendedCount( void ) const { return m_contendedCount; }
 };
 
 class ScopedCriticalSection
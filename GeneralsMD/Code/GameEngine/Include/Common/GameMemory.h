@@ -62,6 +62,12 @@
 	#define MEMORYPOOL_DEBUG
 #endif
 
+// when the per-block debug bookkeeping is off, every thread keeps a small magazine of free blocks
+// in front of each pool, so that most allocations and frees don't take TheMemoryPoolCriticalSection.
+#if !defined(MEMORYPOOL_DEBUG) && !defined(MEMORYPOOL_MAGAZINES) && !defined(DISABLE_MEMORYPOOL_MAGAZINES)
+	#define MEMORYPOOL_MAGAZINES
+#endif
+
 // SYSTEM INCLUDES ////////////////////////////////////////////////////////////
 
 #include <new.h>
@@ -226,6 +232,9 @@ class MemoryPool;
 class MemoryPoolFactory;
 class DynamicMemoryAllocator;
 class BlockCheckpointInfo;
+#ifdef MEMORYPOOL_MAGAZINES
+struct MemoryPoolMagazine;
+#endif
 
 // TYPE DEFINES ///////////////////////////////////////////////////////////////
 
@@ -308,7 +317,17 @@ private:
 	Int								m_peakUsedBlocksInPool;			///< high-water mark of m_usedBlocksInPool
 	MemoryPoolBlob		*m_firstBlob;								///< head of linked list: first blob for this pool.
 	MemoryPoolBlob		*m_lastBlob;								///< tail of linked list: last blob for this pool. (needed for efficiency)
-	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< first blob in this pool that has at least one unallocated block.
+	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< head of linked list: blobs in this pool that have at least one unallocated block.
+	MemoryPoolBlob		*m_lastBlobWithFreeBlocks;	///< tail of linked list: blobs in this pool that have at least one unallocated block.
+	Int								m_overflowBlobsCreated;			///< number of blobs created because the pool outgrew its blobs (survives reset())
+	Int								m_emptyBlobsReleased;				///< number of empty blobs given back by releaseEmpties() (survives reset())
+#ifdef MEMORYPOOL_MAGAZINES
+	Int								m_magazineSlot;							///< index of this pool's magazine in every thread's magazine set, or -1 for none
+	Int								m_magazineCapacity;					///< max number of free blocks a thread keeps in its magazine for this pool
+	Int								m_magazineRefills;					///< number of times a magazine was refilled from the blobs (each one takes the lock)
+	Int								m_magazineDrains;						///< number of times a magazine was drained back into the blobs (each one takes the lock)
+	Int								m_blocksInMagazines;				///< blocks counted in m_usedBlocksInPool that are sitting in magazines (as of each magazine's last refill or drain)
+#endif
 
 private:
 	/// create a new blob with the given number of blocks.
@@ -317,6 +336,24 @@ private:
 	/// destroy a blob.
 	Int freeBlob(MemoryPoolBlob *blob);
 
+	/// take a block from the first blob with free blocks. (there must be one)
+	MemoryPoolSingleBlock* takeBlockFromFreeBlob(DECLARE_LITERALSTRING_ARG1);
+
+	/// give a block back to its blob, putting the blob back on the free list if it was full.
+	void returnBlockToBlob(MemoryPoolSingleBlock *block);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	/// return the calling thread's magazine for this pool, creating it if necessary. null if this pool has none.
+	MemoryPoolMagazine *getThreadMagazine();
+	MemoryPoolMagazine *createThreadMagazine();
+
+	/// move half a magazine's worth of blocks from the blobs into the (empty) magazine.
+	void refillMagazine(MemoryPoolMagazine *magazine);
+
+	/// give the oldest blocks in the magazine back to the blobs, until only 'keep' are left.
+	void drainMagazine(MemoryPoolMagazine *magazine, Int keep);
+#endif
+
 public:
 
 	// 'public' funcs that are really only for use by MemoryPoolFactory
@@ -375,6 +412,15 @@ public:
 	/// return the initial allocation count for this pool
 	Int getInitialBlockCount();
 
+	/// return the overflow allocation count for this pool (0 if it is not allowed to grow)
+	Int getOverflowBlockCount();
+
+	/// return the number of overflow blobs this pool has had to create
+	Int getOverflowBlobsCreated();
+
+	/// return the number of empty blobs releaseEmpties() has given back
+	Int getEmptyBlobsReleased();
+
 	Int countBlobsInPool();
 
 	/// if this pool has any empty blobs, return them to the system.
@@ -383,6 +429,20 @@ public:
 	/// destroy all blocks and blobs in this pool.
 	void reset();
 
+	#ifdef MEMORYPOOL_MAGAZINES
+		/// give the free blocks in every thread's magazine back to this pool. (no other thread may be using the pool.)
+		void flushMagazines();
+
+		/// give the free blocks in the calling thread's magazine back to this pool.
+		void flushThreadMagazine();
+
+		/// return the number of times a magazine of this pool had to be refilled from the blobs.
+		Int getMagazineRefillCount();
+
+		/// return the number of times a magazine of this pool had to be drained back into the blobs.
+		Int getMagazineDrainCount();
+	#endif
+
 	#ifdef MEMORYPOOL_DEBUG
 		/// return true iff this block was allocated by this pool.
 		Bool debugIsBlockInPool(void *pBlock);
@@ -409,6 +469,8 @@ private:
 	Int												m_usedBlocksInDma;		///< total number of blocks allocated, from subpools and "raw"
 	MemoryPool								*m_pools[MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS];	///< the subpools
 	MemoryPoolSingleBlock			*m_rawBlocks;					///< linked list of "raw" blocks allocated directly from system
+	Int												m_numSizeClasses;			///< number of entries in m_sizeClassPools
+	MemoryPool								**m_sizeClassPools;		///< the best subpool for each size class (size rounded up to the alignment, divided by it)
 
 	/// return the best pool for the given allocSize, or null if none are suitable
 	MemoryPool *findPoolForSize(Int allocSize);
@@ -550,6 +612,25 @@ public:
 
 	void memoryPoolUsageReport( const char* filename, FILE *appendToFileInstead = NULL );
 
+	#ifdef MEMORYPOOL_MAGAZINES
+		/// give the free blocks in the calling thread's magazines back to their pools.
+		void flushThreadMagazines();
+
+		/// log how often the memory locks were taken and waited for, and which pools' magazines went to the lock most.
+		void debugMagazineReport();
+	#endif
+
+	#if defined(_DEBUG) || defined(_INTERNAL)
+		/// start writing every pool allocation and free to the given file, for the MemoryPoolBenchmark.
+		Bool debugStartTrace( const char *fileName );
+
+		/// finish the trace file.
+		void debugStopTrace();
+
+		/// write a MemoryPools.ini with pool sizes that fit the peak usage seen so far.
+		void debugWritePoolSizing( const char *fileName );
+	#endif
+
 	#ifdef MEMORYPOOL_DEBUG
 
 		/// perform internal consistency checking
@@ -778,7 +859,14 @@ inline Int MemoryPool::getFreeBlockCount() { return getTotalBlockCount() - getUs
 inline Int MemoryPool::getUsedBlockCount() { return m_usedBlocksInPool; }
 inline Int MemoryPool::getTotalBlockCount() { return m_totalBlocksInPool; }
 inline Int MemoryPool::getPeakBlockCount() { return m_peakUsedBlocksInPool; }
+inline Int MemoryPool::getOverflowBlobsCreated() { return m_overflowBlobsCreated; }
+inline Int MemoryPool::getEmptyBlobsReleased() { return m_emptyBlobsReleased; }
 inline Int MemoryPool::getInitialBlockCount() { return m_initialAllocationCount; }
+inline Int MemoryPool::getOverflowBlockCount() { return m_overflowAllocationCount; }
+#ifdef MEMORYPOOL_MAGAZINES
+inline Int MemoryPool::getMagazineRefillCount() { return m_magazineRefills; }
+inline Int MemoryPool::getMagazineDrainCount() { return m_magazineDrains; }
+#endif
 
 // ----------------------------------------------------------------------------
 inline DynamicMemoryAllocator *DynamicMemoryAllocator::getNextDmaInList() { return m_nextDmaInFactory; }
@@ -65,6 +65,11 @@ class MemoryPoolFactory
 public:
 
 	void memoryPoolUsageReport( const char* filename, FILE *appendToFileInstead = NULL );
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Bool debugStartTrace( const char *fileName );
+	void debugStopTrace();
+	void debugWritePoolSizing( const char *fileName );
+#endif
 
 #ifdef MEMORYPOOL_DEBUG
 
@@ -169,6 +169,8 @@ public:
 										 SnapshotType which = SNAPSHOT_SAVELOAD  );  ///< save a game
 	SaveCode missionSave( void );																	 ///< do a in between mission save
 	SaveCode loadGame( AvailableGameInfo gameInfo );							 ///< load a save file
+	SaveCode saveSnapshot( AsciiString filepath );								 ///< quietly save the game to any file (replay keyframes)
+	SaveCode loadSnapshot( AsciiString filepath );								 ///< quietly load a file written by saveSnapshot()
 	SaveGameInfo *getSaveGameInfo( void ) { return &m_gameInfo; }
 
 	// snapshot interaction
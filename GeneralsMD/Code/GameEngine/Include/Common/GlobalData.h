@@ -249,6 +249,10 @@ public:
 	Bool m_showTerrainNormals;
 
 	UnsignedInt m_noDraw;					///< Used to disable drawing, to profile game logic code.
+	UnsignedInt m_replayKeyframeInterval;	///< If nonzero, replays without keyframes get one saved every this many frames during playback
+	UnsignedInt m_replaySeekFrame;	///< If nonzero, playback jumps to this frame once the replay is under way
+	Bool m_replaySimulate;				///< Play replays back as fast as possible without the client, and quit at the end
+	Bool m_replayCheckKeyframes;	///< At the end of a simulated replay, check that playing on from each keyframe gives the same CRCs
 	AIDebugOptions m_debugAI;			///< Used to display AI debug information
 	Bool m_debugSupplyCenterPlacement; ///< Dumps to log everywhere it thinks about placing a supply center
 	Bool m_debugAIObstacles;			///< Used to display AI obstacle debug information
@@ -318,6 +322,9 @@ public:
 	Real m_commandCenterHealAmount;   ///< health per logic frame close by things are healed
 	Int m_maxLineBuildObjects;				///< line style builds can be no longer than this
 	Int m_maxTunnelCapacity;					///< Max people in Player's tunnel network
+	Bool m_incrementalPathfindZones;	///< Repair the pathfind zones around changed structures at once, rather than rezoning the map later.  Changes pathing, so games & replays must agree on it.
+	Bool m_pathfindFlowFields;				///< Large group moves share a flow field instead of each unit searching.  Changes pathing, so games & replays must agree on it.
+	Bool m_pathfindCache;							///< Units moving together share recently found paths instead of each searching.  Changes pathing, so games & replays must agree on it.
 	Real m_horizontalScrollSpeedFactor;	///< Factor applied to the game screen scrolling speed.
 	Real m_verticalScrollSpeedFactor;		///< Seperated because of our aspect ratio
 	Real m_scrollAmountCutoff;				///< Scroll speed to not adjust camera height
@@ -441,7 +448,11 @@ public:
 	UnsignedInt m_networkCushionHistoryLength;      	///< The number of cushion values to keep.
 	UnsignedInt m_networkRunAheadMetricsTime;	      	///< The number of miliseconds between run ahead metrics things
 	UnsignedInt m_networkKeepAliveDelay;			      	///< The number of seconds between when the connections to each player send a keep-alive packet.
-	UnsignedInt m_networkRunAheadSlack;				      	///< The amount of slack in the run ahead value. This is the percentage of the calculated run ahead that is added.
+	UnsignedInt m_networkRunAheadSlack;				      	///< The percentage of the run ahead that incoming commands need to have to spare before we slow our frame rate down.
+	UnsignedInt m_networkRunAheadPercentile;		    	///< The run ahead is made long enough for this percentage of each player's recent latencies.
+	UnsignedInt m_networkRunAheadHysteresis;		    	///< The number of frames the run ahead has to be able to drop by before it is lowered.
+	UnsignedInt m_networkRunAheadDecreaseDelay;	    	///< The number of run ahead updates in a row it has to be able to drop for before it is lowered.
+	UnsignedInt m_networkRunAheadMinCushion;		    	///< If incoming commands have fewer frames to spare than this, the run ahead isn't lowered.
 	UnsignedInt m_networkDisconnectTime;			      	///< The number of milliseconds between when the game gets stuck on a frame for a network stall and when the disconnect dialog comes up.
 	UnsignedInt m_networkPlayerTimeoutTime;		      	///< The number of milliseconds between when a player's last keep alive command was recieved and when they are considered disconnected from the game.
 	UnsignedInt	m_networkDisconnectScreenNotifyTime;  ///< The number of milliseconds between when the disconnect screen comes up and when the other players are notified that we are on the disconnect screen.
@@ -502,6 +513,20 @@ public:
 	Int m_latencyNoise;						///< Max amplitude of jitter to throw in
 	Int m_packetLoss;							///< Percent of packets to drop
 	Bool m_extraLogging;					///< More expensive debug logging to catch crashes.
+	AsciiString m_recordPathfindQueriesFile;		///< If set, record all pathfind queries to this file.
+	AsciiString m_pathfindBenchmarkFile;				///< If set, replay the pathfind queries in this file once the map is loaded, then quit.
+	AsciiString m_pathfindBenchmarkReportFile;	///< Where to write the pathfind benchmark results.
+	Int m_sleepyUpdateBenchmarkModules;				///< If nonzero, benchmark the sleepy update queue with this many modules at startup.
+	AsciiString m_recordMemoryTraceFile;			///< If set, record all memory pool traffic to this file.
+	AsciiString m_memoryPoolBenchmarkFile;		///< If set, replay the memory pool traffic in this file at startup.
+	AsciiString m_memoryPoolSizingFile;				///< If set, write pool sizes fitted to this run's peak usage to this file on exit.
+	Int m_networkSoakPlayers;									///< If nonzero, play a network game between this many in-process players at startup, then quit.
+	Int m_networkSoakFrames;									///< How many frames the network soak plays.
+	Int m_networkSoakLatency;									///< Milliseconds each network soak packet takes to arrive...
+	Int m_networkSoakJitter;									///< ...give or take up to this many...
+	Int m_networkSoakPacketLoss;							///< ...if it isn't one of the this percent that are lost.
+	Int m_netPacketBenchmarkCommands;					///< If nonzero, compare the packet formats on this many game commands at startup, then quit.
+	AsciiString m_runAheadSimulationFile;			///< If set, play the latencies in this file through the run ahead calculations at startup, then quit.
 #endif
 
 #ifdef DEBUG_CRASHING
@@ -524,6 +549,9 @@ public:
 	// the trailing '\' is included!
   const AsciiString &getPath_UserData() const { return m_userDataDir; }
 
+	/// the user data folder as getPath_UserData() returns it, created if need be. for use before TheGlobalData exists.
+	static AsciiString findUserDataDir( void );
+
 private:
 
 	static const FieldParse s_GlobalDataFieldParseTable[];
@@ -42,6 +42,7 @@
 class INI;
 class Xfer;
 class File;
+struct INILines;
 enum ScienceType CPP_11(: Int);
 
 //-------------------------------------------------------------------------------------------------
@@ -386,20 +387,16 @@ protected:
 
 	static Bool isValidINIFilename( const char *filename ); ///< is this a valid .ini filename		
 
-	void prepFile( AsciiString filename, INILoadType loadType );
+	void load( AsciiString filename, INILoadType loadType, Xfer *pXfer, const INILines *lines );
+	void prepFile( AsciiString filename, INILoadType loadType, const INILines *lines = NULL );
 	void unPrepFile();
 
 	void readLine( void );
 
-	File *m_file;															///< file pointer of file currently loading
-
-  enum
-  {
-    INI_READ_BUFFER = 8192                  ///< size of internal read buffer
-  };
-  char m_readBuffer[INI_READ_BUFFER];       ///< internal read buffer
-  unsigned m_readBufferNext;                ///< next char in read buffer
-  unsigned m_readBufferUsed;                ///< number of bytes in read buffer
+	const INILines *m_lines;									///< lexed lines of file currently loading
+	INILines *m_ownLines;											///< holds the lines when the caller didn't lex the file
+	const char *m_nextLine;										///< next line to hand out
+	Int m_linesLeft;													///< number of lines not handed out yet
 
 	AsciiString m_filename;										///< filename of file currently loading
 	INILoadType m_loadType;										///< load time for current file
@@ -0,0 +1,87 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// INICache.h
+// Lexed INI line streams.
+//
+// INI::load() does not read its file a character at a time any more. The whole file is lexed
+// up front into an INILines: every line exactly as INI::readLine() hands it to the parsers and
+// to the INI CRC (comments stripped, control characters turned into spaces, overlong lines
+// split), so the parsed data and TheGlobalData->m_iniCRC don't change.
+//
+// INI::loadDirectory() hands its whole list of files to an INICache's lexFiles() first. The
+// files are read one after the other (the file system isn't thread safe) and then lexed in
+// parallel, and only after that are the block parsers run, one file at a time in the usual
+// order. Lexing doesn't depend on anything but the file itself, so this changes nothing about
+// the parsed data or the INI CRC. The lines only live as long as the INICache; nothing is kept
+// between runs.
+
+#pragma once
+
+#ifndef _INI_CACHE_H_
+#define _INI_CACHE_H_
+
+#include "Common/AsciiString.h"
+#include "Common/STLTypedefs.h"
+
+//-------------------------------------------------------------------------------------------------
+/** The lines of one INI file, as INI::readLine() returns them. */
+//-------------------------------------------------------------------------------------------------
+struct INILines
+{
+	std::vector<char> m_text;			///< all lines, each one NUL terminated
+	Int m_numLines;								///< number of lines in m_text; the last one is the one that hit EOF
+
+	INILines() : m_numLines(0) { }
+
+	/// read and lex the given file. returns FALSE if it can't be opened.
+	Bool load( const AsciiString& filename );
+
+	/// lex the file contents in 'source'. 'filename' is only used for error messages.
+	void lex( const char *source, Int sourceSize, const AsciiString& filename );
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The lexed lines of a set of INI files, such as the files of one directory */
+//-------------------------------------------------------------------------------------------------
+class INICache
+{
+public:
+
+	INICache();
+	~INICache();
+
+	/// return the lines of the given INI file, lexing it first if lexFiles() didn't. NULL if the file can't be read.
+	const INILines *getLines( const AsciiString& filename );
+
+	/// lex all the given files that haven't been yet, on several threads.
+	void lexFiles( const std::vector<AsciiString>& filenames );
+
+private:
+
+	typedef std::map<AsciiString, INILines *> EntryMap;
+
+	void clear( void );
+
+	/// find (or add) the entry for the given file. isLexed tells whether it holds the file's lines yet.
+	INILines *findEntry( const AsciiString& filename, Bool& isLexed );
+
+	EntryMap m_entries;					///< keyed by lower case filename
+};
+
+#endif // _INI_CACHE_H_
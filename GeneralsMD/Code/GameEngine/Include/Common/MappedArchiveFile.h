@@ -0,0 +1,96 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// MappedArchiveFile.h
+// Read-only files that are read straight out of a memory mapped archive.
+//
+// A RAMFile opened from an archive allocates a buffer the size of the file and reads the file
+// into it. A MappedArchiveFile maps the part of the archive the file is in instead, and reads,
+// seeks and scans in place, so a big texture or model costs page faults rather than an
+// allocation and a copy. It is a RAMFile in every other respect. Only readEntireAndClose()
+// still copies, because its caller owns (and deletes) the buffer it returns.
+//
+// Mapping a view has a cost of its own, so archives only map files of at least
+// MappedArchiveFile::MIN_MAPPED_SIZE bytes and keep copying the small ones.
+
+#pragma once
+
+#ifndef _MAPPED_ARCHIVE_FILE_H_
+#define _MAPPED_ARCHIVE_FILE_H_
+
+#include "Common/RAMFile.h"
+
+//-------------------------------------------------------------------------------------------------
+/** A read-only mapping of a whole archive file, from which views of parts of it are mapped.
+	Views stay valid after the mapping is closed. */
+//-------------------------------------------------------------------------------------------------
+class ArchiveFileMapping
+{
+public:
+
+	ArchiveFileMapping();
+	~ArchiveFileMapping();
+
+	Bool open( const Char *path );					///< map the given file. returns FALSE if it can't be mapped
+	void close( void );
+	Bool isOpen( void ) const;
+
+	/// map the 'size' bytes at 'offset'. returns a pointer to them, or NULL on failure. pass 'view' and 'viewSize' to unmapView() when done.
+	const Char *mapView( Int offset, Int size, void *&view, Int &viewSize ) const;
+	static void unmapView( void *view, Int viewSize );
+
+private:
+
+#ifdef _WIN32
+	void *m_file;														///< HANDLE of the archive file
+	void *m_mapping;												///< HANDLE of the file mapping
+#else
+	int m_fd;
+#endif
+	Int m_granularity;											///< views must start at a multiple of this
+};
+
+//-------------------------------------------------------------------------------------------------
+/** A RAMFile whose data is a view of the archive it came from */
+//-------------------------------------------------------------------------------------------------
+class MappedArchiveFile : public RAMFile
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(MappedArchiveFile, "MappedArchiveFile")
+
+public:
+
+	enum { MIN_MAPPED_SIZE = 64 * 1024 };		///< smaller files are cheaper to copy than to map
+
+	MappedArchiveFile();
+	//virtual				~MappedArchiveFile();
+
+	/// open the file at the given offset and size in the mapped archive.
+	Bool openFromMapping( const ArchiveFileMapping& mapping, const AsciiString& filename, Int offset, Int size );
+
+	virtual void	close( void );
+	virtual char* readEntireAndClose();
+
+protected:
+
+	void unmap( void );
+
+	void *m_view;														///< the mapped view m_data points into, or NULL if m_data is our own
+	Int m_viewSize;
+};
+
+#endif // _MAPPED_ARCHIVE_FILE_H_
@@ -0,0 +1,80 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// MemoryPoolBenchmark.h
+// Records the memory pool traffic of a game, and replays it to time the pool bookkeeping.
+//
+// Usage (debug & internal builds):
+//   record:  -recordMemoryTrace <trace.bin>      (then play a match and quit)
+//   replay:  -memoryPoolBenchmark <trace.bin>
+// The replay runs at startup and compares, on the recorded traffic:
+//   - finding the DMA subpool for a size by scanning the subpools vs. the size class table
+//   - finding a blob with free blocks by walking the blob list vs. the list of blobs with free blocks
+// The replay uses its own model of the pools, so both versions can be timed in the same run.
+//
+// Trace files are binary: a MemoryTraceHeader, then MemoryTraceEvents, then the pool table
+// (MemoryTracePool records, each followed by the pool name), then the file offset of the
+// pool table as the last 4 bytes.
+
+#pragma once
+
+#ifndef _MEMORY_POOL_BENCHMARK_H_
+#define _MEMORY_POOL_BENCHMARK_H_
+
+#include "Common/AsciiString.h"
+
+enum MemoryTraceOp
+{
+	MEMORY_TRACE_ALLOC = 0,		///< a block was allocated from the pool
+	MEMORY_TRACE_FREE,				///< a block was given back to the pool
+	MEMORY_TRACE_DMA,					///< the DMA was asked for m_bytes; the allocation from its subpool (if any) follows
+
+	MEMORY_TRACE_OP_MASK = 3
+};
+
+struct MemoryTraceHeader
+{
+	char m_magic[4];					///< "MTRC"
+	Int m_version;
+};
+
+struct MemoryTraceEvent
+{
+	UnsignedInt m_pool;				///< address of the pool while recording (0 for DMA requests too big for any subpool)
+	UnsignedInt m_blockAndOp;	///< address of the block while recording, with the MemoryTraceOp in the low two bits
+	Int m_bytes;							///< requested size (MEMORY_TRACE_DMA only)
+};
+
+struct MemoryTracePool
+{
+	UnsignedInt m_pool;				///< address of the pool while recording
+	Int m_allocationSize;
+	Int m_initialAllocationCount;
+	Int m_overflowAllocationCount;
+	Int m_nameLength;					///< length of the name that follows this record
+};
+
+#define MEMORY_TRACE_MAGIC		"MTRC"
+#define MEMORY_TRACE_VERSION	1
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// replay the given trace through both versions of the pool bookkeeping and log the times.
+void runMemoryPoolBenchmark( const AsciiString &traceFileName );
+#endif
+
+#endif // _MEMORY_POOL_BENCHMARK_H_
@@ -39,6 +39,10 @@ extern void InitGameLogicRandom( UnsignedInt seed ); ///< Set the GameLogic seed
 extern UnsignedInt GetGameLogicRandomSeed( void );   ///< Get the seed (used for replays)
 extern UnsignedInt GetGameLogicRandomSeedCRC( void );///< Get the seed (used for CRCs)
 
+enum { GAME_LOGIC_RANDOM_STATE_SIZE = 7 };
+extern void GetGameLogicRandomState( UnsignedInt *state );				///< Copy out the whole GameLogic random state, GAME_LOGIC_RANDOM_STATE_SIZE values (used for replay keyframes)
+extern void SetGameLogicRandomState( const UnsignedInt *state );	///< Put back a state from GetGameLogicRandomState()
+
 //--------------------------------------------------------------------------------------------------------------
 
 #endif // _RANDOM_VALUE_H_
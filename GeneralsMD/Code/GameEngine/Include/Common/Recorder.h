@@ -26,6 +26,8 @@
 #pragma once
 
 #include "Common/MessageStream.h"
+#include "Common/RandomValue.h"
+#include "Common/ReplayWriter.h"
 #include "GameNetwork/GameInfo.h"
 
 /**
@@ -71,6 +73,11 @@ public:
 	Bool testVersionPlayback(AsciiString filename);   ///< Returns if the playback is a valid playback file for this version or not.
 	AsciiString getCurrentReplayFilename( void );			///< valid during playback only
 	void stopPlayback();															///< Stops playback.  Its fine to call this even if not playing back a file.
+
+	// Methods dealing with replay keyframes.
+	void updateKeyframes();														///< Between logic frames: save keyframes, and start pending seeks.
+	Bool seekToFrame(UnsignedInt frame);							///< Jump playback to the frame, from the nearest keyframe before it if there is one.
+	Bool isSimulatingFast( void ) const;									///< TRUE while playback runs without the client (seeking, or -replaySimulate).
 #if defined _DEBUG || defined _INTERNAL
 	Bool analyzeReplay( AsciiString filename );
 	Bool isAnalysisInProgress( void );
@@ -139,7 +146,31 @@ protected:
 
 	void cullBadCommands();														///< prevent the user from giving mouse commands that he shouldn't be able to do during playback.
 
+	/**
+		A keyframe is a snapshot of the game taken between two logic frames of a playback, and
+		where in the replay the commands for the frames after it start. The keyframes of a replay
+		live in their own directory under the replay directory, with an index of them.
+	*/
+	struct ReplayKeyframe
+	{
+		UnsignedInt m_frame;														///< logic frame the snapshot is of. none of its commands have run yet
+		Int m_commandOffset;														///< file offset of the first command for m_frame or later
+		UnsignedInt m_randomState[GAME_LOGIC_RANDOM_STATE_SIZE];	///< the logic random state, which isn't in the snapshot
+		Int m_pendingCRCs;															///< our CRCs of earlier frames the replay's CRCs hadn't been compared with yet
+	};
+	typedef std::vector<ReplayKeyframe> ReplayKeyframeList;
+
+	AsciiString getKeyframeDir( void );
+	AsciiString getKeyframeFilename( UnsignedInt frame );
+	void loadKeyframeIndex( void );										///< read the current replay's keyframes, and decide whether to save new ones
+	void saveKeyframeIndex( void );
+	void saveKeyframe( void );												///< snapshot the game as it is now
+	Bool loadKeyframe( ReplayKeyframe keyframe );			///< restore a keyframe, and carry on playback from it
+	void checkKeyframeCRC( UnsignedInt frame );				///< -replayCheckKeyframes: keep or compare this frame's CRC
+	void checkNextKeyframe( void );										///< -replayCheckKeyframes: load the next keyframe to check
+
 	FILE *m_file;
+	ReplayWriter m_replayWriter;											///< writes the commands to m_file while recording
 	AsciiString m_fileName;
 	Int m_currentFilePosition;
 	RecorderModeType m_mode;
@@ -153,6 +184,17 @@ protected:
 	Int m_originalGameMode; // valid in replays
 
 	UnsignedInt m_nextFrame;												///< The Frame that the next message is to be executed on.  This can be -1.
+
+	ReplayKeyframeList m_keyframes;										///< keyframes of the replay being played back
+	Bool m_savingKeyframes;														///< the replay had no up to date keyframes, so we are saving them
+	Bool m_loadingKeyframe;														///< reset() leaves playback alone while this is set
+	UnsignedInt m_seekFrame;													///< frame a seek is fast forwarding to, 0 if none
+
+	std::map<UnsignedInt, UnsignedInt> m_straightCRCs;	///< -replayCheckKeyframes: logic CRCs by frame, from playing straight through
+	Int m_checkingKeyframe;														///< the keyframe being checked, -1 while playing straight through
+	Bool m_checkKeyframePending;											///< the replay ended, so load the next keyframe to check
+	Int m_keyframeCRCsChecked;
+	Int m_keyframeCRCMismatches;
 };
 
 extern RecorderClass *TheRecorder;
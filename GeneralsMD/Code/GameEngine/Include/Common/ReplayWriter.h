@@ -0,0 +1,91 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ReplayWriter.h
+// Buffers the commands the recorder writes to a replay, and writes them out on a thread of its own.
+//
+// The recorder used to fwrite every field of every command, and fflush after each one. Now
+// it appends the same bytes to a ring of blocks here, and a block is handed to the writer
+// thread when it is full, or when it has been collecting commands for FRAMES_PER_HAND_OFF
+// frames. The bytes, and so the replay file, are exactly what they were.
+//
+// flush() writes everything appended so far on the calling thread, and returns once it is in
+// the file. The recorder flushes before it patches the replay header and before it closes the
+// file, and the crash handlers flush through flushAll(), so a replay is complete either way.
+
+#pragma once
+
+#ifndef _REPLAY_WRITER_H_
+#define _REPLAY_WRITER_H_
+
+#include "Common/CriticalSection.h"
+
+class ReplayWriterThread;
+
+//-------------------------------------------------------------------------------------------------
+class ReplayWriter
+{
+public:
+
+	enum
+	{
+		BLOCK_SIZE = 16 * 1024,
+		NUM_BLOCKS = 8,
+		FRAMES_PER_HAND_OFF = 30		///< don't let a partly filled block wait longer than this
+	};
+
+	ReplayWriter();
+	~ReplayWriter();
+
+	void open( FILE *file );					///< start writing to file. everything already in it must have been flushed
+	void close( void );								///< write everything out and stop the writer thread. the file stays open
+	Bool isOpen( void ) const { return m_file != NULL; }
+
+	void write( const void *data, Int size );	///< append to the replay
+	void endFrame( void );						///< the commands of this frame are all in
+	void flush( void );								///< write everything appended so far, and wait for it
+
+	static void flushAll( void );			///< flush the open writer, if there is one. for the crash handlers
+
+private:
+
+	friend class ReplayWriterThread;
+
+	struct Block
+	{
+		Int m_size;
+		char m_data[BLOCK_SIZE];
+	};
+
+	void handOff( void );							///< queue the block being filled for the writer thread
+	void writeQueued( void );					///< write the queued blocks. call with m_fileLock held
+
+	FILE *m_file;
+	Block *m_blocks;									///< ring of NUM_BLOCKS blocks
+	Int m_firstQueued;								///< blocks m_firstQueued up to m_filling are waiting to be written
+	Int m_filling;										///< the block write() appends to
+	Int m_framesSinceHandOff;
+	CriticalSection m_fileLock;				///< held while m_file is written to
+	CriticalSection m_queueLock;			///< guards m_firstQueued and m_filling
+	void *m_wakeEvent;								///< HANDLE of the event that tells the writer thread there is work
+	ReplayWriterThread *m_thread;
+
+	static ReplayWriter *s_openWriter;
+};
+
+#endif // _REPLAY_WRITER_H_
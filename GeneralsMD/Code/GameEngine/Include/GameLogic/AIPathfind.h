@@ -42,6 +42,8 @@ class Bridge;
 class Object;
 class Weapon;
 class PathfindZoneManager;
+class PathfindOpenList;
+class Pathfinder;
 
 // How close is close enough when moving.
 
@@ -207,6 +209,7 @@ enum {MAX_WALL_PIECES = 128};
 class PathfindCellInfo
 {
 	friend class PathfindCell;
+	friend class PathfindOpenList;
 public:
 	static void allocateCellInfos(void);
 	static void releaseCellInfos(void);
@@ -219,7 +222,9 @@ protected:
 	static PathfindCellInfo *s_firstFree;							///< 
 
 
-	PathfindCellInfo *m_nextOpen, *m_prevOpen;						///< for A* "open" list, shared by closed list
+	PathfindCellInfo *m_nextOpen, *m_prevOpen;						///< for A* "closed" list
+	Int m_openIndex;																	///< Index into the open list heap, when on the open list.
+	UnsignedInt m_openSequence;												///< Order this cell was put on the open list, breaks cost ties.
 
 	PathfindCellInfo *m_pathParent;												///< "parent" cell from pathfinder
 	PathfindCell *m_cell;															///< Cell this info belongs to currently.
@@ -252,6 +257,7 @@ protected:
  */
 class PathfindCell
 {
+	friend class PathfindOpenList;
 public:
 
 	enum CellType
@@ -300,11 +306,11 @@ public:
 
 	UnsignedInt costSoFar( PathfindCell *parent );
 
-	/// put self on "open" list in ascending cost order, return new list
-	PathfindCell *putOnSortedOpenList( PathfindCell *list );		
+	/// put self on "open" list in ascending cost order
+	void putOnSortedOpenList( PathfindOpenList &list );		
 
 	/// remove self from "open" list
-	PathfindCell *removeFromOpenList( PathfindCell *list );		
+	void removeFromOpenList( PathfindOpenList &list );		
 
 	/// put self on "closed" list, return new list
 	PathfindCell *putOnClosedList( PathfindCell *list );		
@@ -315,8 +321,8 @@ public:
 	/// remove all cells from closed list.
 	static Int releaseClosedList( PathfindCell *list );	
 
-	/// remove all cells from closed list.
-	static Int releaseOpenList( PathfindCell *list );	
+	/// remove all cells from open list.
+	static Int releaseOpenList( PathfindOpenList &list );	
 
 	inline PathfindCell *getNextOpen(void) {return m_info->m_nextOpen?m_info->m_nextOpen->m_cell:NULL;}
 
@@ -377,6 +383,51 @@ private:
 
 typedef PathfindCell *PathfindCellP;
 
+/**
+ * The A* "open" list.  A binary heap ordered by total cost, with ties going to the cell that
+ * was put on the list first.  This pops cells in exactly the same order as the old insertion
+ * sorted linked list, so paths (and CRCs) are unchanged, but insertion is O(log n) instead of
+ * O(n).
+ */
+class PathfindOpenList
+{
+public:
+	PathfindOpenList();
+	~PathfindOpenList();
+
+	void allocate(Int maxCells);				///< Allocate room for maxCells cells.
+	void release(void);
+
+	void reset(PathfindCell *startCell);	///< Empty the list, and start it with startCell (already flagged as open) if not NULL.
+	inline Bool isEmpty(void) const {return m_count==0;}
+	inline Int getCount(void) const {return m_count;}
+	inline PathfindCell *getHead(void) const {return m_count>0 ? m_heap[0]->m_cell : NULL;}	///< Lowest cost cell.
+	inline PathfindCell *getCell(Int ndx) const {return m_heap[ndx]->m_cell;}	///< In heap order, not sorted.
+
+	void insert(PathfindCellInfo *info);
+	void remove(PathfindCellInfo *info);
+	PathfindCellInfo *removeLast(void);
+
+	inline UnsignedInt getOperationCount(void) const {return m_operationCount;}	///< Inserts & removes since last clear.
+	inline void clearOperationCount(void) {m_operationCount = 0;}
+
+protected:
+	inline Bool isLess(const PathfindCellInfo *a, const PathfindCellInfo *b) const
+	{
+		if (a->m_totalCost != b->m_totalCost) return a->m_totalCost < b->m_totalCost;
+		return a->m_openSequence < b->m_openSequence;
+	}
+	inline void place(PathfindCellInfo *info, Int ndx) {m_heap[ndx] = info; info->m_openIndex = ndx;}
+	void siftUp(Int ndx);
+	void siftDown(Int ndx);
+
+	PathfindCellInfo **m_heap;
+	Int m_count;
+	Int m_maxCount;
+	UnsignedInt m_nextSequence;
+	UnsignedInt m_operationCount;
+};
+
 
 // how close a unit has to be in z to interact with the layer.
 #define LAYER_Z_CLOSE_ENOUGH_F 10.0f
@@ -405,6 +456,7 @@ public:
 	void applyZone(void); // Propagates m_zone to all cells.
 	void getStartCellIndex(ICoord2D *start) {*start = m_startCell;}
 	void getEndCellIndex(ICoord2D *end) {*end = m_endCell;}
+	void getCellBounds(IRegion2D *bounds); ///< Ground cells covered by the layer, including the start & end cells.
 
 	ObjectID getBridgeID(void);
 	Bool connectsZones(PathfindZoneManager *zm, const LocomotorSet& locomotorSet,Int zone1, Int zone2);
@@ -443,6 +495,28 @@ enum { PATHFIND_QUEUE_LEN=512};
 
 struct TCheckMovementInfo;
 
+/**
+ * A connection between two adjacent zones, and the zone equivalency tables that join them.
+ * Each zone block keeps the connections of its own cells and of the cells on its left & top edges,
+ * so the equivalency tables can be rebuilt from the blocks without walking the map.
+ */
+struct ZoneEdge
+{
+	enum
+	{
+		HIERARCHICAL	= 0x01,		///< Same type of cell, or a bridge end.
+		TERRAIN				= 0x02,
+		CRUSHER				= 0x04,
+		GROUND_WATER	= 0x08,
+		GROUND_RUBBLE	= 0x10,
+		GROUND_CLIFF	= 0x20
+	};
+
+	zoneStorageType m_zone1;
+	zoneStorageType m_zone2;
+	UnsignedByte		m_relations;
+};
+
 /** 
  * This class is a helper class for zone manager.  It maintains information regarding the 
  * LocomotorSurfaceTypeMask equivalencies within a ZONE_BLOCK_SIZE x ZONE_BLOCK_SIZE area of 
@@ -457,6 +531,11 @@ public:
 	~ZoneBlock();  // not virtual, please don't override without making virtual.  jba.
 
 	void blockCalculateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Does zone calculations.  
+	void blockCalculateEdges(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds, const IRegion2D &globalBounds);	///< Records the zone connections.
+	Int getNumEdges(void) const {return m_numEdges;}
+	const ZoneEdge *getEdge(Int ndx) const {return &m_edges[ndx];}
+	zoneStorageType getFirstZone(void) const {return m_firstZone;}
+	Int getNumZones(void) const {return m_numZones;}
 	zoneStorageType getEffectiveZone(LocomotorSurfaceTypeMask acceptableSurfaces, Bool crusher, zoneStorageType zone) const;
 
 	void clearMarkedPassable(void) {m_markedPassable = false;}
@@ -469,6 +548,8 @@ public:
 protected:
 	void allocateZones(void);
 	void freeZones(void);
+	void addEdge(zoneStorageType zone1, zoneStorageType zone2, UnsignedByte relations);
+	void freeEdges(void);
 
 protected:
 	ICoord2D		m_cellOrigin;
@@ -485,6 +566,10 @@ protected:
 	zoneStorageType *m_crusherZones;
 	Bool					m_interactsWithBridge;
 	Bool					m_markedPassable;
+
+	ZoneEdge			*m_edges;						///< Connections to adjacent zones.
+	UnsignedShort m_numEdges;
+	UnsignedShort m_edgesAllocated;
 };
 typedef ZoneBlock *ZoneBlockP;
 
@@ -503,6 +588,7 @@ public:
 	enum {ZONE_BLOCK_SIZE = 10};	// Zones are calculated in blocks of 20x20.  This way, the raw zone numbers can be used to 
 	enum {UNINITIALIZED_ZONE = 0};
 																// compute hierarchically between the 20x20 blocks of cells. jba.
+	enum {MAX_ZONES = 0x4000};		///< PathfindCell::m_zone is 14 bits.
 	PathfindZoneManager();
 	~PathfindZoneManager();
 
@@ -510,7 +596,7 @@ public:
 
 	Bool needToCalculateZones(void) const {return m_nextFrameToCalculateZones <= TheGameLogic->getFrame() ;} ///< Returns true if the zones need to be recalculated.
  	void markZonesDirty( Bool insert ) ; ///< Called when the zones need to be recalculated.
- 	void updateZonesForModify( PathfindCell **map,  PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds ) ; ///< Called to recalculate an area when a structure has been removed.
+ 	void updateZonesForModify( PathfindCell **map,  PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds ) ; ///< Called to rezone an area when a structure has been added or removed.
 	void calculateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Does zone calculations.  
 	zoneStorageType getEffectiveZone(LocomotorSurfaceTypeMask acceptableSurfaces, Bool crusher, zoneStorageType zone) const;
 	zoneStorageType getEffectiveTerrainZone(zoneStorageType zone) const;
@@ -533,10 +619,33 @@ public:
 	void setBridge(Int cellX, Int cellY, Bool bridge);
 	Bool interactsWithBridge(Int cellX, Int cellY) const; 
 
+	UnsignedInt getZoneVersion(void) const {return m_zoneVersion;} ///< Changes whenever any zone changes.
+
 private:
+	struct ZoneRange
+	{
+		zoneStorageType m_firstZone;
+		Int							m_numZones;
+	};
+	typedef std::vector<ZoneRange> ZoneRangeVector;
+	typedef std::vector<ZoneEdge> ZoneEdgeVector;
+
 	void allocateZones(void);
 	void freeZones(void);
 	void freeBlocks(void);
+	void getBlockBounds(Int xBlock, Int yBlock, const IRegion2D &globalBounds, IRegion2D &bounds) const;
+	void rezoneBlock(PathfindCell **map, Int xBlock, Int yBlock, const IRegion2D &globalBounds);
+	void fillZonesForModify(PathfindCell **map, const IRegion2D &structureBounds, const IRegion2D &globalBounds);
+	void calculateZoneTables(void);
+	void collectZoneContacts(const IRegion2D &blocks, ZoneRangeVector &oldZones, ZoneEdgeVector &contacts) const;
+	Bool updateZoneTables(const IRegion2D &blocks, const ZoneRangeVector &oldZones, const ZoneEdgeVector &contacts, Int oldMaxZone);
+	Bool updateZoneTable(zoneStorageType *zoneTable, UnsignedByte relations, const IRegion2D &blocks, 
+		const ZoneRangeVector &oldZones, const ZoneEdgeVector &contacts, Int oldMaxZone);
+	static Bool isInZoneRanges(const ZoneRangeVector &ranges, Int zone);
+#ifdef _DEBUG
+	void checkZoneTables(PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds);
+	const zoneStorageType *getZoneTable(Int table) const;
+#endif
 
 private:
 	ZoneBlock			*m_blockOfZoneBlocks;			///< Zone blocks - Info for hierarchical pathfinding at a "blocky" level.
@@ -552,6 +661,185 @@ private:
 	zoneStorageType *m_terrainZones;
 	zoneStorageType *m_crusherZones;
 	zoneStorageType *m_hierarchicalZones;
+	zoneStorageType *m_scratchZones;				///< Each zone is itself, except while updateZoneTable runs.
+
+	UnsignedInt		m_zoneVersion;						///< Incremented whenever zones are calculated or updated.
+};
+
+/**
+ * What a cached path was found for.  Requests with the same key can share a path.
+ */
+struct PathfindCacheKey
+{
+	zoneStorageType						m_startZone;				///< Effective zone of the start cell.
+	ICoord2D									m_goalRegion;				///< Goal cell / PathfindCache::GOAL_REGION_SIZE.
+	PathfindLayerEnum					m_startLayer;
+	PathfindLayerEnum					m_goalLayer;
+	LocomotorSurfaceTypeMask	m_surfaces;
+	Int												m_radius;						///< With m_centerInCell, the path diameter.
+	Bool											m_centerInCell;
+	Bool											m_crusher;
+	Bool											m_isHuman;
+
+	Bool isEqual(const PathfindCacheKey &other) const;
+};
+
+/**
+ * Recently found paths.  Units given the same move order at the same time ask for nearly the same 
+ * path, so one search can serve all of them.  A cached path is only handed out while the zones are
+ * unchanged, for MAX_AGE frames, to requests starting within START_RANGE cells of the cached start.
+ * Only used with PathfindCache in GameData.ini, as it changes the paths units get.
+ */
+class PathfindCache
+{
+public:
+	enum {MAX_ENTRIES = 16};
+	enum {GOAL_REGION_SIZE = 4};										///< Goals in the same square of cells share a key.
+	enum {START_RANGE = 2*PathfindZoneManager::ZONE_BLOCK_SIZE};	///< Max cells between the cached & requested start.
+	enum {MAX_AGE = LOGICFRAMES_PER_SECOND};				///< Units move, so paths go stale.
+
+	PathfindCache();
+	~PathfindCache();
+
+	void reset(void);																	///< Discard all cached paths.
+	void validate(UnsignedInt zoneVersion);						///< Discard all cached paths if the zones changed.
+	Path *findPath(const PathfindCacheKey &key, const ICoord2D &startCell);	///< Returns the closest cached path, or NULL.
+	void addPath(const PathfindCacheKey &key, const ICoord2D &startCell, Path *path);	///< Cache a copy of the optimized path.
+
+	void xfer(Xfer *xfer, UnsignedInt zoneVersion, XferVersion version);	///< Save or load the paths found since the zones last changed.
+	void loadPostProcess(Pathfinder *pathfinder, UnsignedInt zoneVersion);	///< Bring loaded paths up to date with the loaded zones.
+
+	void countLookup(Bool hit) {if (hit) m_hits++; else m_misses++;}
+	Int getHits(void) const {return m_hits;}
+	Int getMisses(void) const {return m_misses;}
+	void clearStats(void) {m_hits = m_misses = 0;}
+
+protected:
+	struct Entry
+	{
+		PathfindCacheKey	m_key;
+		ICoord2D					m_startCell;
+		UnsignedInt				m_frame;						///< Frame the path was found.
+		Path							*m_path;						///< Optimized nodes only.
+	};
+
+	Entry					m_entries[MAX_ENTRIES];
+	Int						m_nextEntry;							///< Entry to replace next.
+	UnsignedInt		m_zoneVersion;
+	Bool					m_loaded;									///< Paths were loaded, and loadPostProcess hasn't been called.
+	Int						m_hits;
+	Int						m_misses;
+};
+
+/**
+ * The cost to move from each ground cell in a region to one goal cell, for one kind of locomotion and
+ * one unit size.  Built with a single search outward from the goal, so the path from any cell in the
+ * region is found by stepping to the cheapest neighbor until the goal is reached.  The costs only
+ * depend on the terrain & structures, so any unit of the group can walk down the field.
+ */
+struct PathfindFlowField
+{
+	enum {UNREACHABLE = 0xffffffff};
+
+	ICoord2D									m_goalCell;
+	IRegion2D									m_region;						///< Cells covered by the field, inclusive.
+	LocomotorSurfaceTypeMask	m_surfaces;
+	Int												m_radius;						///< With m_centerInCell, the path diameter.
+	Bool											m_centerInCell;
+	Bool											m_crusher;
+	Bool											m_isHuman;
+	UnsignedInt								m_frame;						///< Frame the field was started.
+	Bool											m_isBuilt;					///< False if the field is unused, discarded or still being built.
+	UnsignedInt								*m_costs;						///< Cost to the goal of each region cell, or UNREACHABLE.
+	Int												m_costsAllocated;		///< Cells m_costs has room for.
+
+	inline Int getWidth(void) const {return m_region.hi.x - m_region.lo.x + 1;}
+	inline Int getHeight(void) const {return m_region.hi.y - m_region.lo.y + 1;}
+	inline Bool contains(Int x, Int y) const
+	{
+		return x >= m_region.lo.x && x <= m_region.hi.x && y >= m_region.lo.y && y <= m_region.hi.y;
+	}
+	inline Int getIndex(Int x, Int y) const {return (y - m_region.lo.y)*getWidth() + x - m_region.lo.x;}
+	inline UnsignedInt getCost(Int x, Int y) const {return contains(x, y) ? m_costs[getIndex(x, y)] : UNREACHABLE;}
+};
+
+/**
+ * Flow fields for large groups moving to one place.  AIGroup announces the move with addGoal, then
+ * the first path request of the group for each kind of locomotion & unit size starts a field.  One
+ * field at a time is built, a few cells each frame out of the pathfind budget, and once it's done the
+ * rest of the group walks down it instead of searching.  Fields are discarded when the zones change,
+ * and goals expire after MAX_AGE frames.
+ */
+class PathfindFlowFields
+{
+public:
+	enum {MIN_GROUP_SIZE = 40};											///< Smaller groups search for each unit.
+	enum {MAX_GOALS = 4};
+	enum {MAX_FIELDS = 4};
+	enum {MAX_REGION_SIZE = 256};										///< Max cells on a side of a field.
+	enum {REGION_MARGIN = 4*PathfindZoneManager::ZONE_BLOCK_SIZE};	///< Cells around the group & goal, for detours.
+	enum {GOAL_RANGE = 2*PathfindZoneManager::ZONE_BLOCK_SIZE};		///< Max cells between a unit's goal & the group goal.
+	enum {MAX_AGE = 2*LOGICFRAMES_PER_SECOND};			///< Group moves are queued over a few frames.
+
+	PathfindFlowFields();
+	~PathfindFlowFields();
+
+	void reset(void);																	///< Discard all goals & fields.
+	void validate(UnsignedInt zoneVersion);						///< Discard all fields if the zones changed.
+	void addGoal(const ICoord2D &goalCell, const IRegion2D &region);	///< A large group is moving to goalCell.
+	Bool findGoal(const ICoord2D &goalCell, const ICoord2D &startCell, ICoord2D &fieldGoal, IRegion2D &region) const;	///< Unexpired group goal near goalCell, with startCell in its region.
+	PathfindFlowField *findField(const ICoord2D &goalCell, const PathfindCacheKey &key, Bool isHuman);
+	PathfindFlowField *allocateField(void);						///< Field to build, replacing the oldest.
+
+	void xfer(Xfer *xfer, UnsignedInt zoneVersion, XferVersion version);	///< Save or load the goals, and the fields built since the zones last changed.
+	void loadPostProcess(UnsignedInt zoneVersion);		///< Bring loaded fields up to date with the loaded zones.
+
+	// Search from the goal, with costs in the field being built.
+	void startSearch(PathfindFlowField *field);
+	void finishSearch(void);													///< The field being built is done.
+	inline PathfindFlowField *getSearchField(void) const {return m_searchField;}
+	inline zoneStorageType getSearchZone(void) const {return m_searchZone;}
+	inline void setSearchZone(zoneStorageType zone) {m_searchZone = zone;}
+	inline Bool isSearchDone(void) const {return m_count==0;}
+	void pushCell(Int ndx, UnsignedInt cost);					///< Add a cell, or lower its cost.
+	Int popCell(void);																///< Remove the cheapest cell.
+
+	void countPath(void) {m_paths++;}
+	void countField(void) {m_fields++;}
+	Int getPaths(void) const {return m_paths;}
+	Int getFields(void) const {return m_fields;}
+	void clearStats(void) {m_paths = m_fields = 0;}
+
+protected:
+	struct Goal
+	{
+		ICoord2D					m_goalCell;
+		IRegion2D					m_region;
+		UnsignedInt				m_frame;						///< Frame the move was ordered.
+	};
+
+	void allocateCosts(PathfindFlowField *field);			///< Room for the costs of the field's region.
+	void allocateHeap(Int numCells);									///< Room in the heap for the cells of a region.
+	void siftUp(Int ndx);
+	void siftDown(Int ndx);
+	inline void place(Int cellNdx, Int ndx) {m_heap[ndx] = cellNdx; m_heapIndex[cellNdx] = ndx;}
+
+	Goal							m_goals[MAX_GOALS];
+	Int								m_nextGoal;							///< Goal to replace next.
+	PathfindFlowField	m_fields[MAX_FIELDS];
+	Int								m_nextField;						///< Field to replace next.
+	UnsignedInt				m_zoneVersion;
+	Bool							m_loaded;								///< Fields were loaded, and loadPostProcess hasn't been called.
+
+	PathfindFlowField	*m_searchField;					///< Field being built, or NULL.
+	zoneStorageType		m_searchZone;						///< Effective zone of the goal of the field being built.
+	Int								*m_heap;								///< Cell indices, cheapest first.
+	Int								*m_heapIndex;						///< Heap position of each cell, -1 if not in the heap.
+	Int								m_heapAllocated;				///< Cells m_heap & m_heapIndex have room for.
+	Int								m_count;
+
+	Int								m_paths;
+	Int								m_fields;
 };
 
 /** 
@@ -591,6 +879,7 @@ public:
  */
 class Pathfinder : PathfindServicesInterface, public Snapshot
 {
+	friend class PathfindBenchmark;
 // The following routines are private, but available through the doPathfind callback to aiInterface. jba.
 private:
 	virtual Path *findPath( Object *obj, const LocomotorSet& locomotorSet, const Coord3D *from, const Coord3D *to);	///< Find a short, valid path between given locations
@@ -631,6 +920,10 @@ public:
 
 	Bool queueForPath(ObjectID id);	 ///< The object wants to request a pathfind, so put it on the list to process.
 	void processPathfindQueue(void); ///< Process some or all of the queued pathfinds.
+	UnsignedInt getOpenListOperationCount(void) const {return m_openList.getOperationCount();} ///< Open list inserts & removes since the queue was last processed.
+	PathfindCache *getPathCache(void) {return &m_pathCache;}
+	Bool getCacheStartZone(const PathfindCacheKey &key, const ICoord2D &startCell, zoneStorageType &zone);	///< Zone of a cached path's start, as getPathCacheKey finds it.
+	void requestFlowField(const Coord3D *goal, const IRegion2D &groupCells);	///< Let a large group moving to goal share a flow field.
 	void forceMapRecalculation( );	///< Force pathfind map recomputation. If region is given, only that area is recomputed
 
 	/** Returns an aircraft path to the goal.  */
@@ -827,6 +1120,16 @@ protected:
 
 	void checkChangeLayers(PathfindCell *parentCell);
 
+	Bool getPathCacheKey( const Object *obj, const LocomotorSet& locomotorSet, Bool isHuman, const Coord3D *from, 
+		const Coord3D *rawTo, PathfindCacheKey &key, ICoord2D &startCell, ICoord2D &goalCell ); ///< False if the path can't be cached.
+	Path *findCachedPath( Object *obj, const LocomotorSet& locomotorSet, Bool isHuman, const Coord3D *from, 
+		const Coord3D *rawTo );	///< Join a cached path to the start & goal, or NULL.
+	UnsignedInt flowFieldStepCost( const PathfindFlowField *field, PathfindCell *fromCell, PathfindCell *toCell ); ///< Cost of one step, or UNREACHABLE.
+	void startFlowField( PathfindFlowField *field );	///< Start searching out from the field's goal.
+	void continueFlowField( Int maxCells );						///< Fill in the costs of up to maxCells more cells of the field being built.
+	Path *findFlowFieldPath( Object *obj, const LocomotorSet& locomotorSet, Bool isHuman, const Coord3D *from,
+		const Coord3D *rawTo );	///< Walk down a group's flow field, or NULL.
+
 #if defined _DEBUG || defined _INTERNAL
 	void doDebugIcons(void) ;
 #endif
@@ -838,7 +1141,7 @@ private:
 	IRegion2D m_extent;														///< Grid extent limits
 	IRegion2D m_logicalExtent;										///< Logical grid extent limits
 
-	PathfindCell *m_openList;											///< Cells ready to be explored
+	PathfindOpenList m_openList;									///< Cells ready to be explored
 	PathfindCell *m_closedList;										///< Cells already explored
 
 	Bool m_isMapReady;														///< True if all cells of map have been classified
@@ -852,6 +1155,8 @@ private:
 	ObjectID m_ignoreObstacleID;									///< Ignore the given obstacle
 
 	PathfindZoneManager m_zoneManager;						///< Handles the pathfind zones.
+	PathfindCache m_pathCache;										///< Recently found paths.
+	PathfindFlowFields m_flowFields;							///< Fields for large group moves.
 
 	PathfindLayer m_layers[LAYER_LAST+1];
 
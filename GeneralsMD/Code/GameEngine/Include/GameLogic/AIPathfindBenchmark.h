@@ -0,0 +1,103 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// AIPathfindBenchmark.h
+// Records pathfind queries during a game, and replays them against a freshly loaded map
+// to measure pathfinder speed and check that the found paths did not change.
+//
+// Usage (debug & internal builds):
+//   record:  -file <map> -recordPathfindQueries <queries.txt>
+//   replay:  -file <map> -noDraw 1 -pathfindBenchmark <queries.txt> [-pathfindBenchmarkReport <report.txt>]
+// The replay runs once the map's pathfind cells and zones are classified, writes the report
+// and quits the game.
+//
+// Query files are plain text, one query per line:
+//   <type> <isHuman> <isCrusher> <fromX> <fromY> <fromZ> <toX> <toY> <toZ> <pathDiameter> <locomotors...>
+// where type is P (findPath), G (findGroundPath) or H (findHierarchicalPath). The game records
+// P and G queries; H queries only run the hierarchical zone search and can be made by changing
+// the type of a recorded P query.
+
+#pragma once
+
+#ifndef _AI_PATHFIND_BENCHMARK_H_
+#define _AI_PATHFIND_BENCHMARK_H_
+
+#include "Common/AsciiString.h"
+#include "Common/GameType.h"
+#include "GameLogic/LocomotorSet.h"
+
+class CRC;
+class Path;
+class Pathfinder;
+
+enum PathfindQueryType
+{
+	PATHFIND_QUERY_FIND_PATH = 0,					///< Pathfinder::findPath
+	PATHFIND_QUERY_GROUND_PATH,						///< Pathfinder::findGroundPath
+	PATHFIND_QUERY_HIERARCHICAL_PATH,			///< Pathfinder::findHierarchicalPath
+
+	PATHFIND_QUERY_COUNT
+};
+
+struct PathfindQuery
+{
+	PathfindQueryType	m_type;
+	Coord3D						m_from;
+	Coord3D						m_to;
+	Bool							m_isHuman;
+	Bool							m_isCrusher;
+	Int								m_pathDiameter;				///< Ground paths only.
+	AsciiString				m_locomotors;					///< Space separated locomotor template names, not used by ground paths.
+};
+
+/**
+ * Pathfind query recorder & replay benchmark.
+ */
+class PathfindBenchmark
+{
+public:
+	PathfindBenchmark();
+	~PathfindBenchmark();
+
+	// recording
+	Bool startRecording( const AsciiString &fileName );
+	void stopRecording( void );
+	Bool isRecording( void ) const { return m_recordFile != NULL && !m_isRunning; }
+	void recordFindPath( Bool isHuman, const LocomotorSet &locomotorSet, const Coord3D *from, const Coord3D *to );
+	void recordGroundPath( const Coord3D *from, const Coord3D *to, Int pathDiameter, Bool crusher );
+
+	// replay
+	Bool loadQueries( const AsciiString &fileName );
+	Bool isPending( void ) const { return !m_queries.empty() && !m_hasRun; }
+	void run( Pathfinder *pathfinder, const AsciiString &reportFileName );
+
+protected:
+	void writeQuery( const PathfindQuery &query );
+	static void buildLocomotorNames( const LocomotorSet &locomotorSet, AsciiString &names );
+	static void buildLocomotorSet( const AsciiString &names, LocomotorSet &locomotorSet );
+	static void addPathToCRC( Path *path, CRC &crc );
+
+	FILE *m_recordFile;
+	std::vector<PathfindQuery> m_queries;
+	Bool m_isRunning;								///< Don't record our own queries.
+	Bool m_hasRun;
+};
+
+extern PathfindBenchmark *ThePathfindBenchmark;
+
+#endif // _AI_PATHFIND_BENCHMARK_H_
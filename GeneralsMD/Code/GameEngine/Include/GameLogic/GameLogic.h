@@ -136,6 +136,9 @@ public:
 
 	Bool isInGameLogicUpdate( void ) const { return m_isInUpdate; }
 	UnsignedInt getFrame( void );										///< Returns the current simulation frame number
+#if defined(_DEBUG) || defined(_INTERNAL)
+	void friend_setFrame( UnsignedInt frame ) { m_frame = frame; }	///< For the network soak, which steps the frame without running the logic
+#endif
 	UnsignedInt getCRC( Int mode = CRC_CACHED, AsciiString deepCRCFileName = AsciiString::TheEmptyString );		///< Returns the CRC
 
 	void setObjectIDCounter( ObjectID nextObjID ) { m_nextObjID = nextObjID; }
@@ -268,6 +271,7 @@ private:
 	void popSleepyUpdate();
 	void eraseSleepyUpdate(Int i);
 	void rebalanceSleepyUpdate(Int i);
+	void setSleepyUpdateFrame(UpdateModulePtr u, UnsignedInt frame);
 	Int rebalanceParentSleepyUpdate(Int i);
 	Int rebalanceChildSleepyUpdate(Int i);
 	void remakeSleepyUpdate();
@@ -325,7 +329,14 @@ private:
 	// never modify it directly; please use the proper access methods.
 	// (for an excellent discussion of priority queues, please see:
 	// http://dogma.net/markn/articles/pq_stl/priority.htm)
-	std::vector<UpdateModulePtr> m_sleepyUpdates;
+	// each entry keeps a copy of its module's priority, so sifting compares neighboring
+	// entries instead of reading every module it passes.
+	struct SleepyUpdateEntry
+	{
+		UnsignedInt			m_priority;		///< always equal to m_update->friend_getPriority()
+		UpdateModulePtr	m_update;
+	};
+	std::vector<SleepyUpdateEntry> m_sleepyUpdates;
 	
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	// this is a plain old list, not a pq.
@@ -108,6 +108,8 @@ public:
 
 	inline LocomotorSurfaceTypeMask getValidSurfaces() const { return m_validLocomotorSurfaces; }
 	inline Bool isDownhillOnly( void ) const { return m_downhillOnly; };
+	inline Int getLocomotorCount( void ) const { return (Int)m_locomotors.size(); }
+	inline const Locomotor* getLocomotor( Int i ) const { return m_locomotors[i]; }
 
 };
 
@@ -297,6 +297,7 @@ class PartitionCell : public Snapshot	// not MPO: allocated in an array
 {
 private:
 	CellAndObjectIntersection*		m_firstCoiInCell;	///< list of COIs in this cell (may be null).
+	std::vector<PartitionData*>		m_modulesInCell;	///< module of each COI in this cell, oldest first (the reverse of the COI list).
 	ShroudLevel										m_shroudLevel[MAX_PLAYER_COUNT];	
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	Real													m_loTerrainZ;			///< lowest terrain-pt in this cell
@@ -354,6 +355,14 @@ public:
 
 	inline CellAndObjectIntersection *getFirstCoiInCell() { return m_firstCoiInCell; }
 
+	/**
+		The modules touching this cell, in a contiguous array for the collision pass.
+		Index getModuleCount()-1 is the newest, so walking from the back visits them
+		in the same order as the COI list.
+	*/
+	inline Int getModuleCount() const { return (Int)m_modulesInCell.size(); }
+	inline PartitionData *getModule(Int i) const { return m_modulesInCell[i]; }
+
 	#ifdef _DEBUG
 	void validateCoiList();
 	#endif
@@ -1249,6 +1258,7 @@ private:
 	Int							m_totalCellCount;	///< x * y
 	PartitionCell*	m_cells;					///< array of cells
 	PartitionData*	m_dirtyModules;
+	PartitionContactList*	m_contactList;	///< potential collisions found by update(), kept to reuse its storage.
 	Bool						m_updatedSinceLastReset;	///< Used to force a return of OBJECTSHROUD_INVALID before update has been called.
 
 	std::queue<SightingInfo *> m_pendingUndoShroudReveals;	///< Anything can queue up an Undo to happen later. This is a queue, because "later" is a constant
@@ -0,0 +1,38 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// SleepyUpdateBenchmark.h
+// Microbenchmark of the sleepy update queue in GameLogic.
+//
+// Usage (debug & internal builds):
+//   -sleepyUpdateBenchmark <numModules>
+// When GameLogic is initialized, this runs the same synthetic schedule of wakes and updates
+// through the old queue (module pointers only, priorities read from the modules) and the current
+// one (priorities copied into the queue), checks that both call the modules in the same order,
+// and writes the timings to the debug log.
+
+#pragma once
+
+#ifndef _SLEEPY_UPDATE_BENCHMARK_H_
+#define _SLEEPY_UPDATE_BENCHMARK_H_
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+void runSleepyUpdateBenchmark( Int numModules, Int numFrames );
+#endif
+
+#endif // _SLEEPY_UPDATE_BENCHMARK_H_
@@ -65,6 +65,7 @@ public:
 	void setUser(User *user);
 	User *getUser();
 	void setFrameGrouping(time_t frameGrouping);
+	void setPacketFormat(NetPacketFormat format) { m_packetFormat = format; }		///< the format the game's packets are sent in
 
 	void sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay);
 
@@ -79,6 +80,8 @@ public:
 	void setQuitting( void );
 	Bool isQuitting( void ) { return m_isQuitting; }
 
+	Int getTotalRetries( void ) { return m_totalRetries; }		///< commands resent since init()
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	void debugPrintCommands();
 #endif
@@ -100,7 +103,9 @@ protected:
 	time_t m_frameGrouping;				///< The minimum time between packet sends.
 	time_t m_lastTimeSent;				///< The time of the last packet send.
 	Int m_numRetries;							///< The number of retries for the last second.
+	Int m_totalRetries;						///< The number of retries since init().
 	time_t m_retryMetricsTime;		///< The start time of the current retry metrics thing.
+	NetPacketFormat m_packetFormat;	///< How the commands in our packets are encoded.
 };
 
 #endif
@@ -37,6 +37,7 @@
 #include "GameNetwork/Transport.h"
 #include "GameNetwork/FrameDataManager.h"
 #include "GameNetwork/FrameMetrics.h"
+#include "GameNetwork/RunAheadController.h"
 #include "GameNetwork/NetworkDefs.h"
 #include "GameNetwork/DisconnectManager.h"
 
@@ -115,6 +116,7 @@ public:
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
 	UnsignedInt getPacketArrivalCushion( void );
+	Int getTotalRetries( void );				///< commands resent to all the connections since the game started
 
 	UnsignedInt getMinimumCushion();
 
@@ -175,6 +177,7 @@ private:
 	//	void doPerFrameMetrics(UnsignedInt frame);
 	void getMinimumFps(Int &minFps, Int &minFpsPlayer);			///< Returns the smallest FPS in the m_fpsAverages list.
 	Real getMaximumLatency(); ///< This actually sums the two biggest latencies in the m_latencyAverages list.
+	Real getLocalLatency();		///< The latency this player reports for the run ahead.
 
 	void requestFrameDataResend(Int playerID, UnsignedInt frame); ///< request of this player that he send the specified frame's data.
 
@@ -199,10 +202,12 @@ private:
 	NetCommandList *m_relayedCommands;
 
 	FrameMetrics m_frameMetrics;
+	RunAheadController m_runAheadController;
 
 	NetCommandWrapperList *m_netCommandWrapperList;
 
 	// These variables are used to keep track of the other players' average fps and latency.
+	// The latencies are the NetworkRunAheadPercentile percentiles, not the averages.
 	// yup.
 	Real m_latencyAverages[MAX_SLOTS];
 	Int  m_fpsAverages[MAX_SLOTS];
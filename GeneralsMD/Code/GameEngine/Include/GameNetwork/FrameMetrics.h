@@ -31,6 +31,7 @@
 
 #include "Lib/BaseType.h"
 #include "GameNetwork/NetworkDefs.h"
+#include "GameNetwork/RunAheadController.h"
 
 class FrameMetrics {
 public:
@@ -45,6 +46,7 @@ public:
 	void addCushion(Int cushion);
 
 	Real getAverageLatency();
+	Real getLatencyPercentile(Int percentile);	///< the latency that percentile percent of the latency history is no more than.
 	Int getAverageFPS();
 	Int getMinimumCushion();
 
@@ -64,6 +66,7 @@ protected:
 	Real m_averageLatency;																		///< The current average latency, this is used to save calculation time.
 																														///< When a new latency value is received, the old one is subtracted out and the new
 																														///< one is added in.
+	LatencyHistogram m_latencyHistogram;											///< The latencies in m_latencyList, for finding their percentiles.
 
 	// packet arrival cushion variables.
 	// Keeps track of the cushion for the incoming commands.
@@ -219,6 +219,9 @@ public:
 	// CRC checking hack
 	void setCRCInterval( Int val ) { m_crcInterval = (val<100)?val:100; }
 	inline Int getCRCInterval( void ) const { return m_crcInterval; }
+
+	inline NetPacketFormat getPacketFormat( void ) const;				///< How the game's packets are encoded
+	inline void setPacketFormat( NetPacketFormat format );
 	
 	Bool haveWeSurrendered(void) { return m_surrendered; }
 	void markAsSurrendered(void) { m_surrendered = TRUE; }
@@ -254,6 +257,7 @@ protected:
   Money         m_startingCash;
   UnsignedShort m_superweaponRestriction;
   Bool m_oldFactionsOnly; // Only USA, China, GLA -- not USA Air Force General, GLA Toxic General, et al
+	NetPacketFormat m_packetFormat;
 };
 
 extern GameInfo *TheGameInfo;
@@ -275,6 +279,8 @@ const Money&GameInfo::getStartingCash( void ) const         { return m_startingC
 UnsignedShort GameInfo::getSuperweaponRestriction( void ) const { return m_superweaponRestriction; }
 Bool        GameInfo::oldFactionsOnly(void) const           { return m_oldFactionsOnly; }
 void        GameInfo::setOldFactionsOnly( Bool oldFactionsOnly ) { m_oldFactionsOnly = oldFactionsOnly; }
+NetPacketFormat GameInfo::getPacketFormat( void ) const     { return m_packetFormat; }
+void        GameInfo::setPacketFormat( NetPacketFormat format ) { m_packetFormat = format; }
 
 AsciiString GameInfoToAsciiString( const GameInfo *game );
 Bool ParseAsciiStringToGameInfo( GameInfo *game, AsciiString options );
@@ -0,0 +1,117 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// LoopbackTransport.h
+// A Transport that passes its packets through memory instead of a socket.
+//
+// Several ConnectionManagers can play a game with each other in one process by giving each of
+// them a LoopbackTransport on the same LoopbackNetwork. Each transport has an address of its own,
+// which the other players' slots point at, and everything above the socket (the packet headers,
+// CRC's, encryption, the queues and the statistics) is the same as it is over UDP.
+//
+// The network holds on to every datagram until its delivery time, which is the time it was sent
+// plus a latency and a random jitter, and loses the given percentage of them, so the resend and
+// run-ahead logic can be exercised without a second machine.
+
+#pragma once
+
+#ifndef _LOOPBACK_TRANSPORT_H_
+#define _LOOPBACK_TRANSPORT_H_
+
+#include "GameNetwork/Transport.h"
+
+class LoopbackTransport;
+
+//-------------------------------------------------------------------------------------------------
+/** The wire between a set of LoopbackTransports */
+//-------------------------------------------------------------------------------------------------
+class LoopbackNetwork
+{
+public:
+
+	LoopbackNetwork();
+	~LoopbackNetwork();
+
+	/// every datagram takes latency milliseconds, give or take up to jitter, and packetLoss percent of them never arrive.
+	void setConditions( Int latency, Int jitter, Int packetLoss );
+
+	Int getNumSent( void ) const { return m_numSent; }
+	Int getNumLost( void ) const { return m_numLost; }
+
+protected:
+
+	friend class LoopbackTransport;
+
+	struct Datagram
+	{
+		UnsignedInt m_fromIP;
+		UnsignedShort m_fromPort;
+		UnsignedInt m_toIP;
+		UnsignedShort m_toPort;
+		UnsignedInt m_deliveryTime;
+		UnsignedInt m_len;
+		UnsignedByte m_data[MAX_MESSAGE_LEN];
+	};
+	typedef std::list<Datagram *> DatagramList;
+	typedef std::list<LoopbackTransport *> EndpointList;
+
+	void attach( LoopbackTransport *endpoint );
+	void detach( LoopbackTransport *endpoint );
+
+	void send( const LoopbackTransport *from, const UDPDatagram &datagram );
+	Bool receive( const LoopbackTransport *to, UDPDatagram &datagram );			///< take the first datagram that is due at 'to'. FALSE if there are none
+
+	EndpointList m_endpoints;
+	DatagramList m_inFlight;							///< in the order they were sent
+
+	Int m_latency;
+	Int m_jitter;
+	Int m_packetLoss;
+
+	Int m_numSent;
+	Int m_numLost;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** A Transport on a LoopbackNetwork. It is owned and deleted like any other Transport. */
+//-------------------------------------------------------------------------------------------------
+class LoopbackTransport : public Transport
+{
+public:
+
+	LoopbackTransport( LoopbackNetwork *network );
+	virtual ~LoopbackTransport();
+
+	virtual Bool init( UnsignedInt ip, UnsignedShort port );		///< join the network at this address
+	virtual void reset( void );																	///< leave the network
+
+	UnsignedInt getIP( void ) const { return m_ip; }
+
+protected:
+
+	virtual Bool isOpen( void ) const { return m_isOpen; }
+	virtual Int writeDatagrams( UDPDatagram *datagrams, Int count );
+	virtual Int readDatagrams( UDPDatagram *datagrams, Int count );
+	virtual Bool writeWouldBlock( void ) { return FALSE; }
+
+	LoopbackNetwork *m_network;
+	UnsignedInt m_ip;
+	Bool m_isOpen;
+};
+
+#endif // _LOOPBACK_TRANSPORT_H_
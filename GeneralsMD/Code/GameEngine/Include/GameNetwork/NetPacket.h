@@ -45,6 +45,7 @@ be specialized code.
 #include "Common/GameMemory.h"
 
 class NetPacket;
+class TransportBuffer;
 
 typedef std::list<NetPacket *> NetPacketList;
 typedef std::list<NetPacket *>::iterator NetPacketListIter;
@@ -60,6 +61,11 @@ public:
 	void init();
 	void reset();
 	void setAddress(Int addr, Int port);
+	void attachBuffer(TransportBuffer *buffer);			///< write the packet straight into buffer, rather than into our own storage
+	void detachBuffer();
+	TransportBuffer *getBuffer() { return m_buffer; }
+	void setFormat(NetPacketFormat format) { m_format = format; }	///< how to encode the commands added from now on.  Any format can be read.
+	NetPacketFormat getFormat() { return m_format; }
 	Bool addCommand(NetCommandRef *msg);
 	Int getNumCommands();
 
@@ -106,6 +112,7 @@ protected:
 	static UnsignedInt GetFrameResendRequestCommandSize(NetCommandMsg *msg);
 
 	static void FillBufferWithGameCommand(UnsignedByte *buffer, NetCommandRef *msg);
+	static Int FillBufferWithCompactGameMessage(UnsignedByte *buffer, GameMessage *gmsg);	///< returns the length.  buffer may be NULL, to measure the message
 	static void FillBufferWithAckCommand(UnsignedByte *buffer, NetCommandRef *msg);
 	static void FillBufferWithFrameCommand(UnsignedByte *buffer, NetCommandRef *msg);
 	static void FillBufferWithPlayerLeaveCommand(UnsignedByte *buffer, NetCommandRef *msg);
@@ -191,6 +198,7 @@ protected:
 	Bool isFrameRepeat(NetCommandRef *msg);
 
 	static NetCommandMsg * readGameMessage(UnsignedByte *data, Int &i);
+	static NetCommandMsg * readCompactGameMessage(UnsignedByte *data, Int &i, Int end);
 	static NetCommandMsg * readAckBothMessage(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readAckStage1Message(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readAckStage2Message(UnsignedByte *data, Int &i);
@@ -224,7 +232,9 @@ protected:
 	void dumpPacketToLog();
 
 protected:
-	UnsignedByte		m_packet[MAX_PACKET_SIZE];
+	UnsignedByte*		m_packet;								///< m_packetStorage, or the data of m_buffer
+	UnsignedByte		m_packetStorage[MAX_PACKET_SIZE];
+	TransportBuffer*	m_buffer;
 	Int							m_packetLen;
 	UnsignedInt			m_addr;
 	Int							m_numCommands;
@@ -232,9 +242,11 @@ protected:
 	UnsignedInt			m_lastFrame;
 	UnsignedShort		m_port;
 	UnsignedShort		m_lastCommandID;
+	UnsignedShort		m_lastGameCommandID;		///< compact command IDs are relative to the game command before them
 	UnsignedByte		m_lastPlayerID;
 	UnsignedByte		m_lastCommandType;
 	UnsignedByte		m_lastRelay;
+	NetPacketFormat	m_format;
 };
 
 #endif // __NETPACKET_H
@@ -0,0 +1,39 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// NetPacketBenchmark.h
+// Compares the size and speed of the NetPacket formats on a synthetic stream of game commands.
+//
+// Usage (debug & internal builds):
+//   -netPacketBenchmark <commands>
+// At startup this makes the given number of game commands from four players (selections of up
+// to two dozen units, moves, waypoints, attacks and logic CRC's), packs them into as few packets
+// as each format needs, and reads the packets back. The log gets, for each format, the packets
+// and bytes it took, the bytes per command, and the microseconds per command to encode and to
+// decode, and whether the commands that came back out are the ones that went in. Then it quits.
+
+#pragma once
+
+#ifndef _NET_PACKET_BENCHMARK_H_
+#define _NET_PACKET_BENCHMARK_H_
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+void runNetPacketBenchmark( Int numCommands );
+#endif
+
+#endif // _NET_PACKET_BENCHMARK_H_
@@ -73,6 +73,7 @@ struct CommandPacket
 #pragma pack(pop)
 
 #define MAX_TRANSPORT_STATISTICS_SECONDS 30
+#define MAX_TRANSPORT_MESSAGES 512		///< size of the transport's send and receive queues.  Still a fixed cap; packets that don't fit are dropped and counted.
 
 #pragma pack(push, 1)
 struct TransportMessageHeader
@@ -177,6 +178,15 @@ enum PlayerLeaveCode CPP_11(: Int) {
 // Magic number for identifying a Generals packet.
 static const UnsignedShort GENERALS_MAGIC_NUMBER = 0xF00D;
 
+// How the commands in a packet are encoded.  The host of a game picks the format and it goes out
+// with the game options, so a build that doesn't know the format can't join the game.
+enum NetPacketFormat CPP_11(: Int) {
+	NETPACKETFORMAT_FIXED = 0,		///< every field at its full width.  Games that don't name a format use this.
+	NETPACKETFORMAT_COMPACT,			///< game commands with variable length frames, command IDs and arguments
+	NETPACKETFORMAT_COUNT,
+	NETPACKETFORMAT_LATEST = NETPACKETFORMAT_COUNT - 1
+};
+
 // The number of fps history entries.
 //static const Int NETWORK_FPS_HISTORY_LENGTH = 30;
 
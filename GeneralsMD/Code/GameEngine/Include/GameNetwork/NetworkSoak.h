@@ -0,0 +1,47 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// NetworkSoak.h
+// Plays a lockstep network game between several players in one process, to soak the net code.
+//
+// Usage (debug & internal builds):
+//   -networkSoak <players> <frames>
+//   -networkSoakConditions <latency ms> <jitter ms> <packet loss %>     (optional)
+// The soak runs at startup and quits when it is done. Each player is a ConnectionManager with a
+// LoopbackTransport, and they are driven through the same calls Network makes in a game: every
+// player sends a game command each frame, ticks its frames, updates the run-ahead, and waits
+// for allCommandsReady() before taking the frame's commands. The logic doesn't run; all the
+// players step TheGameLogic's frame together once every one of them has its commands.
+//
+// The log gets the frames per second the soak reached, each run-ahead change, the commands that
+// had to be resent and the packets the network lost, and any frame on which the players did not
+// all get the same number of game commands.
+//
+// The players share one command ID counter, so each one's IDs go up in steps, not one at a time.
+
+#pragma once
+
+#ifndef _NETWORK_SOAK_H_
+#define _NETWORK_SOAK_H_
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// play numFrames frames between numPlayers in-process players under the given network conditions, and log how it went.
+void runNetworkSoak( Int numPlayers, Int numFrames, Int latency, Int jitter, Int packetLoss );
+#endif
+
+#endif // _NETWORK_SOAK_H_
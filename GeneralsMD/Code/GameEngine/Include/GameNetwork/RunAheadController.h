@@ -0,0 +1,101 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// RunAheadController.h
+// Picks the game's run ahead from the latencies the players are likely to see, rather than from
+// their averages.
+//
+// Each player keeps a LatencyHistogram of its recent round trips to the packet router, and reports
+// the latency that NetworkRunAheadPercentile percent of them came in under. The packet router
+// gives the two worst of those, its frame rate and its packet arrival cushion to the
+// RunAheadController, which raises the run ahead as soon as they call for more and only lowers it
+// once they have called for NetworkRunAheadHysteresis frames less for NetworkRunAheadDecreaseDelay
+// updates in a row, and not while commands are reaching it with less than NetworkRunAheadMinCushion
+// frames to spare. So one spike no longer raises the input lag for everyone, a steady rise in
+// latency is covered before it stalls the game, and a few quiet seconds don't bring the run ahead
+// down only for it to go straight back up.
+//
+// Neither class looks at the clock or the network, so RunAheadSimulation can drive them with
+// recorded latencies.
+
+#pragma once
+
+#ifndef _RUN_AHEAD_CONTROLLER_H_
+#define _RUN_AHEAD_CONTROLLER_H_
+
+#include "Lib/BaseType.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Counts of latencies in 10ms buckets, so the percentiles of a window of latencies can be found
+	without sorting it. Latencies of a second or more all go in the last bucket. */
+//-------------------------------------------------------------------------------------------------
+class LatencyHistogram
+{
+public:
+	enum
+	{
+		BUCKET_MS = 10,
+		NUM_BUCKETS = 100
+	};
+
+	LatencyHistogram();
+
+	void reset();
+	void add(Real latency);						///< latency is in seconds
+	void remove(Real latency);				///< take out a latency that was added before
+	Int getCount() const { return m_count; }
+
+	/// the latency, in seconds, that at least percentile percent of the latencies are no more than.
+	/// This is the top of the bucket the percentile falls in, so it errs on the high side.
+	Real getPercentile(Int percentile) const;
+
+private:
+	static Int getBucket(Real latency);
+
+	Int m_buckets[NUM_BUCKETS];
+	Int m_count;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Decides the run ahead the packet router sends out */
+//-------------------------------------------------------------------------------------------------
+class RunAheadController
+{
+public:
+	RunAheadController();
+
+	void reset();
+	void setHysteresis(Int frames, Int decreaseDelay, Int minCushion);
+
+	/// The run ahead to use from now on. maximumLatency is the sum of the two biggest per-player
+	/// latencies, in seconds, and minimumCushion is the fewest frames early that the commands for
+	/// a frame have recently all been in, or -1 if that isn't known.
+	Int update(Int runAhead, Real maximumLatency, Int fps, Int minimumCushion);
+
+	/// the run ahead the latencies alone call for
+	static Int getTargetRunAhead(Real maximumLatency, Int fps);
+
+private:
+	Int m_hysteresis;						///< how many frames the target has to drop by before the run ahead follows it
+	Int m_decreaseDelay;				///< how many updates in a row it has to stay down
+	Int m_minCushion;						///< commands arriving with fewer frames to spare than this keep the run ahead from dropping
+	Int m_lowUpdates;						///< updates in a row that the target has been down
+	Int m_lowTarget;						///< the highest target in that run of updates
+};
+
+#endif // _RUN_AHEAD_CONTROLLER_H_
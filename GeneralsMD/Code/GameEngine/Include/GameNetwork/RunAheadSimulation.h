@@ -0,0 +1,46 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// RunAheadSimulation.h
+// Replays recorded latencies through the run ahead calculations, to see how they would have played.
+//
+// Usage (debug & internal builds):
+//   -runAheadSimulation <trace file>
+// The trace is a text file with a line for each logic frame, at 30 frames a second. Each line has
+// a column for each player: the round trip, in milliseconds, of that player's frame info to the
+// packet router that came back on that frame. Lines starting with # are comments. Pasting the
+// columns of several players' pings side by side makes one.
+//
+// At startup the trace is played through two packet routers, one working the run ahead out the
+// old way (the average latencies plus NetworkRunAheadSlack percent) and one using the
+// RunAheadController with the NetworkRunAhead... settings from GameData.ini. A command is taken
+// to need half of each of the two worst round trips to get between players, and a frame whose
+// commands need longer than the run ahead counts as a stall. The log gets, for each, the average
+// run ahead (the input lag), the frames that stalled and for how long, and how often the run ahead
+// changed. Then it quits.
+
+#pragma once
+
+#ifndef _RUN_AHEAD_SIMULATION_H_
+#define _RUN_AHEAD_SIMULATION_H_
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+void runRunAheadSimulation( const AsciiString &traceFileName );
+#endif
+
+#endif // _RUN_AHEAD_SIMULATION_H_
@@ -31,9 +31,35 @@
 #ifndef _TRANSPORT_H_
 #define _TRANSPORT_H_
 
+#include "Common/GameMemory.h"
 #include "GameNetwork/udp.h"
 #include "GameNetwork/NetworkDefs.h"
 
+/**
+ * A TransportBuffer holds one outgoing packet, header and all, laid out exactly as it goes on the
+ * wire. A NetPacket writes its commands straight into the data of one, and the transport adds the
+ * header, CRC's and encrypts it where it is, and sends it from there, so the packet is never copied.
+ * Buffers are reference counted like NetCommandMsgs: creating one counts as an attach, and the
+ * last detach() gives it back to its pool.
+ */
+class TransportBuffer : public MemoryPoolObject
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(TransportBuffer, "TransportBuffer")
+public:
+	TransportBuffer();
+	//virtual ~TransportBuffer();
+
+	void attach();
+	void detach();
+
+	inline UnsignedByte *getData() { return m_message.data; }
+
+	TransportMessage m_message;
+
+protected:
+	Int m_referenceCount;
+};
+
 /**
  * The transport layer handles the UDP socket for the game, and will packetize and
  * de-packetize multiple ACK/CommandPacket/etc packets into larger aggregates.
@@ -46,11 +72,11 @@ class Transport //: public MemoryPoolObject
 public:
 
 	Transport();
-	~Transport();
+	virtual ~Transport();
 
 	Bool init( AsciiString ip, UnsignedShort port );
-	Bool init( UnsignedInt ip, UnsignedShort port );
-	void reset( void );
+	virtual Bool init( UnsignedInt ip, UnsignedShort port );
+	virtual void reset( void );
 	Bool update( void );									///< Call this once a GameEngine tick, regardless of whether the frame advances.
 
 	Bool doRecv( void );		///< call this to service the receive packets
@@ -58,6 +84,7 @@ public:
 
 	Bool queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
 		NetMessageFlags flags, Int id */);				///< Queue a packet for sending to the specified address and port.  This will be sent on the next update() call.
+	Bool queueSend(UnsignedInt addr, UnsignedShort port, TransportBuffer *buffer, Int len);	///< Queue the first len bytes of data in buffer, without copying them. The transport attaches to the buffer if it is queued.
 
 	inline Bool allowBroadcasts(Bool val) { if (!m_udpsock) return false; return (m_udpsock->AllowBroadcasts(val))?true:false; }
 
@@ -72,15 +99,35 @@ public:
 	Real getOutgoingPacketsPerSecond( void );
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
+	Real getOutgoingDroppedPacketsPerSecond( void );	///< packets queueSend() had no room for
+	Real getIncomingDroppedPacketsPerSecond( void );	///< packets that arrived with m_inBuffer full
+	Int getOutgoingQueueDepth( void );								///< packets waiting to be sent
+	Int getIncomingQueueDepth( void );								///< packets waiting to be processed
+
+	/// ring of packets waiting to be sent, oldest first. m_outCount of them, starting at m_outFirst.
+	TransportBuffer *m_outBuffer[MAX_TRANSPORT_MESSAGES];
+	Int m_outFirst;
+	Int m_outCount;
 
-	TransportMessage m_outBuffer[MAX_MESSAGES];
-	TransportMessage m_inBuffer[MAX_MESSAGES];
+	/// received packets, in no particular order. whoever handles one sets its length to 0.
+	TransportMessage m_inBuffer[MAX_TRANSPORT_MESSAGES];
+	Int m_inNext;											///< where doRecv() starts looking for free slots
 
 #if defined(_DEBUG) || defined(_INTERNAL)
-	DelayedTransportMessage m_delayedInBuffer[MAX_MESSAGES];
+	DelayedTransportMessage m_delayedInBuffer[MAX_TRANSPORT_MESSAGES];
 #endif
 
 	UnsignedShort m_port;
+
+protected:
+	// Where the datagrams go. A transport that doesn't use a socket overrides these.
+	virtual Bool isOpen( void ) const { return m_udpsock != NULL; }
+	virtual Int writeDatagrams( UDPDatagram *datagrams, Int count );		///< returns how many of them went out, or -1
+	virtual Int readDatagrams( UDPDatagram *datagrams, Int count );			///< returns how many arrived, or -1
+	virtual Bool writeWouldBlock( void );		///< true if the last writeDatagrams stopped short because the socket was full
+
+	void initBuffers( UnsignedShort port );		///< empty the queues and statistics, once the datagrams have somewhere to go
+
 private:
 	Bool m_winsockInit;
 	UDP *m_udpsock;
@@ -96,10 +143,14 @@ private:
 	UnsignedInt m_incomingPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
 	UnsignedInt m_unknownPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
 	UnsignedInt m_outgoingPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
+	UnsignedInt m_outgoingDrops[MAX_TRANSPORT_STATISTICS_SECONDS];
+	UnsignedInt m_incomingDrops[MAX_TRANSPORT_STATISTICS_SECONDS];
 	Int m_statisticsSlot;
 	UnsignedInt m_lastSecond;
 
 	Bool isGeneralsPacket( TransportMessage *msg );
+	void clearOutBuffer( void );
+	void receivedPacket( TransportMessage *slot, Int len );
 };
 
 #endif // _TRANSPORT_H_
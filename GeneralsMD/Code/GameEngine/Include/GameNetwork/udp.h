@@ -59,6 +59,18 @@
 
 #define DEFAULT_PROTOCOL 0
 
+// Most datagrams WriteBatch() and ReadBatch() handle in one call
+#define UDP_MAX_BATCH 32
+
+// One datagram of a batched read or write
+struct UDPDatagram
+{
+  unsigned char *buf;
+  UnsignedInt    len;        // bytes to write, or room to read into.  ReadBatch() sets it to the bytes read
+  UnsignedInt    ip;         // host order
+  UnsignedShort  port;       // host order
+};
+
 //#include "wlib/wstypes.h"
 //#include "wlib/wtime.h"
 
@@ -109,6 +121,8 @@ class UDP
   Int           Bind(const char *Host,UnsignedShort port);
   Int           Write(const unsigned char *msg,UnsignedInt len,UnsignedInt IP,UnsignedShort port);
   Int           Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from);
+  Int           WriteBatch(UDPDatagram *datagrams,Int count);   // returns how many of them went out, or -1
+  Int           ReadBatch(UDPDatagram *datagrams,Int count);    // returns how many arrived, or -1
   sockStat         GetStatus(void);
   void             ClearStatus(void);
   //int              Wait(Int sec,Int usec,fd_set &returnSet);
@@ -1032,6 +1032,110 @@ Int parseBenchmark(char *args[], int num)
 }
 #endif
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+Int parseRecordPathfindQueries(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_recordPathfindQueriesFile = args[1];
+	}
+	return 2;
+}
+
+Int parsePathfindBenchmark(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_pathfindBenchmarkFile = args[1];
+	}
+	return 2;
+}
+
+Int parsePathfindBenchmarkReport(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_pathfindBenchmarkReportFile = args[1];
+	}
+	return 2;
+}
+
+Int parseSleepyUpdateBenchmark(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_sleepyUpdateBenchmarkModules = atoi(args[1]);
+	}
+	return 2;
+}
+
+Int parseRecordMemoryTrace(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_recordMemoryTraceFile = args[1];
+	}
+	return 2;
+}
+
+Int parseMemoryPoolBenchmark(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_memoryPoolBenchmarkFile = args[1];
+	}
+	return 2;
+}
+
+Int parseMemoryPoolSizing(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_memoryPoolSizingFile = args[1];
+	}
+	return 2;
+}
+
+Int parseNetworkSoak(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 2)
+	{
+		TheWritableGlobalData->m_networkSoakPlayers = atoi(args[1]);
+		TheWritableGlobalData->m_networkSoakFrames = atoi(args[2]);
+	}
+	return 3;
+}
+
+Int parseNetworkSoakConditions(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 3)
+	{
+		TheWritableGlobalData->m_networkSoakLatency = atoi(args[1]);
+		TheWritableGlobalData->m_networkSoakJitter = atoi(args[2]);
+		TheWritableGlobalData->m_networkSoakPacketLoss = atoi(args[3]);
+	}
+	return 4;
+}
+
+Int parseNetPacketBenchmark(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_netPacketBenchmarkCommands = atoi(args[1]);
+	}
+	return 2;
+}
+
+Int parseRunAheadSimulation(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_runAheadSimulationFile = args[1];
+	}
+	return 2;
+}
+#endif
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 #ifdef DUMP_PERF_STATS
 Int parseStats(char *args[], int num)
@@ -1098,6 +1202,45 @@ Int parseJumpToFrame(char *args[], int num)
 	return 1;
 }
 
+Int parseReplayKeyframes(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_replayKeyframeInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseReplaySeek(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_replaySeekFrame = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseReplaySimulate(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_replaySimulate = TRUE;
+	}
+	return 1;
+}
+
+Int parseReplayCheckKeyframes(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_replaySimulate = TRUE;
+		TheWritableGlobalData->m_replayCheckKeyframes = TRUE;
+	}
+	return 1;
+}
+
 Int parseUpdateImages(char *args[], int num)
 {
 	if (TheWritableGlobalData)
@@ -1213,6 +1356,17 @@ static CommandLineParam params[] =
 	{ "-noLogOrCrash", parseNoLogOrCrash },
 	{ "-FPUPreserve", parseFPUPreserve },
 	{ "-benchmark", parseBenchmark },
+	{ "-recordPathfindQueries", parseRecordPathfindQueries },
+	{ "-pathfindBenchmark", parsePathfindBenchmark },
+	{ "-pathfindBenchmarkReport", parsePathfindBenchmarkReport },
+	{ "-sleepyUpdateBenchmark", parseSleepyUpdateBenchmark },
+	{ "-recordMemoryTrace", parseRecordMemoryTrace },
+	{ "-memoryPoolBenchmark", parseMemoryPoolBenchmark },
+	{ "-memoryPoolSizing", parseMemoryPoolSizing },
+	{ "-networkSoak", parseNetworkSoak },
+	{ "-networkSoakConditions", parseNetworkSoakConditions },
+	{ "-netPacketBenchmark", parseNetPacketBenchmark },
+	{ "-runAheadSimulation", parseRunAheadSimulation },
 #ifdef DUMP_PERF_STATS
 	{ "-stats", parseStats }, 
 #endif
@@ -1325,6 +1479,18 @@ static CommandLineParam params[] =
 	{ "-noFPSLimit", parseNoFPSLimit },
 	{ "-dumpAssetUsage", parseDumpAssetUsage },
 	{ "-jumpToFrame", parseJumpToFrame },
+
+	// Replay keyframes, for jumping around in long replays:
+	// -replayKeyframes <frames> saves a keyframe every <frames> frames while a replay without
+	// keyframes plays, -replaySeek <frame> jumps to a frame once playback has started (for now by
+	// playing on, or from the start, until keyframes have been through -replayCheckKeyframes), and
+	// -replaySimulate plays the replay with the logic only, as fast as it will go, then quits.
+	// -replayCheckKeyframes does the same, then plays on from each keyframe to the next and logs
+	// any frame whose CRC differs from the one it had on the way through.
+	{ "-replayKeyframes", parseReplayKeyframes },
+	{ "-replaySeek", parseReplaySeek },
+	{ "-replaySimulate", parseReplaySimulate },
+	{ "-replayCheckKeyframes", parseReplayCheckKeyframes },
 	{ "-updateImages", parseUpdateImages },
 	{ "-showTeamDot", parseShowTeamDot },
 	{ "-extraLogging", parseExtraLogging },
@@ -40,6 +40,7 @@
 #include "Common/GameEngine.h"
 #include "Common/INI.h"
 #include "Common/INIException.h"
+#include "Common/MemoryPoolBenchmark.h"
 #include "Common/MessageStream.h"
 #include "Common/ThingFactory.h"
 #include "Common/file.h"
@@ -102,6 +103,9 @@
 #include "GameClient/GUICallbacks.h"
 
 #include "GameNetwork/NetworkInterface.h"
+#include "GameNetwork/NetPacketBenchmark.h"
+#include "GameNetwork/NetworkSoak.h"
+#include "GameNetwork/RunAheadSimulation.h"
 #include "GameNetwork/WOLBrowser/WebBrowser.h"
 #include "GameNetwork/LANAPI.h"
 #include "GameNetwork/GameSpy/GameResultsThread.h"
@@ -199,6 +203,15 @@ GameEngine::~GameEngine()
 	//extern std::vector<std::string>	preloadTextureNamesGlobalHack;
 	//preloadTextureNamesGlobalHack.clear();
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// the trace ends with the game; tearing down the subsystems isn't worth recording.
+	TheMemoryPoolFactory->debugStopTrace();
+
+	// likewise, the peaks are the game's; shutting down doesn't change them.
+	if (TheGlobalData->m_memoryPoolSizingFile.isNotEmpty())
+		TheMemoryPoolFactory->debugWritePoolSizing(TheGlobalData->m_memoryPoolSizingFile.str());
+#endif
+
 	delete TheMapCache;
 	TheMapCache = NULL;
 
@@ -380,6 +393,13 @@ void GameEngine::init( int argc, char *argv[] )
 		// special-case: parse command-line parameters after loading global data
 		parseCommandLine(argc, argv);
 
+	#if defined(_DEBUG) || defined(_INTERNAL)
+		if (TheGlobalData->m_memoryPoolBenchmarkFile.isNotEmpty())
+			runMemoryPoolBenchmark(TheGlobalData->m_memoryPoolBenchmarkFile);
+		if (TheGlobalData->m_recordMemoryTraceFile.isNotEmpty())
+			TheMemoryPoolFactory->debugStartTrace(TheGlobalData->m_recordMemoryTraceFile.str());
+	#endif
+
 		// doesn't require resets so just create a single instance here.
 		TheGameLODManager = MSGNEW("GameEngineSubsystem") GameLODManager;
 		TheGameLODManager->init();
@@ -621,6 +641,25 @@ void GameEngine::init( int argc, char *argv[] )
 			//populateMapListbox(NULL, true, true);
 			m_quitting = TRUE;
 		}
+
+	#if defined(_DEBUG) || defined(_INTERNAL)
+		if (TheGlobalData->m_networkSoakPlayers > 0)
+		{
+			runNetworkSoak(TheGlobalData->m_networkSoakPlayers, TheGlobalData->m_networkSoakFrames,
+				TheGlobalData->m_networkSoakLatency, TheGlobalData->m_networkSoakJitter, TheGlobalData->m_networkSoakPacketLoss);
+			m_quitting = TRUE;
+		}
+		if (TheGlobalData->m_netPacketBenchmarkCommands > 0)
+		{
+			runNetPacketBenchmark(TheGlobalData->m_netPacketBenchmarkCommands);
+			m_quitting = TRUE;
+		}
+		if (TheGlobalData->m_runAheadSimulationFile.isNotEmpty())
+		{
+			runRunAheadSimulation(TheGlobalData->m_runAheadSimulationFile);
+			m_quitting = TRUE;
+		}
+	#endif
 		
 		// load the initial shell screen
 		//TheShell->push( AsciiString("Menus/MainMenu.wnd") );
@@ -753,12 +792,19 @@ void GameEngine::update( void )
 			// VERIFY CRC needs to be in this code block.  Please to not pull TheGameLogic->update() inside this block.
 			VERIFY_CRC
 
-			TheRadar->UPDATE();
+			// TheSuperHackers @feature While a replay seeks, or is only simulated, nobody is looking, so
+			// leave everything but the logic (and the messages that drive it) alone.
+			Bool simulatingFast = TheRecorder->isSimulatingFast();
 
-			/// @todo Move audio init, update, etc, into GameClient update
-			
-			TheAudio->UPDATE();
-			TheGameClient->UPDATE();
+			if (!simulatingFast)
+			{
+				TheRadar->UPDATE();
+
+				/// @todo Move audio init, update, etc, into GameClient update
+				
+				TheAudio->UPDATE();
+				TheGameClient->UPDATE();
+			}
 			TheMessageStream->propagateMessages();
 
 			if (TheNetwork != NULL)
@@ -766,13 +812,15 @@ void GameEngine::update( void )
 				TheNetwork->UPDATE();
 			}
 			 
-			TheCDManager->UPDATE();
+			if (!simulatingFast)
+				TheCDManager->UPDATE();
 		}
 
 
 		if ((TheNetwork == NULL && !TheGameLogic->isGamePaused()) || (TheNetwork && TheNetwork->isFrameDataReady()))
 		{
 			TheGameLogic->UPDATE();
+			TheRecorder->updateKeyframes();
 		}
 
 	}	// end perfGather
@@ -860,7 +908,7 @@ void GameEngine::execute( void )
 
 			{
 
-				if (TheTacticalView->getTimeMultiplier()<=1 && !TheScriptEngine->isTimeFast()) 
+				if (TheTacticalView->getTimeMultiplier()<=1 && !TheScriptEngine->isTimeFast() && !TheRecorder->isSimulatingFast()) 
 				{
 
 		// I'm disabling this in internal because many people need alt-tab capability.  If you happen to be
@@ -387,6 +387,9 @@ GlobalData* GlobalData::m_theOriginal = NULL;
 
 	{ "MaxLineBuildObjects",				INI::parseInt,				NULL,			offsetof( GlobalData, m_maxLineBuildObjects ) },
 	{ "MaxTunnelCapacity",					INI::parseInt,				NULL,			offsetof( GlobalData, m_maxTunnelCapacity ) },
+	{ "IncrementalPathfindZones",		INI::parseBool,				NULL,			offsetof( GlobalData, m_incrementalPathfindZones ) },
+	{ "PathfindFlowFields",					INI::parseBool,				NULL,			offsetof( GlobalData, m_pathfindFlowFields ) },
+	{ "PathfindCache",							INI::parseBool,				NULL,			offsetof( GlobalData, m_pathfindCache ) },
 
 	{ "MaxParticleCount",						INI::parseInt,				NULL,			offsetof( GlobalData, m_maxParticleCount ) },
 	{ "MaxFieldParticleCount",						INI::parseInt,				NULL,			offsetof( GlobalData, m_maxFieldParticleCount ) },
@@ -480,6 +483,10 @@ GlobalData* GlobalData::m_theOriginal = NULL;
 	{ "NetworkRunAheadMetricsTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadMetricsTime) },
 	{ "NetworkCushionHistoryLength", INI::parseInt, NULL, offsetof(GlobalData, m_networkCushionHistoryLength) },
 	{ "NetworkRunAheadSlack", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadSlack) },
+	{ "NetworkRunAheadPercentile", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadPercentile) },
+	{ "NetworkRunAheadHysteresis", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadHysteresis) },
+	{ "NetworkRunAheadDecreaseDelay", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadDecreaseDelay) },
+	{ "NetworkRunAheadMinCushion", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadMinCushion) },
 	{ "NetworkKeepAliveDelay", INI::parseInt, NULL, offsetof(GlobalData, m_networkKeepAliveDelay) },
 	{ "NetworkDisconnectTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkDisconnectTime) },
 	{ "NetworkPlayerTimeoutTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkPlayerTimeoutTime) },
@@ -591,6 +598,20 @@ GlobalData::GlobalData()
 	m_baseStatsDir = ".\\";
 	m_MOTDPath = "MOTD.txt";
 	m_extraLogging = FALSE;
+	m_recordPathfindQueriesFile.clear();
+	m_pathfindBenchmarkFile.clear();
+	m_pathfindBenchmarkReportFile = "PathfindBenchmark.txt";
+	m_sleepyUpdateBenchmarkModules = 0;
+	m_recordMemoryTraceFile.clear();
+	m_memoryPoolBenchmarkFile.clear();
+	m_memoryPoolSizingFile.clear();
+	m_networkSoakPlayers = 0;
+	m_networkSoakFrames = 3000;
+	m_networkSoakLatency = 0;
+	m_networkSoakJitter = 0;
+	m_networkSoakPacketLoss = 0;
+	m_netPacketBenchmarkCommands = 0;
+	m_runAheadSimulationFile.clear();
 #endif
 
 #ifdef DEBUG_CRASHING
@@ -780,6 +801,10 @@ GlobalData::GlobalData()
 //	m_inGame = FALSE;	
 
 	m_noDraw = 0;
+	m_replayKeyframeInterval = 0;
+	m_replaySeekFrame = 0;
+	m_replaySimulate = FALSE;
+	m_replayCheckKeyframes = FALSE;
 	m_particleScale = 1.0f;
 
 	m_autoFireParticleSmallMax = 0;
@@ -863,6 +888,9 @@ GlobalData::GlobalData()
 	m_commandCenterHealAmount = 0.0f;
 	m_maxTunnelCapacity = 0;
 	m_maxLineBuildObjects = 0;
+	m_incrementalPathfindZones = FALSE;
+	m_pathfindFlowFields = FALSE;
+	m_pathfindCache = FALSE;
 
 	m_standardMinefieldDensity = 0.01f;
 	m_standardMinefieldDistance = 40.0f;
@@ -942,6 +970,10 @@ GlobalData::GlobalData()
 	m_networkRunAheadMetricsTime = 500;
 	m_networkCushionHistoryLength = 10;
 	m_networkRunAheadSlack = 10;
+	m_networkRunAheadPercentile = 95;
+	m_networkRunAheadHysteresis = 2;
+	m_networkRunAheadDecreaseDelay = 6;
+	m_networkRunAheadMinCushion = 1;
 	m_networkKeepAliveDelay = 20;
 	m_networkDisconnectTime = 5000;
 	m_networkPlayerTimeoutTime = 60000;
@@ -1057,6 +1089,18 @@ GlobalData::GlobalData()
 
 	m_keyboardCameraRotateSpeed = 0.1f;
 
+  m_userDataDir = findUserDataDir();
+	
+	//-allAdvice feature
+	//m_allAdvice = FALSE;
+
+	m_clientRetaliationModeEnabled = TRUE; //On by default.
+
+}  // end GlobalData
+
+//-------------------------------------------------------------------------------------------------
+AsciiString GlobalData::findUserDataDir( void )
+{
   // Set user data directory based on registry settings instead of INI parameters. This allows us to 
   // localize the leaf name.
   char temp[_MAX_PATH + 1];
@@ -1081,15 +1125,11 @@ GlobalData::GlobalData()
       myDocumentsDirectory.concat( '\\' );
 
     CreateDirectory(myDocumentsDirectory.str(), NULL);
-    m_userDataDir = myDocumentsDirectory;
+    return myDocumentsDirectory;
   }
-	
-	//-allAdvice feature
-	//m_allAdvice = FALSE;
 
-	m_clientRetaliationModeEnabled = TRUE; //On by default.
-
-}  // end GlobalData
+  return AsciiString::TheEmptyString;
+}
 
 
 //-------------------------------------------------------------------------------------------------
@@ -38,6 +38,7 @@
 #include "Common/file.h"
 #include "Common/FileSystem.h"
 #include "Common/GameAudio.h"
+#include "Common/INICache.h"
 #include "Common/Science.h"
 #include "Common/SpecialPower.h"
 #include "Common/ThingFactory.h"
@@ -184,8 +185,10 @@ Bool INI::isValidINIFilename( const char *filename )
 INI::INI( void )
 {
 
-	m_file							= NULL;
-  m_readBufferNext=m_readBufferUsed=0;
+	m_lines							= NULL;
+	m_ownLines					= NULL;
+	m_nextLine					= NULL;
+	m_linesLeft					= 0;
 	m_filename					= "None";
 	m_loadType					= INI_LOAD_INVALID;
 	m_lineNum						= 0;
@@ -207,6 +210,8 @@ INI::INI( void )
 INI::~INI( void )
 {
 
+	delete m_ownLines;
+
 }  // end ~INI
 
 //-------------------------------------------------------------------------------------------------
@@ -227,6 +232,7 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 		TheFileSystem->getFileListInDirectory(dirName, "*.ini", filenameList, TRUE);
 		// Load the INI files in the dir now, in a sorted order.  This keeps things the same between machines
 		// in a network game.
+		std::vector<AsciiString> filenames;
 		FilenameList::const_iterator it = filenameList.begin();
 		while (it != filenameList.end())
 		{
@@ -235,7 +241,7 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 
 			if ((tempname.find('\\') == NULL) && (tempname.find('/') == NULL)) {
 				// this file doesn't reside in a subdirectory, load it first.
-				load( *it, loadType, pXfer );
+				filenames.push_back( *it );
 			}
 			++it;
 		}
@@ -247,10 +253,19 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 			tempname = (*it).str() + dirName.getLength();
 
 			if ((tempname.find('\\') != NULL) || (tempname.find('/') != NULL)) {
-				load( *it, loadType, pXfer );
+				filenames.push_back( *it );
 			}
 			++it;
 		}
+
+		// lex all the files up front, on several threads, then parse them one at a time in the order above.
+		INICache cache;
+		cache.lexFiles( filenames );
+
+		for (std::vector<AsciiString>::const_iterator nameIt = filenames.begin(); nameIt != filenames.end(); ++nameIt)
+		{
+			load( *nameIt, loadType, pXfer, cache.getLines( *nameIt ) );
+		}
 	} 
 	catch (...) 
 	{
@@ -262,10 +277,10 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
-void INI::prepFile( AsciiString filename, INILoadType loadType )
+void INI::prepFile( AsciiString filename, INILoadType loadType, const INILines *lines )
 {
 	// if we have a file open already -- we can't do another one
-	if( m_file != NULL )
+	if( m_lines != NULL )
 	{
 
 		DEBUG_CRASH(( "INI::load, cannot open file '%s', file already open\n", filename.str() ));
@@ -273,9 +288,24 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 
 	}  // end if
 
-	// open the file
-	m_file = TheFileSystem->openFile(filename.str(), File::READ);
-	if( m_file == NULL )
+	// get the lexed lines of the file, if the caller hasn't lexed it already
+	if( lines )
+	{
+
+		m_lines = lines;
+
+	}  // end if
+	else
+	{
+
+		if( m_ownLines == NULL )
+			m_ownLines = MSGNEW("INI") INILines;
+		if( m_ownLines->load( filename ) )
+			m_lines = m_ownLines;
+
+	}  // end else
+
+	if( m_lines == NULL )
 	{
 
 		DEBUG_CRASH(( "INI::load, cannot open file '%s'\n", filename.str() ));
@@ -283,7 +313,8 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 
 	}  // end if
 
-	m_file = m_file->convertToRAMFile();
+	m_nextLine = &m_lines->m_text[0];
+	m_linesLeft = m_lines->m_numLines;
 
 	// save our filename
 	m_filename = filename;
@@ -296,10 +327,10 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 //-------------------------------------------------------------------------------------------------
 void INI::unPrepFile()
 {
-	// close the file
-	m_file->close();
-	m_file = NULL;
-  m_readBufferUsed=m_readBufferNext=0;
+	// let go of the lines
+	m_lines = NULL;
+	m_nextLine = NULL;
+	m_linesLeft = 0;
 	m_filename = "None";
 	m_loadType = INI_LOAD_INVALID;
 	m_lineNum = 0;
@@ -350,11 +381,19 @@ static INIFieldParseProc findFieldParse(const FieldParse* parseTable, const char
 /** Load and parse an INI file */
 //-------------------------------------------------------------------------------------------------
 void INI::load( AsciiString filename, INILoadType loadType, Xfer *pXfer )
+{
+	load( filename, loadType, pXfer, NULL );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Parse an INI file from lines that were already lexed; if 'lines' is NULL, get them here */
+//-------------------------------------------------------------------------------------------------
+void INI::load( AsciiString filename, INILoadType loadType, Xfer *pXfer, const INILines *lines )
 {
 	setFPMode(); // so we have consistent Real values for GameLogic -MDC
 
 	s_xfer = pXfer;
-	prepFile(filename, loadType);
+	prepFile(filename, loadType, lines);
 
 	try
 	{
@@ -422,63 +461,24 @@ void INI::load( AsciiString filename, INILoadType loadType, Xfer *pXfer )
 void INI::readLine( void )
 {
 	// sanity
-	DEBUG_ASSERTCRASH( m_file, ("readLine(), file pointer is NULL\n") );
-
-  if (m_endOfFile)
-    *m_buffer=0;
-  else
-  {
-    char *p=m_buffer;
-    while (p!=m_buffer+INI_MAX_CHARS_PER_LINE)
-    {
-      // get next character
-      if (m_readBufferNext==m_readBufferUsed)
-      {
-        // refill buffer
-        m_readBufferNext=0;
-        m_readBufferUsed=m_file->read(m_readBuffer,INI_READ_BUFFER);
-
-        // EOF?
-        if (!m_readBufferUsed)
-        {
-          m_endOfFile=true;
-          *p=0;
-          break;
-        }
-      }
-      *p=m_readBuffer[m_readBufferNext++];
-
-      // CR?
-      if (*p=='\n')
-      {
-        *p=0;
-        break;
-      }
-
-      DEBUG_ASSERTCRASH(*p != '\t', ("tab characters are not allowed in INI files (%s). please check your editor settings. Line Number %d\n",m_filename.str(), getLineNum()));
-
-      // comment?
-      if (*p==';')
-        *p=0;
-      // whitespace?
-      else if (*p>0&&*p<32)
-        *p=' ';
-      p++;
-    }
-    *p=0;
+	DEBUG_ASSERTCRASH( m_lines, ("readLine(), file pointer is NULL\n") );
+
+	if (m_endOfFile)
+		*m_buffer=0;
+	else
+	{
+		// the lines were lexed when the file was prepped (see INILines::lex), so just hand out the next one
+		Int len = strlen(m_nextLine);
+		memcpy(m_buffer, m_nextLine, len + 1);
+		m_nextLine += len + 1;
 
 		// increase our line count
 		m_lineNum++;
 
-		// check for at the max
-		if ( p == m_buffer+INI_MAX_CHARS_PER_LINE )
-		{
-
-			DEBUG_ASSERTCRASH( 0, ("Buffer too small (%d) and was truncated, increase INI_MAX_CHARS_PER_LINE\n", 
-														 INI_MAX_CHARS_PER_LINE) );
-
-		}  // end if
-  }
+		// the last line is the one that ran into the end of the file
+		if (--m_linesLeft == 0)
+			m_endOfFile = TRUE;
+	}
 
 	if (s_xfer)
 	{
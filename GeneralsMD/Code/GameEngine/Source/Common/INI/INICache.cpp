@@ -0,0 +1,270 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// INICache.cpp
+// Lexed INI line streams.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/INICache.h"
+
+#include "Common/file.h"
+#include "Common/FileSystem.h"
+#include "Common/INI.h"
+
+#include "thread.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Read the whole file into a buffer the caller has to delete[]. NULL if it can't be opened. */
+static char *readINIFile( const AsciiString& filename, Int& size )
+{
+	File *file = TheFileSystem->openFile(filename.str(), File::READ);
+	if (file == NULL)
+	{
+		size = 0;
+		return NULL;
+	}
+
+	file = file->convertToRAMFile();
+	size = file->size();
+	return file->readEntireAndClose();
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool INILines::load( const AsciiString& filename )
+{
+	Int size;
+	char *data = readINIFile(filename, size);
+	if (data == NULL)
+		return FALSE;
+
+	lex(data, size, filename);
+	delete [] data;
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** This must produce exactly the lines that INI::readLine() used to read from the file one
+	character at a time: everything from a ';' to the end of the line is dropped, control characters
+	become spaces, and a line longer than INI_MAX_CHARS_PER_LINE continues as the next line. The
+	last line is the one that ran into the end of the file, so a file ending in a newline ends in
+	an empty line. */
+//-------------------------------------------------------------------------------------------------
+void INILines::lex( const char *source, Int sourceSize, const AsciiString& filename )
+{
+	m_text.clear();
+	m_text.reserve(sourceSize + 1);
+	m_numLines = 0;
+
+	Int pos = 0;
+	Bool endOfFile = FALSE;
+	while (!endOfFile)
+	{
+		Int len = 0;
+		Bool ended = FALSE;		// hit a ';' (or a NUL), so the rest of the line is ignored
+		while (len != INI_MAX_CHARS_PER_LINE)
+		{
+			if (pos == sourceSize)
+			{
+				endOfFile = TRUE;
+				break;
+			}
+
+			char c = source[pos++];
+			if (c == '\n')
+				break;
+
+			DEBUG_ASSERTCRASH(c != '\t', ("tab characters are not allowed in INI files (%s). please check your editor settings. Line Number %d\n",filename.str(), m_numLines));
+
+			++len;
+			if (c == ';' || c == 0)
+				ended = TRUE;
+			else if (!ended)
+				m_text.push_back((c > 0 && c < 32) ? ' ' : c);
+		}
+		m_text.push_back(0);
+		++m_numLines;
+
+		DEBUG_ASSERTCRASH(len != INI_MAX_CHARS_PER_LINE, ("Buffer too small (%d) and was truncated, increase INI_MAX_CHARS_PER_LINE\n",
+														INI_MAX_CHARS_PER_LINE));
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+INICache::INICache()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+INICache::~INICache()
+{
+	clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void INICache::clear( void )
+{
+	for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+		delete it->second;
+	m_entries.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+INILines *INICache::findEntry( const AsciiString& filename, Bool& isLexed )
+{
+	AsciiString key = filename;
+	key.toLower();
+
+	INILines *&entry = m_entries[key];
+	if (entry == NULL)
+		entry = MSGNEW("INICache") INILines;
+
+	isLexed = entry->m_numLines > 0;
+	return entry;
+}
+
+//-------------------------------------------------------------------------------------------------
+const INILines *INICache::getLines( const AsciiString& filename )
+{
+	Bool isLexed;
+	INILines *entry = findEntry(filename, isLexed);
+	if (isLexed)
+		return entry;
+
+	if (!entry->load(filename))
+	{
+		entry->m_numLines = 0;
+		return NULL;
+	}
+
+	return entry;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** One file waiting to be lexed */
+struct INILexJob
+{
+	INILines *m_lines;
+	char *m_source;
+	Int m_sourceSize;
+	AsciiString m_filename;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The files lexFiles() has to lex, handed out to whichever thread asks next */
+struct INILexQueue
+{
+	std::vector<INILexJob> m_jobs;
+	volatile LONG m_nextJob;
+	volatile LONG m_numJobsDone;
+	HANDLE m_goEvent;						///< set once every thread has been started
+	HANDLE m_doneEvent;					///< set when the last job is done
+
+	INILexQueue() : m_nextJob(0), m_numJobsDone(0)
+	{
+		m_goEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		m_doneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	}
+
+	~INILexQueue()
+	{
+		CloseHandle(m_goEvent);
+		CloseHandle(m_doneEvent);
+	}
+
+	void work( void )
+	{
+		// don't let a thread finish before ThreadClass::Execute() has returned for it.
+		WaitForSingleObject(m_goEvent, INFINITE);
+
+		LONG numJobs = m_jobs.size();
+		LONG i;
+		while ((i = InterlockedIncrement((LONG *)&m_nextJob) - 1) < numJobs)
+		{
+			INILexJob &job = m_jobs[i];
+			job.m_lines->lex(job.m_source, job.m_sourceSize, job.m_filename);
+			if (InterlockedIncrement((LONG *)&m_numJobsDone) == numJobs)
+				SetEvent(m_doneEvent);
+		}
+	}
+};
+
+//-------------------------------------------------------------------------------------------------
+class INILexThread : public ThreadClass
+{
+public:
+	INILexThread( INILexQueue *queue ) : ThreadClass("INILexThread"), m_queue(queue) { }
+
+protected:
+	virtual void Thread_Function() { m_queue->work(); }
+
+private:
+	INILexQueue *m_queue;
+};
+
+//-------------------------------------------------------------------------------------------------
+void INICache::lexFiles( const std::vector<AsciiString>& filenames )
+{
+	enum { MAX_LEX_THREADS = 8 };
+
+	// read everything that isn't lexed yet on this thread
+	INILexQueue queue;
+	queue.m_jobs.reserve(filenames.size());
+	for (std::vector<AsciiString>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		Bool isLexed;
+		INILines *entry = findEntry(*it, isLexed);
+		if (isLexed)
+			continue;
+
+		INILexJob job;
+		job.m_source = readINIFile(*it, job.m_sourceSize);
+		if (job.m_source == NULL)
+			continue;		// getLines() will report it when the file's turn to be parsed comes
+		job.m_lines = entry;
+		job.m_filename = *it;
+		queue.m_jobs.push_back(job);
+	}
+
+	// then lex it on as many threads as it's worth, this one included
+	Int numJobs = queue.m_jobs.size();
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	Int numThreads = min((Int)systemInfo.dwNumberOfProcessors, numJobs) - 1;
+	if (numThreads > MAX_LEX_THREADS)
+		numThreads = MAX_LEX_THREADS;
+
+	INILexThread *threads[MAX_LEX_THREADS];
+	Int i;
+	for (i = 0; i < numThreads; ++i)
+	{
+		threads[i] = MSGNEW("INICache") INILexThread(&queue);
+		threads[i]->Execute();
+	}
+	SetEvent(queue.m_goEvent);
+
+	// the other threads may still be lexing the last files when we run out
+	queue.work();
+	if (numJobs > 0)
+		WaitForSingleObject(queue.m_doneEvent, INFINITE);
+
+	for (i = 0; i < numThreads; ++i)
+		delete threads[i];
+
+	for (i = 0; i < numJobs; ++i)
+		delete [] queue.m_jobs[i].m_source;
+}
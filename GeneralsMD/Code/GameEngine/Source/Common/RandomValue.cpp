@@ -153,6 +153,18 @@ UnsignedInt GetGameLogicRandomSeedCRC( void )
 	return c.get();
 }
 
+void GetGameLogicRandomState( UnsignedInt *state )
+{
+	memcpy(state, theGameLogicSeed, 6*sizeof(UnsignedInt));
+	state[6] = theGameLogicBaseSeed;
+}
+
+void SetGameLogicRandomState( const UnsignedInt *state )
+{
+	memcpy(theGameLogicSeed, state, 6*sizeof(UnsignedInt));
+	theGameLogicBaseSeed = state[6];
+}
+
 void InitRandom( void )
 {
 #ifdef DETERMINISTIC
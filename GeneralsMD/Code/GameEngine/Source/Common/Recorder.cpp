@@ -30,6 +30,8 @@
 #include "Common/Player.h"
 #include "Common/GlobalData.h"
 #include "Common/GameEngine.h"
+#include "Common/GameState.h"
+#include "Common/LatchRestore.h"
 #include "GameClient/GameWindow.h"
 #include "GameClient/GameWindowManager.h"
 #include "GameClient/InGameUI.h"
@@ -125,6 +127,9 @@ void RecorderClass::logPlayerDisconnect(UnicodeString player, Int slot)
 	if (!m_file)
 		return;
 
+	// the header is patched in place, so everything before it has to be in the file first.
+	m_replayWriter.flush();
+
 	DEBUG_ASSERTCRASH((slot >= 0) && (slot < MAX_SLOTS), ("Attempting to disconnect an invalid slot number"));
 	if ((slot < 0) || (slot >= (MAX_SLOTS)))
 	{
@@ -175,6 +180,8 @@ void RecorderClass::logCRCMismatch( void )
 	if (!m_file)
 		return;
 
+	m_replayWriter.flush();
+
 	UnsignedInt fileSize = ftell(m_file);
 	// move to appropriate offset
 	if (!fseek(m_file, desyncOffset, SEEK_SET))
@@ -221,6 +228,8 @@ void RecorderClass::logGameEnd( void )
 	if (!m_file)
 		return;
 
+	m_replayWriter.flush();
+
 	time_t t;
 	time(&t);
 	UnsignedInt duration = TheGameLogic->getFrame();
@@ -291,6 +300,8 @@ void RecorderClass::cleanUpReplayFile( void )
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheGlobalData->m_saveStats)
 	{
+		m_replayWriter.flush();
+
 		char fname[_MAX_PATH+1];
 		strncpy(fname, TheGlobalData->m_baseStatsDir.str(), _MAX_PATH);
 		strncat(fname, m_fileName.str(), _MAX_PATH - strlen(fname));
@@ -374,6 +385,13 @@ RecorderClass::RecorderClass()
 	m_nextFrame = 0;
 	m_wasDesync = FALSE;
 	//
+	m_savingKeyframes = FALSE;
+	m_loadingKeyframe = FALSE;
+	m_seekFrame = 0;
+	m_checkingKeyframe = -1;
+	m_checkKeyframePending = FALSE;
+	m_keyframeCRCsChecked = 0;
+	m_keyframeCRCMismatches = 0;
 
 	init(); // just for the heck of it.
 }
@@ -406,12 +424,20 @@ void RecorderClass::init() {
 	m_gameInfo.setSeed(GetGameLogicRandomSeed());
 	m_wasDesync = FALSE;
 	m_doingAnalysis = FALSE;
+	m_keyframes.clear();
+	m_savingKeyframes = FALSE;
+	m_seekFrame = 0;
 }
 
 /**
  * Reset the recorder to the "initialized state."
  */
 void RecorderClass::reset() {
+	// a keyframe is loaded through a reset of the whole engine, which must leave the playback alone.
+	if (m_loadingKeyframe)
+		return;
+
+	m_replayWriter.close();
 	if (m_file != NULL) {
 		fclose(m_file);
 		m_file = NULL;
@@ -460,16 +486,39 @@ void RecorderClass::updatePlayback() {
  * reaching the end of the playback file.
  */
 void RecorderClass::stopPlayback() {
+	// at the end of the replay, check the keyframes one after another before we're done.
+	if (TheGlobalData->m_replayCheckKeyframes && m_file != NULL && m_nextFrame == -1 && !m_doingAnalysis)
+	{
+		if (m_checkingKeyframe + 1 < (Int)m_keyframes.size())
+		{
+			if (m_checkingKeyframe < 0)
+			{
+				DEBUG_LOG(("RecorderClass::stopPlayback() - kept %d CRCs, checking %d keyframes\n", m_straightCRCs.size(), m_keyframes.size()));
+			}
+			m_checkKeyframePending = TRUE;
+			return;
+		}
+
+		DEBUG_LOG(("RecorderClass::stopPlayback() - checked %d CRCs from %d keyframes, %d didn't match\n",
+			m_keyframeCRCsChecked, m_keyframes.size(), m_keyframeCRCMismatches));
+		DEBUG_ASSERTCRASH(m_keyframeCRCMismatches == 0, ("Playing on from a keyframe doesn't give the same CRCs as playing straight through"));
+	}
+
 	if (m_file != NULL) {
 		fclose(m_file);
 		m_file = NULL;
 	}
 	m_fileName.clear();
+	m_seekFrame = 0;
 	// Don't clear the game data if the replay is over - let things continue
 //#ifdef DEBUG_CRC
 	if (!m_doingAnalysis)
 		TheMessageStream->appendMessage(GameMessage::MSG_CLEAR_GAME_DATA);
 //#endif
+
+	// nobody is watching a simulated replay, so there's nothing to stay around for.
+	if (TheGlobalData->m_replaySimulate && !m_doingAnalysis)
+		TheGameEngine->setQuitting(TRUE);
 }
 
 /**
@@ -522,7 +571,7 @@ void RecorderClass::updateRecord()
 	}
 
 	if (needFlush) {
-		fflush(m_file);
+		m_replayWriter.endFrame();
 	}
 }
 
@@ -694,6 +743,10 @@ void RecorderClass::startRecording(GameDifficulty diff, Int originalGameMode, In
 	*/
 
 	/// @todo Need to write game options when there are some to be written.
+
+	// the commands go through the replay writer from here on.
+	fflush(m_file);
+	m_replayWriter.open(m_file);
 }
 
 /**
@@ -711,6 +764,7 @@ void RecorderClass::stopRecording() {
 			m_wasDesync = FALSE;
 		}
 	}
+	m_replayWriter.close();
 	if (m_file != NULL) {
 		fclose(m_file);
 		m_file = NULL;
@@ -724,15 +778,15 @@ void RecorderClass::stopRecording() {
 void RecorderClass::writeToFile(GameMessage * msg) {
 	// Write the frame number for this command.
 	UnsignedInt frame = TheGameLogic->getFrame();
-	fwrite(&frame, sizeof(frame), 1, m_file);
+	m_replayWriter.write(&frame, sizeof(frame));
 
 	// Write the command type
 	GameMessage::Type type = msg->getType();
-	fwrite(&type, sizeof(type), 1, m_file);
+	m_replayWriter.write(&type, sizeof(type));
 
 	// Write the player index
 	Int playerIndex = msg->getPlayerIndex();
-	fwrite(&playerIndex, sizeof(playerIndex), 1, m_file);
+	m_replayWriter.write(&playerIndex, sizeof(playerIndex));
 
 #ifdef DEBUG_LOGGING
 	AsciiString commandName = msg->getCommandAsAsciiString();
@@ -753,15 +807,15 @@ void RecorderClass::writeToFile(GameMessage * msg) {
 
 	GameMessageParser *parser = newInstance(GameMessageParser)(msg);
 	UnsignedByte numTypes = parser->getNumTypes();
-	fwrite(&numTypes, sizeof(numTypes), 1, m_file);
+	m_replayWriter.write(&numTypes, sizeof(numTypes));
 
 	GameMessageParserArgumentType *argType = parser->getFirstArgumentType();
 	while (argType != NULL) {
 		UnsignedByte type = (UnsignedByte)(argType->getType());
-		fwrite(&type, sizeof(type), 1, m_file);
+		m_replayWriter.write(&type, sizeof(type));
 
 		UnsignedByte argTypeCount = (UnsignedByte)(argType->getArgCount());
-		fwrite(&argTypeCount, sizeof(argTypeCount), 1, m_file);
+		m_replayWriter.write(&argTypeCount, sizeof(argTypeCount));
 
 		argType = argType->getNext();
 	}
@@ -779,33 +833,31 @@ void RecorderClass::writeToFile(GameMessage * msg) {
 
 	parser->deleteInstance();
 	parser = NULL;
-
-	fflush(m_file); ///< @todo should this be in the final release?
 }
 
 void RecorderClass::writeArgument(GameMessageArgumentDataType type, const GameMessageArgumentType arg) {
 	if (type == ARGUMENTDATATYPE_INTEGER) {
-		fwrite(&(arg.integer), sizeof(arg.integer), 1, m_file);
+		m_replayWriter.write(&(arg.integer), sizeof(arg.integer));
 	} else if (type == ARGUMENTDATATYPE_REAL) {
-		fwrite(&(arg.real), sizeof(arg.real), 1, m_file);
+		m_replayWriter.write(&(arg.real), sizeof(arg.real));
 	} else if (type == ARGUMENTDATATYPE_BOOLEAN) {
-		fwrite(&(arg.boolean), sizeof(arg.boolean), 1, m_file);
+		m_replayWriter.write(&(arg.boolean), sizeof(arg.boolean));
 	} else if (type == ARGUMENTDATATYPE_OBJECTID) {
-		fwrite(&(arg.objectID), sizeof(arg.objectID), 1, m_file);
+		m_replayWriter.write(&(arg.objectID), sizeof(arg.objectID));
 	} else if (type == ARGUMENTDATATYPE_DRAWABLEID) {
-		fwrite(&(arg.drawableID), sizeof(arg.drawableID), 1, m_file);
+		m_replayWriter.write(&(arg.drawableID), sizeof(arg.drawableID));
 	} else if (type == ARGUMENTDATATYPE_TEAMID) {
-		fwrite(&(arg.teamID), sizeof(arg.teamID), 1, m_file);
+		m_replayWriter.write(&(arg.teamID), sizeof(arg.teamID));
 	} else if (type == ARGUMENTDATATYPE_LOCATION) {
-		fwrite(&(arg.location), sizeof(arg.location), 1, m_file);
+		m_replayWriter.write(&(arg.location), sizeof(arg.location));
 	} else if (type == ARGUMENTDATATYPE_PIXEL) {
-		fwrite(&(arg.pixel), sizeof(arg.pixel), 1, m_file);
+		m_replayWriter.write(&(arg.pixel), sizeof(arg.pixel));
 	} else if (type == ARGUMENTDATATYPE_PIXELREGION) {
-		fwrite(&(arg.pixelRegion), sizeof(arg.pixelRegion), 1, m_file);
+		m_replayWriter.write(&(arg.pixelRegion), sizeof(arg.pixelRegion));
 	} else if (type == ARGUMENTDATATYPE_TIMESTAMP) {
-		fwrite(&(arg.timestamp), sizeof(arg.timestamp), 1, m_file);
+		m_replayWriter.write(&(arg.timestamp), sizeof(arg.timestamp));
 	} else if (type == ARGUMENTDATATYPE_WIDECHAR) {
-		fwrite(&(arg.wChar), sizeof(arg.wChar), 1, m_file);
+		m_replayWriter.write(&(arg.wChar), sizeof(arg.wChar));
 	}
 }
 
@@ -953,10 +1005,22 @@ public:
 	void setSawCRCMismatch(void) { m_sawCRCMismatch = TRUE; }
 	Bool sawCRCMismatch(void) { return m_sawCRCMismatch; }
 
+	/// the local CRCs that the replay's CRCs have yet to be compared with, counting the inFlight
+	/// ones that haven't been through addCRC() yet.
+	Int getPendingCount(Int inFlight) const;
+
+	/// start over after a keyframe is loaded, when the replay's next pendingCount CRCs are for
+	/// frames before it, which we won't have CRCs of.
+	void restart(Int pendingCount);
+
+	/// TRUE if the replay CRC just read is one of those, and shouldn't be compared.
+	Bool skipReplayCRC(void);
+
 protected:
 
 	Bool m_sawCRCMismatch;
 	Bool m_skippedOne;
+	Int m_skipCount;
 	std::list<UnsignedInt> m_data;
 	UnsignedInt m_localPlayer;
 };
@@ -966,6 +1030,31 @@ CRCInfo::CRCInfo(UnsignedInt localPlayer, Bool isMultiplayer)
 	m_localPlayer = localPlayer;
 	m_skippedOne = !isMultiplayer;
 	m_sawCRCMismatch = FALSE;
+	m_skipCount = 0;
+}
+
+Int CRCInfo::getPendingCount(Int inFlight) const
+{
+	// the first local CRC isn't queued up in multiplayer; see addCRC().
+	if (!m_skippedOne && inFlight > 0)
+		--inFlight;
+	return m_data.size() + inFlight;
+}
+
+void CRCInfo::restart(Int pendingCount)
+{
+	m_data.clear();
+	m_skippedOne = TRUE;
+	m_skipCount = pendingCount;
+}
+
+Bool CRCInfo::skipReplayCRC(void)
+{
+	if (m_skipCount == 0)
+		return FALSE;
+
+	--m_skipCount;
+	return TRUE;
 }
 
 void CRCInfo::addCRC(UnsignedInt val)
@@ -1017,6 +1106,9 @@ void RecorderClass::handleCRCMessage(UnsignedInt newCRC, Int playerIndex, Bool f
 		samePlayer = TRUE;
 	if (samePlayer || (localPlayerIndex < 0))
 	{
+		if (m_crcInfo->skipReplayCRC())
+			return;
+
 		UnsignedInt playbackCRC = m_crcInfo->readCRC();
 		//DEBUG_LOG(("RecorderClass::handleCRCMessage() - Comparing CRCs of InGame:%8.8X Replay:%8.8X Frame:%d from Player %d\n",
 		//	playbackCRC, newCRC, TheGameLogic->getFrame()-m_crcInfo->GetQueueSize()-1, playerIndex));
@@ -1046,6 +1138,378 @@ void RecorderClass::handleCRCMessage(UnsignedInt newCRC, Int playerIndex, Bool f
 	//DEBUG_LOG(("RecorderClass::handleCRCMessage() - Skipping CRC of %8.8X from %d (our index is %d)\n", newCRC, playerIndex, localPlayerIndex));
 }
 
+// TheSuperHackers @feature Replay keyframes.
+// Playback can only run a replay forward from frame 0, because the commands in it only make sense
+// on top of the game they were recorded in. So while a replay plays back with
+// -replayKeyframes <interval>, every interval frames we save the whole game with the save game code,
+// along with the logic random state (which isn't in a save game) and where in the replay the
+// commands of the next frame start. That gives a seek a place to start from near any frame: load
+// the last keyframe before it and simulate forward from there without the client. (Seeks don't use
+// them yet; see SEEK_FROM_KEYFRAMES.)
+// The keyframes go in Replays\Keyframes\<replay name>\, and the index of them in Index.dat there
+// knows the size and time of the replay they were made from, so a replay that has been overwritten
+// since (like the last replay) gets new ones.
+
+// A replay's CRCs reach it some frames after the frame they are of, so when a keyframe is saved,
+// some of our own CRCs haven't been compared with the replay's yet. The keyframe counts them; after
+// loading it, that many of the replay's CRCs are passed over, and the rest are compared as usual.
+//
+// With -replayCheckKeyframes, the logic CRC of every REPLAY_CRC_INTERVAL'th frame, and of every
+// keyframe, is kept as the replay plays straight through. Then each keyframe in turn is loaded and
+// played on to the next, and its CRCs are compared with those.
+
+static const char keyframeIndexMagic[] = "RKFI";
+static const Int keyframeIndexVersion = 2;
+
+/**
+ * returns how many of our own CRCs are on their way to the CRC queue. They are made at the end of a
+ * logic frame, and only reach the recorder during the next one. If discard is set, they are thrown
+ * away as well.
+ */
+static Int countPlaybackCRCMessages( Bool discard )
+{
+	Int count = 0;
+	GameMessage *msg = TheMessageStream->getFirstMessage();
+	while (msg != NULL)
+	{
+		GameMessage *next = msg->next();
+		if (msg->getType() == GameMessage::MSG_LOGIC_CRC && msg->getArgument(1)->boolean)
+		{
+			++count;
+			if (discard)
+				msg->deleteInstance();
+		}
+		msg = next;
+	}
+	return count;
+}
+
+/**
+ * returns the directory the keyframes of the current replay go in.
+ */
+AsciiString RecorderClass::getKeyframeDir( void )
+{
+	AsciiString name = m_currentReplayFilename;
+	if (name.endsWithNoCase(replayExtention))
+	{
+		for (Int i = strlen(replayExtention); i > 0; --i)
+			name.removeLastChar();
+	}
+
+	AsciiString dir;
+	dir.format("%sKeyframes\\%s\\", getReplayDir().str(), name.str());
+	return dir;
+}
+
+/**
+ * returns the file the keyframe of the given frame of the current replay goes in.
+ */
+AsciiString RecorderClass::getKeyframeFilename( UnsignedInt frame )
+{
+	AsciiString filename;
+	filename.format("%sFrame%08d.sav", getKeyframeDir().str(), frame);
+	return filename;
+}
+
+/**
+ * Read the index of the keyframes of the replay we just started playing back. If there isn't an
+ * up to date one and we were asked for keyframes, start saving them.
+ */
+void RecorderClass::loadKeyframeIndex( void )
+{
+	m_keyframes.clear();
+	m_savingKeyframes = FALSE;
+	m_straightCRCs.clear();
+	m_checkingKeyframe = -1;
+	m_checkKeyframePending = FALSE;
+	m_keyframeCRCsChecked = 0;
+	m_keyframeCRCMismatches = 0;
+
+	FileInfo replayInfo;
+	AsciiString replayPath = getReplayDir();
+	replayPath.concat(m_currentReplayFilename);
+	if (!TheFileSystem->getFileInfo(replayPath, &replayInfo))
+		return;
+
+	AsciiString indexPath = getKeyframeDir();
+	indexPath.concat("Index.dat");
+
+	FILE *fp = fopen(indexPath.str(), "rb");
+	if (fp != NULL)
+	{
+		char magic[4];
+		Int version = 0;
+		FileInfo indexedInfo;
+		Int count = 0;
+		Bool valid = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, keyframeIndexMagic, sizeof(magic)) == 0
+			&& fread(&version, sizeof(version), 1, fp) == 1 && version == keyframeIndexVersion
+			&& fread(&indexedInfo, sizeof(indexedInfo), 1, fp) == 1 && memcmp(&indexedInfo, &replayInfo, sizeof(replayInfo)) == 0
+			&& fread(&count, sizeof(count), 1, fp) == 1 && count >= 0;
+
+		if (valid && count > 0)
+		{
+			m_keyframes.resize(count);
+			if (fread(&m_keyframes[0], sizeof(ReplayKeyframe), count, fp) != (size_t)count)
+			{
+				m_keyframes.clear();
+				valid = FALSE;
+			}
+		}
+		fclose(fp);
+
+		if (valid)
+		{
+			DEBUG_LOG(("RecorderClass::loadKeyframeIndex() - %d keyframes for %s\n", m_keyframes.size(), m_currentReplayFilename.str()));
+			return;
+		}
+	}
+
+	if (TheGlobalData->m_replayKeyframeInterval > 0)
+	{
+		AsciiString dir = getReplayDir();
+		dir.concat("Keyframes\\");
+		TheFileSystem->createDirectory(dir);
+		TheFileSystem->createDirectory(getKeyframeDir());
+		m_savingKeyframes = TRUE;
+		saveKeyframeIndex();
+	}
+}
+
+/**
+ * Write out the index of the keyframes saved so far.
+ */
+void RecorderClass::saveKeyframeIndex( void )
+{
+	FileInfo replayInfo;
+	AsciiString replayPath = getReplayDir();
+	replayPath.concat(m_currentReplayFilename);
+	if (!TheFileSystem->getFileInfo(replayPath, &replayInfo))
+		return;
+
+	AsciiString indexPath = getKeyframeDir();
+	indexPath.concat("Index.dat");
+
+	FILE *fp = fopen(indexPath.str(), "wb");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("RecorderClass::saveKeyframeIndex() - can't open %s\n", indexPath.str()));
+		m_savingKeyframes = FALSE;
+		return;
+	}
+
+	Int count = m_keyframes.size();
+	fwrite(keyframeIndexMagic, 4, 1, fp);
+	fwrite(&keyframeIndexVersion, sizeof(keyframeIndexVersion), 1, fp);
+	fwrite(&replayInfo, sizeof(replayInfo), 1, fp);
+	fwrite(&count, sizeof(count), 1, fp);
+	if (count > 0)
+		fwrite(&m_keyframes[0], sizeof(ReplayKeyframe), count, fp);
+	fclose(fp);
+}
+
+/**
+ * Save a keyframe of the game as it is now, between two logic frames.
+ */
+void RecorderClass::saveKeyframe( void )
+{
+	ReplayKeyframe keyframe;
+	keyframe.m_frame = TheGameLogic->getFrame();
+	// m_nextFrame has already been read, so the commands of the coming frames start just before it.
+	keyframe.m_commandOffset = ftell(m_file) - sizeof(m_nextFrame);
+	GetGameLogicRandomState(keyframe.m_randomState);
+	keyframe.m_pendingCRCs = m_crcInfo->getPendingCount(countPlaybackCRCMessages(FALSE));
+
+	if (TheGameState->saveSnapshot(getKeyframeFilename(keyframe.m_frame)) != SC_OK)
+	{
+		DEBUG_LOG(("RecorderClass::saveKeyframe() - can't save frame %d, giving up on keyframes\n", keyframe.m_frame));
+		m_savingKeyframes = FALSE;
+		return;
+	}
+
+	m_keyframes.push_back(keyframe);
+	saveKeyframeIndex();
+}
+
+/**
+ * Restore the game from a keyframe, and carry on reading the replay from where the keyframe was made.
+ */
+Bool RecorderClass::loadKeyframe( ReplayKeyframe keyframe )
+{
+	DEBUG_LOG(("RecorderClass::loadKeyframe() - loading frame %d\n", keyframe.m_frame));
+
+	SaveCode code;
+	{
+		LatchRestore<Bool> loading(m_loadingKeyframe, TRUE);
+		code = TheGameState->loadSnapshot(getKeyframeFilename(keyframe.m_frame));
+	}
+
+	if (code != SC_OK)
+	{
+		DEBUG_LOG(("RecorderClass::loadKeyframe() - frame %d didn't load\n", keyframe.m_frame));
+		return FALSE;
+	}
+
+	SetGameLogicRandomState(keyframe.m_randomState);
+
+	TheCommandList->reset();
+	fseek(m_file, keyframe.m_commandOffset, SEEK_SET);
+	readNextFrame();
+
+	// the CRCs queued up, or on their way, are of the frames before the seek. Drop them, and pass
+	// over the replay CRCs that were waiting for CRCs of frames before the keyframe.
+	countPlaybackCRCMessages(TRUE);
+	m_crcInfo->restart(keyframe.m_pendingCRCs);
+	return TRUE;
+}
+
+/**
+ * For -replayCheckKeyframes: keep the logic CRC of the frame we are at on the way straight through
+ * the replay, or compare it with the one we kept while checking a keyframe.
+ */
+void RecorderClass::checkKeyframeCRC( UnsignedInt frame )
+{
+	Bool atKeyframe = FALSE;
+	for (ReplayKeyframeList::const_iterator it = m_keyframes.begin(); it != m_keyframes.end(); ++it)
+	{
+		if (it->m_frame == frame)
+			atKeyframe = TRUE;
+	}
+	if (!atKeyframe && (REPLAY_CRC_INTERVAL <= 0 || (frame % REPLAY_CRC_INTERVAL) != 0))
+		return;
+
+	UnsignedInt crc = TheGameLogic->getCRC(CRC_RECALC);
+	if (m_checkingKeyframe < 0)
+	{
+		m_straightCRCs[frame] = crc;
+		return;
+	}
+
+	std::map<UnsignedInt, UnsignedInt>::const_iterator straight = m_straightCRCs.find(frame);
+	if (straight == m_straightCRCs.end())
+		return;
+
+	++m_keyframeCRCsChecked;
+	if (straight->second != crc)
+	{
+		++m_keyframeCRCMismatches;
+		DEBUG_LOG(("RecorderClass::checkKeyframeCRC() - from the keyframe of frame %d, frame %d has CRC %8.8X, straight through it had %8.8X\n",
+			m_keyframes[m_checkingKeyframe].m_frame, frame, crc, straight->second));
+	}
+}
+
+/**
+ * For -replayCheckKeyframes: load the next keyframe to check, between logic frames.
+ */
+void RecorderClass::checkNextKeyframe( void )
+{
+	++m_checkingKeyframe;
+	if (!loadKeyframe(m_keyframes[m_checkingKeyframe]))
+	{
+		// there's no telling what state the game is in now, so that's the end of the check.
+		++m_keyframeCRCMismatches;
+		m_checkingKeyframe = m_keyframes.size() - 1;
+		m_nextFrame = -1;
+		stopPlayback();
+		return;
+	}
+	checkKeyframeCRC(TheGameLogic->getFrame());
+}
+
+// Starting a seek from a keyframe leans on the keyframe's replay offset, its count of CRCs still
+// to come, and the logic random state being all a save game leaves out. None of that has been
+// through -replayCheckKeyframes on real replays yet, so until it has, a seek restarts the replay
+// from frame 0 instead. Define this to seek from keyframes.
+//#define SEEK_FROM_KEYFRAMES
+
+/**
+ * Jump playback to the given frame. If we have a keyframe before it that is ahead of us, or we
+ * are past the frame, we start from the last keyframe before it (only with SEEK_FROM_KEYFRAMES;
+ * otherwise from frame 0). Either way, playback runs without the client until the frame is reached.
+ */
+Bool RecorderClass::seekToFrame( UnsignedInt frame )
+{
+	if (m_mode != RECORDERMODETYPE_PLAYBACK || m_doingAnalysis)
+		return FALSE;
+
+	UnsignedInt curFrame = TheGameLogic->getFrame();
+	if (frame == curFrame)
+		return TRUE;
+
+	const ReplayKeyframe *keyframe = NULL;
+#ifdef SEEK_FROM_KEYFRAMES
+	for (ReplayKeyframeList::const_iterator it = m_keyframes.begin(); it != m_keyframes.end() && it->m_frame <= frame; ++it)
+		keyframe = &(*it);
+#endif
+
+	if (m_file != NULL && keyframe != NULL && (frame < curFrame || keyframe->m_frame > curFrame))
+	{
+		if (!loadKeyframe(*keyframe))
+			return FALSE;
+	}
+	else if (m_file == NULL || frame < curFrame)
+	{
+		// nothing to start from but the beginning.
+		AsciiString replayFile = m_currentReplayFilename;
+		TheGameLogic->clearGameData(FALSE);
+		if (!playbackFile(replayFile))
+			return FALSE;
+	}
+
+	m_seekFrame = frame;
+	return TRUE;
+}
+
+/**
+ * Called between logic frames during playback. Starts the seek asked for on the command line, and
+ * saves keyframes.
+ */
+void RecorderClass::updateKeyframes( void )
+{
+	if (m_mode != RECORDERMODETYPE_PLAYBACK || m_doingAnalysis || !TheGameLogic->isInReplayGame())
+		return;
+
+	UnsignedInt frame = TheGameLogic->getFrame();
+	if (frame == 0)
+		return;
+
+	if (TheGlobalData->m_replaySeekFrame != 0)
+	{
+		UnsignedInt seekFrame = TheGlobalData->m_replaySeekFrame;
+		TheWritableGlobalData->m_replaySeekFrame = 0;
+		seekToFrame(seekFrame);
+		return;
+	}
+
+	if (m_seekFrame != 0 && frame >= m_seekFrame)
+		m_seekFrame = 0;
+
+	if (TheGlobalData->m_replayCheckKeyframes)
+	{
+		checkKeyframeCRC(frame);
+		if (m_checkKeyframePending || (m_checkingKeyframe >= 0 && m_checkingKeyframe + 1 < (Int)m_keyframes.size()
+			&& frame >= m_keyframes[m_checkingKeyframe + 1].m_frame))
+		{
+			m_checkKeyframePending = FALSE;
+			checkNextKeyframe();
+			return;
+		}
+	}
+
+	if (m_savingKeyframes && m_file != NULL && frame % TheGlobalData->m_replayKeyframeInterval == 0
+		&& (m_keyframes.empty() || frame > m_keyframes.back().m_frame))
+	{
+		saveKeyframe();
+	}
+}
+
+/**
+ * returns TRUE while the client can be left out: we are seeking, or only simulating the replay.
+ */
+Bool RecorderClass::isSimulatingFast( void ) const
+{
+	return m_mode == RECORDERMODETYPE_PLAYBACK && !m_doingAnalysis && (m_seekFrame != 0 || TheGlobalData->m_replaySimulate);
+}
+
 /**
  * Return true if this version of the file is the same as our version of the game
  */
@@ -1192,6 +1656,10 @@ Bool RecorderClass::playbackFile(AsciiString filename)
 	}
 
 	m_currentReplayFilename = filename;
+
+	if (!m_doingAnalysis)
+		loadKeyframeIndex();
+
 	return TRUE;
 }
 
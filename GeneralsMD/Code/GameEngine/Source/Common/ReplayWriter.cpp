@@ -0,0 +1,217 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ReplayWriter.cpp
+// Buffers the commands the recorder writes to a replay, and writes them out on a thread of its own.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/ReplayWriter.h"
+
+#include "thread.h"
+
+ReplayWriter *ReplayWriter::s_openWriter = NULL;
+
+//-------------------------------------------------------------------------------------------------
+/** Writes the blocks the logic thread hands over, and sleeps in between */
+class ReplayWriterThread : public ThreadClass
+{
+public:
+	ReplayWriterThread( ReplayWriter *writer ) : ThreadClass("ReplayWriterThread"), m_writer(writer) { }
+
+protected:
+	virtual void Thread_Function()
+	{
+		while (running)
+		{
+			WaitForSingleObject((HANDLE)m_writer->m_wakeEvent, 100);
+
+			ScopedCriticalSection lock(&m_writer->m_fileLock);
+			m_writer->writeQueued();
+		}
+	}
+
+private:
+	ReplayWriter *m_writer;
+};
+
+//-------------------------------------------------------------------------------------------------
+ReplayWriter::ReplayWriter() :
+	m_file(NULL),
+	m_blocks(NULL),
+	m_firstQueued(0),
+	m_filling(0),
+	m_framesSinceHandOff(0),
+	m_wakeEvent(NULL),
+	m_thread(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+ReplayWriter::~ReplayWriter()
+{
+	close();
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::open( FILE *file )
+{
+	close();
+
+	DEBUG_ASSERTCRASH(s_openWriter == NULL, ("Only one replay can be recorded at a time"));
+
+	m_blocks = MSGNEW("ReplayWriter") Block[NUM_BLOCKS];
+	m_firstQueued = 0;
+	m_filling = 0;
+	m_blocks[m_filling].m_size = 0;
+	m_framesSinceHandOff = 0;
+	m_file = file;
+
+	m_wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	m_thread = MSGNEW("ReplayWriter") ReplayWriterThread(this);
+	m_thread->Execute();
+
+	s_openWriter = this;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::close( void )
+{
+	if (m_file == NULL)
+		return;
+
+	flush();
+
+	SetEvent((HANDLE)m_wakeEvent);
+	m_thread->Stop();
+	delete m_thread;
+	m_thread = NULL;
+
+	CloseHandle((HANDLE)m_wakeEvent);
+	m_wakeEvent = NULL;
+
+	delete [] m_blocks;
+	m_blocks = NULL;
+	m_file = NULL;
+
+	if (s_openWriter == this)
+		s_openWriter = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::write( const void *data, Int size )
+{
+	if (m_file == NULL)
+		return;
+
+	const char *p = (const char *)data;
+	while (size > 0)
+	{
+		Block &block = m_blocks[m_filling];
+		Int count = BLOCK_SIZE - block.m_size;
+		if (count > size)
+			count = size;
+
+		memcpy(block.m_data + block.m_size, p, count);
+		block.m_size += count;
+		p += count;
+		size -= count;
+
+		if (block.m_size == BLOCK_SIZE)
+			handOff();
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::endFrame( void )
+{
+	if (m_file == NULL)
+		return;
+
+	if (++m_framesSinceHandOff >= FRAMES_PER_HAND_OFF)
+		handOff();
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::flush( void )
+{
+	if (m_file == NULL)
+		return;
+
+	handOff();
+
+	ScopedCriticalSection lock(&m_fileLock);
+	writeQueued();
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::flushAll( void )
+{
+	if (s_openWriter != NULL)
+		s_openWriter->flush();
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::handOff( void )
+{
+	m_framesSinceHandOff = 0;
+	if (m_blocks[m_filling].m_size == 0)
+		return;
+
+	Int next = (m_filling + 1) % NUM_BLOCKS;
+	if (next == m_firstQueued)
+	{
+		// the writer thread has fallen a whole ring behind. catch up here rather than wait for it.
+		ScopedCriticalSection lock(&m_fileLock);
+		writeQueued();
+	}
+
+	m_blocks[next].m_size = 0;
+	{
+		ScopedCriticalSection lock(&m_queueLock);
+		m_filling = next;
+	}
+
+	SetEvent((HANDLE)m_wakeEvent);
+}
+
+//-------------------------------------------------------------------------------------------------
+void ReplayWriter::writeQueued( void )
+{
+	Bool wroteAny = FALSE;
+	for (;;)
+	{
+		Int index;
+		{
+			ScopedCriticalSection lock(&m_queueLock);
+			if (m_firstQueued == m_filling)
+				break;
+			index = m_firstQueued;
+		}
+
+		fwrite(m_blocks[index].m_data, 1, m_blocks[index].m_size, m_file);
+		wroteAny = TRUE;
+
+		{
+			ScopedCriticalSection lock(&m_queueLock);
+			m_firstQueued = (index + 1) % NUM_BLOCKS;
+		}
+	}
+
+	if (wroteAny)
+		fflush(m_file);
+}
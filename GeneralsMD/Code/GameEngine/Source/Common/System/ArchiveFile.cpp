@@ -89,7 +89,8 @@ ArchiveFile::~ArchiveFile()
 	}
 }
 
-ArchiveFile::ArchiveFile() 
+ArchiveFile::ArchiveFile() :
+	m_file(NULL)
 {
 	m_rootDirectory.clear();
 }
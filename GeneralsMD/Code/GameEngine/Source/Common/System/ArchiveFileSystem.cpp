@@ -49,6 +49,9 @@
 #include "Common/ArchiveFile.h"
 #include "Common/ArchiveFileSystem.h"
 #include "Common/AsciiString.h"
+#include "Common/file.h"
+#include "Common/GlobalData.h"
+#include "Common/LocalFileSystem.h"
 #include "Common/PerfTimer.h"
 
 #ifdef _INTERNAL
@@ -67,6 +70,16 @@
 //         Defines                                                         
 //----------------------------------------------------------------------------
 
+// A BIG file starts with "BIGF", the size of the BIG file (little endian), the number of files
+// and the offset of the end of the directory (both big endian). The directory follows: for each
+// file its offset and size (big endian) and its NUL terminated path.
+static const char BIG_FILE_IDENTIFIER[4] = { 'B', 'I', 'G', 'F' };
+enum { BIG_FILE_HEADER_SIZE = 0x10 };
+
+// Bump this whenever the archive index file layout changes.
+static const UnsignedInt ARCHIVE_INDEX_VERSION = 1;
+static const char ARCHIVE_INDEX_MAGIC[4] = { 'B', 'I', 'G', 'I' };
+
 
 
 //----------------------------------------------------------------------------
@@ -97,6 +110,138 @@ ArchiveFileSystem *TheArchiveFileSystem = NULL;
 //         Private Functions                                               
 //----------------------------------------------------------------------------
 
+//------------------------------------------------------
+static UnsignedInt readBigEndian( const char *p )
+{
+	const UnsignedByte *b = (const UnsignedByte *)p;
+	return (b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+}
+
+//------------------------------------------------------
+/** copy 'size' bytes from p, if there are that many left before 'end'. */
+static Bool readIndexData( const char *&p, const char *end, void *dest, Int size )
+{
+	if (end - p < size)
+		return FALSE;
+	memcpy(dest, p, size);
+	p += size;
+	return TRUE;
+}
+
+//------------------------------------------------------
+/**
+	add the files in a BIG file's directory block to archiveFile. returns the number of
+	bytes the numFiles entries took up, or -1 if the block ends before they do.
+*/
+static Int parseBigFileDirectory( ArchiveFile *archiveFile, const AsciiString& archiveFilename, const char *directory, Int directorySize, Int numFiles )
+{
+	ArchivedFileInfo fileInfo;
+	fileInfo.m_archiveFilename = archiveFilename;
+
+	char path[_MAX_PATH];
+	const char *p = directory;
+	const char *end = directory + directorySize;
+	for (Int i = 0; i < numFiles; ++i)
+	{
+		if (end - p < 8)
+			return -1;
+		fileInfo.m_offset = readBigEndian(p);
+		fileInfo.m_size = readBigEndian(p + 4);
+		p += 8;
+
+		const char *name = p;
+		while (p < end && *p != 0)
+			++p;
+		if (p == end)
+			return -1;
+		Int nameLen = p - name;
+		++p;
+
+		if (nameLen >= _MAX_PATH)
+		{
+			DEBUG_CRASH(("BIG file %s has a path longer than %d characters", archiveFilename.str(), _MAX_PATH));
+			continue;
+		}
+
+		Int filenameIndex = nameLen - 1;
+		while ((filenameIndex >= 0) && (name[filenameIndex] != '\\') && (name[filenameIndex] != '/')) {
+			--filenameIndex;
+		}
+
+		fileInfo.m_filename = name + filenameIndex + 1;
+		fileInfo.m_filename.toLower();
+
+		memcpy(path, name, filenameIndex + 1);
+		path[filenameIndex + 1] = 0;
+
+		archiveFile->addFile(AsciiString(path), &fileInfo);
+	}
+
+	return p - directory;
+}
+
+//------------------------------------------------------
+/**
+	turn a path into the key the path index uses for it: lower case, with the directories
+	separated by single '\\'s. Like the walk down the directory tree, the file is the last
+	path component with a '.' in it, and anything after that is ignored. returns FALSE if
+	there is no such component, or the key doesn't fit in keySize characters.
+*/
+static Bool makeArchivePathKey( const Char *filename, Char *key, Int keySize )
+{
+	const Char *lastDot = strrchr(filename, '.');
+	if (lastDot == NULL)
+		return FALSE;
+	const Char *end = lastDot + strcspn(lastDot, "\\/");
+
+	Int len = 0;
+	for (const Char *p = filename; p < end; ++p)
+	{
+		Char c = *p;
+		if (c == '\\' || c == '/')
+		{
+			if (len == 0 || key[len - 1] == '\\')
+				continue;
+			c = '\\';
+		}
+		else
+		{
+			c = tolower(c);
+		}
+
+		if (len >= keySize - 1)
+			return FALSE;
+		key[len++] = c;
+	}
+
+	key[len] = 0;
+	return TRUE;
+}
+
+//------------------------------------------------------
+typedef std::vector< std::pair<AsciiString, const AsciiString *> > ArchivedPathList;
+
+/** list the full path of every file under dirInfo, with the name of the archive it comes from. */
+static void listArchivedPaths( const ArchivedDirectoryInfo *dirInfo, const AsciiString& prefix, ArchivedPathList& paths )
+{
+	ArchivedDirectoryInfoMap::const_iterator dirIt;
+	for (dirIt = dirInfo->m_directories.begin(); dirIt != dirInfo->m_directories.end(); ++dirIt)
+	{
+		AsciiString dirPrefix = prefix;
+		dirPrefix.concat(dirIt->first);
+		dirPrefix.concat('\\');
+		listArchivedPaths(&dirIt->second, dirPrefix, paths);
+	}
+
+	ArchivedFileLocationMap::const_iterator fileIt;
+	for (fileIt = dirInfo->m_files.begin(); fileIt != dirInfo->m_files.end(); ++fileIt)
+	{
+		AsciiString path = prefix;
+		path.concat(fileIt->first);
+		paths.push_back(std::make_pair(path, &fileIt->second));
+	}
+}
+
 
 
 //----------------------------------------------------------------------------
@@ -106,7 +251,9 @@ ArchiveFileSystem *TheArchiveFileSystem = NULL;
 //------------------------------------------------------
 // ArchivedFileInfo
 //------------------------------------------------------
-ArchiveFileSystem::ArchiveFileSystem() 
+ArchiveFileSystem::ArchiveFileSystem() :
+	m_archiveIndexDirty(FALSE),
+	m_pathIndexBuilt(FALSE)
 {
 }
 
@@ -171,6 +318,190 @@ void ArchiveFileSystem::loadIntoDirectoryTree(const ArchiveFile *archiveFile, co
 	}
 }
 
+Bool ArchiveFileSystem::loadBigFileDirectory(ArchiveFile *archiveFile, File *fp, const Char *filename)
+{
+	AsciiString archiveFilename = filename;
+	archiveFilename.toLower();
+
+	FileInfo fileInfo;
+	Bool haveFileInfo = TheLocalFileSystem->getFileInfo(AsciiString(filename), &fileInfo);
+
+	ArchiveIndexEntry *entry = NULL;
+	if (haveFileInfo && m_archiveIndexFilename.isNotEmpty())
+	{
+		entry = &m_archiveIndex[archiveFilename];
+		if (!entry->m_directory.empty() && memcmp(&entry->m_fileInfo, &fileInfo, sizeof(fileInfo)) == 0)
+		{
+			// the BIG file hasn't changed since we indexed it, so we don't need to read it at all.
+			if (parseBigFileDirectory(archiveFile, archiveFilename, &entry->m_directory[0], entry->m_directory.size(), entry->m_numFiles) >= 0)
+			{
+				entry->m_used = TRUE;
+				return TRUE;
+			}
+		}
+	}
+
+	char header[BIG_FILE_HEADER_SIZE];
+	if (fp->read(header, BIG_FILE_HEADER_SIZE) != BIG_FILE_HEADER_SIZE || memcmp(header, BIG_FILE_IDENTIFIER, sizeof(BIG_FILE_IDENTIFIER)) != 0) {
+		return FALSE;
+	}
+
+	Int numFiles = readBigEndian(header + 8);
+	Int directorySize = (Int)readBigEndian(header + 12) - BIG_FILE_HEADER_SIZE;
+	DEBUG_LOG(("ArchiveFileSystem::loadBigFileDirectory - %d files are contained in archive %s\n", numFiles, filename));
+	if (numFiles <= 0) {
+		return numFiles == 0;
+	}
+
+	// read the whole directory at once. some tools don't write the directory end properly,
+	// so if that's off, guess, and read more until all the entries are in.
+	if (directorySize <= 0 || (haveFileInfo && directorySize > fileInfo.sizeLow))
+		directorySize = numFiles * 64 + 64;
+
+	std::vector<char> directory;
+	Int parsedSize = -1;
+	while (parsedSize < 0)
+	{
+		directory.resize(directorySize);
+		fp->seek(BIG_FILE_HEADER_SIZE, File::START);
+		Int bytesRead = fp->read(&directory[0], directorySize);
+		if (bytesRead <= 0) {
+			return FALSE;
+		}
+
+		parsedSize = parseBigFileDirectory(archiveFile, archiveFilename, &directory[0], bytesRead, numFiles);
+		if (parsedSize < 0 && bytesRead < directorySize) {
+			return FALSE;	// the file ends before the directory does
+		}
+		directorySize *= 2;
+	}
+
+	if (entry != NULL)
+	{
+		entry->m_fileInfo = fileInfo;
+		entry->m_numFiles = numFiles;
+		entry->m_directory.assign(directory.begin(), directory.begin() + parsedSize);
+		entry->m_used = TRUE;
+		m_archiveIndexDirty = TRUE;
+	}
+
+	return TRUE;
+}
+
+void ArchiveFileSystem::loadArchiveIndex( void )
+{
+	m_archiveIndex.clear();
+	m_archiveIndexDirty = FALSE;
+
+	AsciiString userDataDir = GlobalData::findUserDataDir();
+	if (userDataDir.isEmpty()) {
+		m_archiveIndexFilename.clear();
+		return;
+	}
+	m_archiveIndexFilename.format("%sArchiveIndex.dat", userDataDir.str());
+
+	File *file = TheLocalFileSystem->openFile(m_archiveIndexFilename.str(), File::READ | File::BINARY);
+	if (file == NULL)
+		return;
+
+	file = file->convertToRAMFile();
+	Int size = file->size();
+	char *data = file->readEntireAndClose();
+
+	const char *p = data;
+	const char *end = data + size;
+	Bool ok = FALSE;
+
+	char magic[4];
+	UnsignedInt version;
+	Int numEntries;
+	if (readIndexData(p, end, magic, sizeof(magic)) && memcmp(magic, ARCHIVE_INDEX_MAGIC, sizeof(magic)) == 0
+		&& readIndexData(p, end, &version, sizeof(version)) && version == ARCHIVE_INDEX_VERSION
+		&& readIndexData(p, end, &numEntries, sizeof(numEntries)) && numEntries >= 0)
+	{
+		ok = TRUE;
+		for (Int i = 0; i < numEntries && ok; ++i)
+		{
+			Int nameLen, directorySize;
+			char name[_MAX_PATH];
+			ArchiveIndexEntry entry;
+			entry.m_used = FALSE;
+
+			ok = readIndexData(p, end, &nameLen, sizeof(nameLen)) && nameLen > 0 && nameLen < _MAX_PATH
+				&& readIndexData(p, end, name, nameLen)
+				&& readIndexData(p, end, &entry.m_fileInfo, sizeof(entry.m_fileInfo))
+				&& readIndexData(p, end, &entry.m_numFiles, sizeof(entry.m_numFiles)) && entry.m_numFiles >= 0
+				&& readIndexData(p, end, &directorySize, sizeof(directorySize)) && directorySize > 0 && end - p >= directorySize;
+			if (ok)
+			{
+				name[nameLen] = 0;
+				ArchiveIndexEntry &slot = m_archiveIndex[AsciiString(name)];
+				slot = entry;
+				slot.m_directory.assign(p, p + directorySize);
+				p += directorySize;
+			}
+		}
+	}
+
+	delete [] data;
+
+	if (!ok)
+	{
+		DEBUG_LOG(("ArchiveFileSystem - ignoring '%s', it is out of date or damaged\n", m_archiveIndexFilename.str()));
+		m_archiveIndex.clear();
+		m_archiveIndexDirty = TRUE;
+	}
+}
+
+void ArchiveFileSystem::saveArchiveIndex( void )
+{
+	if (m_archiveIndexFilename.isEmpty())
+		return;
+
+	Int numEntries = 0;
+	ArchiveIndexMap::const_iterator it;
+	for (it = m_archiveIndex.begin(); it != m_archiveIndex.end(); ++it)
+	{
+		if (it->second.m_used)
+			++numEntries;
+		else
+			m_archiveIndexDirty = TRUE;		// BIG files that weren't loaded this time are dropped
+	}
+
+	if (!m_archiveIndexDirty)
+		return;
+
+	File *file = TheLocalFileSystem->openFile(m_archiveIndexFilename.str(), File::WRITE | File::CREATE | File::TRUNCATE | File::BINARY);
+	if (file == NULL)
+	{
+		DEBUG_LOG(("ArchiveFileSystem - could not write '%s'\n", m_archiveIndexFilename.str()));
+		return;
+	}
+
+	file->write(ARCHIVE_INDEX_MAGIC, sizeof(ARCHIVE_INDEX_MAGIC));
+	file->write(&ARCHIVE_INDEX_VERSION, sizeof(ARCHIVE_INDEX_VERSION));
+	file->write(&numEntries, sizeof(numEntries));
+
+	for (it = m_archiveIndex.begin(); it != m_archiveIndex.end(); ++it)
+	{
+		const ArchiveIndexEntry &entry = it->second;
+		if (!entry.m_used)
+			continue;
+
+		Int nameLen = it->first.getLength();
+		Int directorySize = entry.m_directory.size();
+		file->write(&nameLen, sizeof(nameLen));
+		file->write(it->first.str(), nameLen);
+		file->write(&entry.m_fileInfo, sizeof(entry.m_fileInfo));
+		file->write(&entry.m_numFiles, sizeof(entry.m_numFiles));
+		file->write(&directorySize, sizeof(directorySize));
+		file->write(&entry.m_directory[0], directorySize);
+	}
+
+	file->close();
+	m_archiveIndexDirty = FALSE;
+}
+
 void ArchiveFileSystem::loadMods() {
 	if (TheGlobalData->m_modBIG.isNotEmpty())
 	{
@@ -196,10 +527,82 @@ void ArchiveFileSystem::loadMods() {
 		loadBigFilesFromDirectory(TheGlobalData->m_modDir, "*.big", TRUE);
 		DEBUG_ASSERTLOG(ret, ("loadBigFilesFromDirectory(%s) returned FALSE!\n", TheGlobalData->m_modDir.str()));
 	}
+
+	// every BIG file the game starts with is in by now. Write the index once, and let the
+	// directory blocks go; anything loaded later is read straight from its BIG file.
+	saveArchiveIndex();
+	m_archiveIndex.clear();
+	m_archiveIndexFilename.clear();
+
+	buildPathIndex();
+}
+
+void ArchiveFileSystem::buildPathIndex( void )
+{
+	ArchivedPathList paths;
+	listArchivedPaths(&m_rootDirectory, AsciiString::TheEmptyString, paths);
+
+	// the keys point into m_pathIndexText, so size it once, before any of them go in.
+	Int textSize = 0;
+	ArchivedPathList::const_iterator it;
+	for (it = paths.begin(); it != paths.end(); ++it)
+	{
+		textSize += it->first.getLength() + 1;
+	}
+
+	m_pathIndex.clear();
+	m_pathIndexText.clear();
+	m_pathIndexText.resize(textSize);
+
+	Int pos = 0;
+	for (it = paths.begin(); it != paths.end(); ++it)
+	{
+		ArchiveFileMap::iterator archiveIt = m_archiveFileMap.find(*it->second);
+		if (archiveIt == m_archiveFileMap.end() || archiveIt->second == NULL)
+			continue;	// the archive has been closed
+
+		ArchivedFileLocation location;
+		location.m_archiveFile = archiveIt->second;
+		location.m_fileInfo = location.m_archiveFile->getArchivedFileInfo(it->first);
+		location.m_archiveFilename = &archiveIt->first;
+		if (location.m_fileInfo == NULL)
+			continue;
+
+		char *key = &m_pathIndexText[pos];
+		memcpy(key, it->first.str(), it->first.getLength() + 1);
+		pos += it->first.getLength() + 1;
+
+		m_pathIndex[key] = location;
+	}
+
+	m_pathIndexBuilt = TRUE;
+	DEBUG_LOG(("ArchiveFileSystem::buildPathIndex - %d archived files indexed\n", (Int)m_pathIndex.size()));
+}
+
+void ArchiveFileSystem::updatePathIndex( void )
+{
+	if (m_pathIndexBuilt)
+		buildPathIndex();
+}
+
+const ArchivedFileLocation * ArchiveFileSystem::findArchivedFile(const Char *filename) const
+{
+	Char key[_MAX_PATH];
+	if (!m_pathIndexBuilt || filename == NULL || !makeArchivePathKey(filename, key, _MAX_PATH))
+		return NULL;
+
+	ArchivedFilePathIndex::const_iterator it = m_pathIndex.find(key);
+	if (it == m_pathIndex.end())
+		return NULL;
+
+	return &it->second;
 }
 
 Bool ArchiveFileSystem::doesFileExist(const Char *filename) const
 {
+	if (m_pathIndexBuilt)
+		return findArchivedFile(filename) != NULL;
+
 	AsciiString path = filename;
 	path.toLower();
 	AsciiString token;
@@ -232,6 +635,15 @@ Bool ArchiveFileSystem::doesFileExist(const Char *filename) const
 
 File * ArchiveFileSystem::openFile(const Char *filename, Int access /* = 0 */) 
 {
+	if (m_pathIndexBuilt)
+	{
+		const ArchivedFileLocation *location = findArchivedFile(filename);
+		if (location == NULL) {
+			return NULL;
+		}
+		return location->m_archiveFile->openArchivedFile(location->m_fileInfo, filename, access);
+	}
+
 	AsciiString archiveFilename;
 	archiveFilename = getArchiveFilenameForFile(AsciiString(filename));
 
@@ -252,6 +664,15 @@ Bool ArchiveFileSystem::getFileInfo(const AsciiString& filename, FileInfo *fileI
 		return FALSE;
 	}
 
+	if (m_pathIndexBuilt)
+	{
+		const ArchivedFileLocation *location = findArchivedFile(filename.str());
+		if (location == NULL) {
+			return FALSE;
+		}
+		return location->m_archiveFile->getFileInfo(filename, fileInfo);
+	}
+
 	AsciiString archiveFilename = getArchiveFilenameForFile(filename);
 	ArchiveFileMap::const_iterator it = m_archiveFileMap.find(archiveFilename);
 	if (it != m_archiveFileMap.end())
@@ -266,6 +687,15 @@ Bool ArchiveFileSystem::getFileInfo(const AsciiString& filename, FileInfo *fileI
 
 AsciiString ArchiveFileSystem::getArchiveFilenameForFile(const AsciiString& filename) const
 {
+	if (m_pathIndexBuilt)
+	{
+		const ArchivedFileLocation *location = findArchivedFile(filename.str());
+		if (location == NULL) {
+			return AsciiString::TheEmptyString;
+		}
+		return *location->m_archiveFilename;
+	}
+
 	AsciiString path;
 	path = filename;
 	path.toLower();
@@ -60,6 +60,7 @@
 #endif
 #include "Common/Debug.h"
 #include "Common/CRCDebug.h"
+#include "Common/ReplayWriter.h"
 #include "Common/SystemInfo.h"
 #include "Common/UnicodeString.h"
 #include "GameClient/GameText.h"
@@ -672,6 +673,9 @@ void ReleaseCrash(const char *reason)
 {
 	/// do additional reporting on the crash, if possible
 
+	// get the replay of the game we crashed in onto disk, all of it.
+	ReplayWriter::flushAll();
+
 	if (!DX8Wrapper_IsWindowed) {
 		if (ApplicationHWnd) {
 			ShowWindow(ApplicationHWnd, SW_HIDE);
@@ -757,6 +761,8 @@ void ReleaseCrashLocalized(const AsciiString& p, const AsciiString& m)
 
 	/// do additional reporting on the crash, if possible
 
+	ReplayWriter::flushAll();
+
 	if (!DX8Wrapper_IsWindowed) {
 		if (ApplicationHWnd) {
 			ShowWindow(ApplicationHWnd, SW_HIDE);
@@ -51,10 +51,14 @@
 #include "Common/CriticalSection.h"
 #include "Common/Errors.h"
 #include "Common/GlobalData.h"
+#include "Common/MemoryPoolBenchmark.h"
 #include "Common/PerfTimer.h"
 #ifdef MEMORYPOOL_DEBUG
 #include "GameClient/ClientRandomValue.h"
 #endif
+#ifdef MEMORYPOOL_MAGAZINES
+	#include "thread.h"
+#endif
 #ifdef MEMORYPOOL_STACKTRACE
 	#include "Common/StackDump.h"
 #endif
@@ -152,6 +156,17 @@ DECLARE_PERF_TIMER(MemoryPoolInitFilling)
 
 #endif
 
+#ifdef MEMORYPOOL_MAGAZINES
+
+	enum
+	{
+		MAX_MEMORYPOOL_MAGAZINES = 1024,		///< pools created after this many get no magazines, and always take the lock
+		MAX_MAGAZINE_BLOCKS = 16,						///< max number of free blocks in one magazine
+		MAX_MAGAZINE_BYTES = 4096						///< magazines of big blocks hold fewer of them, so idle threads don't sit on much memory
+	};
+
+#endif
+
 // ----------------------------------------------------------------------------
 // PRIVATE DATA 
 // ----------------------------------------------------------------------------
@@ -195,6 +210,34 @@ DECLARE_PERF_TIMER(MemoryPoolInitFilling)
 #endif
 
 
+#endif
+
+#ifdef MEMORYPOOL_MAGAZINES
+
+	struct MemoryPoolMagazineSet;
+
+	static MemoryPoolMagazineSet *theMagazineSets = NULL;		///< the magazine sets of all threads; guarded by TheMemoryPoolCriticalSection
+	static Int theNextMagazineSlot = 0;
+
+	/// the calling thread's magazines, one per pool. created when the thread first uses a pool.
+	__declspec( thread ) static MemoryPoolMagazineSet *theThreadMagazineSet = NULL;
+
+	/// set on threads that always take the lock, because nothing would flush their magazines when they exit.
+	__declspec( thread ) static Bool theThreadHasNoMagazines = FALSE;
+
+	/// the thread that inited the memory manager. the pools flush its magazines when they go away.
+	static DWORD theMainThreadID = 0;
+
+#endif
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+	enum { MEMORY_TRACE_BUFFER_EVENTS = 65536 };
+
+	static FILE *theMemoryTraceFile = NULL;									///< the file we're recording to, if any; guarded by TheMemoryPoolCriticalSection
+	static MemoryTraceEvent *theMemoryTraceBuffer = NULL;		///< events not written yet
+	static Int theMemoryTraceCount = 0;											///< number of events in theMemoryTraceBuffer
+
 #endif
 
 static Bool thePreMainInitFlag = false;
@@ -216,6 +259,9 @@ static void doStackDumpOutput(const char* m);
 static void doStackDump(void **stacktrace, int size);
 #endif
 static void preMainInitMemoryManager();
+#ifdef MEMORYPOOL_MAGAZINES
+static void releaseThreadMagazines();
+#endif
 
 // ----------------------------------------------------------------------------
 // PRIVATE FUNCTIONS 
@@ -228,6 +274,32 @@ static Int roundUpMemBound(Int i)
 	return (i + (MEM_BOUND_ALIGNMENT-1)) & ~(MEM_BOUND_ALIGNMENT-1);
 }
 
+//-----------------------------------------------------------------------------
+/** if a memory trace is being recorded, add an event to it. (see MemoryPoolBenchmark.h) */
+inline static void traceMemoryEvent(MemoryPool *pool, void *block, Int op, Int bytes)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (theMemoryTraceFile == NULL)
+		return;
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	if (theMemoryTraceFile == NULL)
+		return;
+
+	MemoryTraceEvent &event = theMemoryTraceBuffer[theMemoryTraceCount++];
+	event.m_pool = (UnsignedInt)pool;
+	event.m_blockAndOp = (UnsignedInt)block | op;
+	event.m_bytes = bytes;
+
+	if (theMemoryTraceCount == MEMORY_TRACE_BUFFER_EVENTS)
+	{
+		fwrite(theMemoryTraceBuffer, sizeof(MemoryTraceEvent), theMemoryTraceCount, theMemoryTraceFile);
+		theMemoryTraceCount = 0;
+	}
+#endif
+}
+
 //-----------------------------------------------------------------------------
 /** 
 	this is the low-level allocator that we use to request memory from the OS.
@@ -474,6 +546,8 @@ private:
 	MemoryPool							*m_owningPool;				///< the pool that owns this blob
 	MemoryPoolBlob					*m_nextBlob;					///< next blob in this pool
 	MemoryPoolBlob					*m_prevBlob;					///< prev blob in this pool
+	MemoryPoolBlob					*m_nextFreeBlob;			///< next blob in this pool that has free blocks (valid only if this one has any)
+	MemoryPoolBlob					*m_prevFreeBlob;			///< prev blob in this pool that has free blocks (valid only if this one has any)
 	MemoryPoolSingleBlock		*m_firstFreeBlock;		///< ptr to first available block in this blob
 	Int											m_usedBlocksInBlob;		///< total allocated blocks in this blob
 	Int											m_totalBlocksInBlob;	///< total blocks in this blob (allocated + available)
@@ -488,7 +562,10 @@ public:
 
 	void addBlobToList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
 	void removeBlobFromList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
+	void addBlobToFreeList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
+	void removeBlobFromFreeList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
 	MemoryPoolBlob *getNextInList();
+	MemoryPoolBlob *getNextInFreeList();
 	Bool hasAnyFreeBlocks();
 
 	MemoryPoolSingleBlock *allocateSingleBlock(DECLARE_LITERALSTRING_ARG1);
@@ -510,6 +587,32 @@ public:
 
 };
 
+#ifdef MEMORYPOOL_MAGAZINES
+// ----------------------------------------------------------------------------
+/**
+	A stack of free blocks of one pool, owned by one thread. Only the owning thread touches it
+	(except in MemoryPool::flushMagazines, when the pool is idle), so it needs no locking.
+	As far as the blobs know, the blocks in a magazine are allocated, so they count toward
+	m_usedBlocksInPool, but not toward m_peakUsedBlocksInPool (see m_blocksInMagazines).
+*/
+struct MemoryPoolMagazine
+{
+	Int											m_count;												///< number of blocks in m_blocks
+	Int											m_countWhenLocked;							///< m_count as of the last refill or drain, as counted in the pool's m_blocksInMagazines
+	MemoryPoolSingleBlock		*m_blocks[MAX_MAGAZINE_BLOCKS];	///< the free blocks; the most recently freed one is on top
+};
+
+// ----------------------------------------------------------------------------
+/**
+	The magazines of one thread, indexed by MemoryPool::m_magazineSlot.
+*/
+struct MemoryPoolMagazineSet
+{
+	MemoryPoolMagazineSet		*m_next;																		///< next set in theMagazineSets
+	MemoryPoolMagazine			*m_magazines[MAX_MEMORYPOOL_MAGAZINES];			///< created as needed
+};
+#endif
+
 // ----------------------------------------------------------------------------
 // PUBLIC DATA 
 // ----------------------------------------------------------------------------
@@ -712,6 +815,8 @@ inline void MemoryPoolSingleBlock::debugResetCheckpoint()
 /// accessor
 inline MemoryPoolBlob *MemoryPoolBlob::getNextInList() { return m_nextBlob; }
 /// accessor
+inline MemoryPoolBlob *MemoryPoolBlob::getNextInFreeList() { return m_nextFreeBlob; }
+/// accessor
 inline Bool MemoryPoolBlob::hasAnyFreeBlocks() { return m_firstFreeBlock != NULL; }
 /// accessor
 inline MemoryPool *MemoryPoolBlob::getOwningPool() { return m_owningPool; }
@@ -1157,6 +1262,8 @@ MemoryPoolBlob::MemoryPoolBlob() :
 	m_owningPool(NULL),
 	m_nextBlob(NULL),
 	m_prevBlob(NULL),
+	m_nextFreeBlob(NULL),
+	m_prevFreeBlob(NULL),
 	m_firstFreeBlock(NULL),
 	m_usedBlocksInBlob(0),
 	m_totalBlocksInBlob(0),
@@ -1248,6 +1355,44 @@ void MemoryPoolBlob::removeBlobFromList(MemoryPoolBlob **ppHead, MemoryPoolBlob
 		this->m_nextBlob->m_prevBlob = this->m_prevBlob;
 }
 
+//-----------------------------------------------------------------------------
+/**
+	add this blob to the end of a given pool's list of blobs with free blocks
+*/
+void MemoryPoolBlob::addBlobToFreeList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail)
+{
+	m_prevFreeBlob = *ppTail;
+	m_nextFreeBlob =  NULL;
+
+	if (*ppTail != NULL)
+		(*ppTail)->m_nextFreeBlob = this;
+
+	if (*ppHead == NULL)
+		*ppHead = this;
+
+	*ppTail = this;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	remove this blob from a given pool's list of blobs with free blocks
+*/
+void MemoryPoolBlob::removeBlobFromFreeList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail)
+{
+	if (*ppHead == this)
+		*ppHead = this->m_nextFreeBlob;
+	else
+		this->m_prevFreeBlob->m_nextFreeBlob = this->m_nextFreeBlob;
+		
+	if (*ppTail == this)
+		*ppTail = this->m_prevFreeBlob;
+	else
+		this->m_nextFreeBlob->m_prevFreeBlob = this->m_prevFreeBlob;
+
+	m_nextFreeBlob = NULL;
+	m_prevFreeBlob = NULL;
+}
+
 //-----------------------------------------------------------------------------
 /**
 	grab a free block from this blob, mark it as taken, and return it.
@@ -1509,7 +1654,18 @@ MemoryPool::MemoryPool() :
 	m_peakUsedBlocksInPool(0),
 	m_firstBlob(NULL),
 	m_lastBlob(NULL),
-	m_firstBlobWithFreeBlocks(NULL)
+	m_firstBlobWithFreeBlocks(NULL),
+	m_lastBlobWithFreeBlocks(NULL),
+	m_overflowBlobsCreated(0),
+	m_emptyBlobsReleased(0)
+#ifdef MEMORYPOOL_MAGAZINES
+	,
+	m_magazineSlot(-1),
+	m_magazineCapacity(0),
+	m_magazineRefills(0),
+	m_magazineDrains(0),
+	m_blocksInMagazines(0)
+#endif
 {
 }
 
@@ -1531,6 +1687,23 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 	m_firstBlob = NULL;
 	m_lastBlob = NULL;
 	m_firstBlobWithFreeBlocks = NULL;
+	m_lastBlobWithFreeBlocks = NULL;
+
+#ifdef MEMORYPOOL_MAGAZINES
+	// pools that can't grow don't get magazines: other threads could be sitting on their last blocks.
+	// (reset() calls us again, so keep the slot we already have.)
+	if (m_magazineSlot < 0 && m_overflowAllocationCount > 0)
+	{
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		if (theNextMagazineSlot < MAX_MEMORYPOOL_MAGAZINES)
+			m_magazineSlot = theNextMagazineSlot++;
+	}
+	m_magazineCapacity = MAX_MAGAZINE_BYTES / m_allocationSize;
+	if (m_magazineCapacity > MAX_MAGAZINE_BLOCKS)
+		m_magazineCapacity = MAX_MAGAZINE_BLOCKS;
+	if (m_magazineCapacity < 2)
+		m_magazineCapacity = 2;
+#endif
 
 	// go ahead and init the initial block here (will throw on failure)
 	createBlob(m_initialAllocationCount);
@@ -1567,7 +1740,7 @@ MemoryPoolBlob* MemoryPool::createBlob(Int allocationCount)
 	blob->addBlobToList(&m_firstBlob, &m_lastBlob);
 
 	DEBUG_ASSERTCRASH(m_firstBlobWithFreeBlocks == NULL, ("DO NOT IGNORE. Please call John McD - x36872 (m_firstBlobWithFreeBlocks != NULL)"));
-	m_firstBlobWithFreeBlocks = blob;
+	blob->addBlobToFreeList(&m_firstBlobWithFreeBlocks, &m_lastBlobWithFreeBlocks);
 
 	// bookkeeping
 	m_totalBlocksInPool += allocationCount;
@@ -1600,10 +1773,9 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 	// de-link it from our list
 	blob->removeBlobFromList(&m_firstBlob, &m_lastBlob);
 	
-	// ensure that the 'first free' blob is still a valid blob. 
-	// (doesn't need to actually have free blocks, just be a valid blob) 
-	if (m_firstBlobWithFreeBlocks == blob)
-		m_firstBlobWithFreeBlocks = m_firstBlob;
+	// and from the list of blobs with free blocks, if it has any.
+	if (blob->hasAnyFreeBlocks())
+		blob->removeBlobFromFreeList(&m_firstBlobWithFreeBlocks, &m_lastBlobWithFreeBlocks);
 
 	// this is evil... since there is no 'placement delete' we must do this the hard way
 	// and call the dtor directly. ordinarily this is heinous, but in this case we'll
@@ -1624,31 +1796,271 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 
 //-----------------------------------------------------------------------------
 /**
-	allocate a block from this pool and return it, but don't bother zeroing
-	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
-	function will never return null.
+	take a block from the first blob with free blocks. the caller has made sure there is one.
+	a blob that becomes full leaves the free list, so the next allocation never has to
+	look for free space, however many full blobs the pool has.
 */
-void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+MemoryPoolSingleBlock* MemoryPool::takeBlockFromFreeBlob(DECLARE_LITERALSTRING_ARG1)
+{
+	MemoryPoolBlob *blob = m_firstBlobWithFreeBlocks;
+
+	DEBUG_ASSERTCRASH(blob, ("no blob with free blocks available in MemoryPool::allocate"));
+		
+	MemoryPoolSingleBlock *block = blob->allocateSingleBlock(PASS_LITERALSTRING_ARG1);
+	DEBUG_ASSERTCRASH(block, ("should not fail here"));
+
+	if (!blob->hasAnyFreeBlocks())
+		blob->removeBlobFromFreeList(&m_firstBlobWithFreeBlocks, &m_lastBlobWithFreeBlocks);
+
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give a block back to its blob. a blob that was full goes back on the end of the
+	free list, so that we keep using up the blob at the head first.
+*/
+void MemoryPool::returnBlockToBlob(MemoryPoolSingleBlock *block)
+{
+	MemoryPoolBlob *blob = block->getOwningBlob();
+	Bool wasFull = !blob->hasAnyFreeBlocks();
+
+	blob->freeSingleBlock(block);
+
+	if (wasFull)
+		blob->addBlobToFreeList(&m_firstBlobWithFreeBlocks, &m_lastBlobWithFreeBlocks);
+}
+
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/**
+	return the calling thread's magazine for this pool, or null if the pool has no magazines.
+*/
+inline MemoryPoolMagazine *MemoryPool::getThreadMagazine()
+{
+	if (m_magazineSlot < 0)
+		return NULL;
+
+	MemoryPoolMagazineSet *set = theThreadMagazineSet;
+	if (set && set->m_magazines[m_magazineSlot])
+		return set->m_magazines[m_magazineSlot];
+
+	if (theThreadHasNoMagazines)
+		return NULL;
+
+	return createThreadMagazine();	// first time this thread uses this pool
+}
+
+//-----------------------------------------------------------------------------
+/**
+	create the calling thread's magazine for this pool (and the thread's magazine set, if
+	this is the first pool it uses). the set is added to theMagazineSets, so that
+	flushMagazines() can find it. only the main thread and ThreadClass threads get magazines;
+	other threads (Miles callbacks, threads made with CreateThread) have no exit hook to
+	give their blocks back, so they get null, and always take the lock.
+*/
+MemoryPoolMagazine *MemoryPool::createThreadMagazine()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
-	if (m_firstBlobWithFreeBlocks != NULL && !m_firstBlobWithFreeBlocks->hasAnyFreeBlocks()) 
+	MemoryPoolMagazineSet *set = theThreadMagazineSet;
+	if (set == NULL)
 	{
-		// hmm... the current 'free' blob has nothing available. look and see if there
-		// are any other existing blobs with freespace.
-		MemoryPoolBlob *blob = m_firstBlob;
-		for (; blob != NULL; blob = blob->getNextInList()) 
+		if (GetCurrentThreadId() != theMainThreadID && !ThreadClass::Is_ThreadClass_Thread())
 		{
-			if (blob->hasAnyFreeBlocks())
-			 	break;
+			theThreadHasNoMagazines = TRUE;
+			return NULL;
 		}
 
-		// note that if we walk thru the list without finding anything, this will 
-		// reset m_firstBlobWithFreeBlocks to null and fall thru.
-	 	m_firstBlobWithFreeBlocks = blob;
+		set = (MemoryPoolMagazineSet *)::sysAllocateDoNotZero(sizeof(MemoryPoolMagazineSet));	// will throw on failure
+		memset(set, 0, sizeof(MemoryPoolMagazineSet));
+		set->m_next = theMagazineSets;
+		theMagazineSets = set;
+		theThreadMagazineSet = set;
+
+		// worker threads come and go (INILexThreads are started for every directory of inis),
+		// so each gives its set back as it exits.
+		ThreadClass::Set_Exit_Hook(releaseThreadMagazines);
 	}
-	
-	// OK, if we are here then we have no blobs with freespace... darn.
+
+	MemoryPoolMagazine *magazine = (MemoryPoolMagazine *)::sysAllocateDoNotZero(sizeof(MemoryPoolMagazine));	// will throw on failure
+	magazine->m_count = 0;
+	magazine->m_countWhenLocked = 0;
+	set->m_magazines[m_magazineSlot] = magazine;
+	return magazine;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	take half a magazine's worth of blocks out of the blobs, in one go under the lock.
+	the pool only grows if it has no free blocks at all, never just to top up a magazine.
+	if unable to get even one block, throw ERROR_OUT_OF_MEMORY.
+*/
+void MemoryPool::refillMagazine(MemoryPoolMagazine *magazine)
+{
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	DEBUG_ASSERTCRASH(magazine->m_count == 0, ("refilling a magazine that isn't empty"));
+	++m_magazineRefills;
+
+	// everything in the magazine since the last time has been handed out
+	m_blocksInMagazines -= magazine->m_countWhenLocked;
+
+	Int refillCount = m_magazineCapacity / 2;
+	while (magazine->m_count < refillCount)
+	{
+		if (m_firstBlobWithFreeBlocks == NULL)
+		{
+			if (magazine->m_count > 0)
+				break;
+			// m_overflowAllocationCount is never 0 here; such pools have no magazines.
+			createBlob(m_overflowAllocationCount); // throws on failure
+			++m_overflowBlobsCreated;
+		}
+
+		magazine->m_blocks[magazine->m_count++] = takeBlockFromFreeBlob();
+		++m_usedBlocksInPool;
+	}
+
+	m_blocksInMagazines += magazine->m_count;
+	magazine->m_countWhenLocked = magazine->m_count;
+
+	// the blocks sitting in magazines aren't in use. (other threads' magazines are only counted
+	// as of their last refill or drain, so this can come out a bit low, never high.)
+	if (m_peakUsedBlocksInPool < m_usedBlocksInPool - m_blocksInMagazines)
+		m_peakUsedBlocksInPool = m_usedBlocksInPool - m_blocksInMagazines;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give blocks from the magazine back to their blobs, in one go under the lock, until
+	only 'keep' blocks are left. the oldest blocks go back first; the ones that were freed 
+	most recently are the likeliest to still be in the cache, so they stay.
+*/
+void MemoryPool::drainMagazine(MemoryPoolMagazine *magazine, Int keep)
+{
+	Int drainCount = magazine->m_count - keep;
+	if (drainCount <= 0)
+		return;
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	++m_magazineDrains;
+
+	Int i;
+	for (i = 0; i < drainCount; ++i)
+	{
+		returnBlockToBlob(magazine->m_blocks[i]);
+	}
+	for (i = 0; i < keep; ++i)
+	{
+		magazine->m_blocks[i] = magazine->m_blocks[i + drainCount];
+	}
+	magazine->m_count = keep;
+
+	// bookkeeping
+	m_usedBlocksInPool -= drainCount;
+	m_blocksInMagazines += keep - magazine->m_countWhenLocked;
+	magazine->m_countWhenLocked = keep;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give the blocks in all threads' magazines back to this pool. the other threads must not
+	be using this pool while we do this; it's meant for reset() and for destroying the pool.
+*/
+void MemoryPool::flushMagazines()
+{
+	if (m_magazineSlot < 0)
+		return;
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	for (MemoryPoolMagazineSet *set = theMagazineSets; set; set = set->m_next)
+	{
+		if (set->m_magazines[m_magazineSlot])
+			drainMagazine(set->m_magazines[m_magazineSlot], 0);
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give the blocks in the calling thread's magazine back to this pool.
+*/
+void MemoryPool::flushThreadMagazine()
+{
+	if (m_magazineSlot >= 0 && theThreadMagazineSet && theThreadMagazineSet->m_magazines[m_magazineSlot])
+		drainMagazine(theThreadMagazineSet->m_magazines[m_magazineSlot], 0);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	free a magazine set and its magazines. they must already be empty, and the set must
+	no longer be in theMagazineSets.
+*/
+static void freeMagazineSet(MemoryPoolMagazineSet *set)
+{
+	for (Int i = 0; i < MAX_MEMORYPOOL_MAGAZINES; ++i)
+	{
+		if (set->m_magazines[i])
+			::sysFree((void *)set->m_magazines[i]);
+	}
+	::sysFree((void *)set);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give the blocks in the calling thread's magazines back to their pools, then take the
+	thread's magazine set out of theMagazineSets and free it. ThreadClass calls this on
+	each thread as it exits. (if the thread uses a pool again, it just gets a new set.)
+*/
+static void releaseThreadMagazines()
+{
+	MemoryPoolMagazineSet *set = theThreadMagazineSet;
+	if (set == NULL)
+		return;
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	if (TheMemoryPoolFactory)
+		TheMemoryPoolFactory->flushThreadMagazines();
+
+	for (MemoryPoolMagazineSet **link = &theMagazineSets; *link; link = &(*link)->m_next)
+	{
+		if (*link == set)
+		{
+			*link = set->m_next;
+			break;
+		}
+	}
+	theThreadMagazineSet = NULL;
+	freeMagazineSet(set);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+/**
+	allocate a block from this pool and return it, but don't bother zeroing
+	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
+	function will never return null.
+*/
+void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *magazine = getThreadMagazine();
+	if (magazine)
+	{
+		if (magazine->m_count == 0)
+			refillMagazine(magazine);	// throws on failure
+		void *magazineResult = magazine->m_blocks[--magazine->m_count]->getUserData();
+		traceMemoryEvent(this, magazineResult, MEMORY_TRACE_ALLOC, 0);
+		return magazineResult;
+	}
+#endif
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	// if we have no blobs with freespace... darn.
 	// allocate an overflow block.
 	if (m_firstBlobWithFreeBlocks == NULL) 
 	{
@@ -1659,15 +2071,11 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 		else 
 		{
 			createBlob(m_overflowAllocationCount); // throws on failure
+			++m_overflowBlobsCreated;
 		}
 	}
 	
-	MemoryPoolBlob *blob = m_firstBlobWithFreeBlocks;
-
-	DEBUG_ASSERTCRASH(blob, ("no blob with free blocks available in MemoryPool::allocate"));
-		
-	MemoryPoolSingleBlock *block = blob->allocateSingleBlock(PASS_LITERALSTRING_ARG1);
-	DEBUG_ASSERTCRASH(block, ("should not fail here"));
+	MemoryPoolSingleBlock *block = takeBlockFromFreeBlob(PASS_LITERALSTRING_ARG1);
 
 #ifdef MEMORYPOOL_CHECKPOINTING
 	BlockCheckpointInfo *bi = debugAddCheckpointInfo(block->debugGetLiteralTagString(), m_factory->getCurCheckpoint(), getAllocationSize());
@@ -1690,6 +2098,8 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 	#endif
 #endif
 
+	traceMemoryEvent(this, block->getUserData(), MEMORY_TRACE_ALLOC, 0);
+
 	return block->getUserData();
 }
 
@@ -1715,6 +2125,21 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;	// my, that was easy
 
+	traceMemoryEvent(this, pBlockPtr, MEMORY_TRACE_FREE, 0);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *magazine = getThreadMagazine();
+	if (magazine)
+	{
+		MemoryPoolSingleBlock *magazineBlock = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+		DEBUG_ASSERTCRASH(magazineBlock->getOwningBlob() && magazineBlock->getOwningBlob()->getOwningPool() == this, ("block does not belong to this pool"));
+		if (magazine->m_count == m_magazineCapacity)
+			drainMagazine(magazine, m_magazineCapacity / 2);
+		magazine->m_blocks[magazine->m_count++] = magazineBlock;
+		return;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
 	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
@@ -1732,7 +2157,7 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 		bi->debugSetFreepoint(m_factory->getCurCheckpoint());
 #endif
 
-	blob->freeSingleBlock(block);
+	returnBlockToBlob(block);
 	
 	// if we want to free the blobs as they become empty, do that here.
 	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
@@ -1742,9 +2167,6 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 	//	freeBlob(blob);
 	//	return;
 	//} 
-	
-	if (!m_firstBlobWithFreeBlocks)
-		m_firstBlobWithFreeBlocks = blob;
 
 	// bookkeeping
 	--m_usedBlocksInPool;
@@ -1776,13 +2198,21 @@ Int MemoryPool::releaseEmpties()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// other threads may be using their magazines right now, so we can only empty our own.
+	flushThreadMagazine();
+#endif
+
 	Int released = 0;
 
 	for (MemoryPoolBlob* blob = m_firstBlob; blob;) 
 	{
 		MemoryPoolBlob* pNext = blob->getNextInList();
 		if (blob->getUsedBlockCount() == 0) 
+		{
 			released += freeBlob(blob);
+			++m_emptyBlobsReleased;
+		}
 		blob = pNext;
 	}
 	return released;
@@ -1797,6 +2227,11 @@ void MemoryPool::reset()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// the blocks in the magazines are about to go away with their blobs.
+	flushMagazines();
+#endif
+
 	// toss everything. we could do this slightly more efficiently,
 	// but not really worth the extra code to do so.
 	while (m_firstBlob) 
@@ -1806,6 +2241,7 @@ void MemoryPool::reset()
 	m_firstBlob = NULL;
 	m_lastBlob = NULL;
 	m_firstBlobWithFreeBlocks = NULL;
+	m_lastBlobWithFreeBlocks = NULL;
 
 	init(m_factory, m_poolName, m_allocationSize, m_initialAllocationCount, m_overflowAllocationCount);	// will throw on failure
 
@@ -1907,14 +2343,26 @@ void MemoryPool::debugMemoryVerifyPool()
 
 	Int used = 0;
 	Int total = 0;
-	for (MemoryPoolBlob* blob = m_firstBlob; blob; blob = blob->getNextInList()) 
+	Int withFree = 0;
+	MemoryPoolBlob* blob;
+	for (blob = m_firstBlob; blob; blob = blob->getNextInList()) 
 	{
 		blob->debugMemoryVerifyBlob();
 		used += blob->getUsedBlockCount();
 		total += blob->getTotalBlockCount();
+		if (blob->hasAnyFreeBlocks())
+			++withFree;
 	}
 	DEBUG_ASSERTCRASH(m_usedBlocksInPool == used, ("used mismatch %d %d",m_usedBlocksInPool,used));
 	DEBUG_ASSERTCRASH(m_totalBlocksInPool == total, ("total mismatch %d %d",m_totalBlocksInPool,total));
+
+	Int inFreeList = 0;
+	for (blob = m_firstBlobWithFreeBlocks; blob; blob = blob->getNextInFreeList()) 
+	{
+		DEBUG_ASSERTCRASH(blob->hasAnyFreeBlocks(), ("full blob in the free list"));
+		++inFreeList;
+	}
+	DEBUG_ASSERTCRASH(withFree == inFreeList, ("free list mismatch %d %d",withFree,inFreeList));
 }
 #endif
 
@@ -2008,7 +2456,9 @@ DynamicMemoryAllocator::DynamicMemoryAllocator() :
 	m_nextDmaInFactory(NULL),
 	m_numPools(0),
 	m_usedBlocksInDma(0),
-	m_rawBlocks(NULL)
+	m_rawBlocks(NULL),
+	m_numSizeClasses(0),
+	m_sizeClassPools(NULL)
 {
 	for (Int i = 0; i < MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS; i++)
 		m_pools[i] = 0;
@@ -2049,6 +2499,21 @@ void DynamicMemoryAllocator::init(MemoryPoolFactory *factory, Int numSubPools, c
 		DEBUG_ASSERTCRASH(i == 0 || pParms[i].allocationSize > pParms[i-1].allocationSize, ("alloc size must increase monotonically for DMA"));
 		m_pools[i] = m_factory->createMemoryPool(&pParms[i]);
 	}
+
+	// build the size class table: one entry per MEM_BOUND_ALIGNMENT bytes, up to the biggest subpool,
+	// holding the smallest subpool that fits that many bytes.
+	if (m_numPools > 0)
+	{
+		m_numSizeClasses = m_pools[m_numPools - 1]->getAllocationSize() / MEM_BOUND_ALIGNMENT + 1;
+		m_sizeClassPools = (MemoryPool **)::sysAllocateDoNotZero(m_numSizeClasses * sizeof(MemoryPool *));	// will throw on failure
+		Int pool = 0;
+		for (Int sizeClass = 0; sizeClass < m_numSizeClasses; ++sizeClass)
+		{
+			while (m_pools[pool]->getAllocationSize() < sizeClass * MEM_BOUND_ALIGNMENT)
+				++pool;
+			m_sizeClassPools[sizeClass] = m_pools[pool];
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -2070,6 +2535,10 @@ DynamicMemoryAllocator::~DynamicMemoryAllocator()
 	{
 		freeBytes(m_rawBlocks->getUserData());
 	}
+
+	::sysFree((void *)m_sizeClassPools);
+	m_sizeClassPools = NULL;
+	m_numSizeClasses = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -2079,12 +2548,10 @@ DynamicMemoryAllocator::~DynamicMemoryAllocator()
 */
 MemoryPool *DynamicMemoryAllocator::findPoolForSize(Int allocSize)
 {
-	for (Int i = 0; i < m_numPools; i++)
-	{
-		DEBUG_ASSERTCRASH(m_pools[i], ("null pool"));
-		if (allocSize <= m_pools[i]->getAllocationSize())
-			return m_pools[i];
-	}
+	// subpool sizes are multiples of MEM_BOUND_ALIGNMENT, so every size in a size class fits the same subpool.
+	Int sizeClass = (allocSize + (MEM_BOUND_ALIGNMENT-1)) / MEM_BOUND_ALIGNMENT;
+	if (sizeClass >= 0 && sizeClass < m_numSizeClasses)
+		return m_sizeClassPools[sizeClass];
 	return NULL;
 }
 
@@ -2163,6 +2630,18 @@ void DynamicMemoryAllocator::debugIgnoreLeaksForThisBlock(void* pBlockPtr)
 */
 void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes DECLARE_LITERALSTRING_ARG2)
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	// subpool blocks come out of the calling thread's magazines; only the raw blocks need our lock.
+	MemoryPool *magazinePool = findPoolForSize(numBytes);
+	traceMemoryEvent(magazinePool, NULL, MEMORY_TRACE_DMA, numBytes);
+	if (magazinePool != NULL)
+	{
+		void *magazineResult = magazinePool->allocateBlockDoNotZeroImplementation(PASS_LITERALSTRING_ARG1);
+		InterlockedIncrement((LONG *)&m_usedBlocksInDma);
+		return magazineResult;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
 
 	void *result = NULL;
@@ -2173,6 +2652,9 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 #endif
 
 	MemoryPool *pool = findPoolForSize(numBytes);
+#ifndef MEMORYPOOL_MAGAZINES
+	traceMemoryEvent(pool, NULL, MEMORY_TRACE_DMA, numBytes);
+#endif
 	if (pool != NULL) 
 	{
 		result = pool->allocateBlockDoNotZeroImplementation(PASS_LITERALSTRING_ARG1);
@@ -2237,7 +2719,7 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 }
 #endif // MEMORYPOOL_DEBUG
 
-	++m_usedBlocksInDma;
+	InterlockedIncrement((LONG *)&m_usedBlocksInDma);	// with magazines, subpool allocations don't take our lock
 	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 #ifdef MEMORYPOOL_DEBUG
 	#ifdef USE_FILLER_VALUE
@@ -2279,6 +2761,17 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// subpool blocks go back into the calling thread's magazines; only the raw blocks need our lock.
+	MemoryPoolSingleBlock *magazineBlock = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+	if (magazineBlock->getOwningBlob())
+	{
+		magazineBlock->getOwningBlob()->getOwningPool()->freeBlock(pBlockPtr);
+		InterlockedDecrement((LONG *)&m_usedBlocksInDma);
+		return;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
 
 #ifdef MEMORYPOOL_CHECK_BLOCK_OWNERSHIP
@@ -2346,7 +2839,7 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 		::sysFree((void *)block);
 
 	}
-	--m_usedBlocksInDma;
+	InterlockedDecrement((LONG *)&m_usedBlocksInDma);	// with magazines, subpool frees don't take our lock
 	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 
 #ifdef INTENSE_DMA_BOOKKEEPING
@@ -2701,6 +3194,10 @@ void MemoryPoolFactory::destroyMemoryPool(MemoryPool *pMemoryPool)
 	if (!pMemoryPool)
 		return;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	pMemoryPool->flushMagazines();
+#endif
+
 	DEBUG_ASSERTCRASH(pMemoryPool->getUsedBlockCount() == 0, ("destroying a nonempty pool"));
 
 	pMemoryPool->removeFromList(&m_firstPoolInFactory);
@@ -3060,6 +3557,183 @@ void MemoryPoolFactory::memoryPoolUsageReport( const char* filename, FILE *appen
 #endif
 }
 
+//-----------------------------------------------------------------------------
+#if defined(_DEBUG) || defined(_INTERNAL)
+/**
+	start recording all pool traffic to the given file. see MemoryPoolBenchmark.h for the format.
+*/
+Bool MemoryPoolFactory::debugStartTrace( const char *fileName )
+{
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	debugStopTrace();
+
+	FILE *fp = fopen(fileName, "wb");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("MemoryPoolFactory - could not open %s for the memory trace\n", fileName));
+		return false;
+	}
+
+	MemoryTraceHeader header;
+	memcpy(header.m_magic, MEMORY_TRACE_MAGIC, sizeof(header.m_magic));
+	header.m_version = MEMORY_TRACE_VERSION;
+	fwrite(&header, sizeof(header), 1, fp);
+
+	theMemoryTraceBuffer = (MemoryTraceEvent *)::sysAllocateDoNotZero(MEMORY_TRACE_BUFFER_EVENTS * sizeof(MemoryTraceEvent));	// will throw on failure
+	theMemoryTraceCount = 0;
+	theMemoryTraceFile = fp;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	write the remaining events and the pool table, and close the trace file.
+*/
+void MemoryPoolFactory::debugStopTrace()
+{
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	if (theMemoryTraceFile == NULL)
+		return;
+
+	FILE *fp = theMemoryTraceFile;
+	theMemoryTraceFile = NULL;	// don't trace our own allocations from here on
+
+	fwrite(theMemoryTraceBuffer, sizeof(MemoryTraceEvent), theMemoryTraceCount, fp);
+	::sysFree((void *)theMemoryTraceBuffer);
+	theMemoryTraceBuffer = NULL;
+	theMemoryTraceCount = 0;
+
+	Int poolTableOffset = (Int)ftell(fp);
+	for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+	{
+		MemoryTracePool rec;
+		rec.m_pool = (UnsignedInt)pool;
+		rec.m_allocationSize = pool->getAllocationSize();
+		rec.m_initialAllocationCount = pool->getInitialBlockCount();
+		rec.m_overflowAllocationCount = pool->getOverflowBlockCount();
+		rec.m_nameLength = strlen(pool->getPoolName());
+		fwrite(&rec, sizeof(rec), 1, fp);
+		fwrite(pool->getPoolName(), 1, rec.m_nameLength, fp);
+	}
+	fwrite(&poolTableOffset, sizeof(poolTableOffset), 1, fp);
+	fclose(fp);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	write the pool sizes this run would have wanted, in the format userMemoryManagerInitPools()
+	reads from Data\INI\MemoryPools.ini. every pool's initial blob is sized to its peak usage
+	plus a little headroom, so it neither overflows nor sits on memory nobody used. pools that
+	can't grow are never shrunk, and pools that weren't used at all keep their sizes, since
+	this run tells us nothing about them. the DMA subpools can't be sized from the ini file,
+	so they are written as comments, in the form of the table in userMemoryManagerGetDmaParms().
+*/
+void MemoryPoolFactory::debugWritePoolSizing( const char *fileName )
+{
+	const Int HEADROOM_PERCENT = 10;
+	const char *DMA_PREFIX = "dmaPool_";
+
+	FILE *fp = fopen(fileName, "w");
+	if (fp == NULL)
+	{
+		DEBUG_CRASH(("could not create pool sizing file %s",fileName));
+		return;
+	}
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	fprintf(fp, "; MemoryPools.ini -- written by -memoryPoolSizing\n");
+	fprintf(fp, "; name initial overflow ; peak used, overflow blobs created, empty blobs released, old initial/overflow\n");
+
+	Int oldBytes = 0;
+	Int newBytes = 0;
+	for (Int pass = 0; pass < 2; ++pass)
+	{
+		Bool wantDma = (pass == 1);
+		if (wantDma)
+			fprintf(fp, ";\n; DMA subpools -- for userMemoryManagerGetDmaParms() in MemoryInit.cpp\n");
+
+		for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+		{
+			Bool isDma = (strncmp(pool->getPoolName(), DMA_PREFIX, strlen(DMA_PREFIX)) == 0);
+			if (isDma != wantDma)
+				continue;
+
+			Int peak = pool->getPeakBlockCount();
+			Int initial = pool->getInitialBlockCount();
+			Int overflow = pool->getOverflowBlockCount();
+			if (peak > 0)
+			{
+				initial = peak + (peak * HEADROOM_PERCENT + 99) / 100;
+				if (overflow == 0 && initial < pool->getInitialBlockCount())
+					initial = pool->getInitialBlockCount();
+			}
+			// the counts must be multiples of 4 (userMemoryManagerInitPools() rounds the ini ones
+			// up, but nothing rounds the DMA table), so round up here too.
+			initial = ::roundUpMemBound(initial);
+			overflow = ::roundUpMemBound(overflow);
+
+			oldBytes += pool->getInitialBlockCount() * pool->getAllocationSize();
+			newBytes += initial * pool->getAllocationSize();
+
+			if (isDma)
+				fprintf(fp, ";\t\t{ \"%s\", %d, %d, %d },", pool->getPoolName(), pool->getAllocationSize(), initial, overflow);
+			else
+				fprintf(fp, "%s %d %d", pool->getPoolName(), initial, overflow);
+
+			if (peak > 0)
+				fprintf(fp, " ; peak %d, %d overflow blobs, %d released, was %d %d\n", peak,
+					pool->getOverflowBlobsCreated(), pool->getEmptyBlobsReleased(), pool->getInitialBlockCount(), pool->getOverflowBlockCount());
+			else
+				fprintf(fp, " ; not used\n");
+		}
+	}
+
+	fclose(fp);
+
+	DEBUG_LOG(("Pool sizing written to %s: initial blobs take %dk, were %dk\n", fileName, newBytes/1024, oldBytes/1024));
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#ifdef MEMORYPOOL_MAGAZINES
+void MemoryPoolFactory::flushThreadMagazines()
+{
+	for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+	{
+		pool->flushThreadMagazine();
+	}
+}
+
+//-----------------------------------------------------------------------------
+void MemoryPoolFactory::debugMagazineReport()
+{
+	if (TheMemoryPoolCriticalSection)
+	{
+		DEBUG_LOG(("MemoryPool lock: entered %u times, had to wait %u times\n",
+			TheMemoryPoolCriticalSection->getEnterCount(), TheMemoryPoolCriticalSection->getContendedCount()));
+	}
+	if (TheDmaCriticalSection)
+	{
+		DEBUG_LOG(("DMA lock: entered %u times, had to wait %u times\n",
+			TheDmaCriticalSection->getEnterCount(), TheDmaCriticalSection->getContendedCount()));
+	}
+
+	// only the busy ones; most pools never go back to the lock after the first refill.
+	const Int MIN_LOCKS_TO_REPORT = 1000;
+	for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+	{
+		if (pool->getMagazineRefillCount() + pool->getMagazineDrainCount() >= MIN_LOCKS_TO_REPORT)
+		{
+			DEBUG_LOG(("MemoryPool %s: %d magazine refills, %d magazine drains\n",
+				pool->getPoolName(), pool->getMagazineRefillCount(), pool->getMagazineDrainCount()));
+		}
+	}
+}
+#endif
+
 //-----------------------------------------------------------------------------
 #ifdef MEMORYPOOL_DEBUG
 /**
@@ -3420,6 +4094,9 @@ void initMemoryManager()
 		TheDynamicMemoryAllocator = TheMemoryPoolFactory->createDynamicMemoryAllocator(numSubPools, pParms);	// will throw on failure
 		userMemoryManagerInitPools();
 		thePreMainInitFlag = false;
+	#ifdef MEMORYPOOL_MAGAZINES
+		theMainThreadID = GetCurrentThreadId();
+	#endif
 	}
 	else
 	{
@@ -3496,6 +4173,9 @@ static void preMainInitMemoryManager()
 		TheDynamicMemoryAllocator = TheMemoryPoolFactory->createDynamicMemoryAllocator(numSubPools, pParms);	// will throw on failure
 		userMemoryManagerInitPools();
 		thePreMainInitFlag = true;
+	#ifdef MEMORYPOOL_MAGAZINES
+		theMainThreadID = GetCurrentThreadId();
+	#endif
 	}
 }
 
@@ -3514,6 +4194,11 @@ void shutdownMemoryManager()
 	}
 	else
 	{
+	#ifdef MEMORYPOOL_MAGAZINES
+		if (TheMemoryPoolFactory)
+			TheMemoryPoolFactory->debugMagazineReport();
+	#endif
+
 		if (TheDynamicMemoryAllocator)
 		{
 			DEBUG_ASSERTCRASH(TheMemoryPoolFactory, ("hmm, no factory"));
@@ -3532,6 +4217,20 @@ void shutdownMemoryManager()
 			TheMemoryPoolFactory = NULL;
 		}
 
+	#ifdef MEMORYPOOL_MAGAZINES
+		// the pools are gone, and they flushed their magazines on the way out. threads that
+		// exit from here on have nothing to give back, and their sets are about to be freed.
+		ThreadClass::Set_Exit_Hook(NULL);
+		while (theMagazineSets)
+		{
+			MemoryPoolMagazineSet *set = theMagazineSets;
+			theMagazineSets = set->m_next;
+			freeMagazineSet(set);
+		}
+		theThreadMagazineSet = NULL;
+		theNextMagazineSlot = 0;
+	#endif
+
 	#ifdef MEMORYPOOL_DEBUG
 		DEBUG_LOG(("Peak system allocation was %d bytes\n",thePeakSystemAllocationInBytes));
 		DEBUG_LOG(("Wasted DMA space (peak) was %d bytes\n",thePeakWastedDMA));
@@ -89,6 +89,19 @@ void MemoryPoolFactory::memoryPoolUsageReport( const char* filename, FILE *appen
 {
 }
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+Bool MemoryPoolFactory::debugStartTrace( const char *fileName )
+{
+	return false;
+}
+void MemoryPoolFactory::debugStopTrace()
+{
+}
+void MemoryPoolFactory::debugWritePoolSizing( const char *fileName )
+{
+}
+#endif
+
 #ifdef MEMORYPOOL_DEBUG
 void MemoryPoolFactory::debugMemoryReport(Int flags, Int startCheckpoint, Int endCheckpoint, FILE *fp )
 {
@@ -0,0 +1,279 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// MappedArchiveFile.cpp
+// Read-only files that are read straight out of a memory mapped archive.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Common/MappedArchiveFile.h"
+
+//=================================================================
+// ArchiveFileMapping::ArchiveFileMapping
+//=================================================================
+
+ArchiveFileMapping::ArchiveFileMapping()
+:
+#ifdef _WIN32
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(NULL),
+#else
+	m_fd(-1),
+#endif
+	m_granularity(0)
+{
+}
+
+//=================================================================
+// ArchiveFileMapping::~ArchiveFileMapping
+//=================================================================
+
+ArchiveFileMapping::~ArchiveFileMapping()
+{
+	close();
+}
+
+//=================================================================
+// ArchiveFileMapping::open
+//=================================================================
+
+Bool ArchiveFileMapping::open( const Char *path )
+{
+	close();
+
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	m_granularity = systemInfo.dwAllocationGranularity;
+
+	m_file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	m_mapping = CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping == NULL)
+	{
+		close();
+		return FALSE;
+	}
+#else
+	m_granularity = (Int)sysconf(_SC_PAGESIZE);
+
+	m_fd = ::open(path, O_RDONLY);
+	if (m_fd < 0)
+		return FALSE;
+#endif
+
+	return TRUE;
+}
+
+//=================================================================
+// ArchiveFileMapping::close
+//=================================================================
+
+void ArchiveFileMapping::close( void )
+{
+#ifdef _WIN32
+	if (m_mapping != NULL)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+	}
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
+
+//=================================================================
+// ArchiveFileMapping::isOpen
+//=================================================================
+
+Bool ArchiveFileMapping::isOpen( void ) const
+{
+#ifdef _WIN32
+	return m_mapping != NULL;
+#else
+	return m_fd >= 0;
+#endif
+}
+
+//=================================================================
+// ArchiveFileMapping::mapView
+//=================================================================
+/**
+	views have to start on a multiple of the allocation granularity, so the view
+	starts a little before 'offset', and we return a pointer into it.
+	*/
+//=================================================================
+
+const Char *ArchiveFileMapping::mapView( Int offset, Int size, void *&view, Int &viewSize ) const
+{
+	view = NULL;
+	viewSize = 0;
+
+	if (!isOpen() || offset < 0 || size <= 0)
+		return NULL;
+
+	Int viewOffset = offset - (offset % m_granularity);
+	Int lead = offset - viewOffset;
+
+#ifdef _WIN32
+	view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, viewOffset, lead + size);
+	if (view == NULL)
+		return NULL;
+#else
+	view = mmap(NULL, lead + size, PROT_READ, MAP_PRIVATE, m_fd, viewOffset);
+	if (view == MAP_FAILED)
+	{
+		view = NULL;
+		return NULL;
+	}
+#endif
+
+	viewSize = lead + size;
+	return (const Char *)view + lead;
+}
+
+//=================================================================
+// ArchiveFileMapping::unmapView
+//=================================================================
+
+void ArchiveFileMapping::unmapView( void *view, Int viewSize )
+{
+	if (view == NULL)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+#else
+	munmap(view, viewSize);
+#endif
+}
+
+//=================================================================
+// MappedArchiveFile::MappedArchiveFile
+//=================================================================
+
+MappedArchiveFile::MappedArchiveFile()
+: m_view(NULL),
+	m_viewSize(0)
+{
+}
+
+//=================================================================
+// MappedArchiveFile::~MappedArchiveFile
+//=================================================================
+
+MappedArchiveFile::~MappedArchiveFile()
+{
+	unmap();
+}
+
+//=================================================================
+// MappedArchiveFile::unmap
+//=================================================================
+/**
+	give the view back, and make sure RAMFile doesn't try to delete it.
+	*/
+//=================================================================
+
+void MappedArchiveFile::unmap( void )
+{
+	if (m_view != NULL)
+	{
+		ArchiveFileMapping::unmapView(m_view, m_viewSize);
+		m_view = NULL;
+		m_viewSize = 0;
+		m_data = NULL;
+	}
+}
+
+//=================================================================
+// MappedArchiveFile::openFromMapping
+//=================================================================
+
+Bool MappedArchiveFile::openFromMapping( const ArchiveFileMapping& mapping, const AsciiString& filename, Int offset, Int size )
+{
+	if (File::open(filename.str(), File::READ | File::BINARY) == FALSE) {
+		return FALSE;
+	}
+
+	unmap();
+	if (m_data != NULL) {
+		delete[] m_data;
+		m_data = NULL;
+	}
+
+	const Char *data = mapping.mapView(offset, size, m_view, m_viewSize);
+	if (data == NULL) {
+		return FALSE;
+	}
+
+	// RAMFile only ever reads through m_data, so the view can stay read-only.
+	m_data = (Char *)data;
+	m_size = size;
+	m_pos = 0;
+	m_nameStr = filename;
+
+	return TRUE;
+}
+
+//=================================================================
+// MappedArchiveFile::close
+//=================================================================
+
+void MappedArchiveFile::close( void )
+{
+	unmap();
+	RAMFile::close();
+}
+
+//=================================================================
+// MappedArchiveFile::readEntireAndClose
+//=================================================================
+/**
+	our caller owns the buffer, so this is the one place we have to copy.
+	*/
+//=================================================================
+
+char* MappedArchiveFile::readEntireAndClose()
+{
+	if (m_view == NULL)
+		return RAMFile::readEntireAndClose();
+
+	char* tmp = MSGNEW("RAMFILE") char [ m_size ];	// pool[]ify
+	memcpy(tmp, m_data, m_size);
+
+	close();
+
+	return tmp;
+}
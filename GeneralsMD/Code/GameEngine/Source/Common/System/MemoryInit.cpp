@@ -87,7 +87,6 @@ struct PoolSizeRec
 // not const -- we might override from INI
 static PoolSizeRec sizes[] = 
 {
-	{ "PartitionContactListNode", 2048, 512 },
 	{ "BattleshipUpdate", 32, 32 },
 	{ "FlyToDestAndDestroyUpdate", 32, 32 },
 	{ "MusicTrack", 32, 32 },
@@ -558,6 +557,7 @@ static PoolSizeRec sizes[] =
 	{ "Win32LocalFile", 1024, 256 },
 	{ "StdLocalFile", 1024, 256 },
 	{ "RAMFile", 32, 32 },
+	{ "MappedArchiveFile", 32, 32 },
 	{ "BattlePlanBonuses", 32, 32 },
 	{ "KindOfPercentProductionChange", 32, 32 },
 	{ "UserParser", 4096, 256 },
@@ -585,6 +585,7 @@ static PoolSizeRec sizes[] =
 	{ "Mission", 88, 32 },
 	{ "ModalWindow", 32, 32 },
 	{ "NetPacket", 32, 32 },
+	{ "TransportBuffer", 64, 32 },
 	{ "AISideInfo", 32, 32 },
 	{ "AISideBuildList", 32, 32 },
 	{ "MetaMapRec", 256, 32 },
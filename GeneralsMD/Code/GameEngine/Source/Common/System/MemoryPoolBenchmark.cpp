@@ -0,0 +1,501 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// MemoryPoolBenchmark.cpp
+// Replays recorded memory pool traffic through models of the pool bookkeeping.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/MemoryPoolBenchmark.h"
+#include "Common/STLTypedefs.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+//-------------------------------------------------------------------------------------------------
+/** One pool from the trace's pool table. */
+struct BenchPoolInfo
+{
+	UnsignedInt m_address;
+	Int m_allocationSize;
+	Int m_initialAllocationCount;
+	Int m_overflowAllocationCount;
+	AsciiString m_name;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** One pool allocation or free from the trace, with the block turned into a slot number
+	that is unique among the blocks alive at that moment. */
+struct BenchOp
+{
+	Int m_pool;
+	Int m_slot;
+	Bool m_isFree;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Stand-in for a MemoryPoolBlob: the bookkeeping only, the blocks themselves have no memory. */
+struct BenchBlob
+{
+	BenchBlob *m_next;
+	BenchBlob *m_nextFree;		///< list of blobs with free blocks (BenchListPool only)
+	BenchBlob *m_prevFree;
+	Int m_firstFreeBlock;			///< -1 if full
+	Int m_usedBlocks;
+	Int m_totalBlocks;
+	Int *m_nextFreeBlock;			///< per block: the next free block, like MemoryPoolSingleBlock::m_nextBlock
+
+	Bool hasAnyFreeBlocks() const { return m_firstFreeBlock >= 0; }
+
+	Int allocateBlock()
+	{
+		Int block = m_firstFreeBlock;
+		m_firstFreeBlock = m_nextFreeBlock[block];
+		++m_usedBlocks;
+		return block;
+	}
+
+	void freeBlock( Int block )
+	{
+		m_nextFreeBlock[block] = m_firstFreeBlock;
+		m_firstFreeBlock = block;
+		--m_usedBlocks;
+	}
+};
+
+//-------------------------------------------------------------------------------------------------
+struct BenchBlockRef
+{
+	BenchBlob *m_blob;
+	Int m_block;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** What both pool models share: the list of all blobs, and making new ones. */
+class BenchPoolBase
+{
+public:
+
+	BenchPoolBase() : m_overflowAllocationCount(0), m_firstBlob(NULL), m_lastBlob(NULL), m_numBlobs(0) { }
+
+	~BenchPoolBase()
+	{
+		while (m_firstBlob)
+		{
+			BenchBlob *next = m_firstBlob->m_next;
+			delete [] m_firstBlob->m_nextFreeBlock;
+			delete m_firstBlob;
+			m_firstBlob = next;
+		}
+	}
+
+	Int getBlobCount() const { return m_numBlobs; }
+
+protected:
+
+	BenchBlob *createBlob( Int count )
+	{
+		if (count <= 0)
+			count = 1;
+		BenchBlob *blob = MSGNEW("MemoryPoolBenchmark") BenchBlob;
+		blob->m_next = NULL;
+		blob->m_nextFree = NULL;
+		blob->m_prevFree = NULL;
+		blob->m_usedBlocks = 0;
+		blob->m_totalBlocks = count;
+		blob->m_nextFreeBlock = MSGNEW("MemoryPoolBenchmark") Int[count];
+		for (Int i = 0; i < count; ++i)
+			blob->m_nextFreeBlock[i] = (i + 1 < count) ? i + 1 : -1;
+		blob->m_firstFreeBlock = 0;
+
+		if (m_lastBlob)
+			m_lastBlob->m_next = blob;
+		else
+			m_firstBlob = blob;
+		m_lastBlob = blob;
+		++m_numBlobs;
+		return blob;
+	}
+
+	Int m_overflowAllocationCount;
+	BenchBlob *m_firstBlob;
+	BenchBlob *m_lastBlob;
+	Int m_numBlobs;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The pool as it was: one 'first blob with free blocks' pointer, and a walk over all blobs
+	whenever that one is used up. */
+class BenchScanPool : public BenchPoolBase
+{
+public:
+
+	BenchScanPool() : m_firstBlobWithFreeBlocks(NULL) { }
+
+	void init( Int initialAllocationCount, Int overflowAllocationCount )
+	{
+		m_overflowAllocationCount = overflowAllocationCount;
+		m_firstBlobWithFreeBlocks = createBlob(initialAllocationCount);
+	}
+
+	BenchBlockRef allocate()
+	{
+		if (m_firstBlobWithFreeBlocks != NULL && !m_firstBlobWithFreeBlocks->hasAnyFreeBlocks())
+		{
+			BenchBlob *blob = m_firstBlob;
+			for (; blob != NULL; blob = blob->m_next)
+			{
+				if (blob->hasAnyFreeBlocks())
+					break;
+			}
+			m_firstBlobWithFreeBlocks = blob;
+		}
+		if (m_firstBlobWithFreeBlocks == NULL)
+			m_firstBlobWithFreeBlocks = createBlob(m_overflowAllocationCount);
+
+		BenchBlockRef ref;
+		ref.m_blob = m_firstBlobWithFreeBlocks;
+		ref.m_block = ref.m_blob->allocateBlock();
+		return ref;
+	}
+
+	void free( const BenchBlockRef &ref )
+	{
+		ref.m_blob->freeBlock(ref.m_block);
+		if (!m_firstBlobWithFreeBlocks)
+			m_firstBlobWithFreeBlocks = ref.m_blob;
+	}
+
+private:
+
+	BenchBlob *m_firstBlobWithFreeBlocks;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The pool as it is now: a list of exactly the blobs that have free blocks. */
+class BenchListPool : public BenchPoolBase
+{
+public:
+
+	BenchListPool() : m_firstBlobWithFreeBlocks(NULL), m_lastBlobWithFreeBlocks(NULL) { }
+
+	void init( Int initialAllocationCount, Int overflowAllocationCount )
+	{
+		m_overflowAllocationCount = overflowAllocationCount;
+		addToFreeList(createBlob(initialAllocationCount));
+	}
+
+	BenchBlockRef allocate()
+	{
+		if (m_firstBlobWithFreeBlocks == NULL)
+			addToFreeList(createBlob(m_overflowAllocationCount));
+
+		BenchBlockRef ref;
+		ref.m_blob = m_firstBlobWithFreeBlocks;
+		ref.m_block = ref.m_blob->allocateBlock();
+		if (!ref.m_blob->hasAnyFreeBlocks())
+			removeFromFreeList(ref.m_blob);
+		return ref;
+	}
+
+	void free( const BenchBlockRef &ref )
+	{
+		Bool wasFull = !ref.m_blob->hasAnyFreeBlocks();
+		ref.m_blob->freeBlock(ref.m_block);
+		if (wasFull)
+			addToFreeList(ref.m_blob);
+	}
+
+private:
+
+	void addToFreeList( BenchBlob *blob )
+	{
+		blob->m_prevFree = m_lastBlobWithFreeBlocks;
+		blob->m_nextFree = NULL;
+		if (m_lastBlobWithFreeBlocks)
+			m_lastBlobWithFreeBlocks->m_nextFree = blob;
+		else
+			m_firstBlobWithFreeBlocks = blob;
+		m_lastBlobWithFreeBlocks = blob;
+	}
+
+	void removeFromFreeList( BenchBlob *blob )
+	{
+		if (blob->m_prevFree)
+			blob->m_prevFree->m_nextFree = blob->m_nextFree;
+		else
+			m_firstBlobWithFreeBlocks = blob->m_nextFree;
+		if (blob->m_nextFree)
+			blob->m_nextFree->m_prevFree = blob->m_prevFree;
+		else
+			m_lastBlobWithFreeBlocks = blob->m_prevFree;
+	}
+
+	BenchBlob *m_firstBlobWithFreeBlocks;
+	BenchBlob *m_lastBlobWithFreeBlocks;
+};
+
+//-------------------------------------------------------------------------------------------------
+static Real secondsSince( Int64 startTime64, Int64 freq64 )
+{
+	Int64 endTime64;
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	return (Real)((double)(endTime64 - startTime64) / (double)freq64);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Replay the pool traffic through one pool model. Returns the time in seconds. */
+template <class POOL>
+static Real runPools( const std::vector<BenchPoolInfo> &poolInfos, const std::vector<BenchOp> &ops, Int numSlots, Int &numBlobs )
+{
+	Int numPools = poolInfos.size();
+	POOL *pools = MSGNEW("MemoryPoolBenchmark") POOL[numPools];
+	Int i;
+	for (i = 0; i < numPools; ++i)
+		pools[i].init(poolInfos[i].m_initialAllocationCount, poolInfos[i].m_overflowAllocationCount);
+
+	std::vector<BenchBlockRef> slots;
+	slots.resize(numSlots);
+
+	Int64 freq64, startTime64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+
+	Int numOps = ops.size();
+	for (i = 0; i < numOps; ++i)
+	{
+		const BenchOp &op = ops[i];
+		if (op.m_isFree)
+			pools[op.m_pool].free(slots[op.m_slot]);
+		else
+			slots[op.m_slot] = pools[op.m_pool].allocate();
+	}
+
+	Real time = secondsSince(startTime64, freq64);
+
+	numBlobs = 0;
+	for (i = 0; i < numPools; ++i)
+		numBlobs += pools[i].getBlobCount();
+	delete [] pools;
+	return time;
+}
+
+//-------------------------------------------------------------------------------------------------
+static Bool readTrace( const AsciiString &traceFileName, std::vector<BenchPoolInfo> &poolInfos, std::vector<MemoryTraceEvent> &events )
+{
+	FILE *fp = fopen(traceFileName.str(), "rb");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("MemoryPoolBenchmark - could not open %s\n", traceFileName.str()));
+		return false;
+	}
+
+	MemoryTraceHeader header;
+	Int poolTableOffset = 0;
+	Int fileSize = 0;
+	Bool ok = fread(&header, sizeof(header), 1, fp) == 1
+		&& memcmp(header.m_magic, MEMORY_TRACE_MAGIC, sizeof(header.m_magic)) == 0
+		&& header.m_version == MEMORY_TRACE_VERSION
+		&& fseek(fp, -(Int)sizeof(poolTableOffset), SEEK_END) == 0
+		&& fread(&poolTableOffset, sizeof(poolTableOffset), 1, fp) == 1;
+	if (ok)
+	{
+		fileSize = (Int)ftell(fp);
+		ok = poolTableOffset >= (Int)sizeof(header) && poolTableOffset <= fileSize - (Int)sizeof(poolTableOffset);
+	}
+
+	if (ok)
+	{
+		Int numEvents = (poolTableOffset - sizeof(header)) / sizeof(MemoryTraceEvent);
+		events.resize(numEvents);
+		fseek(fp, sizeof(header), SEEK_SET);
+		ok = numEvents == 0 || fread(&events[0], sizeof(MemoryTraceEvent), numEvents, fp) == (size_t)numEvents;
+	}
+
+	if (ok)
+	{
+		fseek(fp, poolTableOffset, SEEK_SET);
+		while (ok && (Int)ftell(fp) < fileSize - (Int)sizeof(poolTableOffset))
+		{
+			MemoryTracePool rec;
+			char name[256];
+			ok = fread(&rec, sizeof(rec), 1, fp) == 1 && rec.m_nameLength >= 0 && rec.m_nameLength < (Int)sizeof(name)
+				&& fread(name, 1, rec.m_nameLength, fp) == (size_t)rec.m_nameLength;
+			if (ok)
+			{
+				name[rec.m_nameLength] = 0;
+				BenchPoolInfo info;
+				info.m_address = rec.m_pool;
+				info.m_allocationSize = rec.m_allocationSize;
+				info.m_initialAllocationCount = rec.m_initialAllocationCount;
+				info.m_overflowAllocationCount = rec.m_overflowAllocationCount;
+				info.m_name = name;
+				poolInfos.push_back(info);
+			}
+		}
+	}
+
+	fclose(fp);
+
+	if (!ok)
+		DEBUG_LOG(("MemoryPoolBenchmark - %s is not a valid memory trace\n", traceFileName.str()));
+	return ok;
+}
+
+//-------------------------------------------------------------------------------------------------
+void runMemoryPoolBenchmark( const AsciiString &traceFileName )
+{
+	std::vector<BenchPoolInfo> poolInfos;
+	std::vector<MemoryTraceEvent> events;
+	if (!readTrace(traceFileName, poolInfos, events))
+		return;
+
+	Int numPools = poolInfos.size();
+	Int i;
+
+	// turn the recorded addresses into indices: pools into the pool table, blocks into slots.
+	std::map<UnsignedInt, Int> poolIndex;
+	for (i = 0; i < numPools; ++i)
+		poolIndex[poolInfos[i].m_address] = i;
+
+	std::vector<BenchOp> ops;
+	std::vector<Int> dmaRequests;
+	std::map<UnsignedInt, Int> liveSlots;
+	std::vector<Int> unusedSlots;
+	Int numSlots = 0;
+	Int numEvents = events.size();
+	for (i = 0; i < numEvents; ++i)
+	{
+		const MemoryTraceEvent &event = events[i];
+		Int op = event.m_blockAndOp & MEMORY_TRACE_OP_MASK;
+		UnsignedInt block = event.m_blockAndOp & ~MEMORY_TRACE_OP_MASK;
+		if (op == MEMORY_TRACE_DMA)
+		{
+			dmaRequests.push_back(event.m_bytes);
+			continue;
+		}
+
+		std::map<UnsignedInt, Int>::iterator pool = poolIndex.find(event.m_pool);
+		if (pool == poolIndex.end())
+			continue;		// pool was destroyed before the trace ended
+
+		BenchOp benchOp;
+		benchOp.m_pool = pool->second;
+		benchOp.m_isFree = (op == MEMORY_TRACE_FREE);
+		if (benchOp.m_isFree)
+		{
+			std::map<UnsignedInt, Int>::iterator live = liveSlots.find(block);
+			if (live == liveSlots.end())
+				continue;		// allocated before the trace started
+			benchOp.m_slot = live->second;
+			unusedSlots.push_back(live->second);
+			liveSlots.erase(live);
+		}
+		else
+		{
+			if (liveSlots.find(block) != liveSlots.end())
+				continue;		// can't happen, unless the trace is damaged
+			if (unusedSlots.empty())
+			{
+				benchOp.m_slot = numSlots++;
+			}
+			else
+			{
+				benchOp.m_slot = unusedSlots.back();
+				unusedSlots.pop_back();
+			}
+			liveSlots[block] = benchOp.m_slot;
+		}
+		ops.push_back(benchOp);
+	}
+
+	// the DMA subpools, smallest first.
+	std::vector<Int> dmaSizes;
+	for (i = 0; i < numPools; ++i)
+	{
+		if (poolInfos[i].m_name.startsWith("dmaPool_"))
+			dmaSizes.push_back(poolInfos[i].m_allocationSize);
+	}
+	std::sort(dmaSizes.begin(), dmaSizes.end());
+	Int numDmaSizes = dmaSizes.size();
+
+	const Int ALIGNMENT = 4;
+	std::vector<Int> sizeClasses;
+	if (numDmaSizes > 0)
+	{
+		sizeClasses.resize(dmaSizes[numDmaSizes - 1] / ALIGNMENT + 1);
+		Int pool = 0;
+		for (Int sizeClass = 0; sizeClass < (Int)sizeClasses.size(); ++sizeClass)
+		{
+			while (dmaSizes[pool] < sizeClass * ALIGNMENT)
+				++pool;
+			sizeClasses[sizeClass] = pool;
+		}
+	}
+
+	Int64 freq64, startTime64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+	Int numRequests = dmaRequests.size();
+
+	// subpool lookup, scanning
+	UnsignedInt scanSum = 0;
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+	for (i = 0; i < numRequests; ++i)
+	{
+		Int bytes = dmaRequests[i];
+		Int found = -1;
+		for (Int p = 0; p < numDmaSizes; ++p)
+		{
+			if (bytes <= dmaSizes[p])
+			{
+				found = p;
+				break;
+			}
+		}
+		scanSum = scanSum * 31 + found;
+	}
+	Real scanTime = secondsSince(startTime64, freq64);
+
+	// subpool lookup, size class table
+	UnsignedInt tableSum = 0;
+	Int numSizeClasses = sizeClasses.size();
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+	for (i = 0; i < numRequests; ++i)
+	{
+		Int sizeClass = (dmaRequests[i] + (ALIGNMENT-1)) / ALIGNMENT;
+		Int found = (sizeClass >= 0 && sizeClass < numSizeClasses) ? sizeClasses[sizeClass] : -1;
+		tableSum = tableSum * 31 + found;
+	}
+	Real tableTime = secondsSince(startTime64, freq64);
+
+	// the blobs
+	Int scanBlobs, listBlobs;
+	Real scanPoolTime = runPools<BenchScanPool>(poolInfos, ops, numSlots, scanBlobs);
+	Real listPoolTime = runPools<BenchListPool>(poolInfos, ops, numSlots, listBlobs);
+
+	Real numLookups = (Real)(numRequests > 0 ? numRequests : 1);
+	Real numOps = (Real)(ops.size() > 0 ? ops.size() : 1);
+	DEBUG_LOG(("MemoryPoolBenchmark - %s: %d pools, %d events, %d DMA requests, %d pool operations\n",
+		traceFileName.str(), numPools, numEvents, numRequests, (Int)ops.size()));
+	DEBUG_LOG(("MemoryPoolBenchmark - subpool scan:     %.3f ms, %.1f ns/request\n", scanTime * 1000.0f, scanTime * 1.0e9f / numLookups));
+	DEBUG_LOG(("MemoryPoolBenchmark - size class table: %.3f ms, %.1f ns/request\n", tableTime * 1000.0f, tableTime * 1.0e9f / numLookups));
+	DEBUG_LOG(("MemoryPoolBenchmark - subpools %s (%08x %08x)\n", (scanSum == tableSum) ? "match" : "DIFFER", scanSum, tableSum));
+	DEBUG_LOG(("MemoryPoolBenchmark - blob scan:        %.3f ms, %.1f ns/operation, %d blobs\n", scanPoolTime * 1000.0f, scanPoolTime * 1.0e9f / numOps, scanBlobs));
+	DEBUG_LOG(("MemoryPoolBenchmark - free blob list:   %.3f ms, %.1f ns/operation, %d blobs\n", listPoolTime * 1000.0f, listPoolTime * 1.0e9f / numOps, listBlobs));
+	DEBUG_ASSERTCRASH(scanSum == tableSum, ("size class table picked different subpools than the scan"));
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
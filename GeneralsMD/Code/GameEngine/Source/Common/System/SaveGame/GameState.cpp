@@ -764,6 +764,109 @@ SaveCode GameState::loadGame( AvailableGameInfo gameInfo )
 
 }  // end loadGame
 
+// ------------------------------------------------------------------------------------------------
+/** Save the whole game state to 'filepath', which is a full path. Unlike saveGame() this
+	* doesn't go near the save directory or tell the user anything, so the replay keyframes
+	* can use it */
+// ------------------------------------------------------------------------------------------------
+SaveCode GameState::saveSnapshot( AsciiString filepath )
+{
+
+	XferSave xferSave;
+	try
+	{
+		xferSave.open( filepath );
+	}
+	catch( ... )
+	{
+		DEBUG_LOG(( "GameState::saveSnapshot - Error opening file '%s'\n", filepath.str() ));
+		return SC_UNABLE_TO_OPEN_FILE;
+	}
+
+	getSaveGameInfo()->saveFileType = SAVE_FILE_TYPE_NORMAL;
+	getSaveGameInfo()->missionMapName.clear();
+
+	SaveCode code = SC_OK;
+	try
+	{
+		xferSaveData( &xferSave, SNAPSHOT_SAVELOAD );
+	}
+	catch( ... )
+	{
+		DEBUG_LOG(( "GameState::saveSnapshot - Error saving '%s'\n", filepath.str() ));
+		code = SC_ERROR;
+	}
+
+	xferSave.close();
+	return code;
+
+}  // end saveSnapshot
+
+// ------------------------------------------------------------------------------------------------
+/** Load a file written by saveSnapshot(). This is loadGame() for a normal save, less the
+	* messages to the user. On failure the game is cleared out, and the caller decides what
+	* to tell the user */
+// ------------------------------------------------------------------------------------------------
+SaveCode GameState::loadSnapshot( AsciiString filepath )
+{
+
+	XferLoad xferLoad;
+	try
+	{
+		xferLoad.open( filepath );
+	}
+	catch( ... )
+	{
+		DEBUG_LOG(( "GameState::loadSnapshot - Error opening file '%s'\n", filepath.str() ));
+		return SC_FILE_NOT_FOUND;
+	}
+
+	TheGameStateMap->clearScratchPadMaps();
+
+	// clear out the game engine
+	TheGameEngine->reset();
+
+	// lock creation of new ghost objects
+	TheGhostObjectManager->saveLockGhostObjects( TRUE );
+
+	LatchRestore<Bool> inLoadGame(m_isInLoadGame, TRUE);
+
+	Bool error = FALSE;
+	try
+	{
+		xferSaveData( &xferLoad, SNAPSHOT_SAVELOAD );
+	}
+	catch( ... )
+	{
+		error = TRUE;
+	}
+
+	xferLoad.close();
+
+	TheGhostObjectManager->saveLockGhostObjects( FALSE );
+
+	try
+	{
+		gameStatePostProcessLoad();
+	}
+	catch (...)
+	{
+		error = TRUE;
+	}
+
+	if( error == TRUE )
+	{
+		DEBUG_LOG(( "GameState::loadSnapshot - Error loading '%s'\n", filepath.str() ));
+		if (TheGameLogic->isInGame())
+			TheGameLogic->clearGameData( FALSE );
+		TheGameEngine->reset();
+		return SC_INVALID_DATA;
+	}
+
+	return SC_OK;
+
+}  // end loadSnapshot
+
 //-------------------------------------------------------------------------------------------------
 AsciiString GameState::getSaveDirectory() const
 {
@@ -36,6 +36,24 @@
 #include "Common/Snapshot.h"
 #include "winsock2.h" // for htonl
 
+//-------------------------------------------------------------------------------------------------
+/** Same as htonl() on the little endian machines we run on, but inline; htonl() is a call
+	into the socket library, and we used to make one for every word of every CRC. */
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt crcByteSwap( UnsignedInt val )
+{
+	return (val >> 24) | ((val >> 8) & 0x0000ff00) | ((val << 8) & 0x00ff0000) | (val << 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** One step of the CRC: rotate left by one bit, then add. (Shifting left and adding back
+	the bit that fell off, which is how addCRC spells it, is the same thing.) */
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt crcStep( UnsignedInt crc, UnsignedInt val )
+{
+	return ((crc << 1) | (crc >> 31)) + val;
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 XferCRC::XferCRC( void )
@@ -97,22 +115,8 @@ void XferCRC::endBlock( void )
 //-------------------------------------------------------------------------------------------------
 void XferCRC::addCRC( UnsignedInt val )
 {
-	int hibit;
 
-	val = htonl(val);
-
-	if (m_crc & 0x80000000)
-	{
-		hibit = 1;
-	}
-	else
-	{
-		hibit = 0;
-	}
-
-	m_crc <<= 1;
-	m_crc += val;
-	m_crc += hibit;
+	m_crc = crcStep(m_crc, crcByteSwap(val));
 
 }  // end addCRC
 
@@ -147,9 +151,23 @@ void XferCRC::xferImplementation( void *data, Int dataSize )
 
 	const UnsignedInt *uintPtr = (const UnsignedInt *) (data);
 
-	for (Int i=0 ; i<dataSize/4 ; i++)
+	// each step depends on the one before it, so there is nothing to run side by side; the
+	// best we can do is keep the running CRC in a register and go four words at a time.
+	UnsignedInt crc = m_crc;
+	Int numWords = dataSize >> 2;
+	while (numWords >= 4)
+	{
+		crc = crcStep(crc, crcByteSwap(uintPtr[0]));
+		crc = crcStep(crc, crcByteSwap(uintPtr[1]));
+		crc = crcStep(crc, crcByteSwap(uintPtr[2]));
+		crc = crcStep(crc, crcByteSwap(uintPtr[3]));
+		uintPtr += 4;
+		numWords -= 4;
+	}
+	while (numWords > 0)
 	{
-		addCRC (*uintPtr++);
+		crc = crcStep(crc, crcByteSwap(*uintPtr++));
+		--numWords;
 	}
 
 	int leftover = dataSize & 3;
@@ -161,9 +179,11 @@ void XferCRC::xferImplementation( void *data, Int dataSize )
 		{
 			val += (c[i] << (i*8));
 		}
-		val = htonl(val);
-		addCRC (val);
+		// this used to be swapped here and swapped back in addCRC, so it goes in as is.
+		crc = crcStep(crc, val);
 	}
+
+	m_crc = crc;
 	
 }  // end xferImplementation
 
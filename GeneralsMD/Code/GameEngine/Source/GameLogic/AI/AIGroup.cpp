@@ -1643,6 +1643,8 @@ void AIGroup::groupMoveToPosition( const Coord3D *p_posIn, Bool addWaypoint, Com
 	MemoryPoolObjectHolder iterHolder;
 	SimpleObjectIterator *iter = newInstance(SimpleObjectIterator);
 	iterHolder.hold(iter);
+	Int numGroundUnits = 0;
+	IRegion2D groundCells;
 	for( i = m_memberList.begin(); i != m_memberList.end(); ++i )	
 	{
 		Real dx, dy;
@@ -1692,6 +1694,28 @@ void AIGroup::groupMoveToPosition( const Coord3D *p_posIn, Bool addWaypoint, Com
 		}
 #endif 
 		iter->insert((*i), adjust + dx*dx+dy*dy);
+
+		if( (*i)->getAI()->isDoingGroundMovement() )
+		{
+			ICoord2D cell;
+			cell.x = REAL_TO_INT_FLOOR(unitPos.x/PATHFIND_CELL_SIZE_F);
+			cell.y = REAL_TO_INT_FLOOR(unitPos.y/PATHFIND_CELL_SIZE_F);
+			if (numGroundUnits == 0) {
+				groundCells.lo = groundCells.hi = cell;
+			} else {
+				groundCells.lo.x = MIN(groundCells.lo.x, cell.x);
+				groundCells.lo.y = MIN(groundCells.lo.y, cell.y);
+				groundCells.hi.x = MAX(groundCells.hi.x, cell.x);
+				groundCells.hi.y = MAX(groundCells.hi.y, cell.y);
+			}
+			numGroundUnits++;
+		}
+	}
+
+	// Large groups walk down one flow field, instead of each unit searching for a path.
+	if( !addWaypoint && numGroundUnits >= PathfindFlowFields::MIN_GROUP_SIZE )
+	{
+		TheAI->pathfinder()->requestFlowField( pos, groundCells );
 	}
 
 	Coord3D goalPos = *pos;
@@ -29,9 +29,11 @@
 
 #include "GameLogic/AIPathfind.h"
 
+#include "Common/GameEngine.h"
 #include "Common/PerfTimer.h"
 #include "Common/Player.h"
 #include "Common/CRCDebug.h"
+#include "Common/GameState.h"
 #include "Common/GlobalData.h"
 #include "Common/LatchRestore.h"	 
 #include "Common/ThingTemplate.h"
@@ -40,6 +42,7 @@
 #include "GameClient/Line2D.h"
 
 #include "GameLogic/AI.h"
+#include "GameLogic/AIPathfindBenchmark.h"
 #include "GameLogic/GameLogic.h"
 #include "GameLogic/Locomotor.h"
 #include "GameLogic/Module/ContainModule.h"
@@ -115,6 +118,7 @@ static Int frameToShowObstacles;
 
 static UnsignedInt ZONE_UPDATE_FREQUENCY = 300;
 
+
 //-----------------------------------------------------------------------------------
 PathNode::PathNode() :
 	m_nextOpti(0),
@@ -1101,6 +1105,7 @@ Real Path::computeFlightDistToGoal( const Coord3D *pos, Coord3D& goalPos )
 //-----------------------------------------------------------------------------------
 
 enum { PATHFIND_CELLS_PER_FRAME=5000}; // Number of cells we will search pathfinding per frame.
+enum { FLOW_FIELD_CELLS_PER_FRAME=PATHFIND_CELLS_PER_FRAME/2}; // Of those, the most a flow field being built gets.
 enum {CELL_INFOS_TO_ALLOCATE = 30000};
 PathfindCellInfo *PathfindCellInfo::s_infoArray = NULL;
 PathfindCellInfo *PathfindCellInfo::s_firstFree = NULL;						
@@ -1155,6 +1160,7 @@ PathfindCellInfo *PathfindCellInfo::getACellInfo(PathfindCell *cell,const ICoord
 
 		info->m_nextOpen = NULL;
 		info->m_prevOpen = NULL;
+		info->m_openIndex = -1;
 		info->m_pathParent = NULL;
 		info->m_costSoFar = 0;		
 		info->m_totalCost = 0;
@@ -1186,6 +1192,144 @@ void PathfindCellInfo::releaseACellInfo(PathfindCellInfo *theInfo)
 
 //-----------------------------------------------------------------------------------
 
+PathfindOpenList::PathfindOpenList( void ) :
+	m_heap(NULL),
+	m_count(0),
+	m_maxCount(0),
+	m_nextSequence(0),
+	m_operationCount(0)
+{
+}
+
+PathfindOpenList::~PathfindOpenList( void )
+{
+	release();
+}
+
+/**
+ * Allocates the heap.  Every cell on the open list has a PathfindCellInfo, so there
+ * can never be more open cells than there are cell infos.
+ */
+void PathfindOpenList::allocate(Int maxCells)
+{
+	release();
+	m_heap = MSGNEW("PathfindOpenList") PathfindCellInfo *[maxCells];
+	m_maxCount = maxCells;
+	m_count = 0;
+	m_nextSequence = 0;
+}
+
+void PathfindOpenList::release(void)
+{
+	if (m_heap) {
+		delete [] m_heap;
+		m_heap = NULL;
+	}
+	m_maxCount = 0;
+	m_count = 0;
+}
+
+/**
+ * Empties the list.  If startCell is not NULL, it becomes the only cell on the list.
+ * Cells still on the list are NOT released, use PathfindCell::releaseOpenList for that.
+ */
+void PathfindOpenList::reset(PathfindCell *startCell)
+{
+	m_count = 0;
+	m_nextSequence = 0;
+	if (startCell) {
+		DEBUG_ASSERTCRASH(startCell->hasInfo() && startCell->getOpen(), ("Start cell has to be flagged open. jba"));
+		insert(startCell->m_info);
+	}
+}
+
+/**
+ * Adds a cell.  The sequence number puts it after any cells of the same cost that
+ * are already on the list, like the old insertion sort did.
+ */
+void PathfindOpenList::insert(PathfindCellInfo *info)
+{
+	DEBUG_ASSERTCRASH(m_count < m_maxCount, ("Open list overflow."));
+	if (m_count >= m_maxCount) {
+		return;
+	}
+	m_operationCount++;
+	info->m_openSequence = m_nextSequence++;
+	place(info, m_count);
+	m_count++;
+	siftUp(m_count-1);
+}
+
+/**
+ * Removes a cell from anywhere in the heap.
+ */
+void PathfindOpenList::remove(PathfindCellInfo *info)
+{
+	Int ndx = info->m_openIndex;
+	DEBUG_ASSERTCRASH(ndx>=0 && ndx<m_count && m_heap[ndx]==info, ("Cell isn't on the open list."));
+	m_operationCount++;
+	m_count--;
+	info->m_openIndex = -1;
+	if (ndx == m_count) {
+		return; // was the last one.
+	}
+	place(m_heap[m_count], ndx);
+	if (ndx>0 && isLess(m_heap[ndx], m_heap[(ndx-1)/2])) {
+		siftUp(ndx);
+	}	else {
+		siftDown(ndx);
+	}
+}
+
+/**
+ * Removes the last cell in the heap, which never requires re-sorting.  Used to 
+ * empty the list quickly.
+ */
+PathfindCellInfo *PathfindOpenList::removeLast(void)
+{
+	DEBUG_ASSERTCRASH(m_count>0, ("Open list is empty."));
+	m_count--;
+	PathfindCellInfo *info = m_heap[m_count];
+	info->m_openIndex = -1;
+	return info;
+}
+
+void PathfindOpenList::siftUp(Int ndx)
+{
+	PathfindCellInfo *info = m_heap[ndx];
+	while (ndx>0) {
+		Int parent = (ndx-1)/2;
+		if (!isLess(info, m_heap[parent])) {
+			break;
+		}
+		place(m_heap[parent], ndx);
+		ndx = parent;
+	}
+	place(info, ndx);
+}
+
+void PathfindOpenList::siftDown(Int ndx)
+{
+	PathfindCellInfo *info = m_heap[ndx];
+	for (;;) {
+		Int child = 2*ndx+1;
+		if (child >= m_count) {
+			break;
+		}
+		if (child+1 < m_count && isLess(m_heap[child+1], m_heap[child])) {
+			child++;
+		}
+		if (!isLess(m_heap[child], info)) {
+			break;
+		}
+		place(m_heap[child], ndx);
+		ndx = child;
+	}
+	place(info, ndx);
+}
+
+//-----------------------------------------------------------------------------------
+
 /**
  * Constructor
  */
@@ -1507,100 +1651,50 @@ Bool PathfindCell::removeObstacle( Object *obstacle )
 	return true;
 }
 
-/// put self on "open" list in ascending cost order, return new list
-PathfindCell *PathfindCell::putOnSortedOpenList( PathfindCell *list )
+/// put self on "open" list in ascending cost order
+void PathfindCell::putOnSortedOpenList( PathfindOpenList &list )
 {
 	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
 	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
-	if (list == NULL)
-	{
-		list = this;
-		m_info->m_prevOpen = NULL;
-		m_info->m_nextOpen = NULL;
-	}
-	else
-	{
-		// insertion sort
-		PathfindCell *c, *lastCell = NULL;
-		for( c = list; c; c = c->getNextOpen() )
-		{
-			if (c->m_info->m_totalCost > m_info->m_totalCost)
-				break;
-
-			lastCell = c;
-		}
-
-		if (c)
-		{
-			// insert just before "c"
-			if (c->m_info->m_prevOpen)
-				c->m_info->m_prevOpen->m_nextOpen = this->m_info;
-			else
-				list = this;
-
-			m_info->m_prevOpen = c->m_info->m_prevOpen;
-			c->m_info->m_prevOpen = this->m_info;
-				
-			m_info->m_nextOpen = c->m_info;
+	m_info->m_prevOpen = NULL;
+	m_info->m_nextOpen = NULL;
 
-		}
-		else
-		{
-			// append after "lastCell" - end of list
-			lastCell->m_info->m_nextOpen = this->m_info;
-			m_info->m_prevOpen = lastCell->m_info;
-			m_info->m_nextOpen = NULL;
-		}
-	}
+	list.insert(m_info);
 
 	// mark newCell as being on open list
 	m_info->m_open = true;
 	m_info->m_closed = false;
-
-	return list;
 }
 
 /// remove self from "open" list
-PathfindCell *PathfindCell::removeFromOpenList( PathfindCell *list )
+void PathfindCell::removeFromOpenList( PathfindOpenList &list )
 {
 	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
 	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-	if (m_info->m_nextOpen)
-		m_info->m_nextOpen->m_prevOpen = m_info->m_prevOpen;
-	
-	if (m_info->m_prevOpen)
-		m_info->m_prevOpen->m_nextOpen = m_info->m_nextOpen;
-	else
-		list = getNextOpen();
+	list.remove(m_info);
 
 	m_info->m_open = false;
 	m_info->m_nextOpen = NULL;
 	m_info->m_prevOpen = NULL;
-
-	return list;
 }
 
 /// remove all cells from "open" list
-Int PathfindCell::releaseOpenList( PathfindCell *list )
+Int PathfindCell::releaseOpenList( PathfindOpenList &list )
 {
 	Int count = 0;
-	while (list) {
+	while (!list.isEmpty()) {
 		count++;
-		DEBUG_ASSERTCRASH(list->m_info, ("Has to have info."));
-		DEBUG_ASSERTCRASH(list->m_info->m_closed==FALSE && list->m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-		PathfindCell *cur = list;
-		PathfindCellInfo *curInfo = list->m_info;
-		if (curInfo->m_nextOpen) {
-			list = curInfo->m_nextOpen->m_cell;
-		}	else {
-			list = NULL;
-		}
-		DEBUG_ASSERTCRASH(cur == curInfo->m_cell, ("Bad backpointer in PathfindCellInfo"));
+		PathfindCellInfo *curInfo = list.removeLast();
+		PathfindCell *cur = curInfo->m_cell;
+		DEBUG_ASSERTCRASH(cur->m_info, ("Has to have info."));
+		DEBUG_ASSERTCRASH(curInfo->m_closed==FALSE && curInfo->m_open==TRUE, ("Serious error - Invalid flags. jba"));
+		DEBUG_ASSERTCRASH(cur->m_info == curInfo, ("Bad backpointer in PathfindCellInfo"));
 		curInfo->m_nextOpen = NULL;
 		curInfo->m_prevOpen = NULL;
 		curInfo->m_open = FALSE;
 		cur->releaseInfo();
 	}
+	list.reset(NULL);
 	return count;
 }
 
@@ -1893,26 +1987,71 @@ static void __fastcall resolveZones(Int srcZone, Int targetZone, zoneStorageType
 	}
 }
 
-static void flattenZones(zoneStorageType *zoneArray, zoneStorageType *zoneHierarchical, Int sizeOfZones)
+static zoneStorageType findZone(zoneStorageType *zoneEquivalency, Int zone)
+{
+	while (zoneEquivalency[zone] != zone) {
+		zoneEquivalency[zone] = zoneEquivalency[zoneEquivalency[zone]];
+		zone = zoneEquivalency[zone];
+	}
+	return zone;
+}
+
+static void joinZones(zoneStorageType *zoneEquivalency, Int zone1, Int zone2)
+{
+	zone1 = findZone(zoneEquivalency, zone1);
+	zone2 = findZone(zoneEquivalency, zone2);
+	// Keep the lower zone, same as resolveZones.
+	if (zone1<zone2) {
+		zoneEquivalency[zone2] = zone1;
+	} else if (zone2<zone1) {
+		zoneEquivalency[zone1] = zone2;
+	}
+}
+
+/* joinZones, remembering the zones so the table can be put back afterwards. */
+static void joinTrackedZones(zoneStorageType *zoneEquivalency, std::vector<zoneStorageType> &joined, Int zone1, Int zone2)
+{
+	joined.push_back(zone1);
+	joined.push_back(zone2);
+	joinZones(zoneEquivalency, zone1, zone2);
+}
+
+static void flattenZoneTable(zoneStorageType *zoneEquivalency, Int sizeOfZE)
 {
+	// joinZones always points a zone at a lower zone, so a single pass up the table flattens it.
 	Int i;
-	for (i=0; i<sizeOfZones; i++) {
-		Int zone1 = zoneArray[i];
-		Int zone2 = zoneHierarchical[zone1];
-		zone1 = zoneArray[zone2];
-		zone2 = zoneHierarchical[zone1];
-		zoneArray[i] = zone2;
+	for (i=1; i<sizeOfZE; i++) {
+		zoneEquivalency[i] = zoneEquivalency[zoneEquivalency[i]];
 	}
-#if 1
+}
 
-	for (i=0; i<sizeOfZones; i++) {
-		Int zone1 = zoneArray[i];
-		Int zone2 = zoneHierarchical[i];
-		if (zone1!=zone2) {
-			resolveZones(zone1, zone2, zoneArray, sizeOfZones);
-		}
+/* Returns the ZoneEdge relations between a cell and its left or top neighbor in a different zone.
+Cells of the same type are hierarchically equivalent.  Otherwise they may be terrain or crusher 
+equivalent, and at most one of the ground combiners applies.  Left neighbors only check the 
+ground combiners when the cells are neither terrain nor crusher equivalent. */
+static UnsignedByte zoneRelations(const PathfindCell &cell, const PathfindCell &neighbor, Bool leftNeighbor)
+{
+	if (typesMatch(cell, neighbor)) {
+		return ZoneEdge::HIERARCHICAL;
 	}
-#endif
+	UnsignedByte relations = 0;
+	if (terrain(cell, neighbor)) {
+		relations |= ZoneEdge::TERRAIN;
+	}
+	if (crusherGround(cell, neighbor)) {
+		relations |= ZoneEdge::CRUSHER;
+	}
+	if (leftNeighbor && relations != 0) {
+		return relations;
+	}
+	if (waterGround(cell, neighbor)) {
+		relations |= ZoneEdge::GROUND_WATER;
+	} else if (groundRubble(cell, neighbor)) {
+		relations |= ZoneEdge::GROUND_RUBBLE;
+	} else if (groundCliff(cell, neighbor)) {
+		relations |= ZoneEdge::GROUND_CLIFF;
+	}
+	return relations;
 }
 
 inline void applyZone(PathfindCell &targetCell, const PathfindCell &sourceCell, zoneStorageType *zoneEquivalency, Int sizeOfZE)
@@ -1955,7 +2094,10 @@ m_groundWaterZones(NULL),
 m_groundRubbleZones(NULL), 
 m_crusherZones(NULL), 
 m_zonesAllocated(0),
-m_interactsWithBridge(FALSE)
+m_interactsWithBridge(FALSE),
+m_edges(NULL),
+m_numEdges(0),
+m_edgesAllocated(0)
 {		
 	m_cellOrigin.x = 0;
 	m_cellOrigin.y = 0;
@@ -1969,6 +2111,17 @@ m_interactsWithBridge(FALSE)
 ZoneBlock::~ZoneBlock()  
 {
 	freeZones();
+	freeEdges();
+}
+
+void ZoneBlock::freeEdges(void) 
+{
+	if (m_edges) {
+		delete [] m_edges;
+		m_edges = NULL;
+	}
+	m_numEdges = 0;
+	m_edgesAllocated = 0;
 }
 
 void ZoneBlock::freeZones(void) 
@@ -2060,6 +2213,66 @@ void ZoneBlock::blockCalculateZones(PathfindCell **map, PathfindLayer layers[],
 	
 }
 
+/* Record the connections between the zones of this block, to the blocks on the left & top, and 
+to the bridge layers. */
+void ZoneBlock::blockCalculateEdges(PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds, const IRegion2D &globalBounds) 
+{
+	Int i, j;
+	m_numEdges = 0;
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			const PathfindCell &cell = map[i][j];
+			if ( (cell.getConnectLayer() > LAYER_GROUND) && 
+				(cell.getType() == PathfindCell::CELL_CLEAR) ) {
+				PathfindLayer *layer = layers + cell.getConnectLayer();
+				addEdge(cell.getZone(), layer->getZone(), ZoneEdge::HIERARCHICAL);
+			}
+			if (i>globalBounds.lo.x && cell.getZone()!=map[i-1][j].getZone()) {
+				addEdge(cell.getZone(), map[i-1][j].getZone(), zoneRelations(cell, map[i-1][j], true));
+			}
+			if (j>globalBounds.lo.y && cell.getZone()!=map[i][j-1].getZone()) {
+				addEdge(cell.getZone(), map[i][j-1].getZone(), zoneRelations(cell, map[i][j-1], false));
+			}
+		}
+	}
+}
+
+void ZoneBlock::addEdge(zoneStorageType zone1, zoneStorageType zone2, UnsignedByte relations) 
+{
+	if (relations == 0 || zone1 == zone2) {
+		return;
+	}
+	if (zone2 < zone1) {
+		zoneStorageType tmp = zone1;
+		zone1 = zone2;
+		zone2 = tmp;
+	}
+	Int i;
+	for (i=0; i<m_numEdges; i++) {
+		if (m_edges[i].m_zone1 == zone1 && m_edges[i].m_zone2 == zone2) {
+			m_edges[i].m_relations |= relations;
+			return;
+		}
+	}
+	if (m_numEdges >= m_edgesAllocated) {
+		UnsignedShort newAllocated = m_edgesAllocated ? 2*m_edgesAllocated : 16;
+		// pool[]ify
+		ZoneEdge *newEdges = MSGNEW("PathfindZoneInfo") ZoneEdge[newAllocated];
+		for (i=0; i<m_numEdges; i++) {
+			newEdges[i] = m_edges[i];
+		}
+		if (m_edges) {
+			delete [] m_edges;
+		}
+		m_edges = newEdges;
+		m_edgesAllocated = newAllocated;
+	}
+	m_edges[m_numEdges].m_zone1 = zone1;
+	m_edges[m_numEdges].m_zone2 = zone2;
+	m_edges[m_numEdges].m_relations = relations;
+	m_numEdges++;
+}
+
 //
 // Return the zone at this location.
 //
@@ -2161,9 +2374,11 @@ m_groundRubbleZones(NULL),
 m_terrainZones(NULL), 
 m_crusherZones(NULL), 
 m_hierarchicalZones(NULL), 
+m_scratchZones(NULL), 
 m_blockOfZoneBlocks(NULL),
 m_zoneBlocks(NULL),
-m_zonesAllocated(0)
+m_zonesAllocated(0),
+m_zoneVersion(0)
 {		
 	m_zoneBlockExtent.x = 0;
 	m_zoneBlockExtent.y = 0;
@@ -2201,6 +2416,10 @@ void PathfindZoneManager::freeZones()
 		delete [] m_hierarchicalZones;
 		m_hierarchicalZones = NULL;
 	}
+	if (m_scratchZones) {
+		delete [] m_scratchZones;
+		m_scratchZones = NULL;
+	}
 	m_zonesAllocated = 0;
 }
 
@@ -2241,6 +2460,11 @@ void PathfindZoneManager::allocateZones(void)
 	m_terrainZones = MSGNEW("PathfindZoneInfo") zoneStorageType[m_zonesAllocated];
 	m_crusherZones = MSGNEW("PathfindZoneInfo") zoneStorageType[m_zonesAllocated];
 	m_hierarchicalZones = MSGNEW("PathfindZoneInfo") zoneStorageType[m_zonesAllocated];
+	m_scratchZones = MSGNEW("PathfindZoneInfo") zoneStorageType[m_zonesAllocated];
+	Int i;
+	for (i=0; i<m_zonesAllocated; i++) {
+		m_scratchZones[i] = i;
+	}
 }
 
 /* Allocate zone blocks for hierarchical pathfinding.   */
@@ -2273,60 +2497,490 @@ void PathfindZoneManager::markZonesDirty( Bool insert )  ///< Called when the zo
 		m_nextFrameToCalculateZones = 2;
 		return;
 	}
+	if (TheGlobalData->m_incrementalPathfindZones) {
+		return; // updateZonesForModify repairs just the modified blocks.
+	}
 //  if ( insert )
 //  	m_nextFrameToCalculateZones = TheGameLogic->getFrame();
 //  else
     m_nextFrameToCalculateZones = MIN( m_nextFrameToCalculateZones, TheGameLogic->getFrame() + ZONE_UPDATE_FREQUENCY );
 } 
 
-/**
- * Calculate zones.  A zone is an area of the same terrain - clear, water or cliff.
- * The utility of zones is that if current location and destiontion are in the same zone, 
- * you can successfully pathfind.
- * If you are a multiple terrain vehicle, like amphibious transport, the lookup is a little more
- * complicated.
- */
+/* Cell bounds of a zone block, clipped to the map. */
+void PathfindZoneManager::getBlockBounds(Int xBlock, Int yBlock, const IRegion2D &globalBounds, IRegion2D &bounds) const
+{
+	bounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
+	bounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
+	bounds.hi.x = bounds.lo.x + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
+	bounds.hi.y = bounds.lo.y + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
+	if (bounds.hi.x > globalBounds.hi.x) {
+		bounds.hi.x = globalBounds.hi.x;
+	}
+	if (bounds.hi.y > globalBounds.hi.y) {
+		bounds.hi.y = globalBounds.hi.y;
+	}
+}
 
+/* Rebuild the hierarchical & combiner equivalency tables from the zone block edges. */
+void PathfindZoneManager::calculateZoneTables(void)
+{
+	allocateZones();
 
+	Int i;
+	for (i=0; i<m_zonesAllocated; i++) {
+		m_hierarchicalZones[i] = i;
+	}
 
-#define dont_forceRefreshCalling
-#ifdef forceRefreshCalling
-static  Bool  s_stopForceCalling = FALSE;
-#endif
+	Int xBlock, yBlock, edge;
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			const ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			for (edge=0; edge<block.getNumEdges(); edge++) {
+				const ZoneEdge *zoneEdge = block.getEdge(edge);
+				if (zoneEdge->m_relations & ZoneEdge::HIERARCHICAL) {
+					joinZones(m_hierarchicalZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+			}
+		}
+	}
+	flattenZoneTable(m_hierarchicalZones, m_maxZone);
 
+	// Each combiner joins its own zones on top of the hierarchical zones.
+	for (i=0; i<m_zonesAllocated; i++) {
+		m_groundCliffZones[i] = m_groundWaterZones[i] = m_groundRubbleZones[i] = m_terrainZones[i] = m_crusherZones[i] = m_hierarchicalZones[i];
+	}
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			const ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			for (edge=0; edge<block.getNumEdges(); edge++) {
+				const ZoneEdge *zoneEdge = block.getEdge(edge);
+				UnsignedByte relations = zoneEdge->m_relations;
+				if (relations & ZoneEdge::TERRAIN) {
+					joinZones(m_terrainZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+				if (relations & ZoneEdge::CRUSHER) {
+					joinZones(m_crusherZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+				if (relations & ZoneEdge::GROUND_WATER) {
+					joinZones(m_groundWaterZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+				if (relations & ZoneEdge::GROUND_RUBBLE) {
+					joinZones(m_groundRubbleZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+				if (relations & ZoneEdge::GROUND_CLIFF) {
+					joinZones(m_groundCliffZones, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+			}
+		}
+	}
+	flattenZoneTable(m_groundCliffZones, m_maxZone);
+	flattenZoneTable(m_groundWaterZones, m_maxZone);
+	flattenZoneTable(m_groundRubbleZones, m_maxZone);
+	flattenZoneTable(m_terrainZones, m_maxZone);
+	flattenZoneTable(m_crusherZones, m_maxZone);
+}
 
-void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
+/* True if the zone is in one of the ranges. */
+Bool PathfindZoneManager::isInZoneRanges(const ZoneRangeVector &ranges, Int zone)
 {
+	Int i;
+	for (i=0; i<ranges.size(); i++) {
+		if (zone >= ranges[i].m_firstZone && zone < ranges[i].m_firstZone+ranges[i].m_numZones) {
+			return true;
+		}
+	}
+	return false;
+}
 
-#ifdef DEBUG_QPF
-#if defined(DEBUG_LOGGING) 
-	__int64 startTime64;
-	static double timeToUpdate = 0.0f;
-  static double averageTimeToUpdate = 0.0f;
-  static Int updateSamples = 0;
-	__int64 endTime64,freq64;
-	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
-	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
-#endif
-#endif
+/* Before a block is rezoned, record its zones, and the zones outside it that its zones connected to.
+Each contact's m_zone1 is the outside zone, and m_zone2 the zone in the block. */
+void PathfindZoneManager::collectZoneContacts(const IRegion2D &blocks, ZoneRangeVector &oldZones, ZoneEdgeVector &contacts) const
+{
+	Int xBlock, yBlock, edge;
+	for (xBlock=blocks.lo.x; xBlock<=blocks.hi.x; xBlock++) {
+		for (yBlock=blocks.lo.y; yBlock<=blocks.hi.y; yBlock++) {
+			ZoneRange range;
+			range.m_firstZone = m_zoneBlocks[xBlock][yBlock].getFirstZone();
+			range.m_numZones = m_zoneBlocks[xBlock][yBlock].getNumZones();
+			oldZones.push_back(range);
+		}
+	}
 
+	// The blocks' own edges, and the edges the blocks to the right & below keep to them.
+	for (xBlock=blocks.lo.x; xBlock<=blocks.hi.x+1 && xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=blocks.lo.y; yBlock<=blocks.hi.y+1 && yBlock<m_zoneBlockExtent.y; yBlock++) {
+			if (xBlock>blocks.hi.x && yBlock>blocks.hi.y) {
+				continue;
+			}
+			const ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			for (edge=0; edge<block.getNumEdges(); edge++) {
+				const ZoneEdge *zoneEdge = block.getEdge(edge);
+				Bool old1 = isInZoneRanges(oldZones, zoneEdge->m_zone1);
+				Bool old2 = isInZoneRanges(oldZones, zoneEdge->m_zone2);
+				if (old1 == old2) {
+					continue;
+				}
+				ZoneEdge contact = *zoneEdge;
+				if (old1) {
+					contact.m_zone1 = zoneEdge->m_zone2;
+					contact.m_zone2 = zoneEdge->m_zone1;
+				}
+				contacts.push_back(contact);
+			}
+		}
+	}
+}
 
-	m_maxZone = 1;	// we start using zone 0 as a flag.
-	const Int maxZones=24000;
-	zoneStorageType zoneEquivalency[maxZones];
-	Int i, j;
-	for (i=0; i<maxZones; i++) {
-		zoneEquivalency[i] = i;
+/* Repair the equivalency tables after the blocks have been rezoned and their edges recorded again.
+Returns false if a zone may have split, and the tables need rebuilding. */
+Bool PathfindZoneManager::updateZoneTables(const IRegion2D &blocks, const ZoneRangeVector &oldZones, const ZoneEdgeVector &contacts, Int oldMaxZone)
+{
+	if (m_maxZone >= m_zonesAllocated) {
+		return false; // the tables have to grow.
 	}
-	for (i=0; i<=LAYER_LAST; i++) {
-		layers[i].setZone(0);
+	if (!updateZoneTable(m_hierarchicalZones, ZoneEdge::HIERARCHICAL, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
+	}
+	// Each combiner joins its own zones on top of the hierarchical zones.
+	if (!updateZoneTable(m_terrainZones, ZoneEdge::HIERARCHICAL|ZoneEdge::TERRAIN, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
 	}
+	if (!updateZoneTable(m_crusherZones, ZoneEdge::HIERARCHICAL|ZoneEdge::CRUSHER, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
+	}
+	if (!updateZoneTable(m_groundWaterZones, ZoneEdge::HIERARCHICAL|ZoneEdge::GROUND_WATER, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
+	}
+	if (!updateZoneTable(m_groundRubbleZones, ZoneEdge::HIERARCHICAL|ZoneEdge::GROUND_RUBBLE, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
+	}
+	if (!updateZoneTable(m_groundCliffZones, ZoneEdge::HIERARCHICAL|ZoneEdge::GROUND_CLIFF, blocks, oldZones, contacts, oldMaxZone)) {
+		return false;
+	}
+	return true;
+}
 
-	Int xCount = (globalBounds.hi.x-globalBounds.lo.x+1+ZONE_BLOCK_SIZE-1)/ZONE_BLOCK_SIZE;
-	Int yCount = (globalBounds.hi.y-globalBounds.lo.y+1+ZONE_BLOCK_SIZE-1)/ZONE_BLOCK_SIZE;
+/* Repair one equivalency table, where each zone maps to the lowest zone it connects to through edges with
+any of the relations.  Only the edges in and around the rezoned blocks are joined, and only zones that 
+merged, or whose lowest zone was rezoned, are renumbered.  Returns false if a zone that ran through the 
+rezoned blocks no longer connects up around them, as it may have split. */
+Bool PathfindZoneManager::updateZoneTable(zoneStorageType *zoneTable, UnsignedByte relations, const IRegion2D &blocks, 
+	const ZoneRangeVector &oldZones, const ZoneEdgeVector &contacts, Int oldMaxZone)
+{
+	std::vector<zoneStorageType> joined;
+	Bool ok = true;
+	Int xBlock, yBlock, edge;
+	Int i, j;
 
-	Int xBlock, yBlock;
-	for (xBlock = 0; xBlock<xCount; xBlock++) {
+	// Join the zones through the current edges of the rezoned blocks and the blocks around them.
+	IRegion2D around = blocks;
+	if (around.lo.x > 0) {
+		around.lo.x--;
+	}
+	if (around.lo.y > 0) {
+		around.lo.y--;
+	}
+	if (around.hi.x < m_zoneBlockExtent.x-1) {
+		around.hi.x++;
+	}
+	if (around.hi.y < m_zoneBlockExtent.y-1) {
+		around.hi.y++;
+	}
+	for (xBlock=around.lo.x; xBlock<=around.hi.x; xBlock++) {
+		for (yBlock=around.lo.y; yBlock<=around.hi.y; yBlock++) {
+			const ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			for (edge=0; edge<block.getNumEdges(); edge++) {
+				const ZoneEdge *zoneEdge = block.getEdge(edge);
+				if (zoneEdge->m_relations & relations) {
+					joinTrackedZones(m_scratchZones, joined, zoneEdge->m_zone1, zoneEdge->m_zone2);
+				}
+			}
+		}
+	}
+
+	// The outside zones that each zone touched the rezoned blocks with have to still be joined, or the 
+	// zone may have split.
+	Int numContacts = contacts.size();
+	for (i=0; i<numContacts && ok; i++) {
+		if (!(contacts[i].m_relations & relations)) {
+			continue;
+		}
+		for (j=0; j<i; j++) {
+			if ((contacts[j].m_relations & relations) && zoneTable[contacts[j].m_zone1] == zoneTable[contacts[i].m_zone1]) {
+				if (findZone(m_scratchZones, contacts[j].m_zone1) != findZone(m_scratchZones, contacts[i].m_zone1)) {
+					ok = false;
+				}
+				break;
+			}
+		}
+	}
+
+	// Join the zones to the rest of the zones they were already joined to.  If a zone's lowest zone was
+	// rezoned, its first contact stands in for it.
+	std::vector<zoneStorageType> rezonedLowest;
+	std::vector<zoneStorageType> standIns;
+	Int numJoined = joined.size();
+	for (i=0; i<numContacts+numJoined && ok; i++) {
+		zoneStorageType zone;
+		if (i<numContacts) {
+			if (!(contacts[i].m_relations & relations)) {
+				continue;
+			}
+			zone = contacts[i].m_zone1;
+		} else {
+			zone = joined[i-numContacts];
+			if (zone >= oldMaxZone) {
+				continue; // new zone.
+			}
+		}
+		zoneStorageType lowest = zoneTable[zone];
+		if (!isInZoneRanges(oldZones, lowest)) {
+			joinTrackedZones(m_scratchZones, joined, zone, lowest);
+			continue;
+		}
+		for (j=0; j<rezonedLowest.size(); j++) {
+			if (rezonedLowest[j] == lowest) {
+				break;
+			}
+		}
+		if (j == rezonedLowest.size()) {
+			Int contact;
+			for (contact=0; contact<numContacts; contact++) {
+				if ((contacts[contact].m_relations & relations) && zoneTable[contacts[contact].m_zone1] == lowest) {
+					break;
+				}
+			}
+			if (contact == numContacts) {
+				DEBUG_CRASH(("Zone %d has no contacts with the rezoned blocks.", zone));
+				ok = false;
+				break;
+			}
+			rezonedLowest.push_back(lowest);
+			standIns.push_back(contacts[contact].m_zone1);
+		}
+		joinTrackedZones(m_scratchZones, joined, zone, standIns[j]);
+	}
+
+	if (ok) {
+		// Those zones get the next lowest zone instead.  It's the first one up the table.
+		Int numFound = 0;
+		for (i=1; i<oldMaxZone && numFound<rezonedLowest.size(); i++) {
+			if (!isInZoneRanges(oldZones, zoneTable[i]) || isInZoneRanges(oldZones, i)) {
+				continue;
+			}
+			for (j=0; j<rezonedLowest.size(); j++) {
+				if (rezonedLowest[j] == zoneTable[i]) {
+					joinTrackedZones(m_scratchZones, joined, i, standIns[j]);
+					rezonedLowest[j] = UNINITIALIZED_ZONE;	// found.
+					numFound++;
+					break;
+				}
+			}
+		}
+
+		// The scratch table now maps each joined zone to the lowest zone it connects to.  Point the old 
+		// lowest zones at the new ones, and then the rest of the table.
+		std::vector<zoneStorageType> oldLowest(joined.size());
+		for (i=0; i<joined.size(); i++) {
+			oldLowest[i] = zoneTable[joined[i]];
+		}
+		Bool renumber = false;
+		for (i=0; i<joined.size(); i++) {
+			zoneStorageType lowest = findZone(m_scratchZones, joined[i]);
+			if (joined[i] < oldMaxZone && zoneTable[oldLowest[i]] != lowest) {
+				zoneTable[oldLowest[i]] = lowest;
+				renumber = true;
+			}
+		}
+		for (i=0; i<joined.size(); i++) {
+			zoneStorageType lowest = findZone(m_scratchZones, joined[i]);
+			zoneTable[lowest] = lowest;
+		}
+		for (i=oldMaxZone; i<m_maxZone; i++) {
+			zoneTable[i] = findZone(m_scratchZones, i);
+		}
+		if (renumber) {
+			for (i=1; i<oldMaxZone; i++) {
+				zoneTable[i] = zoneTable[zoneTable[i]];
+			}
+		}
+		for (i=0; i<oldZones.size(); i++) {
+			for (j=oldZones[i].m_firstZone; j<oldZones[i].m_firstZone+oldZones[i].m_numZones; j++) {
+				zoneTable[j] = j;
+			}
+		}
+	}
+
+	for (i=0; i<joined.size(); i++) {
+		m_scratchZones[joined[i]] = joined[i];
+	}
+	return ok;
+}
+
+#ifdef _DEBUG
+/* Check the repaired equivalency tables against a full rebuild from every block's edges, and keep the 
+rebuilt ones.  Zone numbers left behind by rezoned blocks aren't used by any cell, so only the zones 
+still in use have to match. */
+void PathfindZoneManager::checkZoneTables(PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds)
+{
+	enum {NUM_TABLES = 6};
+	const char *tableNames[NUM_TABLES] = {"hierarchical", "terrain", "crusher", "ground water", "ground rubble", "ground cliff"};
+	std::vector<zoneStorageType> repaired(NUM_TABLES*m_maxZone);
+	Int table, zone;
+	Int i, j;
+	for (table=0; table<NUM_TABLES; table++) {
+		const zoneStorageType *zoneTable = getZoneTable(table);
+		for (zone=0; zone<m_maxZone; zone++) {
+			repaired[table*m_maxZone+zone] = zoneTable[zone];
+		}
+	}
+
+	calculateZoneTables();
+
+	std::vector<Bool> inUse(m_maxZone, false);
+	for( j=globalBounds.lo.y; j<=globalBounds.hi.y; j++ )	{
+		for( i=globalBounds.lo.x; i<=globalBounds.hi.x; i++ )	{
+			inUse[map[i][j].getZone()] = true;
+		}
+	}
+	for (i=0; i<=LAYER_LAST; i++) {
+		if (!layers[i].isUnused()) {
+			inUse[layers[i].getZone()] = true;
+		}
+	}
+	for (table=0; table<NUM_TABLES; table++) {
+		const zoneStorageType *zoneTable = getZoneTable(table);
+		for (zone=1; zone<m_maxZone; zone++) {
+			if (inUse[zone] && repaired[table*m_maxZone+zone] != zoneTable[zone]) {
+				DEBUG_CRASH(("Repaired %s zone table has %d for zone %d, but the full rebuild has %d.", 
+					tableNames[table], repaired[table*m_maxZone+zone], zone, zoneTable[zone]));
+				break;
+			}
+		}
+	}
+}
+
+/* The equivalency tables in the order checkZoneTables reports them. */
+const zoneStorageType *PathfindZoneManager::getZoneTable(Int table) const
+{
+	switch (table) {
+		case 0: return m_hierarchicalZones;
+		case 1: return m_terrainZones;
+		case 2: return m_crusherZones;
+		case 3: return m_groundWaterZones;
+		case 4: return m_groundRubbleZones;
+		default: return m_groundCliffZones;
+	}
+}
+#endif
+
+/* Zone the cells of one block with fresh zone numbers past m_maxZone, leaving the zones of the 
+other blocks untouched. */
+void PathfindZoneManager::rezoneBlock(PathfindCell **map, Int xBlock, Int yBlock, const IRegion2D &globalBounds)
+{
+	const Int maxBlockZones = ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1;
+	zoneStorageType zoneEquivalency[maxBlockZones];
+	Int collapsedZones[maxBlockZones];
+	Int numZones = 1;	// zone 0 is the unset flag.
+	Int i, j;
+	for (i=0; i<maxBlockZones; i++) {
+		zoneEquivalency[i] = i;
+	}
+
+	IRegion2D bounds;
+	getBlockBounds(xBlock, yBlock, globalBounds, bounds);
+	m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(false);
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			PathfindCell *cell = &map[i][j];
+			cell->setZone(0);
+
+			if (i>bounds.lo.x) {
+				if (map[i][j].getType() == map[i-1][j].getType()) {
+					applyZone(map[i][j], map[i-1][j], zoneEquivalency, numZones);
+				}
+			}
+			if (j>bounds.lo.y) {
+				if (map[i][j].getType() == map[i][j-1].getType()) {
+					applyZone(map[i][j], map[i][j-1], zoneEquivalency, numZones);
+				}
+			}
+			if (cell->getZone()==0) {
+				cell->setZone(numZones);
+				numZones++;
+			}
+			if (cell->getConnectLayer() > LAYER_GROUND) {
+ 				m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(true);
+			}
+		}
+	}
+
+	collapsedZones[0] = 0;
+	for (i=1; i<numZones; i++) {
+		Int zone = zoneEquivalency[i];
+		if (zone == i) {
+			collapsedZones[i] = m_maxZone;
+			++m_maxZone;
+		}	else {
+			collapsedZones[i] = collapsedZones[zone];
+		}
+	}
+
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			map[i][j].setZone(collapsedZones[map[i][j].getZone()]);
+		}
+	}
+}
+
+/**
+ * Calculate zones.  A zone is an area of the same terrain - clear, water or cliff.
+ * The utility of zones is that if current location and destiontion are in the same zone, 
+ * you can successfully pathfind.
+ * If you are a multiple terrain vehicle, like amphibious transport, the lookup is a little more
+ * complicated.
+ */
+
+
+
+#define dont_forceRefreshCalling
+#ifdef forceRefreshCalling
+static  Bool  s_stopForceCalling = FALSE;
+#endif
+
+
+void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
+{
+
+#ifdef DEBUG_QPF
+#if defined(DEBUG_LOGGING) 
+	__int64 startTime64;
+	static double timeToUpdate = 0.0f;
+  static double averageTimeToUpdate = 0.0f;
+  static Int updateSamples = 0;
+	__int64 endTime64,freq64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+#endif
+#endif
+
+
+	m_maxZone = 1;	// we start using zone 0 as a flag.
+	const Int maxZones=24000;
+	zoneStorageType zoneEquivalency[maxZones];
+	Int i, j;
+	for (i=0; i<maxZones; i++) {
+		zoneEquivalency[i] = i;
+	}
+	for (i=0; i<=LAYER_LAST; i++) {
+		layers[i].setZone(0);
+	}
+
+	Int xCount = (globalBounds.hi.x-globalBounds.lo.x+1+ZONE_BLOCK_SIZE-1)/ZONE_BLOCK_SIZE;
+	Int yCount = (globalBounds.hi.y-globalBounds.lo.y+1+ZONE_BLOCK_SIZE-1)/ZONE_BLOCK_SIZE;
+
+	Int xBlock, yBlock;
+	for (xBlock = 0; xBlock<xCount; xBlock++) {
 		for (yBlock=0; yBlock<yCount; yBlock++) {
 			IRegion2D bounds;
 			bounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
@@ -2560,217 +3214,17 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 
 
 
-	// Determine water/ground equivalent zones, and ground/cliff equivalent zones.
-//	for (i=0; i<m_zonesAllocated; i++) {
-//		m_groundCliffZones[i] = i;
-//		m_groundWaterZones[i] = i;
-//		m_groundRubbleZones[i] = i;
-//		m_terrainZones[i] = i;
-//		m_crusherZones[i] = i;
-//		m_hierarchicalZones[i] = i;
-//	}
-	i = 0;
-  while ( i < m_zonesAllocated ) 
-	{
-    m_groundCliffZones[i] = m_groundWaterZones[i] = m_groundRubbleZones[i] = m_terrainZones[i] = m_crusherZones[i] = m_hierarchicalZones[i] = i;
-    i++;
-  }
-
-
-
-
-
-
-//	for( j=globalBounds.lo.y; j<=globalBounds.hi.y; j++ )	{
-//		for( i=globalBounds.lo.x; i<=globalBounds.hi.x; i++ )	{
-//			if ( (map[i][j].getConnectLayer() > LAYER_GROUND) && 
-//				(map[i][j].getType() == PathfindCell::CELL_CLEAR) ) {
-//				PathfindLayer *layer = layers + map[i][j].getConnectLayer();
-//				resolveZones(map[i][j].getZone(), layer->getZone(), m_hierarchicalZones, m_maxZone);
-//			}
-//			if (i>globalBounds.lo.x && map[i][j].getZone()!=map[i-1][j].getZone()) {
-//				if (map[i][j].getType() == map[i-1][j].getType()) {
-//					applyZone(map[i][j], map[i-1][j], m_hierarchicalZones, m_maxZone);
-//				}
-//				if (waterGround(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_groundWaterZones, m_maxZone);
-//				}
-//				if (groundRubble(map[i][j], map[i-1][j])) {
-////					Int zone1 = map[i][j].getZone();
-////					Int zone2 = map[i-1][j].getZone();
-////					if (m_terrainZones[zone1] != m_terrainZones[zone2]) {
-////						//DEBUG_LOG(("Matching terrain zone %d to %d.\n", zone1, zone2));
-////					}
-//					applyZone(map[i][j], map[i-1][j], m_groundRubbleZones, m_maxZone);
-//				}
-//				if (groundCliff(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_groundCliffZones, m_maxZone);
-//				}
-//				if (terrain(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_terrainZones, m_maxZone);
-//				}
-//				if (crusherGround(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_crusherZones, m_maxZone);
-//				}
-//			}
-//			if (j>globalBounds.lo.y && map[i][j].getZone()!=map[i][j-1].getZone()) {
-//				if (map[i][j].getType() == map[i][j-1].getType()) {
-//					applyZone(map[i][j], map[i][j-1], m_hierarchicalZones, m_maxZone);
-//				}
-//				if (waterGround(map[i][j],map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_groundWaterZones, m_maxZone);
-//				}
-//				if (groundRubble(map[i][j], map[i][j-1])) {
-////					Int zone1 = map[i][j].getZone();
-////					Int zone2 = map[i][j-1].getZone();
-////					if (m_terrainZones[zone1] != m_terrainZones[zone2]) {
-////						//DEBUG_LOG(("Matching terrain zone %d to %d.\n", zone1, zone2));
-////					}
-//					applyZone(map[i][j], map[i][j-1], m_groundRubbleZones, m_maxZone);
-//				}
-//				if (groundCliff(map[i][j],map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_groundCliffZones, m_maxZone);
-//				}
-//				if (terrain(map[i][j], map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_terrainZones, m_maxZone);
-//				}
-//				if (crusherGround(map[i][j], map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_crusherZones, m_maxZone);
-//				}
-//			}
-//		//	DEBUG_ASSERTCRASH(map[i][j].getZone() != 0, ("Cleared the zone."));
-//		}
-//	}
-  register UnsignedInt maxZone = m_maxZone;
-	j=globalBounds.lo.y;
-  while( j <= globalBounds.hi.y )	
+	// Record the zone connections of each block, and build the equivalency tables from them.
+	for (xBlock=0; xBlock<xCount; xBlock++) 
   {
-    i=globalBounds.lo.x;
-		while( i <= globalBounds.hi.x )	
+		for (yBlock=0; yBlock<yCount; yBlock++) 
     {
-      PathfindCell &r_thisCell = map[i][j];
-
-			if ( (r_thisCell.getConnectLayer() > LAYER_GROUND) && 
-				(r_thisCell.getType() == PathfindCell::CELL_CLEAR) ) 
-      {
-				PathfindLayer *layer = layers + r_thisCell.getConnectLayer();
-				resolveZones(r_thisCell.getZone(), layer->getZone(), m_hierarchicalZones, maxZone);
-			}
-
-			if ( i > globalBounds.lo.x && r_thisCell.getZone() != map[i-1][j].getZone() ) 
-      {
-        const PathfindCell &r_leftCell = map[i-1][j];
-
-				if (r_thisCell.getType() == r_leftCell.getType()) 
-					applyZone(r_thisCell, r_leftCell, m_hierarchicalZones, maxZone);//if this is true, skip all the ones below
-        else
-        {
-          Bool notTerrainOrCrusher = TRUE; // if this is false, skip the if-else-ladder below 
-
-          if (terrain(r_thisCell, r_leftCell)) 
-          {
-					  applyZone(r_thisCell, r_leftCell, m_terrainZones, maxZone);
-            notTerrainOrCrusher = FALSE;
-          }
-
-          if (crusherGround(r_thisCell, r_leftCell)) 
-          {
-					  applyZone(r_thisCell, r_leftCell, m_crusherZones, maxZone); 
-            notTerrainOrCrusher = FALSE;
-          }
-
-          if ( notTerrainOrCrusher )
-          {
-            if (waterGround(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundWaterZones, maxZone);
-            else if (groundRubble(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundRubbleZones, maxZone);
-            else if (groundCliff(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundCliffZones, maxZone);
-          }
-
-        }
-
-      }
-
-			if (j>globalBounds.lo.y && r_thisCell.getZone()!=map[i][j-1].getZone()) 
-      {
-        const PathfindCell &r_topCell = map[i][j-1];
-
-        if (r_thisCell.getType() == r_topCell.getType()) 
-					applyZone(r_thisCell, r_topCell, m_hierarchicalZones, maxZone);
-        else
-        {
-          Bool notTerrainOrCrusher = TRUE; // if this is false, skip the if-else-ladder below 
-
-          if (terrain(r_thisCell, r_topCell)) 
-          {
-            applyZone(r_thisCell, r_topCell, m_terrainZones, maxZone);
-            notTerrainOrCrusher = FALSE;
-          }
-
-          if (crusherGround(r_thisCell, r_topCell)) 
-          {
-					  applyZone(r_thisCell, r_topCell, m_crusherZones, maxZone);
-            notTerrainOrCrusher = FALSE;
-          }
-
-          if (waterGround(r_thisCell,r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundWaterZones, maxZone);
-          else if (groundRubble(r_thisCell, r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundRubbleZones, maxZone);
-          else if (groundCliff(r_thisCell,r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundCliffZones, maxZone);
-
-        }
-
-      }
-
-//			DEBUG_ASSERTCRASH(r_thisCell.getZone() != 0, ("Cleared the zone."));
-
-      ++i;
+			IRegion2D bounds;
+			getBlockBounds(xBlock, yBlock, globalBounds, bounds);
+			m_zoneBlocks[xBlock][yBlock].blockCalculateEdges(map, layers, bounds, globalBounds);
 		}
-
-    ++j; 
 	}
-
-
-
-
-
-
-
-
-
-//	if (m_maxZone >= m_zonesAllocated) {
-//		RELEASE_CRASH("Pathfind allocation error - fatal. see jba.");
-//	}
-
-//	for (i=1; i<m_maxZone; i++) {
-//		// Flatten hierarchical zones.
-//		Int zone = m_hierarchicalZones[i];
-//		m_hierarchicalZones[i] = m_hierarchicalZones[zone];
-//	}
-  //FLATTEN HIERARCHICAL ZONES
-  {
-	  i = 1;
-    register Int zone;  
-    while ( i < maxZone ) 
-    {		// Flatten hierarchical zones.
-		  zone = m_hierarchicalZones[i];
-		  m_hierarchicalZones[i] = m_hierarchicalZones[ zone ];
-      ++i;
-	  }
-  }
-
-  
-  
-  //THIS BLOCK IS 20% 
-	flattenZones(m_groundCliffZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundWaterZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundRubbleZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_terrainZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_crusherZones, m_hierarchicalZones, m_maxZone);
+	calculateZoneTables();
 
 
 #ifdef DEBUG_QPF
@@ -2826,16 +3280,31 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 	}
 #endif
 	m_nextFrameToCalculateZones = 0xffffffff;
+	m_zoneVersion++;
 }
 
 
 
 /**
  * Update zones where a structure has been added or removed.
- * This can be done by just updating the equivalency arrays, without rezoning the map..
+ * Only the zone blocks under the structure are rezoned, with fresh zone numbers.  The connections 
+ * of those blocks and their right & bottom neighbors are recorded again, and the equivalency 
+ * tables are repaired from the connections in and around those blocks.  The tables are only 
+ * rebuilt from every block's connections when a zone may have been split.
+ * Without IncrementalPathfindZones in GameData.ini, the modified cells are just patched up from 
+ * their neighbors, and markZonesDirty has the whole map rezoned within ZONE_UPDATE_FREQUENCY frames.
  */
 void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds )
 {
+	if (m_zoneBlocks == NULL) {
+		return;
+	}
+	m_zoneVersion++;
+	if (!TheGlobalData->m_incrementalPathfindZones || m_hierarchicalZones == NULL || m_nextFrameToCalculateZones != 0xffffffff) {
+		// The whole map gets zoned shortly, so just patch up the modified cells until then.
+		fillZonesForModify(map, structureBounds, globalBounds);
+		return;
+	}
 
 #ifdef DEBUG_QPF
 #if defined(DEBUG_LOGGING) 
@@ -2846,95 +3315,82 @@ void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer
 	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
 #endif
 #endif
-	IRegion2D bounds = structureBounds;
-	bounds.hi.x++;
-	bounds.hi.y++;
-	if (bounds.hi.x > globalBounds.hi.x) {
-		bounds.hi.x = globalBounds.hi.x;
+	IRegion2D blocks;
+	blocks.lo.x = (structureBounds.lo.x - globalBounds.lo.x)/ZONE_BLOCK_SIZE;
+	blocks.lo.y = (structureBounds.lo.y - globalBounds.lo.y)/ZONE_BLOCK_SIZE;
+	blocks.hi.x = (structureBounds.hi.x - globalBounds.lo.x)/ZONE_BLOCK_SIZE;
+	blocks.hi.y = (structureBounds.hi.y - globalBounds.lo.y)/ZONE_BLOCK_SIZE;
+	if (blocks.lo.x < 0) {
+		blocks.lo.x = 0;
 	}
-	if (bounds.hi.y > globalBounds.hi.y) {
-		bounds.hi.y = globalBounds.hi.y;
+	if (blocks.lo.y < 0) {
+		blocks.lo.y = 0;
+	}
+	if (blocks.hi.x >= m_zoneBlockExtent.x) {
+		blocks.hi.x = m_zoneBlockExtent.x-1;
+	}
+	if (blocks.hi.y >= m_zoneBlockExtent.y) {
+		blocks.hi.y = m_zoneBlockExtent.y-1;
+	}
+	if (blocks.lo.x > blocks.hi.x || blocks.lo.y > blocks.hi.y) {
+		return;
 	}
 
-	Int xBlock, yBlock;
-	for (xBlock = 0; xBlock<m_zoneBlockExtent.x; xBlock++) {
-		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
-			IRegion2D blockBounds;
-			blockBounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
-			blockBounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
-			blockBounds.hi.x = blockBounds.lo.x + ZONE_BLOCK_SIZE - 1; // blockBounds are inclusive.
-			blockBounds.hi.y = blockBounds.lo.y + ZONE_BLOCK_SIZE - 1; // blockBounds are inclusive.
-			if (blockBounds.hi.x > bounds.hi.x) {
-				blockBounds.hi.x = bounds.hi.x;
-			}
-			if (blockBounds.hi.y > bounds.hi.y) {
-				blockBounds.hi.y = bounds.hi.y;
-			}
-			if (blockBounds.lo.x < bounds.lo.x) {
-				blockBounds.lo.x = bounds.lo.x;
-			}
-			if (blockBounds.lo.y < bounds.lo.y) {
-				blockBounds.lo.y = bounds.lo.y;
-			}
-			if (blockBounds.lo.x>blockBounds.hi.x || blockBounds.lo.y>blockBounds.hi.y) {
-				continue;
-			}
-			m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(false);
-			Int i, j;
-			for( j=blockBounds.lo.y; j<=blockBounds.hi.y; j++ )	{
-				for( i=blockBounds.lo.x; i<=blockBounds.hi.x; i++ )	{
-					PathfindCell *cell = &map[i][j];
-					if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+	Int maxNewZones = (blocks.hi.x-blocks.lo.x+1)*(blocks.hi.y-blocks.lo.y+1)*ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE;
+	if (m_maxZone + maxNewZones > MAX_ZONES) {
+		// Out of fresh zone numbers, so renumber the whole map.
+		DEBUG_LOG(("Out of fresh pathfind zones (%d), recalculating all zones.\n", m_maxZone));
+		calculateZones(map, layers, globalBounds);
+		return;
+	}
 
-					if (i>blockBounds.lo.x) {
-						if (map[i][j].getType() == map[i-1][j].getType()) {
-							cell->setZone(map[i-1][j].getZone());
-							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-						}
-					}
-					if (j>blockBounds.lo.y) {
-						if (cell->getType() == map[i][j-1].getType()) {
-							cell->setZone(map[i][j-1].getZone());
-							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-						}
-						if (i<blockBounds.hi.x) {
-							if (typesMatch(*cell, map[i+1][j-1]) &&
-									typesMatch(*cell, map[i+1][j])) {
-								cell->setZone(map[i+1][j-1].getZone());
-								if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-							}
-						}
-					}
-				}
-			}
-			for( j=blockBounds.hi.y; j>=blockBounds.lo.y; j-- )	{
-				for( i=blockBounds.hi.x; i>=blockBounds.lo.x; i-- )	{
-					PathfindCell *cell = &map[i][j];
-					if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-					if (i<blockBounds.hi.x) {
-						if (map[i][j].getType() == map[i+1][j].getType()) {
-							cell->setZone(map[i+1][j].getZone());
-							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-						}
-					}
-					if (j<blockBounds.hi.y) {
-						if (cell->getType() == map[i][j+1].getType()) {
-							cell->setZone(map[i][j+1].getZone());
-							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-						}
-						if (i<blockBounds.hi.x) {
-							if (typesMatch(*cell, map[i+1][j+1]) &&
-									typesMatch(*cell, map[i+1][j])) {
-								cell->setZone(map[i+1][j+1].getZone());
-								if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
-							}
-						}
-					}
-				}
-			}
-			//DEBUG_LOG(("Collapsed zones %d\n", m_maxZone));
- 		}
+	// Remember what the blocks connected to, to repair the equivalency tables afterwards.
+	ZoneRangeVector oldZones;
+	ZoneEdgeVector contacts;
+	collectZoneContacts(blocks, oldZones, contacts);
+	Int oldMaxZone = m_maxZone;
+
+	Int xBlock, yBlock;
+	for (xBlock=blocks.lo.x; xBlock<=blocks.hi.x; xBlock++) {
+		for (yBlock=blocks.lo.y; yBlock<=blocks.hi.y; yBlock++) {
+			rezoneBlock(map, xBlock, yBlock, globalBounds);
+		}
+	}
+	for (xBlock=blocks.lo.x; xBlock<=blocks.hi.x; xBlock++) {
+		for (yBlock=blocks.lo.y; yBlock<=blocks.hi.y; yBlock++) {
+			IRegion2D bounds;
+			getBlockBounds(xBlock, yBlock, globalBounds, bounds);
+			m_zoneBlocks[xBlock][yBlock].blockCalculateZones(map, layers, bounds);
+		}
+	}
+	Int i;
+	for (i=0; i<=LAYER_LAST; i++) {
+		if (!layers[i].isUnused() && !layers[i].isDestroyed()) {
+			ICoord2D ndx;
+			layers[i].getStartCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);	
+			layers[i].getEndCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);	
+		}
+	}
+
+	// The blocks to the right & below record their connections to the rezoned blocks.
+	for (xBlock=blocks.lo.x; xBlock<=blocks.hi.x+1 && xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=blocks.lo.y; yBlock<=blocks.hi.y+1 && yBlock<m_zoneBlockExtent.y; yBlock++) {
+			IRegion2D bounds;
+			getBlockBounds(xBlock, yBlock, globalBounds, bounds);
+			m_zoneBlocks[xBlock][yBlock].blockCalculateEdges(map, layers, bounds, globalBounds);
+		}
+	}
+	if (!updateZoneTables(blocks, oldZones, contacts, oldMaxZone)) {
+		calculateZoneTables();
+	}
+#ifdef _DEBUG
+	else {
+		checkZoneTables(map, layers, globalBounds);
 	}
+#endif
+
 #ifdef DEBUG_QPF
 #if defined(DEBUG_LOGGING) 
 	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
@@ -2982,6 +3438,102 @@ void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer
 
 
 
+/**
+ * Patch up the zones of modified cells from their neighbors, until the whole map is zoned.
+ */
+void PathfindZoneManager::fillZonesForModify(PathfindCell **map, const IRegion2D &structureBounds, const IRegion2D &globalBounds )
+{
+	IRegion2D bounds = structureBounds;
+	bounds.hi.x++;
+	bounds.hi.y++;
+	if (bounds.hi.x > globalBounds.hi.x) {
+		bounds.hi.x = globalBounds.hi.x;
+	}
+	if (bounds.hi.y > globalBounds.hi.y) {
+		bounds.hi.y = globalBounds.hi.y;
+	}
+
+	Int xBlock, yBlock;
+	for (xBlock = 0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			IRegion2D blockBounds;
+			blockBounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
+			blockBounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
+			blockBounds.hi.x = blockBounds.lo.x + ZONE_BLOCK_SIZE - 1; // blockBounds are inclusive.
+			blockBounds.hi.y = blockBounds.lo.y + ZONE_BLOCK_SIZE - 1; // blockBounds are inclusive.
+			if (blockBounds.hi.x > bounds.hi.x) {
+				blockBounds.hi.x = bounds.hi.x;
+			}
+			if (blockBounds.hi.y > bounds.hi.y) {
+				blockBounds.hi.y = bounds.hi.y;
+			}
+			if (blockBounds.lo.x < bounds.lo.x) {
+				blockBounds.lo.x = bounds.lo.x;
+			}
+			if (blockBounds.lo.y < bounds.lo.y) {
+				blockBounds.lo.y = bounds.lo.y;
+			}
+			if (blockBounds.lo.x>blockBounds.hi.x || blockBounds.lo.y>blockBounds.hi.y) {
+				continue;
+			}
+			m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(false);
+			Int i, j;
+			for( j=blockBounds.lo.y; j<=blockBounds.hi.y; j++ )	{
+				for( i=blockBounds.lo.x; i<=blockBounds.hi.x; i++ )	{
+					PathfindCell *cell = &map[i][j];
+					if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+
+					if (i>blockBounds.lo.x) {
+						if (map[i][j].getType() == map[i-1][j].getType()) {
+							cell->setZone(map[i-1][j].getZone());
+							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+						}
+					}
+					if (j>blockBounds.lo.y) {
+						if (cell->getType() == map[i][j-1].getType()) {
+							cell->setZone(map[i][j-1].getZone());
+							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+						}
+						if (i<blockBounds.hi.x) {
+							if (typesMatch(*cell, map[i+1][j-1]) &&
+									typesMatch(*cell, map[i+1][j])) {
+								cell->setZone(map[i+1][j-1].getZone());
+								if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+							}
+						}
+					}
+				}
+			}
+			for( j=blockBounds.hi.y; j>=blockBounds.lo.y; j-- )	{
+				for( i=blockBounds.hi.x; i>=blockBounds.lo.x; i-- )	{
+					PathfindCell *cell = &map[i][j];
+					if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+					if (i<blockBounds.hi.x) {
+						if (map[i][j].getType() == map[i+1][j].getType()) {
+							cell->setZone(map[i+1][j].getZone());
+							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+						}
+					}
+					if (j<blockBounds.hi.y) {
+						if (cell->getType() == map[i][j+1].getType()) {
+							cell->setZone(map[i][j+1].getZone());
+							if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+						}
+						if (i<blockBounds.hi.x) {
+							if (typesMatch(*cell, map[i+1][j+1]) &&
+									typesMatch(*cell, map[i+1][j])) {
+								cell->setZone(map[i+1][j+1].getZone());
+								if (cell->getZone()!=UNINITIALIZED_ZONE) continue;
+							}
+						}
+					}
+				}
+			}
+			//DEBUG_LOG(("Collapsed zones %d\n", m_maxZone));
+ 		}
+	}
+}
+
 //
 // Clear the passable flags.
 //
@@ -3164,36 +3716,619 @@ zoneStorageType PathfindZoneManager::getEffectiveZone( LocomotorSurfaceTypeMask
 		zone = m_crusherZones[zone];
 	}
 
-	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
-			(acceptableSurfaces&LOCOMOTORSURFACE_CLIFF)) {
-		// Locomotors can go on ground & cliff, so use the ground cliff combiner.
-		zone = m_groundCliffZones[zone];
-		return zone; 
+	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
+			(acceptableSurfaces&LOCOMOTORSURFACE_CLIFF)) {
+		// Locomotors can go on ground & cliff, so use the ground cliff combiner.
+		zone = m_groundCliffZones[zone];
+		return zone; 
+	}
+
+	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
+			(acceptableSurfaces&LOCOMOTORSURFACE_WATER)) {
+		// Locomotors can go on ground & water, so use the ground water combiner.
+		zone = m_groundWaterZones[zone];
+		return zone; 
+	}
+
+	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
+			(acceptableSurfaces&LOCOMOTORSURFACE_RUBBLE)) {
+		// Locomotors can go on ground & rubble, so use the ground rubble combiner.
+		zone = m_groundRubbleZones[zone];
+		return zone; 
+	}
+
+	if ( (acceptableSurfaces&LOCOMOTORSURFACE_CLIFF) &&
+			(acceptableSurfaces&LOCOMOTORSURFACE_WATER)) {
+		// Locomotors can go on ground & cliff, so use the ground cliff combiner.
+		DEBUG_CRASH(("Cliff water only locomotor sets not supported yet.")); 
+	}
+	zone = m_hierarchicalZones[zone];
+
+	return zone;
+}
+
+//-------------------- PathfindCache ----------------------------------------
+Bool PathfindCacheKey::isEqual(const PathfindCacheKey &other) const
+{
+	return m_startZone == other.m_startZone &&
+		m_goalRegion.x == other.m_goalRegion.x &&
+		m_goalRegion.y == other.m_goalRegion.y &&
+		m_startLayer == other.m_startLayer &&
+		m_goalLayer == other.m_goalLayer &&
+		m_surfaces == other.m_surfaces &&
+		m_radius == other.m_radius &&
+		m_centerInCell == other.m_centerInCell &&
+		m_crusher == other.m_crusher &&
+		m_isHuman == other.m_isHuman;
+}
+
+PathfindCache::PathfindCache() : m_nextEntry(0), m_zoneVersion(0), m_loaded(false), m_hits(0), m_misses(0)
+{
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		m_entries[i].m_path = NULL;
+	}
+}
+
+PathfindCache::~PathfindCache()
+{
+	reset();
+}
+
+void PathfindCache::reset(void)
+{
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		if (m_entries[i].m_path) {
+			m_entries[i].m_path->deleteInstance();
+			m_entries[i].m_path = NULL;
+		}
+	}
+	m_nextEntry = 0;
+	m_loaded = false;
+}
+
+void PathfindCache::validate(UnsignedInt zoneVersion)
+{
+	if (m_zoneVersion != zoneVersion) {
+		reset();
+		m_zoneVersion = zoneVersion;
+	}
+}
+
+/**
+ * Return the unexpired cached path with the same key whose start is closest to startCell.
+ */
+Path *PathfindCache::findPath(const PathfindCacheKey &key, const ICoord2D &startCell)
+{
+	UnsignedInt frame = TheGameLogic->getFrame();
+	Entry *best = NULL;
+	Int bestDist = START_RANGE+1;
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		Entry *entry = &m_entries[i];
+		if (entry->m_path == NULL) continue;
+		if (frame - entry->m_frame > MAX_AGE) continue;
+		if (!entry->m_key.isEqual(key)) continue;
+		Int dist = IABS(entry->m_startCell.x - startCell.x);
+		if (dist < IABS(entry->m_startCell.y - startCell.y)) {
+			dist = IABS(entry->m_startCell.y - startCell.y);
+		}
+		if (dist < bestDist) {
+			best = entry;
+			bestDist = dist;
+		}
+	}
+	if (best == NULL) {
+		return NULL;
+	}
+	return best->m_path;
+}
+
+/**
+ * Store a copy of the path's optimized nodes, replacing the oldest entry.
+ */
+void PathfindCache::addPath(const PathfindCacheKey &key, const ICoord2D &startCell, Path *path)
+{
+	if (path->getFirstNode() == NULL || path->getBlockedByAlly()) {
+		return;
+	}
+	Entry *entry = &m_entries[m_nextEntry];
+	m_nextEntry++;
+	if (m_nextEntry >= MAX_ENTRIES) {
+		m_nextEntry = 0;
+	}
+	if (entry->m_path) {
+		entry->m_path->deleteInstance();
+	}
+	entry->m_key = key;
+	entry->m_startCell = startCell;
+	entry->m_frame = TheGameLogic->getFrame();
+	entry->m_path = newInstance(Path);
+
+	PathNode *node;
+	for (node = path->getFirstNode(); node; ) {
+		entry->m_path->appendNode(node->getPosition(), node->getLayer());
+		entry->m_path->getLastNode()->setCanOptimize(node->getCanOptimize());
+		PathNode *next = node->getNextOptimized();
+		if (next == NULL) {
+			next = node->getNext();
+		}
+		node = next;
+	}
+}
+
+/**
+ * Save or load the cache.  The paths are saved, so that a loaded game finds the same paths the saved
+ * one goes on to find.  Paths from before the zones last changed are about to be discarded by 
+ * validate(), so they are left out.
+ */
+void PathfindCache::xfer(Xfer *xfer, UnsignedInt zoneVersion, XferVersion version)
+{
+	Bool valid = (m_zoneVersion == zoneVersion);
+	xfer->xferBool(&valid);
+	if (xfer->getXferMode() == XFER_LOAD) {
+		reset();
+		m_loaded = valid;
+	}
+	if (!valid) {
+		return;
+	}
+	xfer->xferInt(&m_nextEntry);
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		Entry *entry = &m_entries[i];
+		Bool hasPath = (entry->m_path != NULL);
+		xfer->xferBool(&hasPath);
+		if (!hasPath) {
+			continue;
+		}
+		if (version >= 4) {
+			xfer->xferUnsignedShort(&entry->m_key.m_startZone);
+			xfer->xferICoord2D(&entry->m_key.m_goalRegion);
+			xfer->xferUser(&entry->m_key.m_startLayer, sizeof(entry->m_key.m_startLayer));
+			xfer->xferUser(&entry->m_key.m_goalLayer, sizeof(entry->m_key.m_goalLayer));
+			xfer->xferInt(&entry->m_key.m_surfaces);
+			xfer->xferInt(&entry->m_key.m_radius);
+			xfer->xferBool(&entry->m_key.m_centerInCell);
+			xfer->xferBool(&entry->m_key.m_crusher);
+			xfer->xferBool(&entry->m_key.m_isHuman);
+		}	else {
+			xfer->xferUser(&entry->m_key, sizeof(PathfindCacheKey));
+		}
+		xfer->xferICoord2D(&entry->m_startCell);
+		xfer->xferUnsignedInt(&entry->m_frame);
+		if (xfer->getXferMode() == XFER_LOAD) {
+			entry->m_path = newInstance(Path);
+		}
+		xfer->xferSnapshot(entry->m_path);
+	}
+}
+
+/**
+ * The zones are calculated again when a game is loaded, and may be numbered differently, so find the
+ * start zone of each loaded path again.  The loaded paths are as valid as they were when saved.
+ */
+void PathfindCache::loadPostProcess(Pathfinder *pathfinder, UnsignedInt zoneVersion)
+{
+	if (!m_loaded) {
+		return;
+	}
+	m_loaded = false;
+	m_zoneVersion = zoneVersion;
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		Entry *entry = &m_entries[i];
+		if (entry->m_path == NULL) {
+			continue;
+		}
+		if (!pathfinder->getCacheStartZone(entry->m_key, entry->m_startCell, entry->m_key.m_startZone)) {
+			DEBUG_CRASH(("Cached path starts off the map."));
+			entry->m_path->deleteInstance();
+			entry->m_path = NULL;
+		}
+	}
+}
+
+//-------------------- PathfindFlowFields ----------------------------------------
+PathfindFlowFields::PathfindFlowFields() : m_nextGoal(0), m_nextField(0), m_zoneVersion(0), m_loaded(false),
+	m_searchField(NULL), m_searchZone(0), m_heap(NULL), m_heapIndex(NULL), m_heapAllocated(0), m_count(0), 
+	m_paths(0), m_fields(0)
+{
+	Int i;
+	for (i=0; i<MAX_GOALS; i++) {
+		m_goals[i].m_frame = 0;
+		m_goals[i].m_goalCell.x = m_goals[i].m_goalCell.y = -1;
+	}
+	for (i=0; i<MAX_FIELDS; i++) {
+		m_fields[i].m_isBuilt = false;
+		m_fields[i].m_costs = NULL;
+		m_fields[i].m_costsAllocated = 0;
+	}
+}
+
+PathfindFlowFields::~PathfindFlowFields()
+{
+	Int i;
+	for (i=0; i<MAX_FIELDS; i++) {
+		if (m_fields[i].m_costs) {
+			delete [] m_fields[i].m_costs;
+			m_fields[i].m_costs = NULL;
+			m_fields[i].m_costsAllocated = 0;
+		}
+	}
+	if (m_heap) {
+		delete [] m_heap;
+		m_heap = NULL;
+	}
+	if (m_heapIndex) {
+		delete [] m_heapIndex;
+		m_heapIndex = NULL;
+	}
+}
+
+void PathfindFlowFields::reset(void)
+{
+	Int i;
+	for (i=0; i<MAX_GOALS; i++) {
+		m_goals[i].m_frame = 0;
+		m_goals[i].m_goalCell.x = m_goals[i].m_goalCell.y = -1;
+	}
+	for (i=0; i<MAX_FIELDS; i++) {
+		m_fields[i].m_isBuilt = false;
+	}
+	m_nextGoal = 0;
+	m_nextField = 0;
+	m_searchField = NULL;
+	m_count = 0;
+	m_loaded = false;
+}
+
+void PathfindFlowFields::validate(UnsignedInt zoneVersion)
+{
+	if (m_zoneVersion != zoneVersion) {
+		Int i;
+		for (i=0; i<MAX_FIELDS; i++) {
+			m_fields[i].m_isBuilt = false;
+		}
+		m_searchField = NULL;
+		m_count = 0;
+		m_zoneVersion = zoneVersion;
+	}
+}
+
+/**
+ * Remember that a large group was ordered to goalCell from inside region.  Replaces the same goal if
+ * it was already ordered, otherwise the oldest goal.
+ */
+void PathfindFlowFields::addGoal(const ICoord2D &goalCell, const IRegion2D &region)
+{
+	Goal *goal = NULL;
+	Int i;
+	for (i=0; i<MAX_GOALS; i++) {
+		if (m_goals[i].m_goalCell.x == goalCell.x && m_goals[i].m_goalCell.y == goalCell.y) {
+			goal = &m_goals[i];
+			break;
+		}
+	}
+	if (goal == NULL) {
+		goal = &m_goals[m_nextGoal];
+		m_nextGoal++;
+		if (m_nextGoal >= MAX_GOALS) {
+			m_nextGoal = 0;
+		}
+	}
+	goal->m_goalCell = goalCell;
+	goal->m_region = region;
+	goal->m_frame = TheGameLogic->getFrame();
+}
+
+/**
+ * Find the newest unexpired group goal within GOAL_RANGE cells of goalCell whose region contains
+ * startCell.
+ */
+Bool PathfindFlowFields::findGoal(const ICoord2D &goalCell, const ICoord2D &startCell,
+																	ICoord2D &fieldGoal, IRegion2D &region) const
+{
+	UnsignedInt frame = TheGameLogic->getFrame();
+	const Goal *best = NULL;
+	Int i;
+	for (i=0; i<MAX_GOALS; i++) {
+		const Goal *goal = &m_goals[i];
+		if (goal->m_goalCell.x < 0) continue;
+		if (frame - goal->m_frame > MAX_AGE) continue;
+		if (IABS(goal->m_goalCell.x - goalCell.x) > GOAL_RANGE) continue;
+		if (IABS(goal->m_goalCell.y - goalCell.y) > GOAL_RANGE) continue;
+		if (startCell.x < goal->m_region.lo.x || startCell.x > goal->m_region.hi.x) continue;
+		if (startCell.y < goal->m_region.lo.y || startCell.y > goal->m_region.hi.y) continue;
+		if (best == NULL || goal->m_frame > best->m_frame) {
+			best = goal;
+		}
+	}
+	if (best == NULL) {
+		return false;
+	}
+	fieldGoal = best->m_goalCell;
+	region = best->m_region;
+	return true;
+}
+
+/**
+ * The built field to goalCell for the locomotion & size in key.
+ */
+PathfindFlowField *PathfindFlowFields::findField(const ICoord2D &goalCell, const PathfindCacheKey &key, Bool isHuman)
+{
+	Int i;
+	for (i=0; i<MAX_FIELDS; i++) {
+		PathfindFlowField *field = &m_fields[i];
+		if (!field->m_isBuilt) continue;
+		if (field->m_goalCell.x != goalCell.x || field->m_goalCell.y != goalCell.y) continue;
+		if (field->m_surfaces != key.m_surfaces || field->m_crusher != key.m_crusher || field->m_isHuman != isHuman) continue;
+		if (field->m_radius != key.m_radius || field->m_centerInCell != key.m_centerInCell) continue;
+		return field;
+	}
+	return NULL;
+}
+
+/**
+ * Returns an unused field, or the oldest one.
+ */
+PathfindFlowField *PathfindFlowFields::allocateField(void)
+{
+	PathfindFlowField *field = NULL;
+	Int i;
+	for (i=0; i<MAX_FIELDS; i++) {
+		if (!m_fields[i].m_isBuilt) {
+			field = &m_fields[i];
+			break;
+		}
+	}
+	if (field == NULL) {
+		field = &m_fields[m_nextField];
+		m_nextField++;
+		if (m_nextField >= MAX_FIELDS) {
+			m_nextField = 0;
+		}
+	}
+	field->m_isBuilt = false;
+	return field;
+}
+
+/**
+ * Make room for the costs of the field's region.  Costs are kept until the pathfinder is destroyed, 
+ * and only grow.
+ */
+void PathfindFlowFields::allocateCosts(PathfindFlowField *field)
+{
+	Int numCells = field->getWidth()*field->getHeight();
+	if (field->m_costsAllocated < numCells) {
+		if (field->m_costs) {
+			delete [] field->m_costs;
+		}
+		field->m_costs = MSGNEW("PathfindFlowField") UnsignedInt[numCells];
+		field->m_costsAllocated = numCells;
+	}
+}
+
+/**
+ * Save or load the goals, and the fields built since the zones last changed.  The field being built
+ * is saved part way, heap & all, so a loaded game finishes it on the same frame the saved game did.
+ */
+void PathfindFlowFields::xfer(Xfer *xfer, UnsignedInt zoneVersion, XferVersion version)
+{
+	Int i;
+	xfer->xferInt(&m_nextGoal);
+	for (i=0; i<MAX_GOALS; i++) {
+		xfer->xferICoord2D(&m_goals[i].m_goalCell);
+		xfer->xferIRegion2D(&m_goals[i].m_region);
+		xfer->xferUnsignedInt(&m_goals[i].m_frame);
+	}
+	xfer->xferInt(&m_nextField);
+
+	Bool valid = (m_zoneVersion == zoneVersion);
+	xfer->xferBool(&valid);
+	if (xfer->getXferMode() == XFER_LOAD) {
+		for (i=0; i<MAX_FIELDS; i++) {
+			m_fields[i].m_isBuilt = false;
+		}
+		m_searchField = NULL;
+		m_count = 0;
+		m_loaded = valid;
+	}
+	if (!valid) {
+		return;
+	}
+	Int searchField = -1;
+	if (version >= 3) {
+		if (m_searchField) {
+			searchField = m_searchField - m_fields;
+		}
+		xfer->xferInt(&searchField);
+		if (searchField < -1 || searchField >= MAX_FIELDS) {
+			DEBUG_CRASH(("Bad flow field being built."));
+			throw SC_INVALID_DATA;
+		}
+	}
+	for (i=0; i<MAX_FIELDS; i++) {
+		PathfindFlowField *field = &m_fields[i];
+		xfer->xferBool(&field->m_isBuilt);
+		if (!field->m_isBuilt && i != searchField) {
+			continue;
+		}
+		xfer->xferICoord2D(&field->m_goalCell);
+		xfer->xferIRegion2D(&field->m_region);
+		xfer->xferUser(&field->m_surfaces, sizeof(field->m_surfaces));
+		xfer->xferInt(&field->m_radius);
+		xfer->xferBool(&field->m_centerInCell);
+		xfer->xferBool(&field->m_crusher);
+		xfer->xferBool(&field->m_isHuman);
+		xfer->xferUnsignedInt(&field->m_frame);
+		Int numCells = field->getWidth()*field->getHeight();
+		if (numCells <= 0 || numCells > MAX_REGION_SIZE*MAX_REGION_SIZE) {
+			DEBUG_CRASH(("Flow field region is too big."));
+			throw SC_INVALID_DATA;
+		}
+		allocateCosts(field);
+		Int j;
+		for (j=0; j<numCells; j++) {
+			xfer->xferUnsignedInt(&field->m_costs[j]);
+		}
+	}
+	if (searchField < 0) {
+		return;
+	}
+
+	// The field being built.
+	xfer->xferUnsignedShort(&m_searchZone);
+	xfer->xferInt(&m_count);
+	PathfindFlowField *field = &m_fields[searchField];
+	Int numCells = field->getWidth()*field->getHeight();
+	if (m_count < 0 || m_count > numCells) {
+		DEBUG_CRASH(("Bad flow field heap."));
+		throw SC_INVALID_DATA;
+	}
+	if (xfer->getXferMode() == XFER_LOAD) {
+		m_searchField = field;
+		allocateHeap(numCells);
+		for (i=0; i<numCells; i++) {
+			m_heapIndex[i] = -1;
+		}
+	}
+	for (i=0; i<m_count; i++) {
+		xfer->xferInt(&m_heap[i]);
+		if (m_heap[i] < 0 || m_heap[i] >= numCells) {
+			DEBUG_CRASH(("Bad flow field heap."));
+			throw SC_INVALID_DATA;
+		}
+		m_heapIndex[m_heap[i]] = i;
+	}
+}
+
+/**
+ * The zones are calculated again when a game is loaded, so the loaded fields are kept until the
+ * zones change from now on.
+ */
+void PathfindFlowFields::loadPostProcess(UnsignedInt zoneVersion)
+{
+	if (m_loaded) {
+		m_zoneVersion = zoneVersion;
+		m_loaded = false;
+	}
+}
+
+/**
+ * Make room in the heap for numCells cells.  Like the costs, it only grows.
+ */
+void PathfindFlowFields::allocateHeap(Int numCells)
+{
+	if (m_heapAllocated < numCells) {
+		if (m_heap) {
+			delete [] m_heap;
+			delete [] m_heapIndex;
+		}
+		m_heap = MSGNEW("PathfindFlowField") Int[numCells];
+		m_heapIndex = MSGNEW("PathfindFlowField") Int[numCells];
+		m_heapAllocated = numCells;
+	}
+}
+
+/**
+ * Empty the heap, and mark every cell of the field unreachable.
+ */
+void PathfindFlowFields::startSearch(PathfindFlowField *field)
+{
+	Int numCells = field->getWidth()*field->getHeight();
+	DEBUG_ASSERTCRASH(numCells <= MAX_REGION_SIZE*MAX_REGION_SIZE, ("Flow field region is too big."));
+	allocateCosts(field);
+	allocateHeap(numCells);
+	m_searchField = field;
+	m_count = 0;
+	Int i;
+	for (i=0; i<numCells; i++) {
+		field->m_costs[i] = PathfindFlowField::UNREACHABLE;
+		m_heapIndex[i] = -1;
+	}
+}
+
+/**
+ * The field being built is done, and can be walked down.
+ */
+void PathfindFlowFields::finishSearch(void)
+{
+	if (m_searchField) {
+		m_searchField->m_isBuilt = true;
+		m_searchField = NULL;
 	}
+	m_count = 0;
+}
 
-	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
-			(acceptableSurfaces&LOCOMOTORSURFACE_WATER)) {
-		// Locomotors can go on ground & water, so use the ground water combiner.
-		zone = m_groundWaterZones[zone];
-		return zone; 
+void PathfindFlowFields::pushCell(Int ndx, UnsignedInt cost)
+{
+	DEBUG_ASSERTCRASH(cost < m_searchField->m_costs[ndx], ("Flow field cost has to go down."));
+	m_searchField->m_costs[ndx] = cost;
+	if (m_heapIndex[ndx] < 0) {
+		place(ndx, m_count);
+		m_count++;
+		siftUp(m_count-1);
+	}	else {
+		siftUp(m_heapIndex[ndx]);
 	}
+}
 
-	if ( (acceptableSurfaces&LOCOMOTORSURFACE_GROUND) &&
-			(acceptableSurfaces&LOCOMOTORSURFACE_RUBBLE)) {
-		// Locomotors can go on ground & rubble, so use the ground rubble combiner.
-		zone = m_groundRubbleZones[zone];
-		return zone; 
+Int PathfindFlowFields::popCell(void)
+{
+	DEBUG_ASSERTCRASH(m_count>0, ("Flow field heap is empty."));
+	Int ndx = m_heap[0];
+	m_heapIndex[ndx] = -1;
+	m_count--;
+	if (m_count > 0) {
+		place(m_heap[m_count], 0);
+		siftDown(0);
 	}
+	return ndx;
+}
 
-	if ( (acceptableSurfaces&LOCOMOTORSURFACE_CLIFF) &&
-			(acceptableSurfaces&LOCOMOTORSURFACE_WATER)) {
-		// Locomotors can go on ground & cliff, so use the ground cliff combiner.
-		DEBUG_CRASH(("Cliff water only locomotor sets not supported yet.")); 
+// Cheapest first, ties to the lower cell index so the search order is the same on every machine.
+#define FLOW_FIELD_LESS(costs, a, b) ((costs)[a] < (costs)[b] || ((costs)[a] == (costs)[b] && (a) < (b)))
+
+void PathfindFlowFields::siftUp(Int ndx)
+{
+	const UnsignedInt *costs = m_searchField->m_costs;
+	Int cellNdx = m_heap[ndx];
+	while (ndx>0) {
+		Int parent = (ndx-1)/2;
+		if (!FLOW_FIELD_LESS(costs, cellNdx, m_heap[parent])) {
+			break;
+		}
+		place(m_heap[parent], ndx);
+		ndx = parent;
 	}
-	zone = m_hierarchicalZones[zone];
+	place(cellNdx, ndx);
+}
 
-	return zone;
+void PathfindFlowFields::siftDown(Int ndx)
+{
+	const UnsignedInt *costs = m_searchField->m_costs;
+	Int cellNdx = m_heap[ndx];
+	for (;;) {
+		Int child = 2*ndx+1;
+		if (child >= m_count) {
+			break;
+		}
+		if (child+1 < m_count && FLOW_FIELD_LESS(costs, m_heap[child+1], m_heap[child])) {
+			child++;
+		}
+		if (!FLOW_FIELD_LESS(costs, m_heap[child], cellNdx)) {
+			break;
+		}
+		place(m_heap[child], ndx);
+		ndx = child;
+	}
+	place(cellNdx, ndx);
 }
+
+#undef FLOW_FIELD_LESS
+
 //-------------------- PathfindLayer ----------------------------------------
 PathfindLayer::PathfindLayer() : m_blockOfMapCells(NULL), m_layerCells(NULL), m_bridge(NULL),
 // Added By Sadullah Nader
@@ -3620,6 +4755,28 @@ Bool PathfindLayer::setDestroyed(Bool destroyed)
 	return true;
 }
 
+/**
+ * Returns the ground cells covered by the layer, including the start & end cells just off the ends.
+ */
+void PathfindLayer::getCellBounds(IRegion2D *bounds)
+{
+	bounds->lo.x = m_xOrigin;
+	bounds->lo.y = m_yOrigin;
+	bounds->hi.x = m_xOrigin + m_width - 1;
+	bounds->hi.y = m_yOrigin + m_height - 1;
+	ICoord2D ends[2];
+	ends[0] = m_startCell;
+	ends[1] = m_endCell;
+	Int i;
+	for (i=0; i<2; i++) {
+		if (ends[i].x < 0 || ends[i].y < 0) continue; // not set.
+		if (bounds->lo.x > ends[i].x) bounds->lo.x = ends[i].x;
+		if (bounds->lo.y > ends[i].y) bounds->lo.y = ends[i].y;
+		if (bounds->hi.x < ends[i].x) bounds->hi.x = ends[i].x;
+		if (bounds->hi.y < ends[i].y) bounds->hi.y = ends[i].y;
+	}
+}
+
 /**
  * Copies m_zone into the zone for all the member cells.
  */
@@ -3829,11 +4986,29 @@ Pathfinder::Pathfinder( void ) :m_map(NULL)
 {
 	debugPath = NULL;
 	PathfindCellInfo::allocateCellInfos();
+	m_openList.allocate(CELL_INFOS_TO_ALLOCATE);
 	reset();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_pathfindBenchmarkFile.isNotEmpty() || TheGlobalData->m_recordPathfindQueriesFile.isNotEmpty()) {
+		DEBUG_ASSERTCRASH(ThePathfindBenchmark == NULL, ("Only one pathfinder may use the benchmark."));
+		ThePathfindBenchmark = NEW PathfindBenchmark;
+		if (TheGlobalData->m_recordPathfindQueriesFile.isNotEmpty()) {
+			ThePathfindBenchmark->startRecording(TheGlobalData->m_recordPathfindQueriesFile);
+		}
+		if (TheGlobalData->m_pathfindBenchmarkFile.isNotEmpty()) {
+			ThePathfindBenchmark->loadQueries(TheGlobalData->m_pathfindBenchmarkFile);
+		}
+	}
+#endif
 }
 
 Pathfinder::~Pathfinder( void )
 {
+	if (ThePathfindBenchmark) {
+		delete ThePathfindBenchmark;
+		ThePathfindBenchmark = NULL;
+	}
 	PathfindCellInfo::releaseCellInfos();
 }
 
@@ -3859,8 +5034,10 @@ void Pathfinder::reset( void )
 	// reset the pathfind grid
 	m_extent.lo.x=m_extent.lo.y=m_extent.hi.x=m_extent.hi.y=0;
 	m_logicalExtent.lo.x=m_logicalExtent.lo.y=m_logicalExtent.hi.x=m_logicalExtent.hi.y=0;
-	m_openList = NULL;
+	m_openList.reset(NULL);
 	m_closedList = NULL;
+	m_pathCache.reset();
+	m_flowFields.reset();
 
 	m_ignoreObstacleID = INVALID_ID;
 	m_isTunneling = false;
@@ -4707,8 +5884,9 @@ void Pathfinder::debugShowSearch(  Bool pathFound  )
 		addIcon(NULL, 0, 0, color);	 // erase.
 	}
 
-	for( s = m_openList; s; s=s->getNextOpen() )
+	for( Int openNdx = 0; openNdx < m_openList.getCount(); openNdx++ )
 	{
+		s = m_openList.getCell(openNdx);
 		// create objects to show path - they decay
 		RGBColor color;
 		color.red = color.green = 0;
@@ -4811,9 +5989,8 @@ Bool Pathfinder::validMovementTerrain( PathfindLayerEnum layer, const Locomotor*
 //
 void Pathfinder::cleanOpenAndClosedLists(void) {
 	Int count = 0;
-	if (m_openList) {
+	if (!m_openList.isEmpty()) {
 		count += PathfindCell::releaseOpenList(m_openList);
-		m_openList = NULL;
 	}		 
 	if (m_closedList) {
 		count += PathfindCell::releaseClosedList(m_closedList);
@@ -5908,6 +7085,13 @@ void Pathfinder::processPathfindQueue(void)
 		return;
 	}
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (ThePathfindBenchmark && ThePathfindBenchmark->isPending() && m_isMapReady) {
+		ThePathfindBenchmark->run(this, TheGlobalData->m_pathfindBenchmarkReportFile);
+		TheGameEngine->setQuitting(TRUE);
+	}
+#endif
+
 	// Get the current logical extent.
 	Region3D terrainExtent;
 	TheTerrainLogic->getExtent( &terrainExtent );
@@ -5921,6 +7105,14 @@ void Pathfinder::processPathfindQueue(void)
 	m_logicalExtent = bounds;
 
 	m_cumulativeCellsAllocated = 0;	// Number of pathfind cells examined.
+	m_openList.clearOperationCount();
+	m_pathCache.clearStats();
+	m_flowFields.clearStats();
+	if (TheGlobalData->m_pathfindFlowFields) {
+		// A flow field being built gets the first share of this frame's cells.
+		m_flowFields.validate(m_zoneManager.getZoneVersion());
+		continueFlowField(FLOW_FIELD_CELLS_PER_FRAME);
+	}
 #ifdef DEBUG_QPF
 	Int pathsFound = 0;
 #endif
@@ -5949,7 +7141,7 @@ void Pathfinder::processPathfindQueue(void)
 		timeToUpdate = ((double)(endTime64-startTime64) / (double)(freq64));
 		if (timeToUpdate>0.01f) 
 		{
-			DEBUG_LOG(("%d Pathfind queue: %d paths, %d cells", TheGameLogic->getFrame(), pathsFound, m_cumulativeCellsAllocated));
+			DEBUG_LOG(("%d Pathfind queue: %d paths, %d cells, %d open list ops, %d cached, %d flow field (%d fields)", TheGameLogic->getFrame(), pathsFound, m_cumulativeCellsAllocated, m_openList.getOperationCount(), m_pathCache.getHits(), m_flowFields.getPaths(), m_flowFields.getFields()));
 			DEBUG_LOG(("Time %f (%f)", timeToUpdate, (::GetTickCount()-startTimeMS)/1000.0f));
 			DEBUG_LOG(("\n"));
 		}
@@ -5998,7 +7190,7 @@ void Pathfinder::checkChangeLayers(PathfindCell *parentCell)
 					newCell->setCostSoFar(parentCell->getCostSoFar()); // same as parent cost
 					newCell->setTotalCost(parentCell->getTotalCost()) ;
 					// insert newCell in open list such that open list is sorted, smallest total path cost first
-					m_openList = newCell->putOnSortedOpenList( m_openList );
+					newCell->putOnSortedOpenList( m_openList );
 
 				}
 			}
@@ -6106,10 +7298,10 @@ struct ExamineCellsStruct
 
 			// if the to was already on the open list, remove it so it can be re-inserted in order
 			if (to->getOpen())
-				d->thePathfinder->m_openList = to->removeFromOpenList( d->thePathfinder->m_openList );
+				to->removeFromOpenList( d->thePathfinder->m_openList );
 
 			// insert to in open list such that open list is sorted, smallest total path cost first
-			d->thePathfinder->m_openList = to->putOnSortedOpenList( d->thePathfinder->m_openList );
+			to->putOnSortedOpenList( d->thePathfinder->m_openList );
 	}
 
 	return 0;	// keep going
@@ -6372,10 +7564,10 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				newCell->removeFromOpenList( m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			newCell->putOnSortedOpenList( m_openList );
 		}
 	return cellCount;
 }
@@ -6395,6 +7587,19 @@ Path *Pathfinder::findPath( Object *obj, const LocomotorSet& locomotorSet, const
 	if (obj && obj->getControllingPlayer() && (obj->getControllingPlayer()->getPlayerType()==PLAYER_COMPUTER)) {
 		isHuman = false; // computer gets to cheat.
 	}
+	if (ThePathfindBenchmark && ThePathfindBenchmark->isRecording()) {
+		ThePathfindBenchmark->recordFindPath(isHuman, locomotorSet, from, rawTo);
+	}
+
+	Path *cachedPath = findCachedPath(obj, locomotorSet, isHuman, from, rawTo);
+	if (cachedPath) {
+		return cachedPath;
+	}
+
+	Path *fieldPath = findFlowFieldPath(obj, locomotorSet, isHuman, from, rawTo);
+	if (fieldPath) {
+		return fieldPath;
+	}
 
 	m_zoneManager.clearPassableFlags();
 	Path *hPat = findHierarchicalPath(isHuman, locomotorSet, from, rawTo, false);
@@ -6406,6 +7611,12 @@ Path *Pathfinder::findPath( Object *obj, const LocomotorSet& locomotorSet, const
 
 	Path *pat = internalFindPath(obj, locomotorSet, from, rawTo);
 	if (pat!=NULL) {
+		PathfindCacheKey key;
+		ICoord2D startCell, goalCell;
+		if (TheGlobalData->m_pathfindCache && 
+			getPathCacheKey(obj, locomotorSet, isHuman, from, rawTo, key, startCell, goalCell)) {
+			m_pathCache.addPath(key, startCell, pat);
+		}
 		return pat;
 	}
 
@@ -6455,6 +7666,489 @@ Path *Pathfinder::findPath( Object *obj, const LocomotorSet& locomotorSet, const
 */
 	return NULL; 
 }
+/**
+ * Build the path cache key for a findPath request, the same way internalFindPath sets up its search.
+ * Returns false if the request can't share paths - tunneling, ignoring an obstacle, or moving into 
+ * a building.
+ */
+Bool Pathfinder::getPathCacheKey( const Object *obj, const LocomotorSet& locomotorSet, Bool isHuman, 
+																 const Coord3D *from, const Coord3D *rawTo, PathfindCacheKey &key, 
+																 ICoord2D &startCell, ICoord2D &goalCell )
+{
+	if (!m_isMapReady || m_ignoreObstacleID != INVALID_ID) {
+		return false;
+	}
+	if (rawTo->x == 0.0f && rawTo->y == 0.0f) {
+		return false;
+	}
+	Bool centerInCell = true;
+	Int radius = 0;
+	if (obj) {
+		getRadiusAndCenter(obj, radius, centerInCell);
+	}
+
+	Coord3D adjustTo = *rawTo;
+	Coord3D clipFrom = *from;
+	clip(&clipFrom, &adjustTo);
+	if (!centerInCell) {
+		adjustTo.x += PATHFIND_CELL_SIZE_F/2;
+		adjustTo.y += PATHFIND_CELL_SIZE_F/2;
+	}
+
+	PathfindLayerEnum destinationLayer = TheTerrainLogic->getLayerForDestination(&adjustTo);
+	PathfindCell *goal = getCell( destinationLayer, &adjustTo );
+	PathfindLayerEnum layer = LAYER_GROUND;
+	if (obj) {
+		layer = obj->getLayer();
+	}
+	PathfindCell *start = getClippedCell( layer, &clipFrom );
+	if (goal == NULL || start == NULL) {
+		return false;
+	}
+	if (start->getType() == PathfindCell::CELL_OBSTACLE || goal->getType() == PathfindCell::CELL_OBSTACLE) {
+		return false;
+	}
+	worldToCell(&adjustTo, &goalCell);
+	worldToCell(&clipFrom, &startCell);
+
+	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
+	key.m_startZone = m_zoneManager.getEffectiveZone(locomotorSet.getValidSurfaces(), isCrusher, start->getZone());
+	key.m_goalRegion.x = goalCell.x/PathfindCache::GOAL_REGION_SIZE;
+	key.m_goalRegion.y = goalCell.y/PathfindCache::GOAL_REGION_SIZE;
+	key.m_startLayer = layer;
+	key.m_goalLayer = destinationLayer;
+	key.m_surfaces = locomotorSet.getValidSurfaces();
+	key.m_radius = radius;
+	key.m_centerInCell = centerInCell;
+	key.m_crusher = isCrusher;
+	key.m_isHuman = isHuman;
+	return true;
+}
+
+/**
+ * The effective zone of a cached path's start cell, as getPathCacheKey found it.  False if the cell is
+ * off the map.
+ */
+Bool Pathfinder::getCacheStartZone(const PathfindCacheKey &key, const ICoord2D &startCell, zoneStorageType &zone)
+{
+	PathfindCell *start = getCell(key.m_startLayer, startCell.x, startCell.y);
+	if (start == NULL) {
+		return false;
+	}
+	zone = m_zoneManager.getEffectiveZone(key.m_surfaces, key.m_crusher, start->getZone());
+	return true;
+}
+
+/**
+ * Look for a recently found path for a nearby unit with the same locomotion, going to the same 
+ * place.  If the start can see one of the first nodes of that path, and one of the last nodes can 
+ * see the goal, join them into a new path instead of searching.
+ */
+Path *Pathfinder::findCachedPath( Object *obj, const LocomotorSet& locomotorSet, Bool isHuman, 
+																	const Coord3D *from, const Coord3D *rawTo )
+{
+	const Int MAX_JOIN_NODES = 3;	// Nodes at each end of the cached path that we try to join to.
+
+	if (!TheGlobalData->m_pathfindCache) {
+		return NULL;
+	}
+	m_pathCache.validate(m_zoneManager.getZoneVersion());
+
+	PathfindCacheKey key;
+	ICoord2D startCell, goalCell;
+	if (!getPathCacheKey(obj, locomotorSet, isHuman, from, rawTo, key, startCell, goalCell)) {
+		return NULL;
+	}
+	Path *cachedPath = m_pathCache.findPath(key, startCell);
+	if (cachedPath == NULL) {
+		m_pathCache.countLookup(false);
+		return NULL;
+	}
+
+	// Same checks internalFindPath does on the destination.
+	if (!checkDestination(obj, goalCell.x, goalCell.y, key.m_goalLayer, key.m_radius, key.m_centerInCell) ||
+		!validMovementPosition( key.m_crusher, key.m_goalLayer, locomotorSet, goalCell.x, goalCell.y )) {
+		m_pathCache.countLookup(false);
+		return NULL;
+	}
+	Coord3D goalPos;
+	adjustCoordToCell(goalCell.x, goalCell.y, key.m_centerInCell, goalPos, key.m_goalLayer);
+
+	LocomotorSurfaceTypeMask surfaces = locomotorSet.getValidSurfaces();
+	PathNode *startJoin = NULL;
+	PathNode *node;
+	Int count;
+	for (node = cachedPath->getFirstNode()->getNext(), count = 0; node && count < MAX_JOIN_NODES; node = node->getNext(), count++) {
+		if (node->getLayer() == key.m_startLayer &&
+			isLinePassable(obj, surfaces, key.m_startLayer, *from, *node->getPosition(), false, false)) {
+			startJoin = node;
+			break;
+		}
+	}
+	if (startJoin == NULL) {
+		m_pathCache.countLookup(false);
+		return NULL;
+	}
+	PathNode *goalJoin = NULL;
+	for (node = cachedPath->getLastNode(), count = 0; node && count < MAX_JOIN_NODES; node = node->getPrevious(), count++) {
+		if (node->getLayer() == key.m_goalLayer &&
+			isLinePassable(obj, surfaces, key.m_goalLayer, *node->getPosition(), goalPos, false, false)) {
+			goalJoin = node;
+			break;
+		}
+		if (node == startJoin) {
+			break; // don't go back past the start.
+		}
+	}
+	if (goalJoin == NULL) {
+		m_pathCache.countLookup(false);
+		return NULL;
+	}
+	// The cached path went around the units in the way of whoever found it, so check it clears the 
+	// units in our way too.
+	for (node = startJoin; node != goalJoin; node = node->getNext()) {
+		PathfindLayerEnum layer = node->getLayer();
+		if (layer == LAYER_GROUND) {
+			layer = node->getNext()->getLayer();
+		}
+		if (!isLinePassable(obj, surfaces, layer, *node->getPosition(), *node->getNext()->getPosition(), false, true)) {
+			m_pathCache.countLookup(false);
+			return NULL;
+		}
+	}
+
+	// Every segment is already known to be passable, so the new path is optimized as built.
+	Path *path = newInstance(Path);
+	path->prependNode(&goalPos, key.m_goalLayer);
+	for (node = goalJoin; node; node = node->getPrevious()) {
+		const Coord3D *pos = node->getPosition();
+		const Coord3D *nextPos = path->getFirstNode()->getPosition();
+		if (pos->x != nextPos->x || pos->y != nextPos->y) {
+			path->prependNode(pos, node->getLayer());
+			path->getFirstNode()->setCanOptimize(node->getCanOptimize());
+		}
+		if (node == startJoin) {
+			break;
+		}
+	}
+	if (from->x != path->getFirstNode()->getPosition()->x || from->y != path->getFirstNode()->getPosition()->y) {
+		path->prependNode(from, key.m_startLayer);
+	}
+	for (node = path->getFirstNode(); node; node = node->getNext()) {
+		node->setNextOptimized(node->getNext());
+	}
+	path->markOptimized();
+	m_pathCache.countLookup(true);
+	return path;
+}
+
+/**
+ * A large group was ordered to goal.  Their path requests walk down a flow field covering the cells
+ * around the group & goal, instead of each searching.
+ */
+void Pathfinder::requestFlowField(const Coord3D *goal, const IRegion2D &groupCells)
+{
+	if (!m_isMapReady || !TheGlobalData->m_pathfindFlowFields) {
+		return;
+	}
+	ICoord2D goalCell;
+	worldToCell(goal, &goalCell);
+	if (goalCell.x < m_extent.lo.x || goalCell.y < m_extent.lo.y ||
+		goalCell.x > m_extent.hi.x || goalCell.y > m_extent.hi.y) {
+		return;
+	}
+	IRegion2D region = groupCells;
+	if (region.lo.x > goalCell.x) region.lo.x = goalCell.x;
+	if (region.lo.y > goalCell.y) region.lo.y = goalCell.y;
+	if (region.hi.x < goalCell.x) region.hi.x = goalCell.x;
+	if (region.hi.y < goalCell.y) region.hi.y = goalCell.y;
+	region.lo.x -= PathfindFlowFields::REGION_MARGIN;
+	region.lo.y -= PathfindFlowFields::REGION_MARGIN;
+	region.hi.x += PathfindFlowFields::REGION_MARGIN;
+	region.hi.y += PathfindFlowFields::REGION_MARGIN;
+	if (region.lo.x < m_extent.lo.x) region.lo.x = m_extent.lo.x;
+	if (region.lo.y < m_extent.lo.y) region.lo.y = m_extent.lo.y;
+	if (region.hi.x > m_extent.hi.x) region.hi.x = m_extent.hi.x;
+	if (region.hi.y > m_extent.hi.y) region.hi.y = m_extent.hi.y;
+	if (region.hi.x - region.lo.x >= PathfindFlowFields::MAX_REGION_SIZE ||
+		region.hi.y - region.lo.y >= PathfindFlowFields::MAX_REGION_SIZE) {
+		return; // Too spread out, search for each unit.
+	}
+	m_flowFields.addGoal(goalCell, region);
+}
+
+/**
+ * The cost of stepping from fromCell to the adjacent toCell, using the same rules & terrain costs
+ * as examineNeighboringCells.  Units and turns are left out, as the field is shared by the group, 
+ * so each unit checks the units in its own way as it walks down the field.
+ */
+UnsignedInt Pathfinder::flowFieldStepCost( const PathfindFlowField *field, PathfindCell *fromCell, PathfindCell *toCell )
+{
+	if (!validMovementPosition(field->m_crusher, field->m_surfaces, toCell, fromCell)) {
+		return PathfindFlowField::UNREACHABLE;
+	}
+	Int dx = toCell->getXIndex() - fromCell->getXIndex();
+	Int dy = toCell->getYIndex() - fromCell->getYIndex();
+	UnsignedInt cost = COST_ORTHOGONAL;
+	if (dx != 0 && dy != 0) {
+		// make sure one of the adjacent sides is open.
+		PathfindCell *side1 = getCell(LAYER_GROUND, fromCell->getXIndex()+dx, fromCell->getYIndex());
+		PathfindCell *side2 = getCell(LAYER_GROUND, fromCell->getXIndex(), fromCell->getYIndex()+dy);
+		if (!validMovementPosition(field->m_crusher, field->m_surfaces, side1, fromCell) &&
+			!validMovementPosition(field->m_crusher, field->m_surfaces, side2, fromCell)) {
+			return PathfindFlowField::UNREACHABLE;
+		}
+		cost = COST_DIAGONAL;
+	}
+	// The field's unit size has to stay on the map, as checkForMovement requires.
+	Int numCellsAbove = field->m_radius;
+	if (field->m_centerInCell) numCellsAbove++;
+	if (toCell->getXIndex()-field->m_radius < m_extent.lo.x || toCell->getXIndex()+numCellsAbove-1 > m_extent.hi.x ||
+		toCell->getYIndex()-field->m_radius < m_extent.lo.y || toCell->getYIndex()+numCellsAbove-1 > m_extent.hi.y) {
+		return PathfindFlowField::UNREACHABLE;
+	}
+	if (toCell->getPinched()) {
+		cost += COST_DIAGONAL;
+	}
+	if (toCell->getType() == PathfindCell::CELL_CLIFF && !toCell->getPinched() ) {
+		Real fromZ = TheTerrainLogic->getGroundHeight(fromCell->getXIndex()*PATHFIND_CELL_SIZE_F, fromCell->getYIndex()*PATHFIND_CELL_SIZE_F);
+		Real toZ = TheTerrainLogic->getGroundHeight(toCell->getXIndex()*PATHFIND_CELL_SIZE_F, toCell->getYIndex()*PATHFIND_CELL_SIZE_F);
+		if ( fabs(fromZ - toZ)<PATHFIND_CELL_SIZE_F) {
+			cost += 7*COST_DIAGONAL;
+		}
+	} else if (toCell->getPinched()) {
+		cost += COST_ORTHOGONAL;
+	}
+	return cost;
+}
+
+/**
+ * Start a search outward from the field's goal.  continueFlowField carries it on over the following
+ * frames.
+ */
+void Pathfinder::startFlowField( PathfindFlowField *field )
+{
+	m_flowFields.startSearch(field);
+	m_flowFields.countField();
+	field->m_frame = TheGameLogic->getFrame();
+
+	PathfindCell *goalCell = getCell(LAYER_GROUND, field->m_goalCell.x, field->m_goalCell.y);
+	if (goalCell == NULL || !field->contains(field->m_goalCell.x, field->m_goalCell.y) ||
+		!validMovementPosition(field->m_crusher, field->m_surfaces, goalCell)) {
+		m_flowFields.finishSearch(); // Nothing can reach it.
+		return;
+	}
+	m_flowFields.setSearchZone(m_zoneManager.getEffectiveZone(field->m_surfaces, field->m_crusher, goalCell->getZone()));
+	m_flowFields.pushCell(field->getIndex(field->m_goalCell.x, field->m_goalCell.y), 0);
+}
+
+/**
+ * Carry on the search out from the goal of the field being built, over the ground cells of its 
+ * region that are in the goal's zone, recording the cheapest cost to the goal from each.  Stops after
+ * maxCells cells, or when the field is done.
+ */
+void Pathfinder::continueFlowField( Int maxCells )
+{
+	static const ICoord2D delta[] =
+	{
+		{ 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 },
+		{ 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 }
+	};
+	const Int numNeighbors = 8;
+
+	PathfindFlowField *field = m_flowFields.getSearchField();
+	if (field == NULL) {
+		return;
+	}
+	zoneStorageType zone = m_flowFields.getSearchZone();
+
+	Int width = field->getWidth();
+	Int cellCount = 0;
+	while (!m_flowFields.isSearchDone() && cellCount < maxCells) {
+		Int ndx = m_flowFields.popCell();
+		cellCount++;
+		UnsignedInt cost = field->m_costs[ndx];
+		Int x = field->m_region.lo.x + ndx%width;
+		Int y = field->m_region.lo.y + ndx/width;
+		PathfindCell *cell = getCell(LAYER_GROUND, x, y);
+		Int i;
+		for (i=0; i<numNeighbors; i++) {
+			Int newX = x + delta[i].x;
+			Int newY = y + delta[i].y;
+			if (!field->contains(newX, newY)) {
+				continue;
+			}
+			Int newNdx = field->getIndex(newX, newY);
+			if (field->m_costs[newNdx] <= cost) {
+				continue; // already done, or can't get cheaper.
+			}
+			PathfindCell *newCell = getCell(LAYER_GROUND, newX, newY);
+			if (newCell == NULL) {
+				continue;
+			}
+			if (m_zoneManager.getEffectiveZone(field->m_surfaces, field->m_crusher, newCell->getZone()) != zone) {
+				continue;
+			}
+			// Units move from newCell to cell.
+			UnsignedInt stepCost = flowFieldStepCost(field, newCell, cell);
+			if (stepCost == PathfindFlowField::UNREACHABLE) {
+				continue;
+			}
+			if (cost + stepCost < field->m_costs[newNdx]) {
+				m_flowFields.pushCell(newNdx, cost + stepCost);
+			}
+		}
+	}
+	m_cumulativeCellsAllocated += cellCount;
+	if (m_flowFields.isSearchDone()) {
+		m_flowFields.finishSearch();
+	}
+}
+
+/**
+ * If a large group was just ordered to near rawTo, walk down the group's flow field from the start
+ * cell until the unit's own goal is in sight.  Only ground layer moves use flow fields.  Until the 
+ * field is built, the group's units search as usual.
+ */
+Path *Pathfinder::findFlowFieldPath( Object *obj, const LocomotorSet& locomotorSet, Bool isHuman,
+																		const Coord3D *from, const Coord3D *rawTo )
+{
+	static const ICoord2D delta[] =
+	{
+		{ 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 },
+		{ 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 }
+	};
+	const Int numNeighbors = 8;
+
+	if (!TheGlobalData->m_pathfindFlowFields || locomotorSet.isDownhillOnly()) {
+		return NULL;
+	}
+	m_flowFields.validate(m_zoneManager.getZoneVersion());
+
+	PathfindCacheKey key;
+	ICoord2D startCell, goalCell;
+	if (!getPathCacheKey(obj, locomotorSet, isHuman, from, rawTo, key, startCell, goalCell)) {
+		return NULL;
+	}
+	if (key.m_startLayer != LAYER_GROUND || key.m_goalLayer != LAYER_GROUND) {
+		return NULL;
+	}
+	ICoord2D fieldGoal;
+	IRegion2D region;
+	if (!m_flowFields.findGoal(goalCell, startCell, fieldGoal, region)) {
+		return NULL;
+	}
+	PathfindFlowField *field = m_flowFields.findField(fieldGoal, key, isHuman);
+	if (field == NULL) {
+		if (m_flowFields.getSearchField()) {
+			return NULL; // One field at a time.
+		}
+		if (isHuman) {
+			// Humans have to stay on the logical map.
+			if (region.lo.x < m_logicalExtent.lo.x) region.lo.x = m_logicalExtent.lo.x;
+			if (region.lo.y < m_logicalExtent.lo.y) region.lo.y = m_logicalExtent.lo.y;
+			if (region.hi.x > m_logicalExtent.hi.x) region.hi.x = m_logicalExtent.hi.x;
+			if (region.hi.y > m_logicalExtent.hi.y) region.hi.y = m_logicalExtent.hi.y;
+			if (region.lo.x > region.hi.x || region.lo.y > region.hi.y) {
+				return NULL;
+			}
+		}
+		field = m_flowFields.allocateField();
+		field->m_goalCell = fieldGoal;
+		field->m_region = region;
+		field->m_surfaces = key.m_surfaces;
+		field->m_radius = key.m_radius;
+		field->m_centerInCell = key.m_centerInCell;
+		field->m_crusher = key.m_crusher;
+		field->m_isHuman = isHuman;
+		startFlowField(field);
+		return NULL;
+	}
+	if (field->getCost(startCell.x, startCell.y) == PathfindFlowField::UNREACHABLE) {
+		return NULL;
+	}
+
+	// Same checks internalFindPath does on the destination.
+	if (!checkDestination(obj, goalCell.x, goalCell.y, LAYER_GROUND, key.m_radius, key.m_centerInCell) ||
+		!validMovementPosition( key.m_crusher, LAYER_GROUND, locomotorSet, goalCell.x, goalCell.y )) {
+		return NULL;
+	}
+	Coord3D goalPos;
+	adjustCoordToCell(goalCell.x, goalCell.y, key.m_centerInCell, goalPos, LAYER_GROUND);
+
+	Path *path = newInstance(Path);
+	path->appendNode(from, LAYER_GROUND);
+	ICoord2D cellNdx = startCell;
+	PathfindCell *cell = getCell(LAYER_GROUND, cellNdx.x, cellNdx.y);
+	Coord3D pos = *from;
+	Bool joined = false;
+	for (;;) {
+		if (IABS(cellNdx.x - goalCell.x) <= PathfindFlowFields::GOAL_RANGE &&
+			IABS(cellNdx.y - goalCell.y) <= PathfindFlowFields::GOAL_RANGE &&
+			isLinePassable(obj, key.m_surfaces, LAYER_GROUND, pos, goalPos, false, false)) {
+			joined = true;
+			break;
+		}
+		UnsignedInt cost = field->getCost(cellNdx.x, cellNdx.y);
+		if (cost == 0) {
+			break; // At the group goal, and our goal isn't in sight.
+		}
+		// Step to the neighbor the field was reached from.
+		PathfindCell *nextCell = NULL;
+		UnsignedInt bestCost = cost;
+		Int i;
+		for (i=0; i<numNeighbors; i++) {
+			UnsignedInt newCost = field->getCost(cellNdx.x + delta[i].x, cellNdx.y + delta[i].y);
+			if (newCost >= bestCost) {
+				continue;
+			}
+			PathfindCell *newCell = getCell(LAYER_GROUND, cellNdx.x + delta[i].x, cellNdx.y + delta[i].y);
+			UnsignedInt stepCost = flowFieldStepCost(field, cell, newCell);
+			if (stepCost == PathfindFlowField::UNREACHABLE || newCost + stepCost > cost) {
+				continue;
+			}
+			// Our own way around the units that aren't moving, as examineNeighboringCells does.
+			TCheckMovementInfo info;
+			info.cell.x = newCell->getXIndex();
+			info.cell.y = newCell->getYIndex();
+			info.layer = LAYER_GROUND;
+			info.centerInCell = key.m_centerInCell;
+			info.radius = key.m_radius;
+			info.considerTransient = false;
+			info.acceptableSurfaces = key.m_surfaces;
+			if (!checkForMovement(obj, info) || info.enemyFixed) {
+				continue;
+			}
+			nextCell = newCell;
+			bestCost = newCost;
+		}
+		if (nextCell == NULL) {
+			break;
+		}
+		adjustCoordToCell(nextCell->getXIndex(), nextCell->getYIndex(), key.m_centerInCell, pos, LAYER_GROUND);
+		path->appendNode(&pos, LAYER_GROUND);
+		// Don't optimize across the edge of a cliff, same as prependCells.
+		if (cell->getType() == PathfindCell::CELL_CLIFF && nextCell->getType() != PathfindCell::CELL_CLIFF) {
+			path->getLastNode()->setCanOptimize(false);
+		} else if (cell->getType() != PathfindCell::CELL_CLIFF && nextCell->getType() == PathfindCell::CELL_CLIFF) {
+			path->getLastNode()->getPrevious()->setCanOptimize(false);
+		}
+		cell = nextCell;
+		cellNdx.x = cell->getXIndex();
+		cellNdx.y = cell->getYIndex();
+	}
+	if (!joined) {
+		path->deleteInstance();
+		return NULL;
+	}
+	if (pos.x != goalPos.x || pos.y != goalPos.y) {
+		path->appendNode(&goalPos, LAYER_GROUND);
+	}
+	path->optimize(obj, key.m_surfaces, false);
+	m_flowFields.countPath();
+	return path;
+}
+
 /**
  * Find a short, valid path between given locations.
  * Uses A* algorithm.
@@ -6485,7 +8179,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -6599,7 +8293,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -6610,11 +8304,11 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		if (parentCell == goalCell)
 		{
@@ -6999,7 +8693,7 @@ struct GroundCellsStruct
 			to->setTotalCost(to->getCostSoFar() + costRemaining) ;
 
 			// insert to in open list such that open list is sorted, smallest total path cost first
-			d->thePathfinder->m_openList = to->putOnSortedOpenList( d->thePathfinder->m_openList );
+			to->putOnSortedOpenList( d->thePathfinder->m_openList );
 	}
 
 	return 0;	// keep going
@@ -7016,6 +8710,9 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 #ifdef DEBUG_LOGGING
 	Int startTimeMS = ::GetTickCount();
 #endif
+	if (ThePathfindBenchmark && ThePathfindBenchmark->isRecording()) {
+		ThePathfindBenchmark->recordGroundPath(from, rawTo, pathDiameter, crusher);
+	}
 #ifdef INTENSE_DEBUG
 	DEBUG_LOG(("Find ground path..."));
 #endif	
@@ -7035,7 +8732,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -7122,7 +8819,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -7132,11 +8829,11 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 	// until goal is found.
 	//
 	Int cellCount = 0;
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		if (parentCell == goalCell)
 		{
@@ -7289,10 +8986,10 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				newCell->removeFromOpenList( m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			newCell->putOnSortedOpenList( m_openList );
 		}
 
 
@@ -7430,7 +9127,7 @@ void Pathfinder::processHierarchicalCell( const ICoord2D &scanCell, const ICoord
 			adjNewCell->setTotalCost(adjNewCell->getCostSoFar()+remCost);
 			adjNewCell->setParentCellHierarchical(parentCell);
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = adjNewCell->putOnSortedOpenList( m_openList );
+			adjNewCell->putOnSortedOpenList( m_openList );
 		}
 
 	}
@@ -7476,7 +9173,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -7551,9 +9248,9 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 
 	if (parentCell->getLayer()==LAYER_GROUND) {
 		// initialize "open" list to contain start cell
-		m_openList = parentCell;
+		m_openList.reset(parentCell);
 	}	else {
-		m_openList = parentCell;
+		m_openList.reset(parentCell);
 		PathfindLayerEnum layer = parentCell->getLayer();
 		// We're starting on a bridge, so link to land at the bridge end points.
 		ICoord2D ndx;
@@ -7564,7 +9261,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		PathfindCell *startCell = getCell(LAYER_GROUND, ndx.x, ndx.y);
 		if (cell && startCell) {
 			// Close parent cell;
-			m_openList = parentCell->removeFromOpenList(m_openList);
+			parentCell->removeFromOpenList( m_openList );
 			m_closedList = parentCell->putOnClosedList(m_closedList);
 			startCell->allocateInfo(ndx);
 			startCell->setParentCellHierarchical(parentCell);
@@ -7575,7 +9272,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 			startCell->setTotalCost(remCost);
 			startCell->setParentCellHierarchical(parentCell);
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = startCell->putOnSortedOpenList( m_openList );
+			startCell->putOnSortedOpenList( m_openList );
 
 			cellCount++;
 			cell->allocateInfo(toNdx);
@@ -7585,7 +9282,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 			cell->setTotalCost(remCost);
 			cell->setParentCellHierarchical(parentCell);
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = cell->putOnSortedOpenList( m_openList );
+			cell->putOnSortedOpenList( m_openList );
 		}
 	}
 
@@ -7596,11 +9293,11 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		zoneStorageType parentZone;
 		if (parentCell->getLayer()==LAYER_GROUND) {
@@ -7679,7 +9376,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 					cell->setTotalCost(cell->getCostSoFar()+remCost);
 					cell->setParentCellHierarchical(startCell);
 					// insert newCell in open list such that open list is sorted, smallest total path cost first
-					m_openList = cell->putOnSortedOpenList( m_openList );
+					cell->putOnSortedOpenList( m_openList );
 
 				}
 			}
@@ -8198,7 +9895,7 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 
 	Coord3D adjustTo = *groupDest;
 	Coord3D *to = &adjustTo;
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -8257,7 +9954,7 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -8266,11 +9963,11 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		Coord3D pos;
 		// put parent cell onto closed list - its evaluation is finished
@@ -8393,10 +10090,10 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				newCell->removeFromOpenList( m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			newCell->putOnSortedOpenList( m_openList );
 		}
 	}
 
@@ -8476,7 +10173,7 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 
 	Coord3D adjustTo = *rawTo;
 	Coord3D *to = &adjustTo;
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -8521,7 +10218,7 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -8530,11 +10227,11 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		// put parent cell onto closed list - its evaluation is finished
 		m_closedList = parentCell->putOnClosedList( m_closedList );
@@ -8646,10 +10343,10 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				newCell->removeFromOpenList( m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			newCell->putOnSortedOpenList( m_openList );
 		}
 	}
 
@@ -8705,7 +10402,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 		adjustTo.x += PATHFIND_CELL_SIZE_F/2;
 		adjustTo.y += PATHFIND_CELL_SIZE_F/2;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -8804,7 +10501,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 	Real closestDistScreenSqr = FLT_MAX;
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -8814,14 +10511,14 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 	// until goal is found.
 	//
 	Bool foundGoal = false;
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		Real dx;
 		Real dy;
 		Real distSqr;
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		if (parentCell == goalCell)
 		{
@@ -9701,6 +11398,11 @@ void Pathfinder::changeBridgeState( PathfindLayerEnum layer, Bool repaired)
 	if (m_layers[layer].isUnused()) return;	
 	if (m_layers[layer].setDestroyed(!repaired)) {
 		m_zoneManager.markZonesDirty( repaired );
+		if (TheGlobalData->m_incrementalPathfindZones) {
+			IRegion2D cellBounds;
+			m_layers[layer].getCellBounds(&cellBounds);
+			m_zoneManager.updateZonesForModify(m_map, m_layers, cellBounds, m_extent);
+		}
 	}
 }
 
@@ -10228,7 +11930,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	Int radius;
 	getRadiusAndCenter(obj, radius, centerInCell);
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 
 	// determine start cell
 	ICoord2D startCellNdx;
@@ -10268,7 +11970,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	parentCell->startPathfind(NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -10283,11 +11985,11 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	boxHalfWidth += otherRadius*PATHFIND_CELL_SIZE_F;
 	if (otherCenter) boxHalfWidth+=PATHFIND_CELL_SIZE_F/2;
 
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		Region2D bounds;
 		Coord3D cellCenter;
@@ -10398,7 +12100,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 
 	m_zoneManager.setAllPassable();
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 
 	enum {CELL_LIMIT = 2000}; // max cells to examine.
 	Int cellCount = 0;
@@ -10429,7 +12131,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 	parentCell->startPathfind( NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -10499,11 +12201,11 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 		return NULL;
 	}
 
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -10668,7 +12370,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 
 	Int cellCount = 0;
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 
 	Int attackDistance = weapon->getAttackDistance(obj, victim, victimPos);
 	attackDistance += 3*PATHFIND_CELL_SIZE;
@@ -10709,7 +12411,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 	}
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -10729,11 +12431,11 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 		checkLOS = true;
 	}
 	
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -10943,7 +12645,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 		isHuman = false; // computer gets to cheat.
 	}
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(m_openList.isEmpty() && m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	m_zoneManager.setAllPassable();
@@ -10962,7 +12664,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 	parentCell->startPathfind( NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	m_openList.reset(parentCell);
 
 	// "closed" list is initially empty
 	m_closedList = NULL;
@@ -10974,11 +12676,11 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 
 	Real farthestDistanceSqr = 0;
 
-	while( m_openList != NULL )
+	while( !m_openList.isEmpty() )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = m_openList.getHead();
+		parentCell->removeFromOpenList( m_openList );
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -10997,7 +12699,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 		if (distSqr>repulsorDistSqr) {
 			ok = true;
 		}
-		if (m_openList == NULL && cellCount>0) {
+		if (m_openList.isEmpty() && cellCount>0) {
 			ok = true; // exhausted the search space, just take the last cell.
 		}
 		if (distSqr > farthestDistanceSqr) {
@@ -11126,14 +12828,31 @@ void Pathfinder::xfer( Xfer *xfer )
 {
 
 	// version
-	XferVersion currentVersion = 1;
+	// 2: the path cache & flow fields
+	// 3: the flow field being built
+	// 4: path cache keys a field at a time
+	XferVersion currentVersion = 4;
 	XferVersion version = currentVersion;
 	xfer->xferVersion( &version, currentVersion );
 
+	// A cached path or flow field is handed out instead of searching, so a loaded game has to start
+	// with the same ones the saved game carried on with.
+	if (version >= 2) {
+		m_pathCache.xfer(xfer, m_zoneManager.getZoneVersion(), version);
+		m_flowFields.xfer(xfer, m_zoneManager.getZoneVersion(), version);
+	}	else {
+		m_pathCache.reset();
+		m_flowFields.reset();
+	}
+
 }  // end xfer
 
 //-----------------------------------------------------------------------------
 void Pathfinder::loadPostProcess( void )
 {
 
+	// the zones have been calculated again by now.
+	m_pathCache.loadPostProcess(this, m_zoneManager.getZoneVersion());
+	m_flowFields.loadPostProcess(m_zoneManager.getZoneVersion());
+
 }  // end loadPostProcess
@@ -0,0 +1,349 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// AIPathfindBenchmark.cpp
+// Pathfind query recorder & replay benchmark.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameLogic/AIPathfindBenchmark.h"
+
+#include "Common/crc.h"
+#include "Common/GlobalData.h"
+#include "Common/NameKeyGenerator.h"
+
+#include "GameLogic/AIPathfind.h"
+#include "GameLogic/GameLogic.h"
+#include "GameLogic/Locomotor.h"
+
+PathfindBenchmark *ThePathfindBenchmark = NULL;
+
+static const char *s_queryTypeTags[PATHFIND_QUERY_COUNT] = { "P", "G", "H" };
+
+//-------------------------------------------------------------------------------------------------
+PathfindBenchmark::PathfindBenchmark() :
+	m_recordFile(NULL),
+	m_isRunning(FALSE),
+	m_hasRun(FALSE)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+PathfindBenchmark::~PathfindBenchmark()
+{
+	stopRecording();
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool PathfindBenchmark::startRecording( const AsciiString &fileName )
+{
+	stopRecording();
+	m_recordFile = fopen(fileName.str(), "wt");
+	if (m_recordFile == NULL)
+	{
+		DEBUG_LOG(("PathfindBenchmark - could not open %s for recording\n", fileName.str()));
+		return FALSE;
+	}
+	fprintf(m_recordFile, "; Pathfind queries. Type isHuman isCrusher from(x y z) to(x y z) pathDiameter locomotors\n");
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void PathfindBenchmark::stopRecording( void )
+{
+	if (m_recordFile)
+	{
+		fclose(m_recordFile);
+		m_recordFile = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void PathfindBenchmark::writeQuery( const PathfindQuery &query )
+{
+	// %.9g round trips a float exactly, so the replay asks for exactly the same positions.
+	fprintf(m_recordFile, "%s %d %d %.9g %.9g %.9g %.9g %.9g %.9g %d %s\n",
+		s_queryTypeTags[query.m_type], query.m_isHuman ? 1 : 0, query.m_isCrusher ? 1 : 0,
+		query.m_from.x, query.m_from.y, query.m_from.z,
+		query.m_to.x, query.m_to.y, query.m_to.z,
+		query.m_pathDiameter, query.m_locomotors.str());
+	fflush(m_recordFile);
+}
+
+//-------------------------------------------------------------------------------------------------
+void PathfindBenchmark::recordFindPath( Bool isHuman, const LocomotorSet &locomotorSet, const Coord3D *from, const Coord3D *to )
+{
+	PathfindQuery query;
+	query.m_type = PATHFIND_QUERY_FIND_PATH;
+	query.m_from = *from;
+	query.m_to = *to;
+	query.m_isHuman = isHuman;
+	query.m_isCrusher = FALSE;
+	query.m_pathDiameter = 0;
+	buildLocomotorNames(locomotorSet, query.m_locomotors);
+	writeQuery(query);
+}
+
+//-------------------------------------------------------------------------------------------------
+void PathfindBenchmark::recordGroundPath( const Coord3D *from, const Coord3D *to, Int pathDiameter, Bool crusher )
+{
+	PathfindQuery query;
+	query.m_type = PATHFIND_QUERY_GROUND_PATH;
+	query.m_from = *from;
+	query.m_to = *to;
+	query.m_isHuman = TRUE;
+	query.m_isCrusher = crusher;
+	query.m_pathDiameter = pathDiameter;
+	writeQuery(query);
+}
+
+//-------------------------------------------------------------------------------------------------
+/*static*/ void PathfindBenchmark::buildLocomotorNames( const LocomotorSet &locomotorSet, AsciiString &names )
+{
+	names.clear();
+	for (Int i = 0; i < locomotorSet.getLocomotorCount(); ++i)
+	{
+		if (i > 0)
+			names.concat(' ');
+		names.concat(locomotorSet.getLocomotor(i)->getTemplateName());
+	}
+	if (names.isEmpty())
+		names = "-";
+}
+
+//-------------------------------------------------------------------------------------------------
+/*static*/ void PathfindBenchmark::buildLocomotorSet( const AsciiString &names, LocomotorSet &locomotorSet )
+{
+	locomotorSet.clear();
+	AsciiString remaining = names;
+	AsciiString token;
+	while (remaining.nextToken(&token, " "))
+	{
+		if (token == "-")
+			continue;
+		const LocomotorTemplate *lt = TheLocomotorStore->findLocomotorTemplate(NAMEKEY(token));
+		DEBUG_ASSERTCRASH(lt, ("PathfindBenchmark - unknown locomotor %s", token.str()));
+		if (lt)
+			locomotorSet.addLocomotor(lt);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool PathfindBenchmark::loadQueries( const AsciiString &fileName )
+{
+	m_queries.clear();
+	m_hasRun = FALSE;
+
+	FILE *fp = fopen(fileName.str(), "rt");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("PathfindBenchmark - could not open %s\n", fileName.str()));
+		return FALSE;
+	}
+
+	char line[1024];
+	while (fgets(line, sizeof(line), fp))
+	{
+		if (line[0] == ';' || line[0] == '\n' || line[0] == '\r' || line[0] == 0)
+			continue;
+
+		char tag[8];
+		Int isHuman, isCrusher;
+		PathfindQuery query;
+		Int consumed = 0;
+		if (sscanf(line, "%7s %d %d %f %f %f %f %f %f %d %n", tag, &isHuman, &isCrusher,
+				&query.m_from.x, &query.m_from.y, &query.m_from.z,
+				&query.m_to.x, &query.m_to.y, &query.m_to.z,
+				&query.m_pathDiameter, &consumed) < 10)
+		{
+			DEBUG_LOG(("PathfindBenchmark - skipping bad line %s", line));
+			continue;
+		}
+
+		Int type;
+		for (type = 0; type < PATHFIND_QUERY_COUNT; ++type)
+		{
+			if (strcmp(tag, s_queryTypeTags[type]) == 0)
+				break;
+		}
+		if (type == PATHFIND_QUERY_COUNT)
+		{
+			DEBUG_LOG(("PathfindBenchmark - skipping unknown query type %s\n", tag));
+			continue;
+		}
+
+		query.m_type = (PathfindQueryType)type;
+		query.m_isHuman = isHuman != 0;
+		query.m_isCrusher = isCrusher != 0;
+		query.m_locomotors = line + consumed;
+		query.m_locomotors.trim();
+		m_queries.push_back(query);
+	}
+	fclose(fp);
+
+	DEBUG_LOG(("PathfindBenchmark - loaded %d queries from %s\n", (Int)m_queries.size(), fileName.str()));
+	return !m_queries.empty();
+}
+
+//-------------------------------------------------------------------------------------------------
+/*static*/ void PathfindBenchmark::addPathToCRC( Path *path, CRC &crc )
+{
+	Int count = 0;
+	if (path)
+	{
+		for (PathNode *node = path->getFirstNode(); node; node = node->getNext())
+		{
+			const Coord3D *pos = node->getPosition();
+			Int layer = node->getLayer();
+			crc.computeCRC(pos, sizeof(Coord3D));
+			crc.computeCRC(&layer, sizeof(layer));
+			++count;
+		}
+	}
+	// Include the node count so no-path and empty path are told apart from each other.
+	crc.computeCRC(&count, sizeof(count));
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Replays all loaded queries against the current map, and writes paths/sec, cells examined,
+ * latency percentiles and a hash of all resulting paths to the report file & debug log.
+ * The path cache and flow fields are switched off for the run, so every query is searched for and
+ * none of them is stored. Paths are not kept, and no units are moved, so the replay leaves the
+ * pathfinder as it found it.
+ */
+void PathfindBenchmark::run( Pathfinder *pathfinder, const AsciiString &reportFileName )
+{
+	m_hasRun = TRUE;
+	m_isRunning = TRUE;
+
+	const Int numQueries = (Int)m_queries.size();
+	std::vector<__int64> latencies;
+	latencies.reserve(numQueries);
+
+	__int64 freq64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+
+	Int queryCounts[PATHFIND_QUERY_COUNT] = {0};
+	Int pathsFound = 0;
+	Int totalCells = 0;
+	UnsignedInt totalOpenListOps = 0;
+	__int64 totalTime64 = 0;
+	CRC pathHash;
+
+	// A query answered from the cache or a flow field would time the lookup, not the search, and
+	// one that is stored would change the answers to the queries after it.
+	Bool usePathfindCache = TheGlobalData->m_pathfindCache;
+	Bool usePathfindFlowFields = TheGlobalData->m_pathfindFlowFields;
+	TheWritableGlobalData->m_pathfindCache = FALSE;
+	TheWritableGlobalData->m_pathfindFlowFields = FALSE;
+
+	LocomotorSet locomotorSet;
+	for (Int i = 0; i < numQueries; ++i)
+	{
+		const PathfindQuery &query = m_queries[i];
+		if (query.m_type != PATHFIND_QUERY_GROUND_PATH)
+			buildLocomotorSet(query.m_locomotors, locomotorSet);
+
+		pathfinder->m_cumulativeCellsAllocated = 0;
+		pathfinder->m_openList.clearOperationCount();
+
+		__int64 startTime64, endTime64;
+		QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+
+		Path *path = NULL;
+		switch (query.m_type)
+		{
+			case PATHFIND_QUERY_FIND_PATH:
+				path = pathfinder->findPath(NULL, locomotorSet, &query.m_from, &query.m_to);
+				break;
+			case PATHFIND_QUERY_GROUND_PATH:
+				path = pathfinder->findGroundPath(&query.m_from, &query.m_to, query.m_pathDiameter, query.m_isCrusher);
+				break;
+			case PATHFIND_QUERY_HIERARCHICAL_PATH:
+				pathfinder->m_zoneManager.clearPassableFlags();
+				path = pathfinder->findHierarchicalPath(query.m_isHuman, locomotorSet, &query.m_from, &query.m_to, query.m_isCrusher);
+				break;
+		}
+
+		QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+
+		latencies.push_back(endTime64 - startTime64);
+		totalTime64 += endTime64 - startTime64;
+		totalCells += pathfinder->m_cumulativeCellsAllocated;
+		totalOpenListOps += pathfinder->m_openList.getOperationCount();
+		queryCounts[query.m_type]++;
+
+		addPathToCRC(path, pathHash);
+		if (path)
+		{
+			++pathsFound;
+			path->deleteInstance();
+		}
+	}
+	pathfinder->m_cumulativeCellsAllocated = 0;
+	TheWritableGlobalData->m_pathfindCache = usePathfindCache;
+	TheWritableGlobalData->m_pathfindFlowFields = usePathfindFlowFields;
+	m_isRunning = FALSE;
+
+	std::sort(latencies.begin(), latencies.end());
+	Real toMicroSec = 1000000.0f / (Real)freq64;
+	Real p50 = 0, p99 = 0, maxLatency = 0;
+	if (numQueries > 0)
+	{
+		p50 = latencies[(numQueries - 1) * 50 / 100] * toMicroSec;
+		p99 = latencies[(numQueries - 1) * 99 / 100] * toMicroSec;
+		maxLatency = latencies[numQueries - 1] * toMicroSec;
+	}
+	Real seconds = (Real)((double)totalTime64 / (double)freq64);
+	Real pathsPerSecond = seconds > 0 ? numQueries / seconds : 0;
+
+	char report[1024];
+	_snprintf(report, sizeof(report),
+		"Pathfind benchmark, map %s\n"
+		"Queries        = %d (findPath %d, findGroundPath %d, findHierarchicalPath %d)\n"
+		"Paths found    = %d\n"
+		"Total time     = %.3f ms\n"
+		"Paths/sec      = %.1f\n"
+		"Cells examined = %d (%.1f per query)\n"
+		"Open list ops  = %u\n"
+		"Latency p50    = %.1f us\n"
+		"Latency p99    = %.1f us\n"
+		"Latency max    = %.1f us\n"
+		"Path hash      = %8.8X\n",
+		TheGlobalData->m_mapName.str(),
+		numQueries, queryCounts[PATHFIND_QUERY_FIND_PATH], queryCounts[PATHFIND_QUERY_GROUND_PATH], queryCounts[PATHFIND_QUERY_HIERARCHICAL_PATH],
+		pathsFound,
+		seconds * 1000.0f,
+		pathsPerSecond,
+		totalCells, numQueries > 0 ? (Real)totalCells / numQueries : 0.0f,
+		totalOpenListOps,
+		p50, p99, maxLatency,
+		pathHash.get());
+	report[sizeof(report) - 1] = 0;
+
+	DEBUG_LOG(("%s", report));
+	if (!reportFileName.isEmpty())
+	{
+		FILE *fp = fopen(reportFileName.str(), "wt");
+		if (fp)
+		{
+			fputs(report, fp);
+			fclose(fp);
+		}
+	}
+}
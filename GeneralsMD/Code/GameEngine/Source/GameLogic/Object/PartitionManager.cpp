@@ -987,46 +987,44 @@ PartitionManager *ThePartitionManager = NULL;  ///< the object manager singleton
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
-class PartitionContactListNode : public MemoryPoolObject
-{
-	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(PartitionContactListNode, "PartitionContactListNode" )
-
-public:
-	PartitionContactListNode*			m_nextHash;	///< next node with same hash value 
-	PartitionContactListNode*			m_next;			///< next node
-	PartitionData*								m_obj;			///< one object that is possibly colliding
-	PartitionData*								m_other;		///< the other object (or null for collisions with the terrain)
-	Int														m_hashValue;///< index into hash table 
-};
-
-inline PartitionContactListNode::~PartitionContactListNode() { }
-
-//-----------------------------------------------------------------------------
-
 class PartitionContactList
 {
 private:
 
-	/*
-		socketcount should be prime (and "not too close to a power of 2) for best results.
-		
-		if this one isn't large enough, try this website:
-		http://www.utm.edu/research/primes/lists/small/1000.txt
+	struct Contact
+	{
+		PartitionData*		m_obj;				///< one object that is possibly colliding
+		PartitionData*		m_other;			///< the other object
+		UnsignedInt				m_hashValue;	///< hash of both object ids
+		Int								m_slot;				///< index into m_hashTable
+	};
 
-		So how is this chosen? Eh, pretty much based on experimentation.
+	/*
+		Contacts are kept in a flat array in the order they were found, and found again
+		through an open addressed hash table of indices into that array, so adding
+		contacts never allocates once the arrays have grown to fit a frame's worth, and
+		emptying the list only touches the slots that were used.
 	*/
-	enum { PartitionContactList_SOCKET_COUNT = 5381 };
+	enum { INITIAL_HASH_BITS = 12 };
+	enum { INITIAL_HASH_SIZE = 1 << INITIAL_HASH_BITS };
 
+	std::vector<Contact>	m_contacts;		///< contacts for this frame, oldest first
+	std::vector<Int>			m_hashTable;	///< index+1 into m_contacts, or 0 for an empty slot
+	UnsignedInt						m_hashMask;
+	Int										m_hashShift;	///< 32 - log2 of the table size
 
-	PartitionContactListNode* m_contactHash[PartitionContactList_SOCKET_COUNT];
-	PartitionContactListNode* m_contactList;
+	/// Fibonacci hashing: the top bits of the product depend on all the bits of both ids.
+	inline UnsignedInt getHomeSlot(UnsignedInt hashValue) const { return (hashValue * 2654435761U) >> m_hashShift; }
+	inline Int findSlot(UnsignedInt hashValue, PartitionData *obj, PartitionData *other, Bool &found) const;
+	void growHashTable();
 
 public:
 
 	PartitionContactList()
 	{
-		memset(m_contactHash, 0, sizeof(m_contactHash));
-		m_contactList = NULL;
+		m_hashTable.resize(INITIAL_HASH_SIZE, 0);
+		m_hashMask = INITIAL_HASH_SIZE - 1;
+		m_hashShift = 32 - INITIAL_HASH_BITS;
 	}
 
 	~PartitionContactList()
@@ -1202,11 +1200,14 @@ void CellAndObjectIntersection::addCoverage(PartitionCell *cell, PartitionData *
 		return;
 	}
 
-	if (m_cell == NULL)
-		cell->friend_addToCellList(this);
+	Bool isNewCell = (m_cell == NULL);
 
 	m_cell = cell;
 	m_module = module;
+
+	// (the cell records our module, so set it first.)
+	if (isNewCell)
+		cell->friend_addToCellList(this);
 }
 
 //-----------------------------------------------------------------------------
@@ -1471,6 +1472,7 @@ void PartitionCell::friend_addToCellList(CellAndObjectIntersection *coi)
 	if (coi)
 	{
 		coi->friend_addToCellList(&m_firstCoiInCell);
+		m_modulesInCell.push_back(coi->getModule());
 		++m_coiCount;
 	}
 }
@@ -1481,6 +1483,11 @@ void PartitionCell::friend_removeFromCellList(CellAndObjectIntersection *coi)
 	if (coi)
 	{
 		coi->friend_removeFromCellList(&m_firstCoiInCell);
+		// keep the order of the rest, it decides the order collisions are processed in.
+		std::vector<PartitionData*>::iterator it = std::find(m_modulesInCell.begin(), m_modulesInCell.end(), coi->getModule());
+		DEBUG_ASSERTCRASH(it != m_modulesInCell.end(), ("module is not in cell"));
+		if (it != m_modulesInCell.end())
+			m_modulesInCell.erase(it);
 		--m_coiCount;
 	}
 }
@@ -1504,6 +1511,14 @@ void PartitionCell::validateCoiList()
 		DEBUG_ASSERTCRASH((coi == getFirstCoiInCell()) == (prevCoi == NULL) , ("coi link mismatch"));
 		DEBUG_ASSERTCRASH(nextCoi == NULL || nextCoi->getPrevCoi() == coi, ("coi link mismatch"));
 	}
+
+	Int i = getModuleCount();
+	for (CellAndObjectIntersection *coi = getFirstCoiInCell(); coi; coi = coi->getNextCoi())
+	{
+		--i;
+		DEBUG_ASSERTCRASH(i >= 0 && getModule(i) == coi->getModule(), ("coi module mismatch"));
+	}
+	DEBUG_ASSERTCRASH(i == 0, ("coi module count mismatch"));
 }
 #endif
 
@@ -1952,9 +1967,11 @@ void PartitionData::addPossibleCollisions(PartitionContactList *ctList)
 		if (cell->getCoiCount() < 2)
 			continue;
 
-		for (CellAndObjectIntersection *coi = cell->getFirstCoiInCell(); coi; coi = coi->getNextCoi())
+		// walk the cell's contiguous module array rather than its COI list (which would
+		// hop through every other module's COI array), newest first, same as the list.
+		for (Int j = cell->getModuleCount() - 1; j >= 0; --j)
 		{
-			PartitionData *that = coi->getModule();
+			PartitionData *that = cell->getModule(j);
 			if (this != that)
 			{
 				ctList->addToContactList(this, that);
@@ -2369,6 +2386,54 @@ inline UnsignedInt hash2ints(Int a, Int b)
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+inline Int PartitionContactList::findSlot(UnsignedInt hashValue, PartitionData *obj, PartitionData *other, Bool &found) const
+{
+	// spread the ids over the table; the low bits of hash2ints are just one of the ids.
+	UnsignedInt slot = getHomeSlot(hashValue);
+	for (;;)
+	{
+		slot &= m_hashMask;
+		Int ndx = m_hashTable[slot];
+		if (ndx == 0)
+		{
+			found = false;
+			return slot;
+		}
+		const Contact& cd = m_contacts[ndx - 1];
+		if ((cd.m_obj == obj && cd.m_other == other) ||
+				(cd.m_obj == other && cd.m_other == obj)) 
+		{
+			found = true;
+			return slot;
+		}
+		++slot;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void PartitionContactList::growHashTable()
+{
+	UnsignedInt newSize = (m_hashMask + 1) * 2;
+	m_hashTable.assign(newSize, 0);
+	m_hashMask = newSize - 1;
+	--m_hashShift;
+	for (Int i = 0; i < (Int)m_contacts.size(); ++i)
+	{
+		Contact& cd = m_contacts[i];
+		UnsignedInt slot = getHomeSlot(cd.m_hashValue);
+		for (;;)
+		{
+			slot &= m_hashMask;
+			if (m_hashTable[slot] == 0)
+				break;
+			++slot;
+		}
+		m_hashTable[slot] = i + 1;
+		cd.m_slot = slot;
+	}
+}
+
 //-----------------------------------------------------------------------------
 void PartitionContactList::addToContactList( PartitionData *obj, PartitionData *other )
 {
@@ -2382,91 +2447,37 @@ void PartitionContactList::addToContactList( PartitionData *obj, PartitionData *
 
 	// compute hash index based on object's ids.
 	UnsignedInt hashValue = hash2ints(obj_obj->getID(), other_obj->getID());
-	hashValue %= PartitionContactList_SOCKET_COUNT;
 
 	// make sure given hit has not already been recorded 
-	for (PartitionContactListNode* cd = m_contactHash[ hashValue ]; cd; cd = cd->m_nextHash )
-	{
-		if ((cd->m_obj == obj && cd->m_other == other) ||
-				(cd->m_obj == other && cd->m_other == obj)) 
-		{
-			// already noted 
-			return;
-		}
-	}
+	Bool found;
+	Int slot = findSlot(hashValue, obj, other, found);
+	if (found)
+		return;
 
 	// new hit 
-	PartitionContactListNode *ncd = newInstance(PartitionContactListNode);
-	ncd->m_obj = obj;
-	ncd->m_other = other;
-	ncd->m_hashValue = hashValue;
-
-	// add to hash table 
-	ncd->m_nextHash = m_contactHash[ hashValue ];
-	m_contactHash[ hashValue ] = ncd;
-
-	// add to list of contacts for this frame 
-	ncd->m_next = m_contactList;
-	m_contactList = ncd;
-
-
-#if 0
-
-Int depth = 0;
-for (PartitionContactListNode *cd2 = m_contactHash[ hashValue ]; cd2; cd2 = cd2->m_nextHash )
-{
-	depth++;
-}
-if (depth > 3)
-{
-	DEBUG_LOG(("depth is %d for %s %08lx (%d) - %s %08lx (%d)\n",
-		depth,obj_obj->getTemplate()->getName().str(),obj_obj,obj_obj->getID(),
-		other_obj->getTemplate()->getName().str(),other_obj,other_obj->getID()
-		));
-
-	for (cd2 = m_contactHash[ hashValue ]; cd2; cd2 = cd2->m_nextHash )
-	{
-		UnsignedInt rawhash = djb2hash2ints(cd2->m_obj->getObject()->getID(), cd2->m_other->getObject()->getID());
-		//hashValue %= PartitionContactList_SOCKET_COUNT;
-
-
-		DEBUG_LOG(("ENTRY: %s %08lx (%d) - %s %08lx (%d) [rawhash %d]\n",
-			cd2->m_obj->getObject()->getTemplate()->getName().str(),cd2->m_obj->getObject(),cd2->m_obj->getObject()->getID(),
-			cd2->m_other->getObject()->getTemplate()->getName().str(),cd2->m_other->getObject(),cd2->m_other->getObject()->getID(),
-			rawhash));
-	}
-}
-
-static Real aggtotal = 0;
-static Real aggfull = 0;
-static Real aggcount = 0;
-for (int ii = 0; ii < PartitionContactList_SOCKET_COUNT; ++ii)
-{
-	if (m_contactHash[ii])
-		aggfull += 1.0f;
-
-	for (cd2 = m_contactHash[ ii ]; cd2; cd2 = cd2->m_nextHash )
-	{
-		aggtotal += 1.0f;
-	}
-}
-aggcount += 1.0f;
-DEBUG_ASSERTLOG(((Int)aggcount)%1000!=0,("avg hash depth at %f is %f, fullness %f%%\n",
-aggcount,aggtotal/(aggcount*PartitionContactList_SOCKET_COUNT),(aggfull*100)/(aggcount*PartitionContactList_SOCKET_COUNT)));
-#endif
-
+	Contact ncd;
+	ncd.m_obj = obj;
+	ncd.m_other = other;
+	ncd.m_hashValue = hashValue;
+	ncd.m_slot = slot;
+	m_contacts.push_back(ncd);
+	m_hashTable[slot] = (Int)m_contacts.size();
 
+	// keep the table at most half full, so searches stay short.
+	if (m_contacts.size() * 2 > m_hashTable.size())
+		growHashTable();
 }
 
 //-----------------------------------------------------------------------------
 void PartitionContactList::removeSpecificPartitionData(PartitionData* data)
 {
-	for (PartitionContactListNode* cd = m_contactList; cd; cd = cd->m_next)
+	for (Int i = 0; i < (Int)m_contacts.size(); ++i)
 	{
-		if (cd->m_obj == data || cd->m_other == data)
+		Contact& cd = m_contacts[i];
+		if (cd.m_obj == data || cd.m_other == data)
 		{
-			cd->m_obj = NULL;
-			cd->m_other = NULL;
+			cd.m_obj = NULL;
+			cd.m_other = NULL;
 		}
 	}
 }
@@ -2475,22 +2486,20 @@ void PartitionContactList::removeSpecificPartitionData(PartitionData* data)
 void PartitionContactList::resetContactList()
 {
 	// remove items from hash table 
-	PartitionContactListNode* cdnext;
-	for (PartitionContactListNode* cd = m_contactList; cd; cd = cdnext)
+	for (Int i = 0; i < (Int)m_contacts.size(); ++i)
 	{
-		cdnext = cd->m_next;
-		cd->deleteInstance();
+		m_hashTable[m_contacts[i].m_slot] = 0;
 	}
-
-	memset(m_contactHash, 0, sizeof(m_contactHash));
-	m_contactList = NULL;
+	m_contacts.clear();
 }
 
 //-----------------------------------------------------------------------------
 void PartitionContactList::processContactList()
 {
-	for (PartitionContactListNode* cd = m_contactList; cd; cd = cd->m_next) 
+	// newest first, the order they have always been processed in.
+	for (Int i = (Int)m_contacts.size() - 1; i >= 0; --i)
 	{
+		Contact* cd = &m_contacts[i];
 		if (cd->m_obj == NULL || cd->m_other == NULL)
 			continue;
 
@@ -2563,6 +2572,7 @@ PartitionManager::PartitionManager()
 	m_worldExtents.lo.zero();
 	m_worldExtents.hi.zero();
 	m_dirtyModules = NULL;
+	m_contactList = NULL;
 	m_updatedSinceLastReset = false;
 #ifdef FASTER_GCO
 	m_maxGcoRadius = 0;
@@ -2575,6 +2585,9 @@ PartitionManager::~PartitionManager()
 
 	shutdown();
 
+	delete m_contactList;
+	m_contactList = NULL;
+
 }  // end ~PartitionManager
 
 //-----------------------------------------------------------------------------
@@ -2725,10 +2738,10 @@ void PartitionManager::shutdown()
 }
 
 //-----------------------------------------------------------------------------
-//DECLARE_PERF_TIMER(PartitionManager_update)
+DECLARE_PERF_TIMER(PartitionManager_update)
 void PartitionManager::update()
 {
-	//USE_PERF_TIMER(PartitionManager_update)
+	USE_PERF_TIMER(PartitionManager_update)
 	{
 #ifdef INTENSE_DEBUG
 		Int cc = 0;
@@ -2738,7 +2751,9 @@ void PartitionManager::update()
 			m_updatedSinceLastReset = true;
 		}
 
-		PartitionContactList ctList;
+		if (m_contactList == NULL)
+			m_contactList = MSGNEW("PartitionManager_Contacts") PartitionContactList;
+		PartitionContactList& ctList = *m_contactList;
 		TheContactList = &ctList;
 		while (m_dirtyModules)
 		{
@@ -2771,6 +2786,7 @@ void PartitionManager::update()
 		}
 		
 		ctList.processContactList();
+		ctList.resetContactList();
 #ifdef INTENSE_DEBUG
 		DEBUG_ASSERTLOG(cc==0,("updated partition info for %d objects\n",cc));
 #endif
@@ -96,6 +96,7 @@
 #include "GameLogic/ScriptConditions.h"
 #include "GameLogic/ScriptEngine.h"
 #include "GameLogic/SidesList.h"
+#include "GameLogic/SleepyUpdateBenchmark.h"
 #include "GameLogic/VictoryConditions.h"
 #include "GameLogic/Weapon.h"
 #include "GameLogic/GhostObject.h"
@@ -277,9 +278,9 @@ void GameLogic::setDefaults( Bool loadingSaveGame )
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	m_normalUpdates.clear();
 #endif
-	for (std::vector<UpdateModulePtr>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
+	for (std::vector<SleepyUpdateEntry>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
 	{
-		(*it)->friend_setIndexInLogic(-1);
+		it->m_update->friend_setIndexInLogic(-1);
 	}
 	m_sleepyUpdates.clear();
 	m_curUpdateModule = NULL;
@@ -379,6 +380,13 @@ void GameLogic::init( void )
 	/// @todo Clear object and destroy lists
 	setDefaults( FALSE );
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_sleepyUpdateBenchmarkModules > 0)
+	{
+		runSleepyUpdateBenchmark(TheGlobalData->m_sleepyUpdateBenchmarkModules, 30 * LOGICFRAMES_PER_SECOND);
+	}
+#endif
+
 	// create the partition manager
 	ThePartitionManager = NEW PartitionManager;
 	ThePartitionManager->init();
@@ -2509,26 +2517,46 @@ void GameLogic::processDestroyList( void )
 			and rebalancing the entire heap afterwards, at least for real-world maps, since an individual
 			rebalance is O(log N) and a full rebalance is O(N)... so unless you are deleting the majority
 			of the objects in the world every frame, we come out well ahead this way.)
+
+			we find them through the object's own modules rather than by scanning the whole list, and
+			sort them by their place in the list, so they are erased in exactly the order a scan would give.
 		*/
 
 		const Int MAX_SUO = 256;
 		UpdateModulePtr sleepyUpdatesForThisObject[MAX_SUO];
 		Int numSUO = 0;
 
-		for (std::vector<UpdateModulePtr>::iterator it2 = m_sleepyUpdates.begin(); it2 != m_sleepyUpdates.end(); ++it2)
+		for (BehaviorModule** b = currentObject->getBehaviorModules(); *b; ++b)
 		{
-			UpdateModulePtr u = *it2;
-			if (u->friend_getObject() == currentObject && numSUO < MAX_SUO)
+#ifdef DIRECT_UPDATEMODULE_ACCESS
+			// evil, but necessary at this point. (srj)
+			UpdateModulePtr u = (UpdateModulePtr)((*b)->getUpdate());
+#else
+			UpdateModulePtr u = (*b)->getUpdate();
+#endif
+			if (!u || u->friend_getIndexInLogic() < 0)
+				continue;
+
+			DEBUG_ASSERTCRASH(numSUO < MAX_SUO, ("too many sleepy updates for one object"));
+			if (numSUO >= MAX_SUO)
+				break;
+
+			// insertion sort by index; objects only have a handful of modules.
+			Int idx = u->friend_getIndexInLogic();
+			Int j = numSUO++;
+			while (j > 0 && sleepyUpdatesForThisObject[j-1]->friend_getIndexInLogic() > idx)
 			{
-				sleepyUpdatesForThisObject[numSUO++] = u;
+				sleepyUpdatesForThisObject[j] = sleepyUpdatesForThisObject[j-1];
+				--j;
 			}
+			sleepyUpdatesForThisObject[j] = u;
 		}
 
 		for (--numSUO; numSUO >= 0; --numSUO)
 		{
 			// have to re-get idx each time since each call to erase might change others.
 			Int idx = sleepyUpdatesForThisObject[numSUO]->friend_getIndexInLogic();
-			DEBUG_ASSERTCRASH(m_sleepyUpdates[idx] == sleepyUpdatesForThisObject[numSUO], ("Hmm, expected update mismatch here"));
+			DEBUG_ASSERTCRASH(m_sleepyUpdates[idx].m_update == sleepyUpdatesForThisObject[numSUO], ("Hmm, expected update mismatch here"));
 			eraseSleepyUpdate(idx);
 			DEBUG_ASSERTCRASH(sleepyUpdatesForThisObject[numSUO]->friend_getIndexInLogic() == -1, ("Hmm, expected index to be -1 here"));
 		}
@@ -2741,28 +2769,29 @@ inline void GameLogic::validateSleepyUpdate() const
 	//DEBUG_LOG(("\n\n"));
 	//for (i = 0; i < sz; ++i)
 	//{
-	//	DEBUG_LOG(("u %04d: %08lx %08lx\n",i,m_sleepyUpdates[i],m_sleepyUpdates[i]->friend_getNextCallFrame()));
+	//	DEBUG_LOG(("u %04d: %08lx %08lx\n",i,m_sleepyUpdates[i].m_update,m_sleepyUpdates[i].m_update->friend_getNextCallFrame()));
 	//}
 	for (i = 0; i < sz; ++i)
 	{
-		DEBUG_ASSERTCRASH(m_sleepyUpdates[i]->friend_getIndexInLogic() == i, ("index mismatch: expected %d, got %d\n",i,m_sleepyUpdates[i]->friend_getIndexInLogic()));
-		UnsignedInt pri = m_sleepyUpdates[i]->friend_getPriority();
+		DEBUG_ASSERTCRASH(m_sleepyUpdates[i].m_update->friend_getIndexInLogic() == i, ("index mismatch: expected %d, got %d\n",i,m_sleepyUpdates[i].m_update->friend_getIndexInLogic()));
+		UnsignedInt pri = m_sleepyUpdates[i].m_priority;
+		DEBUG_ASSERTCRASH(pri == m_sleepyUpdates[i].m_update->friend_getPriority(), ("stale sleepy priority at %d\n",i));
 		if (i > 0)
 		{
 			Int i0 = (i+1)/2-1;
-			UnsignedInt pri0 = m_sleepyUpdates[i0]->friend_getPriority();
+			UnsignedInt pri0 = m_sleepyUpdates[i0].m_priority;
 			DEBUG_ASSERTCRASH(pri >= pri0, ("sleepyUpdates are munged (0)"));
 		}
 		Int i1 = 2*(i+1)-1;
 		Int i2 = 2*(i+1);
 		if (i1 < sz)
 		{
-			UnsignedInt pri1 = m_sleepyUpdates[i1]->friend_getPriority();
+			UnsignedInt pri1 = m_sleepyUpdates[i1].m_priority;
 			DEBUG_ASSERTCRASH(pri <= pri1, ("sleepyUpdates are munged (1)"));
 		}
 		if (i2 < sz)
 		{
-			UnsignedInt pri2 = m_sleepyUpdates[i2]->friend_getPriority();
+			UnsignedInt pri2 = m_sleepyUpdates[i2].m_priority;
 			DEBUG_ASSERTCRASH(pri <= pri2, ("sleepyUpdates are munged (2)"));
 		}
 	}
@@ -2777,13 +2806,13 @@ void GameLogic::eraseSleepyUpdate(Int i)
 	DEBUG_ASSERTCRASH(i >= 0 && i < m_sleepyUpdates.size(), ("bad sleepy idx"));
 
 	// swap with the final item, toss the final item, then rebalance
-	m_sleepyUpdates[i]->friend_setIndexInLogic(-1);
+	m_sleepyUpdates[i].m_update->friend_setIndexInLogic(-1);
 
 	Int final = m_sleepyUpdates.size() - 1;
 	if (i < final)
 	{
 		m_sleepyUpdates[i] = m_sleepyUpdates[final];
-		m_sleepyUpdates[i]->friend_setIndexInLogic(i);
+		m_sleepyUpdates[i].m_update->friend_setIndexInLogic(i);
 		m_sleepyUpdates.pop_back();
 		rebalanceSleepyUpdate(i);
 	}
@@ -2794,17 +2823,20 @@ void GameLogic::eraseSleepyUpdate(Int i)
 }
 
 // ------------------------------------------------------------------------------------------------
-inline Bool isLowerPriority(const UpdateModulePtr a, const UpdateModulePtr b)
+inline Bool isLowerPriority(UnsignedInt a, UnsignedInt b)
 {
 	// return true iff a is lower pri than b.
 	// remember: lower ordinal value means higher priority.
 	// therefore, higher ordinal value means lower priority.
-	DEBUG_ASSERTCRASH(a && b, ("these may no longer be null"));
-	UnsignedInt f1 = a->friend_getPriority();
-	UnsignedInt f2 = b->friend_getPriority();
-	return f1 > f2;
+	return a > b;
 }
 
+/*
+	Both rebalance directions carry the entry along in a hole instead of swapping it at
+	every level: each entry it passes is shifted into the hole, and the entry itself is
+	written once at the end. The entries end up exactly where swapping would put them,
+	but only the modules that actually move get their index written.
+*/
 // ------------------------------------------------------------------------------------------------
 Int GameLogic::rebalanceParentSleepyUpdate(Int i)
 {
@@ -2812,22 +2844,21 @@ Int GameLogic::rebalanceParentSleepyUpdate(Int i)
 
 	DEBUG_ASSERTCRASH(i >= 0 && i < m_sleepyUpdates.size(), ("bad sleepy idx"));
 
+	SleepyUpdateEntry entry = m_sleepyUpdates[i];
+
 	Int parent = ((i+1)>>1)-1;
-	while (parent >= 0 && isLowerPriority(m_sleepyUpdates[parent], m_sleepyUpdates[i]))
+	while (parent >= 0 && isLowerPriority(m_sleepyUpdates[parent].m_priority, entry.m_priority))
 	{
-		UpdateModulePtr a = m_sleepyUpdates[parent];
-		UpdateModulePtr b = m_sleepyUpdates[i];
-
-		m_sleepyUpdates[i] = a;
-		m_sleepyUpdates[parent] = b;
-
-		a->friend_setIndexInLogic(i);
-		b->friend_setIndexInLogic(parent);
+		m_sleepyUpdates[i] = m_sleepyUpdates[parent];
+		m_sleepyUpdates[i].m_update->friend_setIndexInLogic(i);
 
 		i = parent;
 		parent = ((parent+1)>>1)-1;
 	}
 
+	m_sleepyUpdates[i] = entry;
+	entry.m_update->friend_setIndexInLogic(i);
+
 	return i;
 }
 
@@ -2841,74 +2872,72 @@ Int GameLogic::rebalanceChildSleepyUpdate(Int i)
 // this function gets the brunt of the work (we frequently
 // balance down, not up), so this one is hand-unrolled for
 // max efficiency. I have left the pristine non-unrolled
-// version present for clarity. (Yes, this is worth doing.) (srj) 
+// version present for clarity. (Yes, this is worth doing.) (srj)
 #if 1
-	UpdateModulePtr* pI = &m_sleepyUpdates[i];
+	SleepyUpdateEntry* pBase = &m_sleepyUpdates[0];
+	SleepyUpdateEntry* pI = pBase + i;
+	SleepyUpdateEntry entry = *pI;
 
 	// our children are i*2 and i*2+1
   Int child = ((i)<<1)+1;
-	UpdateModulePtr* pChild = &m_sleepyUpdates[0] + child;
-	UpdateModulePtr* pSZ = &m_sleepyUpdates[0] + m_sleepyUpdates.size();	// yes, this is off the end.
+	SleepyUpdateEntry* pChild = pBase + child;
+	SleepyUpdateEntry* pSZ = pBase + m_sleepyUpdates.size();	// yes, this is off the end.
 
-  while (pChild < pSZ) 
+  while (pChild < pSZ)
 	{
 		// choose the higher-priority of the two children; we must be higher-pri than that.
-		if (pChild < pSZ-1 && isLowerPriority(*pChild, *(pChild+1)))
+		if (pChild < pSZ-1 && isLowerPriority(pChild->m_priority, (pChild+1)->m_priority))
 		{
       ++pChild;
 			++child;
 		}
 
 		// if we're higher-pri than our children, we're done.
-		if (!isLowerPriority(*pI, *pChild))
+		if (!isLowerPriority(entry.m_priority, pChild->m_priority))
 		{
 			break;
 		}
 
-		// doh. swap with the highest-pri child we have.
-		UpdateModulePtr a = *pChild;
-		UpdateModulePtr b = *pI;
-
-		*pI = a;
-		*pChild = b;
-
-		a->friend_setIndexInLogic(i);
-		b->friend_setIndexInLogic(child);
+		// doh. move the highest-pri child we have up into our spot.
+		*pI = *pChild;
+		pI->m_update->friend_setIndexInLogic(i);
 
 		i = child;
 		pI = pChild;
 
 		child = ((i)<<1)+1;
-		pChild = &m_sleepyUpdates[0] + child;
+		pChild = pBase + child;
   }
+
+	*pI = entry;
+	entry.m_update->friend_setIndexInLogic(i);
 #else
+	SleepyUpdateEntry entry = m_sleepyUpdates[i];
+
 	// our children are i*2 and i*2+1
 	Int sz = m_sleepyUpdates.size();
   Int child = ((i)<<1)+1;
-  while (child < sz) 
+  while (child < sz)
 	{
 		// choose the higher-priority of the two children; we must be higher-pri than that.
-		if (child < sz-1 && isLowerPriority(m_sleepyUpdates[child], m_sleepyUpdates[child+1]))
+		if (child < sz-1 && isLowerPriority(m_sleepyUpdates[child].m_priority, m_sleepyUpdates[child+1].m_priority))
       ++child;
-		
+
 		// if we're higher-pri than our children, we're done.
-		if (!isLowerPriority(m_sleepyUpdates[i], m_sleepyUpdates[child]))
+		if (!isLowerPriority(entry.m_priority, m_sleepyUpdates[child].m_priority))
 		{
 			break;
 		}
 
-		// doh. swap with the highest-pri child we have.
-		UpdateModulePtr a = m_sleepyUpdates[child];
-		UpdateModulePtr b = m_sleepyUpdates[i];
-
-		m_sleepyUpdates[i] = a;
-		m_sleepyUpdates[child] = b;
-
-		a->friend_setIndexInLogic(i);
-		b->friend_setIndexInLogic(child);
+		// doh. move the highest-pri child we have up into our spot.
+		m_sleepyUpdates[i] = m_sleepyUpdates[child];
+		m_sleepyUpdates[i].m_update->friend_setIndexInLogic(i);
 		i = child;
 		child = ((i)<<1)+1;
   }
+
+	m_sleepyUpdates[i] = entry;
+	entry.m_update->friend_setIndexInLogic(i);
 #endif
 	return i;
 }
@@ -2922,13 +2951,25 @@ void GameLogic::rebalanceSleepyUpdate(Int i)
 	i = rebalanceChildSleepyUpdate(i);
 }
 
+// ------------------------------------------------------------------------------------------------
+void GameLogic::setSleepyUpdateFrame(UpdateModulePtr u, UnsignedInt frame)
+{
+	// the copy of the priority in the list must change along with the module's, wherever the
+	// module is, since every later comparison against it has to see the new value.
+	u->friend_setNextCallFrame(frame);
+
+	Int idx = u->friend_getIndexInLogic();
+	DEBUG_ASSERTCRASH(idx >= 0 && idx < m_sleepyUpdates.size() && m_sleepyUpdates[idx].m_update == u, ("bad sleepy idx"));
+	m_sleepyUpdates[idx].m_priority = u->friend_getPriority();
+}
+
 // ------------------------------------------------------------------------------------------------
 void GameLogic::remakeSleepyUpdate()
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
 	Int parent = m_sleepyUpdates.size() / 2;
-  while (true) 
+  while (true)
 	{
     rebalanceChildSleepyUpdate(parent);
     if (parent == 0)
@@ -2946,9 +2987,12 @@ void GameLogic::pushSleepyUpdate(UpdateModulePtr u)
 
 	DEBUG_ASSERTCRASH(u != NULL, ("You may not pass null for sleepy update info"));
 
-	m_sleepyUpdates.push_back(u);
+	SleepyUpdateEntry entry;
+	entry.m_priority = u->friend_getPriority();
+	entry.m_update = u;
+	m_sleepyUpdates.push_back(entry);
 	u->friend_setIndexInLogic(m_sleepyUpdates.size() - 1);
-	
+
 	rebalanceParentSleepyUpdate(m_sleepyUpdates.size()-1);
 }
 
@@ -2957,7 +3001,7 @@ UpdateModulePtr GameLogic::peekSleepyUpdate() const
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
-	UpdateModulePtr u = m_sleepyUpdates.front();
+	UpdateModulePtr u = m_sleepyUpdates.front().m_update;
 	DEBUG_ASSERTCRASH(u->friend_getIndexInLogic() == 0, ("index mismatch: expected %d, got %d\n",0,u->friend_getIndexInLogic()));
 	return u;
 }
@@ -2974,11 +3018,11 @@ void GameLogic::popSleepyUpdate()
 		return;
 	}
 
-	m_sleepyUpdates[0]->friend_setIndexInLogic(-1);
+	m_sleepyUpdates[0].m_update->friend_setIndexInLogic(-1);
 	if (sz > 1)
 	{
 		m_sleepyUpdates[0] = m_sleepyUpdates[sz-1];
-		m_sleepyUpdates[0]->friend_setIndexInLogic(0);
+		m_sleepyUpdates[0].m_update->friend_setIndexInLogic(0);
 		m_sleepyUpdates.pop_back();
 		rebalanceChildSleepyUpdate(0);
 	}
@@ -3026,14 +3070,14 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 			return;
 		}
 
-		if (m_sleepyUpdates[idx] != u)
+		if (m_sleepyUpdates[idx].m_update != u)
 		{
 			RELEASE_CRASH("fatal error! sleepy update module index mismatch.\n");
 			return;
 		}
 
 		// update the value.
-		u->friend_setNextCallFrame(whenToWakeUp);
+		setSleepyUpdateFrame(u, whenToWakeUp);
 
 		// rebalance.
 		rebalanceSleepyUpdate(idx);
@@ -3768,7 +3812,7 @@ void GameLogic::update( void )
 			}
 
 			// else defer it till next frame and re-push it
-			u->friend_setNextCallFrame(now + sleepLen);
+			setSleepyUpdateFrame(u, now + sleepLen);
 			rebalanceSleepyUpdate(0);
 		}
 	}
@@ -5047,9 +5091,9 @@ void GameLogic::loadPostProcess( void )
 			m_nextObjID = (ObjectID)((UnsignedInt)obj->getID() + 1);
 
 	// blow away the sleepy update and normal update module lists
-	for (std::vector<UpdateModulePtr>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
+	for (std::vector<SleepyUpdateEntry>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
 	{
-		(*it)->friend_setIndexInLogic(-1);
+		it->m_update->friend_setIndexInLogic(-1);
 	}
 	m_sleepyUpdates.clear();
 #ifdef ALLOW_NONSLEEPY_UPDATES
@@ -5093,7 +5137,10 @@ void GameLogic::loadPostProcess( void )
 				u->friend_setNextCallFrame(now);
 #endif
 			{
-				m_sleepyUpdates.push_back(u);
+				SleepyUpdateEntry entry;
+				entry.m_priority = u->friend_getPriority();
+				entry.m_update = u;
+				m_sleepyUpdates.push_back(entry);
 				u->friend_setIndexInLogic(m_sleepyUpdates.size() - 1);
 			}
 				
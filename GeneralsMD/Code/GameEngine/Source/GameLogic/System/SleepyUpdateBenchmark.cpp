@@ -0,0 +1,309 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// SleepyUpdateBenchmark.cpp
+// Microbenchmark of the sleepy update queue in GameLogic.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameLogic/SleepyUpdateBenchmark.h"
+
+#include "GameLogic/Module/UpdateModule.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+//-------------------------------------------------------------------------------------------------
+/** Stand-in for an UpdateModule: the scheduler fields, plus enough padding that the modules are
+	spread out over memory like the real ones. */
+struct BenchModule
+{
+	UnsignedInt m_priority;
+	Int m_indexInLogic;
+	Int m_id;
+	char m_padding[116];
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The queue as it was: module pointers only, reading each module's priority while sifting,
+	and swapping at every level. */
+class BenchPointerQueue
+{
+public:
+
+	void push( BenchModule *m )
+	{
+		m_heap.push_back(m);
+		m->m_indexInLogic = m_heap.size() - 1;
+		rebalanceParent(m_heap.size() - 1);
+	}
+
+	BenchModule *peek() const { return m_heap.front(); }
+
+	void setPriority( BenchModule *m, UnsignedInt priority )
+	{
+		m->m_priority = priority;
+		Int i = rebalanceParent(m->m_indexInLogic);
+		rebalanceChild(i);
+	}
+
+private:
+
+	Int rebalanceParent( Int i )
+	{
+		Int parent = ((i+1)>>1)-1;
+		while (parent >= 0 && m_heap[parent]->m_priority > m_heap[i]->m_priority)
+		{
+			BenchModule *a = m_heap[parent];
+			BenchModule *b = m_heap[i];
+			m_heap[i] = a;
+			m_heap[parent] = b;
+			a->m_indexInLogic = i;
+			b->m_indexInLogic = parent;
+			i = parent;
+			parent = ((parent+1)>>1)-1;
+		}
+		return i;
+	}
+
+	Int rebalanceChild( Int i )
+	{
+		Int sz = m_heap.size();
+		Int child = (i<<1)+1;
+		while (child < sz)
+		{
+			if (child < sz-1 && m_heap[child]->m_priority > m_heap[child+1]->m_priority)
+				++child;
+			if (!(m_heap[i]->m_priority > m_heap[child]->m_priority))
+				break;
+			BenchModule *a = m_heap[child];
+			BenchModule *b = m_heap[i];
+			m_heap[i] = a;
+			m_heap[child] = b;
+			a->m_indexInLogic = i;
+			b->m_indexInLogic = child;
+			i = child;
+			child = (i<<1)+1;
+		}
+		return i;
+	}
+
+	std::vector<BenchModule *> m_heap;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The queue as it is now: a copy of each module's priority kept next to its pointer, with
+	entries carried along in a hole. */
+class BenchEntryQueue
+{
+public:
+
+	void push( BenchModule *m )
+	{
+		Entry entry;
+		entry.m_priority = m->m_priority;
+		entry.m_module = m;
+		m_heap.push_back(entry);
+		m->m_indexInLogic = m_heap.size() - 1;
+		rebalanceParent(m_heap.size() - 1);
+	}
+
+	BenchModule *peek() const { return m_heap.front().m_module; }
+
+	void setPriority( BenchModule *m, UnsignedInt priority )
+	{
+		m->m_priority = priority;
+		m_heap[m->m_indexInLogic].m_priority = priority;
+		Int i = rebalanceParent(m->m_indexInLogic);
+		rebalanceChild(i);
+	}
+
+private:
+
+	struct Entry
+	{
+		UnsignedInt m_priority;
+		BenchModule *m_module;
+	};
+
+	Int rebalanceParent( Int i )
+	{
+		Entry entry = m_heap[i];
+		Int parent = ((i+1)>>1)-1;
+		while (parent >= 0 && m_heap[parent].m_priority > entry.m_priority)
+		{
+			m_heap[i] = m_heap[parent];
+			m_heap[i].m_module->m_indexInLogic = i;
+			i = parent;
+			parent = ((parent+1)>>1)-1;
+		}
+		m_heap[i] = entry;
+		entry.m_module->m_indexInLogic = i;
+		return i;
+	}
+
+	Int rebalanceChild( Int i )
+	{
+		Entry entry = m_heap[i];
+		Int sz = m_heap.size();
+		Int child = (i<<1)+1;
+		while (child < sz)
+		{
+			if (child < sz-1 && m_heap[child].m_priority > m_heap[child+1].m_priority)
+				++child;
+			if (!(entry.m_priority > m_heap[child].m_priority))
+				break;
+			m_heap[i] = m_heap[child];
+			m_heap[i].m_module->m_indexInLogic = i;
+			i = child;
+			child = (i<<1)+1;
+		}
+		m_heap[i] = entry;
+		entry.m_module->m_indexInLogic = i;
+		return i;
+	}
+
+	std::vector<Entry> m_heap;
+};
+
+//-------------------------------------------------------------------------------------------------
+static UnsignedInt nextRandom( UnsignedInt &seed )
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+static UnsignedInt makePriority( const BenchModule *m, UnsignedInt frame )
+{
+	if (frame > UPDATE_SLEEP_FOREVER)
+		frame = UPDATE_SLEEP_FOREVER;
+	SleepyUpdatePhase phase = (m->m_id % 8 == 0) ? PHASE_PHYSICS : PHASE_NORMAL;
+	return (frame << 2) | phase;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A rough mix of what update modules return: a lot of every-frame modules, a lot of
+	short naps, some long ones, and some that sleep until something wakes them. */
+static UnsignedInt pickSleep( UnsignedInt &seed )
+{
+	UnsignedInt r = nextRandom(seed);
+	switch (r % 10)
+	{
+		case 0: case 1: case 2:	return 1;
+		case 3: case 4: case 5:	return 1 + (r >> 4) % 10;
+		case 6: case 7: case 8:	return 1 + (r >> 4) % 90;
+		default:								return UPDATE_SLEEP_FOREVER;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Run the schedule through one queue. Each frame a few modules are woken early, as setWakeFrame()
+	does, then every module that is due is "updated" and put back to sleep, as GameLogic::update() does.
+	Returns the time in seconds; callOrderCRC gets a hash of the order the modules were called in. */
+template <class QUEUE>
+static Real runSchedule( QUEUE &queue, std::vector<BenchModule *> &modules, Int numFrames, UnsignedInt &callOrderCRC, Int &numCalls )
+{
+	Int numModules = modules.size();
+	UnsignedInt seed = 0x5eed;
+	Int i;
+	for (i = 0; i < numModules; ++i)
+	{
+		modules[i]->m_indexInLogic = -1;
+		modules[i]->m_priority = makePriority(modules[i], 1 + nextRandom(seed) % 30);
+	}
+
+	Int64 freq64, startTime64, endTime64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+
+	for (i = 0; i < numModules; ++i)
+		queue.push(modules[i]);
+
+	callOrderCRC = 0;
+	numCalls = 0;
+	Int numWakesPerFrame = numModules / 200 + 1;
+	for (UnsignedInt now = 1; now <= (UnsignedInt)numFrames; ++now)
+	{
+		for (Int w = 0; w < numWakesPerFrame; ++w)
+		{
+			BenchModule *m = modules[nextRandom(seed) % numModules];
+			queue.setPriority(m, makePriority(m, now + 1 + nextRandom(seed) % 30));
+		}
+
+		while ((queue.peek()->m_priority >> 2) <= now)
+		{
+			BenchModule *m = queue.peek();
+			callOrderCRC = callOrderCRC * 31 + m->m_id;
+			++numCalls;
+			queue.setPriority(m, makePriority(m, now + pickSleep(seed)));
+		}
+	}
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	return (Real)((double)(endTime64 - startTime64) / (double)freq64);
+}
+
+//-------------------------------------------------------------------------------------------------
+void runSleepyUpdateBenchmark( Int numModules, Int numFrames )
+{
+	if (numModules <= 0 || numFrames <= 0)
+		return;
+
+	// allocate the modules one at a time and queue them in a shuffled order, so that neighbors
+	// in the queue are not neighbors in memory.
+	std::vector<BenchModule *> modules;
+	modules.resize(numModules);
+	Int i;
+	for (i = 0; i < numModules; ++i)
+	{
+		modules[i] = MSGNEW("SleepyUpdateBenchmark") BenchModule;
+		modules[i]->m_id = i;
+	}
+	UnsignedInt seed = 0xbe7c4;
+	for (i = numModules - 1; i > 0; --i)
+	{
+		Int j = nextRandom(seed) % (i + 1);
+		BenchModule *tmp = modules[i];
+		modules[i] = modules[j];
+		modules[j] = tmp;
+	}
+
+	UnsignedInt pointerCRC, entryCRC;
+	Int pointerCalls, entryCalls;
+	Real pointerTime, entryTime;
+	{
+		BenchPointerQueue queue;
+		pointerTime = runSchedule(queue, modules, numFrames, pointerCRC, pointerCalls);
+	}
+	{
+		BenchEntryQueue queue;
+		entryTime = runSchedule(queue, modules, numFrames, entryCRC, entryCalls);
+	}
+
+	Real numCalls = (Real)(pointerCalls > 0 ? pointerCalls : 1);
+	DEBUG_LOG(("SleepyUpdateBenchmark - %d modules, %d frames, %d update calls\n", numModules, numFrames, pointerCalls));
+	DEBUG_LOG(("SleepyUpdateBenchmark - pointer queue: %.3f ms, %.1f ns/call\n", pointerTime * 1000.0f, pointerTime * 1.0e9f / numCalls));
+	DEBUG_LOG(("SleepyUpdateBenchmark - entry queue:   %.3f ms, %.1f ns/call\n", entryTime * 1000.0f, entryTime * 1.0e9f / numCalls));
+	DEBUG_LOG(("SleepyUpdateBenchmark - call order %s (%08x %08x)\n",
+		(pointerCRC == entryCRC && pointerCalls == entryCalls) ? "matches" : "DIFFERS", pointerCRC, entryCRC));
+	DEBUG_ASSERTCRASH(pointerCRC == entryCRC && pointerCalls == entryCalls, ("sleepy update queues called modules in different orders"));
+
+	for (i = 0; i < numModules; ++i)
+		delete modules[i];
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
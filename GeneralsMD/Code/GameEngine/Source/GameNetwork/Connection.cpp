@@ -43,6 +43,7 @@ Connection::Connection() {
 	m_frameGrouping = 1;
 	m_isQuitting = false;
 	m_quitTime = 0;
+	m_packetFormat = NETPACKETFORMAT_FIXED;
 	// Added By Sadullah Nader
 	// clearing out the latency tracker
 	m_averageLatency = 0.0f;
@@ -89,7 +90,9 @@ void Connection::init() {
 	m_lastTimeSent = 0;
 	m_frameGrouping = 1;
 	m_numRetries = 0;
+	m_totalRetries = 0;
 	m_retryMetricsTime = 0;
+	m_packetFormat = NETPACKETFORMAT_FIXED;
 
 	for (Int i = 0; i < CONNECTION_LATENCY_HISTORY_LENGTH; ++i) {
 		m_latencies[i] = 0;
@@ -160,6 +163,7 @@ void Connection::sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay) {
 		// resend the ENTIRE command (i.e. multiple packets work of data) and only do the retry
 		// one wrapper command at a time.
 		packet->reset();
+		packet->setFormat(m_packetFormat);
 
 		NetCommandRef *tempref = NEW_NETCOMMANDREF(msg);
 
@@ -277,13 +281,23 @@ UnsignedInt Connection::doSend() {
 		return 0;
 	}
 	
+	static NetPacket *packet = NULL;
+
+	// this is done so we don't have to allocate and delete a packet every time we send one.
+	if (packet == NULL) {
+		packet = newInstance(NetPacket);
+	}
+
 	// iterate through all the messages and put them into a packet(s).
 	NetCommandRef *msg = m_netCommandList->getFirstMessage();
 
 	while ((msg != NULL) && couldQueue) {
-		NetPacket *packet = newInstance(NetPacket);
-		packet->init();
+		// the packet is written straight into the buffer the transport sends it from.
+		TransportBuffer *buffer = newInstance(TransportBuffer);
+		packet->attachBuffer(buffer);
+		buffer->detach();
 		packet->setAddress(m_user->GetIPAddr(), m_user->GetPort());
+		packet->setFormat(m_packetFormat);
 
 		Bool notDone = TRUE;
 
@@ -300,6 +314,7 @@ UnsignedInt Connection::doSend() {
 					if (CommandRequiresAck(msg->getCommand())) {
 						if (timeLastSent != -1) {
 							++m_numRetries;
+							++m_totalRetries;
 						}
 						doRetryMetrics();
 						msg->setTimeLastSent(curtime);
@@ -318,16 +333,13 @@ UnsignedInt Connection::doSend() {
 
 		++numpackets;
 
-		/// @todo Make the act of giving the transport object a packet to send more efficient.  Make the transport take a NetPacket object rather than the raw data, thus avoiding an extra memcpy.
 		if (packet->getNumCommands() > 0) {
-			// If the packet actually has any information to give, give it to the transport object
-			// for transmission.
-			couldQueue = m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getData(), packet->getLength());
+			// If the packet actually has any information to give, hand its buffer to the transport
+			// object for transmission.
+			couldQueue = m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getBuffer(), packet->getLength());
 			m_lastTimeSent = curtime;
 		}
-		if (packet != NULL) {
-			packet->deleteInstance(); // delete the packet now that we're done with it.
-		}
+		packet->detachBuffer(); // the transport has its own reference to the buffer if it kept it.
 	}
 
 	return numpackets;
@@ -198,6 +198,10 @@ void ConnectionManager::init()
 
 	m_frameMetrics.init();
 
+	m_runAheadController.setHysteresis(TheGlobalData->m_networkRunAheadHysteresis, TheGlobalData->m_networkRunAheadDecreaseDelay,
+		TheGlobalData->m_networkRunAheadMinCushion);
+	m_runAheadController.reset();
+
 	TheDisconnectMenu = NEW DisconnectMenu;
 	TheDisconnectMenu->init();
 
@@ -283,6 +287,7 @@ void ConnectionManager::reset()
 	}
 
 	m_frameMetrics.reset();
+	m_runAheadController.reset();
 }
 
 UnsignedInt ConnectionManager::getPingFrame()
@@ -352,7 +357,7 @@ void ConnectionManager::doRelay() {
 
 	NetPacket *packet = NULL;
 
-	for (Int i = 0; i < MAX_MESSAGES; ++i) {
+	for (Int i = 0; i < MAX_TRANSPORT_MESSAGES; ++i) {
 		if (m_transport->m_inBuffer[i].length != 0) {
 			// This transport buffer has yet to be processed.
 
@@ -1220,7 +1225,7 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 	if ((lasttimesent == 0) || ((curTime - lasttimesent) > TheGlobalData->m_networkRunAheadMetricsTime)) {
 		if (m_localSlot == m_packetRouterSlot) {
 			// We are the packet router, time to compute a new run ahead for this game.
-			m_latencyAverages[m_localSlot] = m_frameMetrics.getAverageLatency();
+			m_latencyAverages[m_localSlot] = getLocalLatency();
 
 			// since we are now using the display frame rate rather than the logic frame rate to get our average FPS,
 			// it doesn't make sense to send the desired logic frame rate if we "slugged" ourself.
@@ -1249,14 +1254,12 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 				minFps = TheGlobalData->m_framesPerSecondLimit; // Cap to 30 FPS.
 			}
 			DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::updateRunAhead - minFps after adjustment is %d\n", minFps));
-			Int newRunAhead = (Int)((getMaximumLatency() / 2.0) * (Real)minFps);
-			newRunAhead += (newRunAhead * TheGlobalData->m_networkRunAheadSlack) / 100; // Add in 10% of slack to the run ahead in case of network hiccups.
-			if (newRunAhead < MIN_RUNAHEAD) {
-				newRunAhead = MIN_RUNAHEAD; // make sure its at least MIN_RUNAHEAD.
-			}
-
-			if (newRunAhead > (MAX_FRAMES_AHEAD / 2)) {
-				newRunAhead = MAX_FRAMES_AHEAD / 2; // dont let run ahead get out of hand.
+			// The latencies already allow for the spikes we expect, so there is no slack to add.  The controller
+			// raises the run ahead right away, but only lowers it once it has been able to for a while.
+			Int newRunAhead = m_runAheadController.update(oldRunAhead, getMaximumLatency(), minFps, (Int)getMinimumCushion());
+			if (newRunAhead != oldRunAhead) {
+				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::updateRunAhead - run ahead %d -> %d, target %d, min cushion %d\n", oldRunAhead, newRunAhead,
+					RunAheadController::getTargetRunAhead(getMaximumLatency(), minFps), (Int)getMinimumCushion()));
 			}
 
 			NetRunAheadCommandMsg *msg = newInstance(NetRunAheadCommandMsg);
@@ -1336,7 +1339,7 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 			if (DoesCommandRequireACommandID(msg->getNetCommandType())) {
 				msg->setID(GenerateNextCommandID());
 			}
-			msg->setAverageLatency(m_frameMetrics.getAverageLatency());
+			msg->setAverageLatency(getLocalLatency());
 
 			// see above for explanation.
 //			if (didSelfSlug) {
@@ -1395,6 +1398,14 @@ void ConnectionManager::getMinimumFps(Int &minFps, Int &minFpsPlayer) {
 //	DEBUG_LOG(("\n"));
 }
 
+/**
+ * The latency that NetworkRunAheadPercentile percent of our recent round trips to the packet router
+ * came in under.  This goes out in the run ahead metrics in place of the average latency.
+ */
+Real ConnectionManager::getLocalLatency() {
+	return m_frameMetrics.getLatencyPercentile(TheGlobalData->m_networkRunAheadPercentile);
+}
+
 UnsignedInt ConnectionManager::getMinimumCushion() {
 	return m_frameMetrics.getMinimumCushion();
 }
@@ -1865,6 +1876,7 @@ void ConnectionManager::parseUserList(const GameInfo *game)
 	Int numUsers = 0;
 	m_localSlot = -1;
 	DEBUG_LOG(("Local slot is %d\n", game->getLocalSlotNum()));
+	DEBUG_LOG(("Game packets are in format %d\n", game->getPacketFormat()));
 	for (i=0; i<MAX_SLOTS; ++i)
 	{
 		const GameSlot *slot = game->getConstSlot(i);	// badness, but since we cast right back to const, we should be ok
@@ -1881,6 +1893,7 @@ void ConnectionManager::parseUserList(const GameInfo *game)
 				m_connections[i] = newInstance(Connection)();
 				m_connections[i]->init();
 				m_connections[i]->attachTransport(m_transport);
+				m_connections[i]->setPacketFormat(game->getPacketFormat());
 //				UnsignedShort port = (TheNAT)?TheNAT->getSlotPort(i):8088;
 				UnsignedShort port = slot->getPort();
 				m_connections[i]->setUser(newInstance(User)(slot->getName(), slot->getIP(), port));
@@ -2074,6 +2087,19 @@ UnsignedInt ConnectionManager::getPacketArrivalCushion() {
 	return retval;
 }
 
+/**
+ * Return the number of commands that have had to be resent, over all the connections.
+ */
+Int ConnectionManager::getTotalRetries( void ) {
+	Int retval = 0;
+	for (Int i = 0; i < NUM_CONNECTIONS; ++i) {
+		if (m_connections[i] != NULL) {
+			retval += m_connections[i]->getTotalRetries();
+		}
+	}
+	return retval;
+}
+
 void ConnectionManager::sendChat(UnicodeString text, Int playerMask, UnsignedInt executionFrame)
 {
 	NetChatCommandMsg *msg = newInstance(NetChatCommandMsg);
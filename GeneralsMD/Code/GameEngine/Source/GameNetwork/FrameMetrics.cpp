@@ -77,8 +77,10 @@ void FrameMetrics::init() {
 		m_fpsList[i] = 30.0;
 	}
 	m_fpsListIndex = 0;
+	m_latencyHistogram.reset();
 	for (i = 0; i < TheGlobalData->m_networkLatencyHistoryLength; ++i) {
 		m_latencyList[i] = (Real)0.2;
+		m_latencyHistogram.add(m_latencyList[i]);
 	}
 	m_cushionIndex = 0;
 }
@@ -116,8 +118,10 @@ void FrameMetrics::processLatencyResponse(UnsignedInt frame) {
 
 	Int latencyListIndex = frame % TheGlobalData->m_networkLatencyHistoryLength;
 	m_averageLatency -= m_latencyList[latencyListIndex] / TheGlobalData->m_networkLatencyHistoryLength;
+	m_latencyHistogram.remove(m_latencyList[latencyListIndex]);
 	m_latencyList[latencyListIndex] = (Real)timeDiff / (Real)1000; // convert to seconds from milliseconds.
 	m_averageLatency += m_latencyList[latencyListIndex] / TheGlobalData->m_networkLatencyHistoryLength;
+	m_latencyHistogram.add(m_latencyList[latencyListIndex]);
 
 	if (frame % 16 == 0) {
 //		DEBUG_LOG(("ConnectionManager::processFrameInfoAck - average latency = %f\n", m_averageLatency));
@@ -143,6 +147,10 @@ Real FrameMetrics::getAverageLatency() {
 	return m_averageLatency;
 }
 
+Real FrameMetrics::getLatencyPercentile(Int percentile) {
+	return m_latencyHistogram.getPercentile(percentile);
+}
+
 Int FrameMetrics::getMinimumCushion() {
 	return m_minimumCushion;
 }
\ No newline at end of file
@@ -312,6 +312,7 @@ void GameInfo::reset( void )
 	m_useStats = TRUE;
 	m_surrendered = FALSE;
   m_oldFactionsOnly = FALSE;
+	m_packetFormat = NETPACKETFORMAT_FIXED;	// only network games we host use a newer format; see LANAPI and GameSpyInfo
 	// Added By Sadullah Nader
 	// Initializations missing and needed
 //	m_localIP = 0; // BGC - actually we don't want this to be reset since the m_localIP is 
@@ -931,6 +932,15 @@ AsciiString GameInfoToAsciiString( const GameInfo *game )
 		game->getMapCRC(), game->getMapSize(), game->getSeed(), game->getCRCInterval(), game->getSuperweaponRestriction(),
 		game->getStartingCash().countMoney(), game->oldFactionsOnly() ? 'Y' : 'N' );
 
+	// builds from before the packet formats don't know this key, and turn down the options when
+	// they see it, rather than join a game whose packets they can't read.
+	if (game->getPacketFormat() != NETPACKETFORMAT_FIXED)
+	{
+		AsciiString formatString;
+		formatString.format("PF=%d;", game->getPacketFormat());
+		optionsString.concat(formatString);
+	}
+
 	//add player info for each slot
 	optionsString.concat(slotListID);
 	optionsString.concat('=');
@@ -1022,6 +1032,7 @@ Bool ParseAsciiStringToGameInfo(GameInfo *game, AsciiString options)
 	Int useStats = TRUE;
   Money startingCash = TheGlobalData->m_defaultStartingCash;
   UnsignedShort restriction = 0; // Always the default
+	Int packetFormat = NETPACKETFORMAT_FIXED; // a game that doesn't say is in the format from before there were others
   
 	Bool sawMap, sawMapCRC, sawMapSize, sawSeed, sawSlotlist, sawUseStats, sawSuperweaponRestriction, sawStartingCash, sawOldFactions;
 	sawMap = sawMapCRC = sawMapSize = sawSeed = sawSlotlist = sawUseStats = sawSuperweaponRestriction = sawStartingCash = sawOldFactions = FALSE;
@@ -1124,6 +1135,16 @@ Bool ParseAsciiStringToGameInfo(GameInfo *game, AsciiString options)
       oldFactionsOnly = ( val.compareNoCase( "Y" ) == 0 );
       sawOldFactions = TRUE;
     }
+		else if (key.compare("PF") == 0)
+		{
+			packetFormat = atoi(val.str());
+			if (packetFormat < NETPACKETFORMAT_FIXED || packetFormat > NETPACKETFORMAT_LATEST)
+			{
+				optionsOk = FALSE;
+				DEBUG_LOG(("ParseAsciiStringToGameInfo - game uses packet format %d, we only know up to %d; quitting\n", packetFormat, NETPACKETFORMAT_LATEST));
+				break;
+			}
+		}
 		else if (key.getLength() == 1 && *key.str() == slotListID)
 		{
 			sawSlotlist = true;
@@ -1486,6 +1507,7 @@ Bool ParseAsciiStringToGameInfo(GameInfo *game, AsciiString options)
     game->setSuperweaponRestriction(restriction);
     game->setStartingCash( startingCash );
     game->setOldFactionsOnly( oldFactionsOnly );
+		game->setPacketFormat( (NetPacketFormat)packetFormat );
 
 		return true;
 	}
@@ -340,7 +340,7 @@ void LANAPI::update( void )
 
 	// Handle any new messages
 	int i;
-	for (i=0; i<MAX_MESSAGES && !LANbuttonPushed; ++i)
+	for (i=0; i<MAX_TRANSPORT_MESSAGES && !LANbuttonPushed; ++i)
 	{
 		if (m_transport->m_inBuffer[i].length > 0)
 		{
@@ -892,6 +892,7 @@ void LANAPI::RequestGameCreate( UnicodeString gameName, Bool isDirectConnect )
 	
 //	myGame->setInProgress(false);
 	myGame->enterGame();
+	myGame->setPacketFormat(NETPACKETFORMAT_LATEST); // the games we host use the best format we have
 	UnicodeString s;
 	s.format(L"%8.8X%8.8X", m_localIP, myGame->getSeed());
 	if (gameName.isEmpty())
@@ -0,0 +1,206 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// LoopbackTransport.cpp
+// A Transport that passes its packets through memory instead of a socket.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/LoopbackTransport.h"
+
+//-------------------------------------------------------------------------------------------------
+LoopbackNetwork::LoopbackNetwork() :
+	m_latency(0),
+	m_jitter(0),
+	m_packetLoss(0),
+	m_numSent(0),
+	m_numLost(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+LoopbackNetwork::~LoopbackNetwork()
+{
+	DEBUG_ASSERTCRASH(m_endpoints.empty(), ("LoopbackNetwork deleted before its transports"));
+
+	for (DatagramList::iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it)
+	{
+		delete *it;
+	}
+	m_inFlight.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void LoopbackNetwork::setConditions( Int latency, Int jitter, Int packetLoss )
+{
+	m_latency = latency;
+	m_jitter = jitter;
+	m_packetLoss = packetLoss;
+}
+
+//-------------------------------------------------------------------------------------------------
+void LoopbackNetwork::attach( LoopbackTransport *endpoint )
+{
+	m_endpoints.push_back(endpoint);
+}
+
+//-------------------------------------------------------------------------------------------------
+void LoopbackNetwork::detach( LoopbackTransport *endpoint )
+{
+	m_endpoints.remove(endpoint);
+
+	// nobody is listening at that address any more
+	DatagramList::iterator it = m_inFlight.begin();
+	while (it != m_inFlight.end())
+	{
+		Datagram *datagram = *it;
+		if (datagram->m_toIP == endpoint->getIP() && datagram->m_toPort == endpoint->m_port)
+		{
+			delete datagram;
+			it = m_inFlight.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void LoopbackNetwork::send( const LoopbackTransport *from, const UDPDatagram &datagram )
+{
+	++m_numSent;
+
+	if (m_packetLoss > 0 && m_packetLoss >= GameClientRandomValue(1, 100))
+	{
+		++m_numLost;
+		return;
+	}
+
+	// like UDP, a datagram to an address nobody is at just disappears
+	EndpointList::iterator it;
+	for (it = m_endpoints.begin(); it != m_endpoints.end(); ++it)
+	{
+		if ((*it)->getIP() == datagram.ip && (*it)->m_port == datagram.port)
+			break;
+	}
+	if (it == m_endpoints.end())
+	{
+		++m_numLost;
+		return;
+	}
+
+	Int delay = m_latency;
+	if (m_jitter > 0)
+		delay += GameClientRandomValue(-m_jitter, m_jitter);
+	if (delay < 0)
+		delay = 0;
+
+	Datagram *copy = NEW Datagram;
+	copy->m_fromIP = from->getIP();
+	copy->m_fromPort = from->m_port;
+	copy->m_toIP = datagram.ip;
+	copy->m_toPort = datagram.port;
+	copy->m_deliveryTime = timeGetTime() + delay;
+	copy->m_len = (datagram.len < MAX_MESSAGE_LEN) ? datagram.len : MAX_MESSAGE_LEN;
+	memcpy(copy->m_data, datagram.buf, copy->m_len);
+	m_inFlight.push_back(copy);
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool LoopbackNetwork::receive( const LoopbackTransport *to, UDPDatagram &datagram )
+{
+	UnsignedInt now = timeGetTime();
+	for (DatagramList::iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it)
+	{
+		Datagram *copy = *it;
+		if (copy->m_toIP != to->getIP() || copy->m_toPort != to->m_port || copy->m_deliveryTime > now)
+			continue;
+
+		// a read that is too small truncates the datagram, as it does with a socket
+		UnsignedInt len = (copy->m_len < datagram.len) ? copy->m_len : datagram.len;
+		memcpy(datagram.buf, copy->m_data, len);
+		datagram.len = len;
+		datagram.ip = copy->m_fromIP;
+		datagram.port = copy->m_fromPort;
+
+		delete copy;
+		m_inFlight.erase(it);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+LoopbackTransport::LoopbackTransport( LoopbackNetwork *network ) :
+	m_network(network),
+	m_ip(0),
+	m_isOpen(FALSE)
+{
+	m_port = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+LoopbackTransport::~LoopbackTransport()
+{
+	reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool LoopbackTransport::init( UnsignedInt ip, UnsignedShort port )
+{
+	reset();
+
+	m_ip = ip;
+	initBuffers(port);
+
+	m_network->attach(this);
+	m_isOpen = TRUE;
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void LoopbackTransport::reset( void )
+{
+	if (m_isOpen)
+	{
+		m_network->detach(this);
+		m_isOpen = FALSE;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Int LoopbackTransport::writeDatagrams( UDPDatagram *datagrams, Int count )
+{
+	for (Int i=0; i<count; ++i)
+	{
+		m_network->send(this, datagrams[i]);
+	}
+	return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int LoopbackTransport::readDatagrams( UDPDatagram *datagrams, Int count )
+{
+	Int numRead = 0;
+	while (numRead < count && m_network->receive(this, datagrams[numRead]))
+	{
+		++numRead;
+	}
+	return numRead;
+}
@@ -31,6 +31,7 @@
 #include "GameNetwork/NetworkDefs.h"
 #include "GameNetwork/networkutil.h"
 #include "GameNetwork/GameMessageParser.h"
+#include "GameNetwork/Transport.h"
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -38,6 +39,68 @@
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
+// Helpers for the compact packet format.  Integers are written seven bits to a byte, low bits
+// first, with the top bit of each byte set when another byte follows.  Signed values are zig-zagged
+// first (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) so that small negative numbers stay small.
+static inline UnsignedInt zigZagEncode(Int value) {
+	return ((UnsignedInt)value << 1) ^ (UnsignedInt)(value >> 31);
+}
+
+static inline Int zigZagDecode(UnsignedInt value) {
+	return (Int)(value >> 1) ^ -(Int)(value & 1);
+}
+
+/**
+ * Writes the value as a variable length integer and returns the number of bytes it took.
+ * If buffer is NULL, nothing is written.
+ */
+static Int writeVarInt(UnsignedByte *buffer, UnsignedInt value) {
+	Int len = 0;
+	while (value >= 0x80) {
+		if (buffer != NULL) {
+			buffer[len] = (UnsignedByte)(value | 0x80);
+		}
+		++len;
+		value >>= 7;
+	}
+	if (buffer != NULL) {
+		buffer[len] = (UnsignedByte)value;
+	}
+	return len + 1;
+}
+
+/**
+ * Reads a variable length integer, without reading at or past end. If the packet ends before the
+ * integer does, i is left past end so the caller can tell.
+ */
+static UnsignedInt readVarInt(UnsignedByte *data, Int &i, Int end) {
+	UnsignedInt value = 0;
+	for (Int shift = 0; shift < 35; shift += 7) {
+		if (i >= end) {
+			i = end + 1;
+			break;
+		}
+		UnsignedByte b = data[i];
+		++i;
+		value |= (UnsignedInt)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			break;
+		}
+	}
+	return value;
+}
+
+static inline UnsignedByte * bufferAt(UnsignedByte *buffer, Int offset) {
+	return (buffer != NULL) ? (buffer + offset) : NULL;
+}
+
+static Int writeRaw(UnsignedByte *buffer, const void *data, Int size) {
+	if (buffer != NULL) {
+		memcpy(buffer, data, size);
+	}
+	return size;
+}
+
 // This function assumes that all of the fields are either of default value or are
 // present in the raw data.
 NetCommandRef * NetPacket::ConstructNetCommandMsgFromRawData(UnsignedByte *data, UnsignedShort dataLength) {
@@ -941,6 +1004,85 @@ void NetPacket::FillBufferWithGameCommand(UnsignedByte *buffer, NetCommandRef *m
 	gmsg = NULL;
 }
 
+/**
+ * Writes the data portion of a game message in the compact format, and returns its length.
+ * If buffer is NULL the message is only measured.
+ *
+ * The message type and the number of argument types are varints.  Each run of arguments of the
+ * same type gets one byte, with the type in the high four bits and the number of arguments in
+ * the low four; runs of 16 or more arguments put 0 there and follow it with a varint count.
+ * Integers are zig-zag varints, and object and drawable IDs are zig-zag varints of the difference
+ * from the ID before them in the message, so a list of selected units is about a byte a unit.
+ * Team IDs, timestamps and characters are varints, pixels are zig-zag varints, booleans are a
+ * byte, and reals and locations are written as they are.
+ */
+Int NetPacket::FillBufferWithCompactGameMessage(UnsignedByte *buffer, GameMessage *gmsg) {
+	Int len = 0;
+
+	len += writeVarInt(bufferAt(buffer, len), (UnsignedInt)gmsg->getType());
+
+	GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
+	len += writeVarInt(bufferAt(buffer, len), (UnsignedInt)parser->getNumTypes());
+
+	GameMessageParserArgumentType *argType = parser->getFirstArgumentType();
+	while (argType != NULL) {
+		UnsignedInt count = (UnsignedInt)argType->getArgCount();
+		UnsignedByte header = (UnsignedByte)(argType->getType() << 4);
+		if (count < 16) {
+			header |= (UnsignedByte)count;
+		}
+		len += writeRaw(bufferAt(buffer, len), &header, sizeof(header));
+		if (count >= 16) {
+			len += writeVarInt(bufferAt(buffer, len), count);
+		}
+		argType = argType->getNext();
+	}
+
+	parser->deleteInstance();
+	parser = NULL;
+
+	Int lastObjectID = 0;
+	Int lastDrawableID = 0;
+	Int numArgs = gmsg->getArgumentCount();
+	for (Int i = 0; i < numArgs; ++i) {
+		GameMessageArgumentDataType type = gmsg->getArgumentDataType(i);
+		const GameMessageArgumentType *arg = gmsg->getArgument(i);
+
+		if (type == ARGUMENTDATATYPE_INTEGER) {
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->integer));
+		} else if (type == ARGUMENTDATATYPE_REAL) {
+			len += writeRaw(bufferAt(buffer, len), &(arg->real), sizeof(arg->real));
+		} else if (type == ARGUMENTDATATYPE_BOOLEAN) {
+			UnsignedByte b = arg->boolean ? 1 : 0;
+			len += writeRaw(bufferAt(buffer, len), &b, sizeof(b));
+		} else if (type == ARGUMENTDATATYPE_OBJECTID) {
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode((Int)arg->objectID - lastObjectID));
+			lastObjectID = (Int)arg->objectID;
+		} else if (type == ARGUMENTDATATYPE_DRAWABLEID) {
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode((Int)arg->drawableID - lastDrawableID));
+			lastDrawableID = (Int)arg->drawableID;
+		} else if (type == ARGUMENTDATATYPE_TEAMID) {
+			len += writeVarInt(bufferAt(buffer, len), arg->teamID);
+		} else if (type == ARGUMENTDATATYPE_LOCATION) {
+			len += writeRaw(bufferAt(buffer, len), &(arg->location), sizeof(arg->location));
+		} else if (type == ARGUMENTDATATYPE_PIXEL) {
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixel.x));
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixel.y));
+		} else if (type == ARGUMENTDATATYPE_PIXELREGION) {
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixelRegion.lo.x));
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixelRegion.lo.y));
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixelRegion.hi.x));
+			len += writeVarInt(bufferAt(buffer, len), zigZagEncode(arg->pixelRegion.hi.y));
+		} else if (type == ARGUMENTDATATYPE_TIMESTAMP) {
+			len += writeVarInt(bufferAt(buffer, len), arg->timestamp);
+		} else if (type == ARGUMENTDATATYPE_WIDECHAR) {
+			len += writeVarInt(bufferAt(buffer, len), (UnsignedInt)arg->wChar);
+		}
+	}
+
+	return len;
+}
+
 void NetPacket::FillBufferWithAckCommand(UnsignedByte *buffer, NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::FillBufferWithAckCommand - adding ack for command %d for player %d\n", cmdMsg->getCommandID(), msg->getCommand()->getPlayerID()));
 
@@ -1901,6 +2043,8 @@ void NetPacket::FillBufferWithFrameResendRequestMessage(UnsignedByte *buffer, Ne
  * Constructor
  */
 NetPacket::NetPacket() {
+	m_buffer = NULL;
+	m_format = NETPACKETFORMAT_FIXED;
 	init();
 }
 
@@ -1908,6 +2052,8 @@ NetPacket::NetPacket() {
  * Constructor given raw transport data.
  */
 NetPacket::NetPacket(TransportMessage *msg) {
+	m_buffer = NULL;
+	m_format = NETPACKETFORMAT_FIXED;
 	init();
 	m_packetLen = msg->length;
 	memcpy(m_packet, msg->data, MAX_PACKET_SIZE);
@@ -1924,6 +2070,7 @@ NetPacket::~NetPacket() {
 		m_lastCommand->deleteInstance();
 		m_lastCommand = NULL;
 	}
+	detachBuffer();
 }
 
 /**
@@ -1933,12 +2080,14 @@ void NetPacket::init() {
 	m_addr = 0;
 	m_port = 0;
 	m_numCommands = 0;
+	m_packet = (m_buffer != NULL) ? m_buffer->getData() : m_packetStorage;
 	m_packetLen = 0;
 	m_packet[0] = 0;
 
 	m_lastPlayerID = 0;
 	m_lastFrame = 0;
 	m_lastCommandID = 0;
+	m_lastGameCommandID = 0;
 	m_lastCommandType = 0;
 	m_lastRelay = 0;
 
@@ -1953,6 +2102,31 @@ void NetPacket::reset() {
 	init();
 }
 
+/**
+ * Empty the packet, and from now on write it into the data of the given transport buffer.
+ * The packet attaches to the buffer until detachBuffer() or another attachBuffer().
+ */
+void NetPacket::attachBuffer(TransportBuffer *buffer) {
+	if (buffer != NULL) {
+		buffer->attach();
+	}
+	detachBuffer();
+	m_buffer = buffer;
+	reset();
+}
+
+/**
+ * Go back to writing the packet into our own storage.  The packet is emptied.
+ */
+void NetPacket::detachBuffer() {
+	if (m_buffer == NULL) {
+		return;
+	}
+	m_buffer->detach();
+	m_buffer = NULL;
+	reset();
+}
+
 /**
  * Set the address to which this packet is to be sent.
  */
@@ -2046,6 +2220,11 @@ C = Command ID
 R = Relay
 D = Command Data
 Z = Repeat last command
+
+The compact format (NETPACKETFORMAT_COMPACT) writes game commands with these instead:
+f = Execution frame, as a zig-zag varint of the difference from the last frame
+c = Command ID, as a zig-zag varint of the difference from one past the last game command's ID
+d = Game command data, see FillBufferWithCompactGameMessage()
 */
 Bool NetPacket::addFrameResendRequestCommand(NetCommandRef *msg) {
 	Bool needNewCommandID = FALSE;
@@ -4717,11 +4896,17 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
 			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
+			if (m_format == NETPACKETFORMAT_COMPACT) {
+				m_packet[m_packetLen] = 'f';
+				++m_packetLen;
+				m_packetLen += writeVarInt(m_packet + m_packetLen, zigZagEncode((Int)(newframe - m_lastFrame)));
+			} else {
+				m_packet[m_packetLen] = 'F';
+				++m_packetLen;
+				memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
+				m_packetLen += sizeof(UnsignedInt);
+			}
 
 			m_lastFrame = newframe;
 		}
@@ -4751,50 +4936,64 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 
 		// If necessary, specify the command ID of this command.
 		if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-			m_packet[m_packetLen] = 'C';
-			++m_packetLen;
 			UnsignedShort newID = cmdMsg->getID();
-			memcpy(m_packet + m_packetLen, &newID, sizeof(UnsignedShort));
-			m_packetLen += sizeof(UnsignedShort);
+			if (m_format == NETPACKETFORMAT_COMPACT) {
+				m_packet[m_packetLen] = 'c';
+				++m_packetLen;
+				Short delta = (Short)(newID - (UnsignedShort)(m_lastGameCommandID + 1));
+				m_packetLen += writeVarInt(m_packet + m_packetLen, zigZagEncode(delta));
+			} else {
+				m_packet[m_packetLen] = 'C';
+				++m_packetLen;
+				memcpy(m_packet + m_packetLen, &newID, sizeof(UnsignedShort));
+				m_packetLen += sizeof(UnsignedShort);
+			}
 		}
 		m_lastCommandID = cmdMsg->getID();
+		m_lastGameCommandID = cmdMsg->getID();
 
-		m_packet[m_packetLen] = 'D';
-		++m_packetLen;
+		if (m_format == NETPACKETFORMAT_COMPACT) {
+			m_packet[m_packetLen] = 'd';
+			++m_packetLen;
+			m_packetLen += FillBufferWithCompactGameMessage(m_packet + m_packetLen, gmsg);
+		} else {
+			m_packet[m_packetLen] = 'D';
+			++m_packetLen;
 
-		// Now copy the GameMessage type into the packet.
-		GameMessage::Type newType = gmsg->getType();
-		memcpy(m_packet + m_packetLen, &newType, sizeof(GameMessage::Type));
-		m_packetLen += sizeof(GameMessage::Type);
+			// Now copy the GameMessage type into the packet.
+			GameMessage::Type newType = gmsg->getType();
+			memcpy(m_packet + m_packetLen, &newType, sizeof(GameMessage::Type));
+			m_packetLen += sizeof(GameMessage::Type);
 
 
-		GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
-		UnsignedByte numTypes = parser->getNumTypes();
-		memcpy(m_packet + m_packetLen, &numTypes, sizeof(numTypes));
-		m_packetLen += sizeof(numTypes);
+			GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
+			UnsignedByte numTypes = parser->getNumTypes();
+			memcpy(m_packet + m_packetLen, &numTypes, sizeof(numTypes));
+			m_packetLen += sizeof(numTypes);
 
-		GameMessageParserArgumentType *argType = parser->getFirstArgumentType();
-		while (argType != NULL) {
-			UnsignedByte type = (UnsignedByte)(argType->getType());
-			memcpy(m_packet + m_packetLen, &type, sizeof(type));
-			m_packetLen += sizeof(type);
+			GameMessageParserArgumentType *argType = parser->getFirstArgumentType();
+			while (argType != NULL) {
+				UnsignedByte type = (UnsignedByte)(argType->getType());
+				memcpy(m_packet + m_packetLen, &type, sizeof(type));
+				m_packetLen += sizeof(type);
 
-			UnsignedByte argTypeCount = argType->getArgCount();
-			memcpy(m_packet + m_packetLen, &argTypeCount, sizeof(argTypeCount));
-			m_packetLen += sizeof(argTypeCount);
+				UnsignedByte argTypeCount = argType->getArgCount();
+				memcpy(m_packet + m_packetLen, &argTypeCount, sizeof(argTypeCount));
+				m_packetLen += sizeof(argTypeCount);
 
-			argType = argType->getNext();
-		}
+				argType = argType->getNext();
+			}
 
-		Int numArgs = gmsg->getArgumentCount();
-		for (Int i = 0; i < numArgs; ++i) {
-			GameMessageArgumentDataType type = gmsg->getArgumentDataType(i);
-			GameMessageArgumentType arg = *(gmsg->getArgument(i));
-			writeGameMessageArgumentToPacket(type, arg);
-		}
+			Int numArgs = gmsg->getArgumentCount();
+			for (Int i = 0; i < numArgs; ++i) {
+				GameMessageArgumentDataType type = gmsg->getArgumentDataType(i);
+				GameMessageArgumentType arg = *(gmsg->getArgument(i));
+				writeGameMessageArgumentToPacket(type, arg);
+			}
 
-		parser->deleteInstance();
-		parser = NULL;
+			parser->deleteInstance();
+			parser = NULL;
+		}
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addGameMessage - added game message, frame %d, player %d, command ID %d\n", m_lastFrame, m_lastPlayerID, m_lastCommandID));
 
@@ -4867,7 +5066,11 @@ Bool NetPacket::isRoomForGameMessage(NetCommandRef *msg, GameMessage *gmsg) {
 	Bool needNewCommandID = FALSE;
 
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		msglen += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		if (m_format == NETPACKETFORMAT_COMPACT) {
+			msglen += writeVarInt(NULL, zigZagEncode((Int)(cmdMsg->getExecutionFrame() - m_lastFrame))) + sizeof(UnsignedByte);
+		} else {
+			msglen += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		}
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		msglen += sizeof(UnsignedByte) + sizeof(UnsignedByte);
@@ -4880,7 +5083,17 @@ Bool NetPacket::isRoomForGameMessage(NetCommandRef *msg, GameMessage *gmsg) {
 		msglen += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-		msglen += sizeof(UnsignedShort) + sizeof(UnsignedByte);
+		if (m_format == NETPACKETFORMAT_COMPACT) {
+			Short delta = (Short)(cmdMsg->getID() - (UnsignedShort)(m_lastGameCommandID + 1));
+			msglen += writeVarInt(NULL, zigZagEncode(delta)) + sizeof(UnsignedByte);
+		} else {
+			msglen += sizeof(UnsignedShort) + sizeof(UnsignedByte);
+		}
+	}
+
+	if (m_format == NETPACKETFORMAT_COMPACT) {
+		msglen += sizeof(UnsignedByte) + FillBufferWithCompactGameMessage(NULL, gmsg); // for 'd' and the data
+		return (msglen <= (MAX_PACKET_SIZE - m_packetLen));
 	}
 
 	GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
@@ -4943,6 +5156,7 @@ NetCommandList * NetPacket::getCommandList() {
 	UnsignedShort commandID = 1; // The first command is going to be
 	UnsignedByte commandType = 0;
 	UnsignedByte relay = 0;
+	UnsignedShort lastGameCommandID = 0; // the same as m_lastGameCommandID's default
 	NetCommandRef *lastCommand = NULL;
 
 	Int i = 0;
@@ -4955,6 +5169,9 @@ NetCommandList * NetPacket::getCommandList() {
 			++i;
 			memcpy(&frame, m_packet + i, sizeof(UnsignedInt));
 			i += sizeof(UnsignedInt);
+		} else if (m_packet[i] == 'f') {
+			++i;
+			frame += zigZagDecode(readVarInt(m_packet, i, m_packetLen));
 		} else if (m_packet[i] == 'P') {
 			++i;
 			memcpy(&playerID, m_packet + i, sizeof(UnsignedByte));
@@ -4967,9 +5184,20 @@ NetCommandList * NetPacket::getCommandList() {
 			++i;
 			memcpy(&commandID, m_packet + i, sizeof(UnsignedShort));
 			i += sizeof(UnsignedShort);
-		} else if (m_packet[i] == 'D') {
+		} else if (m_packet[i] == 'c') {
+			++i;
+			commandID = (UnsignedShort)(lastGameCommandID + 1 + zigZagDecode(readVarInt(m_packet, i, m_packetLen)));
+		} else if ((m_packet[i] == 'D') || (m_packet[i] == 'd')) {
+			Bool isCompact = (m_packet[i] == 'd');
 			++i;
 
+			if (isCompact && (commandType != NETCOMMANDTYPE_GAMECOMMAND)) {
+				// only game commands have a compact form, so we can't tell how long this one is.
+				DEBUG_CRASH(("Compact data for a command of type %d, ignoring the rest of the packet.", commandType));
+				dumpPacketToLog();
+				break;
+			}
+
 			NetCommandMsg *msg = NULL;
 
 			//DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::getCommandList() - command of type %d(%s)\n", commandType, GetAsciiNetCommandType((NetCommandType)commandType).str()));
@@ -4977,7 +5205,8 @@ NetCommandList * NetPacket::getCommandList() {
 			switch((NetCommandType)commandType)
 			{
 			case NETCOMMANDTYPE_GAMECOMMAND:
-				msg = readGameMessage(m_packet, i);
+				msg = isCompact ? readCompactGameMessage(m_packet, i, m_packetLen) : readGameMessage(m_packet, i);
+				lastGameCommandID = commandID;
 				//DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("read game command from player %d for frame %d\n", playerID, frame));
 				break;
 			case NETCOMMANDTYPE_ACKBOTH:
@@ -5085,6 +5314,13 @@ NetCommandList * NetPacket::getCommandList() {
 				break;
 			}
 
+			if (msg == NULL && isCompact) {
+				// a compact message that doesn't fit in the packet; we can't tell where the next command starts.
+				DEBUG_LOG(("Bad compact game message, ignoring the rest of the packet.\n"));
+				dumpPacketToLog();
+				break;
+			}
+
 			if (msg == NULL) {
 				DEBUG_CRASH(("Didn't read a message from the packet. Things are about to go wrong."));
 				continue;
@@ -5346,6 +5582,129 @@ void NetPacket::readGameMessageArgumentFromPacket(GameMessageArgumentDataType ty
 	}
 }
 
+/**
+ * Reads the data portion of a game message written by FillBufferWithCompactGameMessage().
+ */
+NetCommandMsg * NetPacket::readCompactGameMessage(UnsignedByte *data, Int &i, Int end)
+{
+	NetGameCommandMsg *msg = newInstance(NetGameCommandMsg);
+
+	msg->setGameMessageType((GameMessage::Type)readVarInt(data, i, end));
+
+	// Get the types and the number of arguments of those types.
+	GameMessageParser *parser = newInstance(GameMessageParser)();
+	// every type takes at least a byte, and so does every argument, so a count larger than what is
+	// left of the packet can't be right.
+	Int numArgTypes = (Int)readVarInt(data, i, end);
+	Bool ok = (i <= end && numArgTypes >= 0 && numArgTypes <= end - i);
+	Int numArgs = 0;
+	Int j = 0;
+	for (; ok && j < numArgTypes; ++j) {
+		if (i >= end) {
+			ok = FALSE;
+			break;
+		}
+		UnsignedByte header = data[i];
+		++i;
+		Int argCount = header & 0x0f;
+		if (argCount == 0) {
+			argCount = (Int)readVarInt(data, i, end);
+		}
+		if (i > end || argCount < 0 || argCount > end - i - numArgs) {
+			ok = FALSE;
+			break;
+		}
+		numArgs += argCount;
+		parser->addArgType((GameMessageArgumentDataType)(header >> 4), argCount);
+	}
+	if (!ok) {
+		DEBUG_LOG(("Compact game message argument counts run past the end of the packet\n"));
+		parser->deleteInstance();
+		parser = NULL;
+		msg->detach();
+		return NULL;
+	}
+
+	Int lastObjectID = 0;
+	Int lastDrawableID = 0;
+	GameMessageParserArgumentType *parserArgType = parser->getFirstArgumentType();
+	while (parserArgType != NULL) {
+		GameMessageArgumentDataType type = parserArgType->getType();
+		Int argCount = parserArgType->getArgCount();
+		for (j = 0; j < argCount; ++j) {
+			GameMessageArgumentType arg;
+			if (type == ARGUMENTDATATYPE_INTEGER) {
+				arg.integer = zigZagDecode(readVarInt(data, i, end));
+			} else if (type == ARGUMENTDATATYPE_REAL) {
+				if (end - i < (Int)sizeof(arg.real)) {
+					i = end + 1;
+					break;
+				}
+				memcpy(&(arg.real), data + i, sizeof(arg.real));
+				i += sizeof(arg.real);
+			} else if (type == ARGUMENTDATATYPE_BOOLEAN) {
+				if (i >= end) {
+					i = end + 1;
+					break;
+				}
+				arg.boolean = (data[i] != 0);
+				++i;
+			} else if (type == ARGUMENTDATATYPE_OBJECTID) {
+				lastObjectID += zigZagDecode(readVarInt(data, i, end));
+				arg.objectID = (ObjectID)lastObjectID;
+			} else if (type == ARGUMENTDATATYPE_DRAWABLEID) {
+				lastDrawableID += zigZagDecode(readVarInt(data, i, end));
+				arg.drawableID = (DrawableID)lastDrawableID;
+			} else if (type == ARGUMENTDATATYPE_TEAMID) {
+				arg.teamID = readVarInt(data, i, end);
+			} else if (type == ARGUMENTDATATYPE_LOCATION) {
+				if (end - i < (Int)sizeof(arg.location)) {
+					i = end + 1;
+					break;
+				}
+				memcpy(&(arg.location), data + i, sizeof(arg.location));
+				i += sizeof(arg.location);
+			} else if (type == ARGUMENTDATATYPE_PIXEL) {
+				arg.pixel.x = zigZagDecode(readVarInt(data, i, end));
+				arg.pixel.y = zigZagDecode(readVarInt(data, i, end));
+			} else if (type == ARGUMENTDATATYPE_PIXELREGION) {
+				arg.pixelRegion.lo.x = zigZagDecode(readVarInt(data, i, end));
+				arg.pixelRegion.lo.y = zigZagDecode(readVarInt(data, i, end));
+				arg.pixelRegion.hi.x = zigZagDecode(readVarInt(data, i, end));
+				arg.pixelRegion.hi.y = zigZagDecode(readVarInt(data, i, end));
+			} else if (type == ARGUMENTDATATYPE_TIMESTAMP) {
+				arg.timestamp = readVarInt(data, i, end);
+			} else if (type == ARGUMENTDATATYPE_WIDECHAR) {
+				arg.wChar = (WideChar)readVarInt(data, i, end);
+			} else {
+				// we can't tell how long an argument we don't know is, so we can't read past it.
+				DEBUG_CRASH(("Unknown argument type %d in a compact game message", type));
+				parser->deleteInstance();
+				parser = NULL;
+				msg->detach();
+				return NULL;
+			}
+			if (i > end) {
+				break;
+			}
+			msg->addArgument(type, arg);
+		}
+		if (i > end) {
+			DEBUG_LOG(("Compact game message runs past the end of the packet\n"));
+			parser->deleteInstance();
+			parser = NULL;
+			msg->detach();
+			return NULL;
+		}
+		parserArgType = parserArgType->getNext();
+	}
+
+	parser->deleteInstance();
+	parser = NULL;
+
+	return (NetCommandMsg *)msg;
+}
+
 /**
  * Reads the data portion of the ack message at this position in the packet.
  */
@@ -0,0 +1,247 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// NetPacketBenchmark.cpp
+// Compares the size and speed of the NetPacket formats on a synthetic stream of game commands.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/NetPacketBenchmark.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "GameNetwork/NetCommandMsg.h"
+#include "GameNetwork/NetCommandRef.h"
+#include "GameNetwork/NetPacket.h"
+
+enum
+{
+	BENCH_PLAYERS = 4,
+	BENCH_PASSES = 20			///< each format encodes and decodes the whole stream this many times
+};
+
+//-------------------------------------------------------------------------------------------------
+static UnsignedInt nextRandom( UnsignedInt &seed )
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A game message like the ones players send the most of */
+//-------------------------------------------------------------------------------------------------
+static GameMessage *makeGameMessage( UnsignedInt &seed )
+{
+	GameMessage *msg = NULL;
+	UnsignedInt r = nextRandom(seed) % 10;
+	if (r < 4)
+	{
+		// a selection: runs of nearby IDs, as the units a player built around the same time are
+		msg = newInstance(GameMessage)(GameMessage::MSG_CREATE_SELECTED_GROUP);
+		msg->appendBooleanArgument(TRUE);
+		Int numUnits = 1 + nextRandom(seed) % 24;
+		ObjectID id = (ObjectID)(1000 + nextRandom(seed) % 20000);
+		for (Int i = 0; i < numUnits; ++i)
+		{
+			msg->appendObjectIDArgument(id);
+			id = (ObjectID)(id + 1 + nextRandom(seed) % 8);
+		}
+	}
+	else if (r < 7)
+	{
+		msg = newInstance(GameMessage)((r == 6) ? GameMessage::MSG_ADD_WAYPOINT : GameMessage::MSG_DO_MOVETO);
+		Coord3D pos;
+		pos.x = (Real)(nextRandom(seed) % 400000) / 100.0f;
+		pos.y = (Real)(nextRandom(seed) % 400000) / 100.0f;
+		pos.z = (Real)(nextRandom(seed) % 5000) / 100.0f;
+		msg->appendLocationArgument(pos);
+	}
+	else if (r < 9)
+	{
+		msg = newInstance(GameMessage)(GameMessage::MSG_DO_ATTACK_OBJECT);
+		msg->appendObjectIDArgument((ObjectID)(1000 + nextRandom(seed) % 20000));
+	}
+	else
+	{
+		msg = newInstance(GameMessage)(GameMessage::MSG_LOGIC_CRC);
+		msg->appendIntegerArgument((Int)((nextRandom(seed) << 8) ^ nextRandom(seed)));
+	}
+	return msg;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A hash of everything about a game command that has to survive the trip through a packet */
+//-------------------------------------------------------------------------------------------------
+static UnsignedInt hashCommand( NetCommandMsg *cmdMsg )
+{
+	UnsignedInt hash = cmdMsg->getExecutionFrame();
+	hash = hash * 31 + cmdMsg->getID();
+	hash = hash * 31 + cmdMsg->getPlayerID();
+
+	GameMessage *msg = ((NetGameCommandMsg *)cmdMsg)->constructGameMessage();
+	hash = hash * 31 + (UnsignedInt)msg->getType();
+	for (Int i = 0; i < msg->getArgumentCount(); ++i)
+	{
+		GameMessageArgumentDataType type = msg->getArgumentDataType(i);
+		const GameMessageArgumentType *arg = msg->getArgument(i);
+		UnsignedInt value = 0;
+		if (type == ARGUMENTDATATYPE_INTEGER)
+			value = (UnsignedInt)arg->integer;
+		else if (type == ARGUMENTDATATYPE_BOOLEAN)
+			value = arg->boolean ? 1 : 0;
+		else if (type == ARGUMENTDATATYPE_OBJECTID)
+			value = (UnsignedInt)arg->objectID;
+		else if (type == ARGUMENTDATATYPE_LOCATION)
+			value = (UnsignedInt)(arg->location.x * 100.0f) ^ ((UnsignedInt)(arg->location.y * 100.0f) << 12) ^ (UnsignedInt)(arg->location.z * 100.0f);
+		hash = (hash * 31 + type) * 31 + value;
+	}
+	msg->deleteInstance();
+
+	return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Packs all the commands into packets of the given format, as Connection::doSend() does,
+	and then reads them back. */
+//-------------------------------------------------------------------------------------------------
+static void benchmarkFormat( NetPacketFormat format, const char *name, std::vector<NetCommandRef *> &commands, UnsignedInt expectedHash )
+{
+	Int numCommands = commands.size();
+	std::vector<TransportMessage> packets;
+	Int numBytes = 0;
+
+	NetPacket *packet = newInstance(NetPacket);
+
+	Int64 freq64, startTime64, endTime64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+	Int pass;
+	for (pass = 0; pass < BENCH_PASSES; ++pass)
+	{
+		Bool keep = (pass == 0);
+		packet->reset();
+		packet->setFormat(format);
+		for (Int i = 0; i < numCommands; ++i)
+		{
+			if (packet->addCommand(commands[i]))
+				continue;
+
+			if (keep)
+			{
+				packets.push_back(TransportMessage());
+				TransportMessage &out = packets.back();
+				out.length = packet->getLength();
+				memcpy(out.data, packet->getData(), out.length);
+				numBytes += out.length;
+			}
+			packet->reset();
+			packet->setFormat(format);
+			packet->addCommand(commands[i]);
+		}
+		if (keep)
+		{
+			packets.push_back(TransportMessage());
+			TransportMessage &out = packets.back();
+			out.length = packet->getLength();
+			memcpy(out.data, packet->getData(), out.length);
+			numBytes += out.length;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	Real encodeTime = (Real)((double)(endTime64 - startTime64) / (double)freq64);
+
+	packet->deleteInstance();
+	packet = NULL;
+
+	Int numPackets = packets.size();
+	Int numDecoded = 0;
+	UnsignedInt decodedHash = 0;
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+	for (pass = 0; pass < BENCH_PASSES; ++pass)
+	{
+		for (Int p = 0; p < numPackets; ++p)
+		{
+			NetPacket *in = newInstance(NetPacket)(&packets[p]);
+			NetCommandList *list = in->getCommandList();
+			if (pass == 0)
+			{
+				for (NetCommandRef *ref = list->getFirstMessage(); ref != NULL; ref = ref->getNext())
+				{
+					++numDecoded;
+					decodedHash += hashCommand(ref->getCommand());
+				}
+			}
+			list->deleteInstance();
+			in->deleteInstance();
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	Real decodeTime = (Real)((double)(endTime64 - startTime64) / (double)freq64);
+
+	Real perCommand = 1.0e6f / ((Real)numCommands * BENCH_PASSES);
+	DEBUG_LOG(("NetPacketBenchmark - %s: %d packets, %d bytes, %.2f bytes/command, encode %.3f us/command, decode %.3f us/command\n",
+		name, numPackets, numBytes, (Real)numBytes / numCommands, encodeTime * perCommand, decodeTime * perCommand));
+	Bool matches = (numDecoded == numCommands && decodedHash == expectedHash);
+	DEBUG_LOG(("NetPacketBenchmark - %s: read back %d commands, %s\n", name, numDecoded, matches ? "all match" : "they DIFFER"));
+	DEBUG_ASSERTCRASH(matches, ("%s packets didn't read back the commands that were put in them", name));
+}
+
+//-------------------------------------------------------------------------------------------------
+void runNetPacketBenchmark( Int numCommands )
+{
+	if (numCommands <= 0)
+		return;
+
+	// each player's commands have consecutive IDs, and a few commands go out for each frame
+	UnsignedInt seed = 0x9ac7e7;
+	UnsignedShort nextID[BENCH_PLAYERS];
+	Int i;
+	for (i = 0; i < BENCH_PLAYERS; ++i)
+		nextID[i] = (UnsignedShort)(nextRandom(seed) % 60000);
+
+	std::vector<NetCommandRef *> commands;
+	UnsignedInt expectedHash = 0;
+	UnsignedInt frame = 300;
+	for (i = 0; i < numCommands; ++i)
+	{
+		if (nextRandom(seed) % 3 == 0)
+			frame += 1 + nextRandom(seed) % 4;
+		Int player = nextRandom(seed) % BENCH_PLAYERS;
+
+		GameMessage *gmsg = makeGameMessage(seed);
+		NetGameCommandMsg *msg = newInstance(NetGameCommandMsg)(gmsg);
+		gmsg->deleteInstance();
+		msg->setExecutionFrame(frame);
+		msg->setPlayerID(player);
+		msg->setID(nextID[player]++);
+
+		expectedHash += hashCommand(msg);
+		commands.push_back(NEW_NETCOMMANDREF(msg));
+		msg->detach();
+	}
+
+	DEBUG_LOG(("NetPacketBenchmark - %d game commands from %d players, %d passes\n", numCommands, BENCH_PLAYERS, BENCH_PASSES));
+	benchmarkFormat(NETPACKETFORMAT_FIXED, "fixed  ", commands, expectedHash);
+	benchmarkFormat(NETPACKETFORMAT_COMPACT, "compact", commands, expectedHash);
+
+	for (i = 0; i < numCommands; ++i)
+		commands[i]->deleteInstance();
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
@@ -353,6 +353,10 @@ void Network::init()
 	DEBUG_LOG(("NetworkRunAheadMetricsTime: %d\n", TheGlobalData->m_networkRunAheadMetricsTime));
 	DEBUG_LOG(("NetworkCushionHistoryLength: %d\n", TheGlobalData->m_networkCushionHistoryLength));
 	DEBUG_LOG(("NetworkRunAheadSlack: %d\n", TheGlobalData->m_networkRunAheadSlack));
+	DEBUG_LOG(("NetworkRunAheadPercentile: %d\n", TheGlobalData->m_networkRunAheadPercentile));
+	DEBUG_LOG(("NetworkRunAheadHysteresis: %d\n", TheGlobalData->m_networkRunAheadHysteresis));
+	DEBUG_LOG(("NetworkRunAheadDecreaseDelay: %d\n", TheGlobalData->m_networkRunAheadDecreaseDelay));
+	DEBUG_LOG(("NetworkRunAheadMinCushion: %d\n", TheGlobalData->m_networkRunAheadMinCushion));
 	DEBUG_LOG(("NetworkKeepAliveDelay: %d\n", TheGlobalData->m_networkKeepAliveDelay));
 	DEBUG_LOG(("NetworkDisconnectTime: %d\n", TheGlobalData->m_networkDisconnectTime));
 	DEBUG_LOG(("NetworkPlayerTimeoutTime: %d\n", TheGlobalData->m_networkPlayerTimeoutTime));
@@ -0,0 +1,290 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// NetworkSoak.cpp
+// Plays a lockstep network game between several players in one process, to soak the net code.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/NetworkSoak.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Common/MessageStream.h"
+#include "GameClient/DisconnectMenu.h"
+#include "GameLogic/GameLogic.h"
+#include "GameNetwork/ConnectionManager.h"
+#include "GameNetwork/GameInfo.h"
+#include "GameNetwork/LoopbackTransport.h"
+
+enum
+{
+	SOAK_BASE_IP = 0x7F000001,		///< players are at 127.0.0.1, 127.0.0.2, ...
+	SOAK_PORT = 8088,
+	SOAK_STALL_TIME = 30000				///< give up if no frame completes for this many milliseconds
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The soak's game. Like a skirmish, its slots live in the GameInfo itself. */
+//-------------------------------------------------------------------------------------------------
+class SoakGameInfo : public GameInfo
+{
+public:
+	SoakGameInfo()
+	{
+		for (Int i = 0; i < MAX_SLOTS; ++i)
+			setSlotPointer(i, &m_soakSlot[i]);
+	}
+
+private:
+	GameSlot m_soakSlot[MAX_SLOTS];
+};
+
+//-------------------------------------------------------------------------------------------------
+/** What Network keeps track of for one player */
+//-------------------------------------------------------------------------------------------------
+struct SoakPlayer
+{
+	ConnectionManager *m_conMgr;
+	Int m_runAhead;
+	Int m_frameRate;
+	Int m_lastExecutionFrame;
+	Int m_lastFrameCompleted;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Network::getExecutionFrame() */
+//-------------------------------------------------------------------------------------------------
+static Int getExecutionFrame( SoakPlayer &player, UnsignedInt frame )
+{
+	Int logicFrame = frame + player.m_runAhead;
+	if (logicFrame > player.m_lastExecutionFrame)
+		player.m_lastExecutionFrame = logicFrame;
+	return player.m_lastExecutionFrame;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Network::processRunAheadCommand() */
+//-------------------------------------------------------------------------------------------------
+static void processRunAheadCommand( SoakPlayer &player, NetRunAheadCommandMsg *msg )
+{
+	player.m_runAhead = msg->getRunAhead();
+	player.m_frameRate = msg->getFrameRate();
+	time_t frameGrouping = (1000 * player.m_runAhead) / player.m_frameRate;
+	frameGrouping = frameGrouping / 2;
+	if (frameGrouping < 1)
+		frameGrouping = 1;
+	if (frameGrouping > 500)
+		frameGrouping = 500;
+	player.m_conMgr->setFrameGrouping(frameGrouping);
+}
+
+//-------------------------------------------------------------------------------------------------
+void runNetworkSoak( Int numPlayers, Int numFrames, Int latency, Int jitter, Int packetLoss )
+{
+	if (numPlayers < 2)
+		numPlayers = 2;
+	if (numPlayers > MAX_SLOTS)
+		numPlayers = MAX_SLOTS;
+
+	DEBUG_LOG(("NetworkSoak - %d players, %d frames, %dms latency, %dms jitter, %d%% packet loss\n",
+		numPlayers, numFrames, latency, jitter, packetLoss));
+
+	LoopbackNetwork network;
+	network.setConditions(latency, jitter, packetLoss);
+
+	SoakGameInfo game;
+	game.init();
+	game.enterGame();
+
+	Int i;
+	for (i = 0; i < numPlayers; ++i)
+	{
+		UnicodeString name;
+		name.format(L"Soak%d", i);
+		GameSlot *slot = game.getSlot(i);
+		slot->setState(SLOT_PLAYER, name, SOAK_BASE_IP + i);
+		slot->setPort(SOAK_PORT);
+	}
+
+	// set up each player the way Network does when a game starts
+	Int initialRunAhead = min(max(30, MIN_RUNAHEAD), MAX_FRAMES_AHEAD/2);
+	SoakPlayer players[MAX_SLOTS];
+	for (i = 0; i < numPlayers; ++i)
+	{
+		// every ConnectionManager makes a DisconnectMenu of its own, and the last one made is the one
+		// that is deleted, so don't let the earlier ones leak.
+		if (TheDisconnectMenu != NULL)
+		{
+			delete TheDisconnectMenu;
+			TheDisconnectMenu = NULL;
+		}
+
+		SoakPlayer &player = players[i];
+		player.m_conMgr = NEW ConnectionManager;
+		player.m_conMgr->init();
+
+		LoopbackTransport *transport = NEW LoopbackTransport(&network);
+		transport->init(SOAK_BASE_IP + i, SOAK_PORT);
+		player.m_conMgr->attachTransport(transport);
+		player.m_conMgr->setLocalAddress(SOAK_BASE_IP + i, SOAK_PORT);
+
+		game.setLocalIP(SOAK_BASE_IP + i);
+		player.m_conMgr->parseUserList(&game);
+		player.m_conMgr->destroyGameMessages();
+
+		player.m_runAhead = initialRunAhead;
+		player.m_frameRate = 30;
+		player.m_lastExecutionFrame = player.m_runAhead - 1;
+		player.m_lastFrameCompleted = player.m_runAhead - 1;
+		player.m_conMgr->zeroFrames(1, player.m_runAhead - 1);
+	}
+
+	// the game starts at frame 1, so nobody waits for frame 0
+	TheGameLogic->friend_setFrame(1);
+	for (i = 0; i < numPlayers; ++i)
+	{
+		NetCommandList *netcmdlist = players[i].m_conMgr->getFrameCommandList(0);
+		netcmdlist->deleteInstance();
+	}
+
+	Int runAheadChanges = 0;
+	Int mismatchedFrames = 0;
+	UnsignedInt startTime = timeGetTime();
+	UnsignedInt lastFrameTime = startTime;
+	UnsignedInt lastFrameSent = 0;
+	UnsignedInt frame = 1;
+	while (frame <= (UnsignedInt)numFrames)
+	{
+		TheGameLogic->friend_setFrame(frame);
+
+		// once a frame, each player sends a command and finishes the frames it won't send any more for
+		if (frame != lastFrameSent)
+		{
+			for (i = 0; i < numPlayers; ++i)
+			{
+				SoakPlayer &player = players[i];
+				Int executionFrame = getExecutionFrame(player, frame);
+
+				GameMessage *msg = newInstance(GameMessage)(GameMessage::MSG_LOGIC_CRC);
+				msg->appendIntegerArgument(frame);
+				player.m_conMgr->sendLocalGameMessage(msg, executionFrame);
+				msg->deleteInstance();
+
+				for (Int f = player.m_lastFrameCompleted + 1; f < executionFrame; ++f)
+				{
+					player.m_conMgr->processFrameTick(f);
+					player.m_lastFrameCompleted = f;
+				}
+			}
+			lastFrameSent = frame;
+		}
+
+		Bool allReady = TRUE;
+		for (i = 0; i < numPlayers; ++i)
+		{
+			SoakPlayer &player = players[i];
+			player.m_conMgr->updateRunAhead(player.m_runAhead, player.m_frameRate, FALSE, getExecutionFrame(player, frame));
+			player.m_conMgr->update(FALSE);
+		}
+		for (i = 0; i < numPlayers; ++i)
+		{
+			if (!players[i].m_conMgr->allCommandsReady(frame))
+				allReady = FALSE;
+		}
+
+		if (!allReady)
+		{
+			if (timeGetTime() - lastFrameTime > SOAK_STALL_TIME)
+			{
+				DEBUG_LOG(("NetworkSoak - stalled on frame %d\n", frame));
+				players[0].m_conMgr->debugPrintConnectionCommands();
+				break;
+			}
+			continue;
+		}
+
+		// everybody has the frame. take its commands, and make sure everybody got the same ones.
+		Int firstPlayerCommands = 0;
+		for (i = 0; i < numPlayers; ++i)
+		{
+			SoakPlayer &player = players[i];
+			player.m_conMgr->handleAllCommandsReady();
+
+			Int gameCommands = 0;
+			NetCommandList *netcmdlist = player.m_conMgr->getFrameCommandList(frame);
+			for (NetCommandRef *ref = netcmdlist->getFirstMessage(); ref != NULL; ref = ref->getNext())
+			{
+				NetCommandMsg *cmdMsg = ref->getCommand();
+				if (cmdMsg->getNetCommandType() == NETCOMMANDTYPE_GAMECOMMAND)
+				{
+					++gameCommands;
+				}
+				else if (cmdMsg->getNetCommandType() == NETCOMMANDTYPE_RUNAHEAD)
+				{
+					Int oldRunAhead = player.m_runAhead;
+					processRunAheadCommand(player, (NetRunAheadCommandMsg *)cmdMsg);
+					if (i == 0 && player.m_runAhead != oldRunAhead)
+					{
+						++runAheadChanges;
+						DEBUG_LOG(("NetworkSoak - frame %d: run ahead %d -> %d at %d fps\n", frame, oldRunAhead, player.m_runAhead, player.m_frameRate));
+					}
+				}
+			}
+			netcmdlist->deleteInstance();
+
+			if (i == 0)
+			{
+				firstPlayerCommands = gameCommands;
+			}
+			else if (gameCommands != firstPlayerCommands)
+			{
+				++mismatchedFrames;
+				DEBUG_LOG(("NetworkSoak - frame %d: player %d got %d game commands, player 0 got %d\n", frame, i, gameCommands, firstPlayerCommands));
+			}
+		}
+
+		lastFrameTime = timeGetTime();
+		++frame;
+	}
+
+	UnsignedInt elapsed = timeGetTime() - startTime;
+	Int framesPlayed = frame - 1;
+	DEBUG_LOG(("NetworkSoak - played %d of %d frames in %dms, %.1f frames per second\n",
+		framesPlayed, numFrames, elapsed, (elapsed > 0) ? (1000.0 * framesPlayed / elapsed) : 0.0));
+	DEBUG_LOG(("NetworkSoak - run ahead changed %d times, ended at %d frames\n", runAheadChanges, players[0].m_runAhead));
+	Int totalRetries = 0;
+	for (i = 0; i < numPlayers; ++i)
+	{
+		Int retries = players[i].m_conMgr->getTotalRetries();
+		DEBUG_LOG(("NetworkSoak - player %d resent %d commands\n", i, retries));
+		totalRetries += retries;
+	}
+	DEBUG_LOG(("NetworkSoak - %d commands resent, %d of %d packets lost, %d frames with mismatched commands\n",
+		totalRetries, network.getNumLost(), network.getNumSent(), mismatchedFrames));
+
+	for (i = 0; i < numPlayers; ++i)
+	{
+		players[i].m_conMgr->destroyGameMessages();
+		delete players[i].m_conMgr;
+		players[i].m_conMgr = NULL;
+	}
+
+	TheGameLogic->friend_setFrame(0);
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
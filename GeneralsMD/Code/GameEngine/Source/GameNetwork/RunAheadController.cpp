@@ -0,0 +1,159 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// RunAheadController.cpp
+// Picks the game's run ahead from the latencies the players are likely to see, rather than from
+// their averages.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/RunAheadController.h"
+#include "GameNetwork/NetworkDefs.h"
+
+//-------------------------------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+void LatencyHistogram::reset()
+{
+	for (Int i = 0; i < NUM_BUCKETS; ++i)
+		m_buckets[i] = 0;
+	m_count = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int LatencyHistogram::getBucket(Real latency)
+{
+	Int bucket = (Int)(latency * 1000.0f) / BUCKET_MS;
+	if (bucket < 0)
+		bucket = 0;
+	if (bucket >= NUM_BUCKETS)
+		bucket = NUM_BUCKETS - 1;
+	return bucket;
+}
+
+//-------------------------------------------------------------------------------------------------
+void LatencyHistogram::add(Real latency)
+{
+	++m_buckets[getBucket(latency)];
+	++m_count;
+}
+
+//-------------------------------------------------------------------------------------------------
+void LatencyHistogram::remove(Real latency)
+{
+	Int bucket = getBucket(latency);
+	DEBUG_ASSERTCRASH(m_buckets[bucket] > 0, ("LatencyHistogram::remove - %f was never added", latency));
+	if (m_buckets[bucket] > 0)
+	{
+		--m_buckets[bucket];
+		--m_count;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Real LatencyHistogram::getPercentile(Int percentile) const
+{
+	if (m_count == 0)
+		return 0.0f;
+
+	// the number of latencies that have to be at or below the answer, rounded up
+	Int needed = (m_count * percentile + 99) / 100;
+	if (needed < 1)
+		needed = 1;
+
+	Int seen = 0;
+	Int bucket;
+	for (bucket = 0; bucket < NUM_BUCKETS - 1; ++bucket)
+	{
+		seen += m_buckets[bucket];
+		if (seen >= needed)
+			break;
+	}
+	return (Real)((bucket + 1) * BUCKET_MS) / 1000.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+RunAheadController::RunAheadController()
+{
+	m_hysteresis = 0;
+	m_decreaseDelay = 0;
+	m_minCushion = 0;
+	reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+void RunAheadController::reset()
+{
+	m_lowUpdates = 0;
+	m_lowTarget = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void RunAheadController::setHysteresis(Int frames, Int decreaseDelay, Int minCushion)
+{
+	m_hysteresis = frames;
+	m_decreaseDelay = decreaseDelay;
+	m_minCushion = minCushion;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int RunAheadController::getTargetRunAhead(Real maximumLatency, Int fps)
+{
+	// a command takes half of each of the two round trips to get from one player to the other
+	// through the packet router. Round up; a run ahead a frame short of that is a stall.
+	Int target = (Int)ceil((maximumLatency / 2.0) * (Real)fps);
+	if (target < MIN_RUNAHEAD)
+		target = MIN_RUNAHEAD;
+	if (target > (MAX_FRAMES_AHEAD / 2))
+		target = MAX_FRAMES_AHEAD / 2;
+	return target;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int RunAheadController::update(Int runAhead, Real maximumLatency, Int fps, Int minimumCushion)
+{
+	Int target = getTargetRunAhead(maximumLatency, fps);
+
+	if (target >= runAhead)
+	{
+		m_lowUpdates = 0;
+		return target;
+	}
+
+	// the percentile leaves room for the odd late command, so commands cutting it fine don't raise
+	// the run ahead; they only keep it from coming down.
+	Bool cutting = (minimumCushion >= 0) && (minimumCushion < m_minCushion);
+	if (cutting || (target > runAhead - m_hysteresis))
+	{
+		m_lowUpdates = 0;
+		return runAhead;
+	}
+
+	if (m_lowUpdates == 0 || target > m_lowTarget)
+		m_lowTarget = target;
+	++m_lowUpdates;
+	if (m_lowUpdates < m_decreaseDelay)
+		return runAhead;
+
+	// it has been down long enough. Go to the most it has asked for while it was down.
+	m_lowUpdates = 0;
+	return m_lowTarget;
+}
@@ -0,0 +1,280 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 TheSuperHackers
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// RunAheadSimulation.cpp
+// Replays recorded latencies through the run ahead calculations, to see how they would have played.
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/RunAheadSimulation.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Common/GlobalData.h"
+#include "GameNetwork/NetworkDefs.h"
+#include "GameNetwork/RunAheadController.h"
+
+enum
+{
+	SIM_FPS = 30				///< the frame rate the trace was recorded at
+};
+
+//-------------------------------------------------------------------------------------------------
+/** One packet router's run ahead as the trace plays */
+//-------------------------------------------------------------------------------------------------
+struct SimRouter
+{
+	Int m_runAhead;											///< the run ahead frames are executing with
+	std::vector<Int> m_pendingFrames;		///< run ahead changes that have been sent but haven't reached their frame yet
+	std::vector<Int> m_pendingRunAheads;
+	Int m_lastSent;
+	Int m_minimumCushion;								///< the fewest frames to spare since the last update, or -1
+	RunAheadController m_controller;
+
+	Int m_runAheadTotal;
+	Int m_stalledFrames;
+	Real m_stallTime;										///< frames
+	Int m_changes;
+};
+
+//-------------------------------------------------------------------------------------------------
+static void initRouter( SimRouter &router, Int runAhead )
+{
+	router.m_runAhead = runAhead;
+	router.m_lastSent = runAhead;
+	router.m_minimumCushion = -1;
+	router.m_controller.setHysteresis(TheGlobalData->m_networkRunAheadHysteresis, TheGlobalData->m_networkRunAheadDecreaseDelay,
+		TheGlobalData->m_networkRunAheadMinCushion);
+	router.m_controller.reset();
+	router.m_runAheadTotal = 0;
+	router.m_stalledFrames = 0;
+	router.m_stallTime = 0.0f;
+	router.m_changes = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** ConnectionManager::updateRunAhead() sends a run ahead command for the frame the old run ahead
+	gets to, and it takes effect from there */
+//-------------------------------------------------------------------------------------------------
+static void sendRunAhead( SimRouter &router, Int frame, Int runAhead )
+{
+	router.m_pendingFrames.push_back(frame + router.m_runAhead);
+	router.m_pendingRunAheads.push_back(runAhead);
+	if (runAhead != router.m_lastSent)
+		++router.m_changes;
+	router.m_lastSent = runAhead;
+	router.m_minimumCushion = -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A frame's commands take delay frames to get to everyone */
+//-------------------------------------------------------------------------------------------------
+static void playFrame( SimRouter &router, Int frame, Real delay )
+{
+	while (!router.m_pendingFrames.empty() && router.m_pendingFrames.front() <= frame)
+	{
+		router.m_runAhead = router.m_pendingRunAheads.front();
+		router.m_pendingFrames.erase(router.m_pendingFrames.begin());
+		router.m_pendingRunAheads.erase(router.m_pendingRunAheads.begin());
+	}
+
+	router.m_runAheadTotal += router.m_runAhead;
+	Int cushion = 0;
+	if (delay > router.m_runAhead)
+	{
+		++router.m_stalledFrames;
+		router.m_stallTime += delay - router.m_runAhead;
+	}
+	else
+	{
+		cushion = (Int)(router.m_runAhead - delay);
+	}
+	if (router.m_minimumCushion == -1 || cushion < router.m_minimumCushion)
+		router.m_minimumCushion = cushion;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The two biggest latencies added together, as ConnectionManager::getMaximumLatency() does */
+//-------------------------------------------------------------------------------------------------
+static Real sumOfTwoBiggest( const Real *latencies, Int numPlayers )
+{
+	Real lat1 = 0.0f;
+	Real lat2 = 0.0f;
+	for (Int i = 0; i < numPlayers; ++i)
+	{
+		if (latencies[i] > lat1)
+		{
+			lat2 = lat1;
+			lat1 = latencies[i];
+		}
+		else if (latencies[i] > lat2)
+		{
+			lat2 = latencies[i];
+		}
+	}
+	return lat1 + lat2;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The run ahead ConnectionManager::updateRunAhead() used to pick */
+//-------------------------------------------------------------------------------------------------
+static Int getSlackRunAhead( Real maximumLatency, Int fps )
+{
+	Int runAhead = (Int)((maximumLatency / 2.0) * (Real)fps);
+	runAhead += (runAhead * TheGlobalData->m_networkRunAheadSlack) / 100;
+	if (runAhead < MIN_RUNAHEAD)
+		runAhead = MIN_RUNAHEAD;
+	if (runAhead > (MAX_FRAMES_AHEAD / 2))
+		runAhead = MAX_FRAMES_AHEAD / 2;
+	return runAhead;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void logRouter( const char *name, const SimRouter &router, Int numFrames )
+{
+	Real averageRunAhead = (Real)router.m_runAheadTotal / numFrames;
+	DEBUG_LOG(("RunAheadSimulation - %s: average run ahead %.2f frames (%.0fms), %d frames stalled (%.2f%%) for %.0fms, %d run ahead changes\n",
+		name, averageRunAhead, averageRunAhead * 1000.0f / SIM_FPS, router.m_stalledFrames, 100.0f * router.m_stalledFrames / numFrames,
+		router.m_stallTime * 1000.0f / SIM_FPS, router.m_changes));
+}
+
+//-------------------------------------------------------------------------------------------------
+static Bool readTrace( const AsciiString &traceFileName, Int &numPlayers, std::vector<Real> &latencies )
+{
+	FILE *fp = fopen(traceFileName.str(), "r");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("RunAheadSimulation - could not open %s\n", traceFileName.str()));
+		return false;
+	}
+
+	numPlayers = 0;
+	Bool ok = true;
+	Int lineNumber = 0;
+	char line[1024];
+	while (ok && fgets(line, sizeof(line), fp) != NULL)
+	{
+		++lineNumber;
+		if (line[0] == '#')
+			continue;
+
+		Real row[MAX_SLOTS];
+		Int numColumns = 0;
+		const char *seps = " \t\r\n,";
+		for (char *token = strtok(line, seps); token != NULL; token = strtok(NULL, seps))
+		{
+			if (numColumns == MAX_SLOTS)
+			{
+				ok = false;
+				break;
+			}
+			row[numColumns++] = (Real)atof(token) / 1000.0f;
+		}
+		if (numColumns == 0)
+			continue;
+
+		if (numPlayers == 0)
+			numPlayers = numColumns;
+		if (!ok || numColumns != numPlayers || numPlayers < 2)
+		{
+			DEBUG_LOG(("RunAheadSimulation - %s line %d: need the same 2 to %d columns on every line\n", traceFileName.str(), lineNumber, MAX_SLOTS));
+			ok = false;
+			break;
+		}
+		for (Int i = 0; i < numColumns; ++i)
+			latencies.push_back(row[i]);
+	}
+
+	fclose(fp);
+	return ok && numPlayers > 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void runRunAheadSimulation( const AsciiString &traceFileName )
+{
+	Int numPlayers;
+	std::vector<Real> trace;
+	if (!readTrace(traceFileName, numPlayers, trace))
+		return;
+
+	Int numFrames = trace.size() / numPlayers;
+	Int historyLength = TheGlobalData->m_networkLatencyHistoryLength;
+	Int percentile = TheGlobalData->m_networkRunAheadPercentile;
+	Int updateFrames = (TheGlobalData->m_networkRunAheadMetricsTime * SIM_FPS) / 1000;
+	if (updateFrames < 1)
+		updateFrames = 1;
+
+	DEBUG_LOG(("RunAheadSimulation - %s: %d players, %d frames, run ahead updated every %d frames\n",
+		traceFileName.str(), numPlayers, numFrames, updateFrames));
+	DEBUG_LOG(("RunAheadSimulation - slack %d%%; percentile %d, hysteresis %d frames over %d updates, min cushion %d\n",
+		TheGlobalData->m_networkRunAheadSlack, percentile, TheGlobalData->m_networkRunAheadHysteresis,
+		TheGlobalData->m_networkRunAheadDecreaseDelay, TheGlobalData->m_networkRunAheadMinCushion));
+
+	// each player's latency history, as FrameMetrics keeps it
+	std::vector<Real> history(numPlayers * historyLength, 0.2f);
+	Real averages[MAX_SLOTS];
+	LatencyHistogram histograms[MAX_SLOTS];
+	Int i;
+	for (i = 0; i < numPlayers; ++i)
+	{
+		averages[i] = 0.2f;
+		for (Int h = 0; h < historyLength; ++h)
+			histograms[i].add(0.2f);
+	}
+
+	Int initialRunAhead = min(max(30, MIN_RUNAHEAD), MAX_FRAMES_AHEAD/2);
+	SimRouter slackRouter;
+	SimRouter controlledRouter;
+	initRouter(slackRouter, initialRunAhead);
+	initRouter(controlledRouter, initialRunAhead);
+
+	for (Int frame = 0; frame < numFrames; ++frame)
+	{
+		const Real *latencies = &trace[frame * numPlayers];
+		for (i = 0; i < numPlayers; ++i)
+		{
+			Real &old = history[i * historyLength + frame % historyLength];
+			averages[i] += (latencies[i] - old) / historyLength;
+			histograms[i].remove(old);
+			histograms[i].add(latencies[i]);
+			old = latencies[i];
+		}
+
+		if (frame % updateFrames == 0)
+		{
+			Real percentiles[MAX_SLOTS];
+			for (i = 0; i < numPlayers; ++i)
+				percentiles[i] = histograms[i].getPercentile(percentile);
+
+			sendRunAhead(slackRouter, frame, getSlackRunAhead(sumOfTwoBiggest(averages, numPlayers), SIM_FPS));
+			sendRunAhead(controlledRouter, frame, controlledRouter.m_controller.update(controlledRouter.m_runAhead,
+				sumOfTwoBiggest(percentiles, numPlayers), SIM_FPS, controlledRouter.m_minimumCushion));
+		}
+
+		Real delay = (sumOfTwoBiggest(latencies, numPlayers) / 2.0f) * SIM_FPS;
+		playFrame(slackRouter, frame, delay);
+		playFrame(controlledRouter, frame, delay);
+	}
+
+	if (numFrames > 0)
+	{
+		logRouter("average + slack   ", slackRouter, numFrames);
+		logRouter("percentile control", controlledRouter, numFrames);
+	}
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
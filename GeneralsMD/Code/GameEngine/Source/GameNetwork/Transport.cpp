@@ -72,15 +72,67 @@ static inline void decryptBuf( unsigned char *buf, Int len )
 
 //--------------------------------------------------------------------------
 
+TransportBuffer::TransportBuffer()
+{
+	m_referenceCount = 1; // start this off as 1.  This means that an "attach" is implied by creating a TransportBuffer object.
+	m_message.length = 0;
+	m_message.addr = 0;
+	m_message.port = 0;
+}
+
+TransportBuffer::~TransportBuffer()
+{
+}
+
+void TransportBuffer::attach()
+{
+	++m_referenceCount;
+}
+
+void TransportBuffer::detach()
+{
+	--m_referenceCount;
+	DEBUG_ASSERTCRASH(m_referenceCount >= 0, ("Invalid reference count for TransportBuffer"));
+	if (m_referenceCount <= 0) {
+		deleteInstance();
+	}
+}
+
+//--------------------------------------------------------------------------
+
 Transport::Transport(void)
 {
 	m_winsockInit = false;
 	m_udpsock = NULL;
+	m_useLatency = false;
+	m_usePacketLoss = false;
+	for (Int i=0; i<MAX_TRANSPORT_MESSAGES; ++i)
+	{
+		m_outBuffer[i] = NULL;
+	}
+	m_outFirst = 0;
+	m_outCount = 0;
+	m_inNext = 0;
 }
 
 Transport::~Transport(void)
 {
 	reset();
+	clearOutBuffer();
+}
+
+void Transport::clearOutBuffer( void )
+{
+	for (Int i=0; i<MAX_TRANSPORT_MESSAGES; ++i)
+	{
+		if (m_outBuffer[i] != NULL)
+		{
+			m_outBuffer[i]->detach();
+			m_outBuffer[i] = NULL;
+		}
+	}
+	m_outFirst = 0;
+	m_outCount = 0;
 }
 
 Bool Transport::init( AsciiString ip, UnsignedShort port )
@@ -130,16 +182,23 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 		return false;
 	}
 
-	// ------- Clear buffers --------
+	initBuffers(port);
+
+	return true;
+}
+
+void Transport::initBuffers( UnsignedShort port )
+{
+	clearOutBuffer();
 	int i=0;
-	for (; i<MAX_MESSAGES; ++i)
+	for (; i<MAX_TRANSPORT_MESSAGES; ++i)
 	{
-		m_outBuffer[i].length = 0;
 		m_inBuffer[i].length = 0;
 #if defined(_DEBUG) || defined(_INTERNAL)
 		m_delayedInBuffer[i].message.length = 0;
 #endif
 	}
+	m_inNext = 0;
 	for (i=0; i<MAX_TRANSPORT_STATISTICS_SECONDS; ++i)
 	{
 		m_incomingBytes[i] = 0;
@@ -148,6 +207,8 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 		m_incomingPackets[i] = 0;
 		m_outgoingPackets[i] = 0;
 		m_unknownPackets[i] = 0;
+		m_outgoingDrops[i] = 0;
+		m_incomingDrops[i] = 0;
 	}
 	m_statisticsSlot = 0;
 	m_lastSecond = timeGetTime();
@@ -161,8 +222,6 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 	if (TheGlobalData->m_packetLoss)
 		m_usePacketLoss = true;
 #endif
-
-	return true;
 }
 
 void Transport::reset( void )
@@ -180,6 +239,22 @@ void Transport::reset( void )
 	}
 }
 
+Int Transport::writeDatagrams( UDPDatagram *datagrams, Int count )
+{
+	return m_udpsock->WriteBatch(datagrams, count);
+}
+
+Int Transport::readDatagrams( UDPDatagram *datagrams, Int count )
+{
+	return m_udpsock->ReadBatch(datagrams, count);
+}
+
+Bool Transport::writeWouldBlock( void )
+{
+	UDP::sockStat status = m_udpsock->GetStatus();
+	return (status == UDP::WOULDBLOCK || status == UDP::AGAIN);
+}
+
 Bool Transport::update( void )
 {
 	Bool retval = TRUE;
@@ -197,7 +272,7 @@ Bool Transport::update( void )
 }
 
 Bool Transport::doSend() {
-	if (!m_udpsock)
+	if (!isOpen())
 	{
 		DEBUG_LOG(("Transport::doSend() - m_udpSock is NULL!\n"));
 		return FALSE;
@@ -217,47 +292,74 @@ Bool Transport::doSend() {
 		m_incomingBytes[m_statisticsSlot] = 0;
 		m_unknownPackets[m_statisticsSlot] = 0;
 		m_unknownBytes[m_statisticsSlot] = 0;
+		m_outgoingDrops[m_statisticsSlot] = 0;
+		m_incomingDrops[m_statisticsSlot] = 0;
 	}
 
-	// Send all messages
-	int i;
-	for (i=0; i<MAX_MESSAGES; ++i)
+	// Send the queued messages, oldest first, a batch at a time.  If the socket won't take any
+	// more, the rest wait for the next update.  A message that fails any other way (no route to
+	// the host, broadcasts not allowed, ...) would fail again next time too, so it is dropped,
+	// and the ones behind it still go.
+	while (m_outCount > 0)
 	{
-		if (m_outBuffer[i].length != 0)
+		UDPDatagram batch[UDP_MAX_BATCH];
+		Int count = (m_outCount < UDP_MAX_BATCH) ? m_outCount : UDP_MAX_BATCH;
+		Int j;
+		for (j=0; j<count; ++j)
 		{
-			int bytesSent = 0;
-			// Send this message
-			if ((bytesSent = m_udpsock->Write((unsigned char *)(&m_outBuffer[i]), m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port)) > 0)
-			{
-				//DEBUG_LOG(("Sending %d bytes to %d:%d\n", m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port));
-				m_outgoingPackets[m_statisticsSlot]++;
-				m_outgoingBytes[m_statisticsSlot] += m_outBuffer[i].length + sizeof(TransportMessageHeader);
-				m_outBuffer[i].length = 0;  // Remove from queue
-//				DEBUG_LOG(("Transport::doSend - sent %d butes to %d.%d.%d.%d:%d\n", bytesSent,
-//					(m_outBuffer[i].addr >> 24) & 0xff,
-//					(m_outBuffer[i].addr >> 16) & 0xff,
-//					(m_outBuffer[i].addr >> 8) & 0xff,
-//					m_outBuffer[i].addr & 0xff,
-//					m_outBuffer[i].port));
-			}
-			else
+			TransportMessage &message = m_outBuffer[(m_outFirst + j) % MAX_TRANSPORT_MESSAGES]->m_message;
+			batch[j].buf = (unsigned char *)(&message);
+			batch[j].len = message.length + sizeof(TransportMessageHeader);
+			batch[j].ip = message.addr;
+			batch[j].port = message.port;
+		}
+
+		Int numSent = writeDatagrams(batch, count);
+		if (numSent < 0)
+		{
+			numSent = 0;
+		}
+		for (j=0; j<numSent; ++j)
+		{
+			//DEBUG_LOG(("Sending %d bytes to %d:%d\n", batch[j].len, batch[j].ip, batch[j].port));
+			m_outgoingPackets[m_statisticsSlot]++;
+			m_outgoingBytes[m_statisticsSlot] += batch[j].len;
+
+			// Remove from queue
+			m_outBuffer[m_outFirst]->detach();
+			m_outBuffer[m_outFirst] = NULL;
+			m_outFirst = (m_outFirst + 1) % MAX_TRANSPORT_MESSAGES;
+			--m_outCount;
+		}
+
+		if (numSent < count)
+		{
+			if (writeWouldBlock())
 			{
 				//DEBUG_LOG(("Could not write to socket!!!  Not discarding message!\n"));
 				retval = FALSE;
 				//DEBUG_LOG(("Transport::doSend returning FALSE\n"));
+				break;
 			}
+
+			DEBUG_LOG(("Transport::doSend - dropping %d bytes to %d:%d\n", batch[numSent].len, batch[numSent].ip, batch[numSent].port));
+			m_outgoingDrops[m_statisticsSlot]++;
+			m_outBuffer[m_outFirst]->detach();
+			m_outBuffer[m_outFirst] = NULL;
+			m_outFirst = (m_outFirst + 1) % MAX_TRANSPORT_MESSAGES;
+			--m_outCount;
 		}
-	} // for (i=0; i<MAX_MESSAGES; ++i)
+	}
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	// Latency simulation - deliver anything we're holding on to that is ready
 	if (m_useLatency)
 	{
-		for (i=0; i<MAX_MESSAGES; ++i)
+		for (Int i=0; i<MAX_TRANSPORT_MESSAGES; ++i)
 		{
 			if (m_delayedInBuffer[i].message.length != 0 && m_delayedInBuffer[i].deliveryTime <= now)
 			{
-				for (int j=0; j<MAX_MESSAGES; ++j)
+				for (int j=0; j<MAX_TRANSPORT_MESSAGES; ++j)
 				{
 					if (m_inBuffer[j].length == 0)
 					{
@@ -276,7 +378,7 @@ Bool Transport::doSend() {
 
 Bool Transport::doRecv() 
 {
-	if (!m_udpsock)
+	if (!isOpen())
 	{
 		DEBUG_LOG(("Transport::doRecv() - m_udpSock is NULL!\n"));
 		return FALSE;
@@ -284,137 +386,189 @@ Bool Transport::doRecv()
 
 	Bool retval = TRUE;
 
-	// Read in anything on our socket
-	sockaddr_in from;
-#if defined(_DEBUG) || defined(_INTERNAL)
-	UnsignedInt now = timeGetTime();
-#endif
-
-	TransportMessage incomingMessage;
-	unsigned char *buf = (unsigned char *)&incomingMessage;
-	int len = MAX_MESSAGE_LEN;
+	// Read in anything on our socket, a batch at a time, straight into free slots of m_inBuffer.
 //	DEBUG_LOG(("Transport::doRecv - checking\n"));
-	while ( (len=m_udpsock->Read(buf, MAX_MESSAGE_LEN, &from)) > 0 )
+	for (;;)
 	{
-#if defined(_DEBUG) || defined(_INTERNAL)
-		// Packet loss simulation
-		if (m_usePacketLoss)
+		UDPDatagram batch[UDP_MAX_BATCH];
+		TransportMessage *slots[UDP_MAX_BATCH];
+		Int count = 0;
+		for (Int looked = 0; looked < MAX_TRANSPORT_MESSAGES && count < UDP_MAX_BATCH; ++looked)
 		{
-			if ( TheGlobalData->m_packetLoss >= GameClientRandomValue(0, 100) )
+			TransportMessage *slot = &m_inBuffer[m_inNext];
+			m_inNext = (m_inNext + 1) % MAX_TRANSPORT_MESSAGES;
+			if (slot->length == 0)
 			{
-				continue;
+				slots[count] = slot;
+				batch[count].buf = (unsigned char *)slot;
+				batch[count].len = MAX_MESSAGE_LEN;
+				++count;
 			}
 		}
-#endif
-
-//		DEBUG_LOG(("Transport::doRecv - Got something! len = %d\n", len));
-		// Decrypt the packet
-//		DEBUG_LOG(("buffer = "));
-//		for (Int munkee = 0; munkee < len; ++munkee) {
-//			DEBUG_LOG(("%02x", *(buf + munkee)));
-//		}
-//		DEBUG_LOG(("\n"));
-		decryptBuf(buf, len);
-
-		incomingMessage.length = len - sizeof(TransportMessageHeader);
 
-		if (len <= sizeof(TransportMessageHeader) || !isGeneralsPacket( &incomingMessage ))
+		// No room: read a packet anyway, so the socket doesn't back up, and count it as dropped.
+		TransportMessage droppedMessage;
+		Bool dropping = (count == 0);
+		if (dropping)
 		{
-			m_unknownPackets[m_statisticsSlot]++;
-			m_unknownBytes[m_statisticsSlot] += len;
-			continue;
+			slots[0] = &droppedMessage;
+			batch[0].buf = (unsigned char *)&droppedMessage;
+			batch[0].len = MAX_MESSAGE_LEN;
+			count = 1;
 		}
 
-		// Something there; stick it somewhere
-//		DEBUG_LOG(("Saw %d bytes from %d:%d\n", len, ntohl(from.sin_addr.S_un.S_addr), ntohs(from.sin_port)));
-		m_incomingPackets[m_statisticsSlot]++;
-		m_incomingBytes[m_statisticsSlot] += len;
+		Int numRead = readDatagrams(batch, count);
+		if (numRead < 0)
+		{
+			// there was a socket error trying to perform a read.
+			//DEBUG_LOG(("Transport::doRecv returning FALSE\n"));
+			retval = FALSE;
+			break;
+		}
 
-		for (int i=0; i<MAX_MESSAGES; ++i)
+		for (Int j=0; j<numRead; ++j)
 		{
-#if defined(_DEBUG) || defined(_INTERNAL)
-			// Latency simulation
-			if (m_useLatency)
+			if (dropping)
 			{
-				if (m_delayedInBuffer[i].message.length == 0)
-				{
-					// Empty slot; use it
-					m_delayedInBuffer[i].deliveryTime =
-						now + TheGlobalData->m_latencyAverage +
-						(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
-						GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
-					m_delayedInBuffer[i].message.length = incomingMessage.length;
-					m_delayedInBuffer[i].message.addr = ntohl(from.sin_addr.S_un.S_addr);
-					m_delayedInBuffer[i].message.port = ntohs(from.sin_port);
-					memcpy(&m_delayedInBuffer[i].message, buf, len);
-					break;
-				}
+				m_incomingDrops[m_statisticsSlot]++;
+				//DEBUG_ASSERTCRASH(FALSE, ("Message lost!"));
+				continue;
 			}
-			else
-			{
+			slots[j]->addr = batch[j].ip;
+			slots[j]->port = batch[j].port;
+			receivedPacket(slots[j], batch[j].len);
+		}
+
+		if (numRead < count)
+			break;	// nothing more waiting
+	}
+
+	return retval;
+}
+
+/**
+ * A packet of len bytes has just been read into slot, which was free.  Check it, and either leave
+ * it there for processing, or free the slot again.
+ */
+void Transport::receivedPacket( TransportMessage *slot, Int len )
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// Packet loss simulation
+	if (m_usePacketLoss)
+	{
+		if ( TheGlobalData->m_packetLoss >= GameClientRandomValue(0, 100) )
+		{
+			return;
+		}
+	}
 #endif
-				if (m_inBuffer[i].length == 0)
-				{
-					// Empty slot; use it
-					m_inBuffer[i].length = incomingMessage.length;
-					m_inBuffer[i].addr = ntohl(from.sin_addr.S_un.S_addr);
-					m_inBuffer[i].port = ntohs(from.sin_port);
-					memcpy(&m_inBuffer[i], buf, len);
-					break;
-				}
+
+//	DEBUG_LOG(("Transport::doRecv - Got something! len = %d\n", len));
+	// Decrypt the packet
+//	DEBUG_LOG(("buffer = "));
+//	for (Int munkee = 0; munkee < len; ++munkee) {
+//		DEBUG_LOG(("%02x", *(((unsigned char *)slot) + munkee)));
+//	}
+//	DEBUG_LOG(("\n"));
+	decryptBuf((unsigned char *)slot, len);
+
+	slot->length = len - sizeof(TransportMessageHeader);
+
+	if (len <= sizeof(TransportMessageHeader) || !isGeneralsPacket( slot ))
+	{
+		m_unknownPackets[m_statisticsSlot]++;
+		m_unknownBytes[m_statisticsSlot] += len;
+		slot->length = 0;
+		return;
+	}
+
+	// Something there; it stays where it is
+//	DEBUG_LOG(("Saw %d bytes from %d:%d\n", len, slot->addr, slot->port));
+	m_incomingPackets[m_statisticsSlot]++;
+	m_incomingBytes[m_statisticsSlot] += len;
+
 #if defined(_DEBUG) || defined(_INTERNAL)
+	// Latency simulation
+	if (m_useLatency)
+	{
+		UnsignedInt now = timeGetTime();
+		for (Int i=0; i<MAX_TRANSPORT_MESSAGES; ++i)
+		{
+			if (m_delayedInBuffer[i].message.length == 0)
+			{
+				// Empty slot; use it
+				m_delayedInBuffer[i].deliveryTime =
+					now + TheGlobalData->m_latencyAverage +
+					(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
+					GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
+				memcpy(&m_delayedInBuffer[i].message, slot, sizeof(TransportMessage));
+				break;
 			}
-#endif
 		}
-		//DEBUG_ASSERTCRASH(i<MAX_MESSAGES, ("Message lost!"));
+		slot->length = 0;
 	}
+#endif
+}
 
-	if (len == -1) {
-		// there was a socket error trying to perform a read.
-		//DEBUG_LOG(("Transport::doRecv returning FALSE\n"));
-		retval = FALSE;
+Bool Transport::queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
+						  NetMessageFlags flags, Int id */)
+{
+	if (len < 1 || len > MAX_PACKET_SIZE)
+	{
+		return false;
 	}
 
+	// callers that have their bytes somewhere else pay for one copy here.
+	TransportBuffer *buffer = newInstance(TransportBuffer);
+	memcpy(buffer->getData(), buf, len);
+	Bool retval = queueSend(addr, port, buffer, len);
+	buffer->detach();
 	return retval;
 }
 
-Bool Transport::queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
-						  NetMessageFlags flags, Int id */)
+Bool Transport::queueSend(UnsignedInt addr, UnsignedShort port, TransportBuffer *buffer, Int len)
 {
-	int i;
+	if (buffer == NULL || len < 1 || len > MAX_PACKET_SIZE)
+	{
+		return false;
+	}
 
-	if (len < 1 || len > MAX_PACKET_SIZE)
+	// the socket would never take this one, and it would hold up everything queued behind it.
+	if (addr == 0 || port == 0)
 	{
 		return false;
 	}
 
-	for (i=0; i<MAX_MESSAGES; ++i)
+	if (m_outCount == MAX_TRANSPORT_MESSAGES)
 	{
-		if (m_outBuffer[i].length == 0)
-		{
-			// Insert data here
-			m_outBuffer[i].length = len;
-			memcpy(m_outBuffer[i].data, buf, len);
-			m_outBuffer[i].addr = addr;
-			m_outBuffer[i].port = port;
-//			m_outBuffer[i].header.flags = flags;
-//			m_outBuffer[i].header.id = id;
-			m_outBuffer[i].header.magic = GENERALS_MAGIC_NUMBER;
-
-			CRC crc;
-			crc.computeCRC( (unsigned char *)(&(m_outBuffer[i].header.magic)), m_outBuffer[i].length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
-//			DEBUG_LOG(("About to assign the CRC for the packet\n"));
-			m_outBuffer[i].header.crc = crc.get();
-
-			// Encrypt packet
-//			DEBUG_LOG(("buffer: "));
-			encryptBuf((unsigned char *)&m_outBuffer[i], len + sizeof(TransportMessageHeader));
-//			DEBUG_LOG(("\n"));
-
-			return true;
-		}
+		m_outgoingDrops[m_statisticsSlot]++;
+		return false;
 	}
-	return false;
+
+	// The data is already in place, so all that is left is the header
+	TransportMessage &message = buffer->m_message;
+	message.length = len;
+	message.addr = addr;
+	message.port = port;
+//	message.header.flags = flags;
+//	message.header.id = id;
+	message.header.magic = GENERALS_MAGIC_NUMBER;
+
+	CRC crc;
+	crc.computeCRC( (unsigned char *)(&(message.header.magic)), message.length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
+//	DEBUG_LOG(("About to assign the CRC for the packet\n"));
+	message.header.crc = crc.get();
+
+	// Encrypt packet
+//	DEBUG_LOG(("buffer: "));
+	encryptBuf((unsigned char *)&message, len + sizeof(TransportMessageHeader));
+//	DEBUG_LOG(("\n"));
+
+	// Add it to the end of the queue
+	buffer->attach();
+	m_outBuffer[(m_outFirst + m_outCount) % MAX_TRANSPORT_MESSAGES] = buffer;
+	++m_outCount;
+	return true;
 }
 
 Bool Transport::isGeneralsPacket( TransportMessage *msg )
@@ -505,5 +659,40 @@ Real Transport::getUnknownPacketsPerSecond( void )
 	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
 }
 
+Real Transport::getOutgoingDroppedPacketsPerSecond( void )
+{
+	Real val = 0.0;
+	for (int i=0; i<MAX_TRANSPORT_STATISTICS_SECONDS; ++i)
+	{
+		if (i != m_statisticsSlot)
+			val += m_outgoingDrops[i];
+	}
+	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
+}
 
+Real Transport::getIncomingDroppedPacketsPerSecond( void )
+{
+	Real val = 0.0;
+	for (int i=0; i<MAX_TRANSPORT_STATISTICS_SECONDS; ++i)
+	{
+		if (i != m_statisticsSlot)
+			val += m_incomingDrops[i];
+	}
+	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
+}
+
+Int Transport::getOutgoingQueueDepth( void )
+{
+	return m_outCount;
+}
 
+Int Transport::getIncomingQueueDepth( void )
+{
+	Int depth = 0;
+	for (int i=0; i<MAX_TRANSPORT_MESSAGES; ++i)
+	{
+		if (m_inBuffer[i].length != 0)
+			++depth;
+	}
+	return depth;
+}
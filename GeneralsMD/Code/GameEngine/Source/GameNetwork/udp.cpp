@@ -317,6 +317,124 @@ Int UDP::Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from)
   return(retval);
 }
 
+//
+// Send datagrams in order until one of them can't go.  On Linux, sendmmsg() does a whole
+//   batch in one call; everywhere else it is one sendto() per datagram.  The game itself is
+//   only built for Windows, so the sendto() loop is what runs there; the Linux branches here
+//   and in ReadBatch() are only built when udp.cpp is compiled on its own with _UNIX.
+//
+Int UDP::WriteBatch(UDPDatagram *datagrams,Int count)
+{
+  if (count > UDP_MAX_BATCH)
+    count = UDP_MAX_BATCH;
+
+  // so GetStatus() tells a full socket from a datagram that can't go at all
+  ClearStatus();
+
+#if defined(_UNIX) && defined(__linux__)
+  struct mmsghdr     msgs[UDP_MAX_BATCH];
+  struct iovec       iovecs[UDP_MAX_BATCH];
+  struct sockaddr_in to[UDP_MAX_BATCH];
+  Int i;
+
+  for (i=0; i<count; ++i)
+  {
+    if ((datagrams[i].ip==0)||(datagrams[i].port==0))
+      break;
+    memset(&to[i],0,sizeof(to[i]));
+    to[i].sin_port=htons(datagrams[i].port);
+    to[i].sin_addr.s_addr=htonl(datagrams[i].ip);
+    to[i].sin_family=AF_INET;
+    iovecs[i].iov_base=datagrams[i].buf;
+    iovecs[i].iov_len=datagrams[i].len;
+    memset(&msgs[i],0,sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name=&to[i];
+    msgs[i].msg_hdr.msg_namelen=sizeof(to[i]);
+    msgs[i].msg_hdr.msg_iov=&iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen=1;
+  }
+  if (i==0)
+    return(count ? ADDRNOTAVAIL : 0);
+
+  ClearStatus();
+  Int retval=sendmmsg(fd,msgs,i,0);
+  if (retval<0)
+  {
+    m_lastError=errno;
+    if ((errno==EAGAIN)||(errno==EWOULDBLOCK))
+      return(0);
+    return(-1);
+  }
+  return(retval);
+#else
+  Int i;
+  for (i=0; i<count; ++i)
+  {
+    Int retval=Write(datagrams[i].buf,datagrams[i].len,datagrams[i].ip,datagrams[i].port);
+    if (retval<=0)
+      return((i>0) ? i : retval);
+  }
+  return(count);
+#endif
+}
+
+//
+// Read whatever datagrams are waiting, up to count of them.  On Linux, recvmmsg() does a
+//   whole batch in one call; everywhere else it is one recvfrom() per datagram.
+//
+Int UDP::ReadBatch(UDPDatagram *datagrams,Int count)
+{
+  if (count > UDP_MAX_BATCH)
+    count = UDP_MAX_BATCH;
+
+#if defined(_UNIX) && defined(__linux__)
+  struct mmsghdr     msgs[UDP_MAX_BATCH];
+  struct iovec       iovecs[UDP_MAX_BATCH];
+  struct sockaddr_in from[UDP_MAX_BATCH];
+  Int i;
+
+  for (i=0; i<count; ++i)
+  {
+    iovecs[i].iov_base=datagrams[i].buf;
+    iovecs[i].iov_len=datagrams[i].len;
+    memset(&msgs[i],0,sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name=&from[i];
+    msgs[i].msg_hdr.msg_namelen=sizeof(from[i]);
+    msgs[i].msg_hdr.msg_iov=&iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen=1;
+  }
+
+  Int retval=recvmmsg(fd,msgs,count,MSG_DONTWAIT,NULL);
+  if (retval<0)
+  {
+    if ((errno==EAGAIN)||(errno==EWOULDBLOCK))
+      return(0);
+    m_lastError=errno;
+    return(-1);
+  }
+  for (i=0; i<retval; ++i)
+  {
+    datagrams[i].len=msgs[i].msg_len;
+    datagrams[i].ip=ntohl(from[i].sin_addr.s_addr);
+    datagrams[i].port=ntohs(from[i].sin_port);
+  }
+  return(retval);
+#else
+  Int i;
+  for (i=0; i<count; ++i)
+  {
+    sockaddr_in from;
+    Int retval=Read(datagrams[i].buf,datagrams[i].len,&from);
+    if (retval<=0)
+      return((i>0) ? i : retval);
+    datagrams[i].len=retval;
+    datagrams[i].ip=ntohl(from.sin_addr.s_addr);
+    datagrams[i].port=ntohs(from.sin_port);
+  }
+  return(count);
+#endif
+}
+
 
 void UDP::ClearStatus(void)
 {
@@ -34,6 +34,7 @@
 #include "Common/ArchiveFile.h"
 #include "Common/AsciiString.h"
 #include "Common/List.h"
+#include "Common/MappedArchiveFile.h"
 
 class Win32BIGFile : public ArchiveFile
 {
@@ -43,6 +44,7 @@ class Win32BIGFile : public ArchiveFile
 
 		virtual Bool					getFileInfo(const AsciiString& filename, FileInfo *fileInfo) const;	///< fill in the fileInfo struct with info about the requested file.
 		virtual File*					openFile( const Char *filename, Int access = 0 );///< Open the specified file within the BIG file
+		virtual File*					openArchivedFile( const ArchivedFileInfo *fileInfo, const Char *filename, Int access = 0 );	///< Open the file within the BIG file that getArchivedFileInfo() returned
 		virtual void					closeAllFiles( void );									///< Close all file opened in this BIG file
 		virtual AsciiString		getName( void );												///< Returns the name of the BIG file
 		virtual AsciiString		getPath( void );												///< Returns full path and name of BIG file
@@ -51,8 +53,12 @@ class Win32BIGFile : public ArchiveFile
 
 	protected:
 
+		File*					openMappedFile( const ArchivedFileInfo *fileInfo );	///< open the file as a view of the mapped BIG file, or return NULL
+
 		AsciiString		m_name;		///< BIG file name
 		AsciiString		m_path;		///< BIG file path
+		ArchiveFileMapping	m_mapping;	///< the BIG file, mapped for reading big files in place
+		Bool					m_mappingFailed;	///< don't try mapping again
 };
 
 #endif // __WIN32BIGFILE_H
\ No newline at end of file
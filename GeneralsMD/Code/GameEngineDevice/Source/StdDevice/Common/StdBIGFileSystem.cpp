@@ -37,8 +37,6 @@
 #include "StdDevice/Common/StdBIGFileSystem.h"
 #include "Common/Registry.h"
 
-static const char *BIGFileIdentifier = "BIGF";
-
 StdBIGFileSystem::StdBIGFileSystem() : ArchiveFileSystem() {
 }
 
@@ -51,6 +49,8 @@ void StdBIGFileSystem::init() {
 		return;
 	}
 
+	loadArchiveIndex();
+
 	loadBigFilesFromDirectory("", "*.big");
 
     // load original Generals assets
@@ -64,6 +64,8 @@ void StdBIGFileSystem::init() {
 #endif
     if (installPath!="")
       loadBigFilesFromDirectory(installPath, "*.big");
+
+	// the archive index is written by loadMods(), once the mod BIG files are in too.
 }
 
 void StdBIGFileSystem::reset() {
@@ -77,13 +79,6 @@ void StdBIGFileSystem::postProcessLoad() {
 
 ArchiveFile * StdBIGFileSystem::openArchiveFile(const Char *filename) {
 	File *fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
-	AsciiString archiveFileName;
-	archiveFileName = filename;
-	archiveFileName.toLower();
-	Int archiveFileSize = 0;
-	Int numLittleFiles = 0;
-
-	ArchiveFile *archiveFile = NEW StdBIGFile;
 
 	DEBUG_LOG(("StdBIGFileSystem::openArchiveFile - opening BIG file %s\n", filename));
 
@@ -92,86 +87,19 @@ ArchiveFile * StdBIGFileSystem::openArchiveFile(const Char *filename) {
 		return NULL;
 	}
 
-	AsciiString asciibuf;
-	char buffer[_MAX_PATH];
-	fp->read(buffer, 4); // read the "BIG" at the beginning of the file.
-	buffer[4] = 0;
-	if (strcmp(buffer, BIGFileIdentifier) != 0) {
-		DEBUG_CRASH(("Error reading BIG file identifier in file %s", filename));
+	ArchiveFile *archiveFile = NEW StdBIGFile;
+
+	// read the whole directory in one go, or take it from the archive index.
+	if (loadBigFileDirectory(archiveFile, fp, filename) == FALSE) {
+		DEBUG_CRASH(("Error reading BIG file directory in file %s", filename));
+		delete archiveFile;
 		fp->close();
 		fp = NULL;
 		return NULL;
 	}
 
-	// read in the file size.
-	fp->read(&archiveFileSize, 4);
-
-	DEBUG_LOG(("StdBIGFileSystem::openArchiveFile - size of archive file is %d bytes\n", archiveFileSize));
-
-//	char t;
-
-	// read in the number of files contained in this BIG file.
-	// change the order of the bytes cause the file size is in reverse byte order for some reason.
-	fp->read(&numLittleFiles, 4);
-	numLittleFiles = ntohl(numLittleFiles);
-
-	DEBUG_LOG(("StdBIGFileSystem::openArchiveFile - %d are contained in archive\n", numLittleFiles));
-//	for (Int i = 0; i < 2; ++i) {
-//		t = buffer[i];
-//		buffer[i] = buffer[(4-i)-1];
-//		buffer[(4-i)-1] = t;
-//	}
-
-	// seek to the beginning of the directory listing.
-	fp->seek(0x10, File::START);
-	// read in each directory listing.
-	ArchivedFileInfo *fileInfo = NEW ArchivedFileInfo;
-
-	for (Int i = 0; i < numLittleFiles; ++i) {
-		Int filesize = 0;
-		Int fileOffset = 0;
-		fp->read(&fileOffset, 4);
-		fp->read(&filesize, 4);
-
-		filesize = ntohl(filesize);
-		fileOffset = ntohl(fileOffset);
-
-		fileInfo->m_archiveFilename = archiveFileName;
-		fileInfo->m_offset = fileOffset;
-		fileInfo->m_size = filesize;
-		
-		// read in the path name of the file.
-		Int pathIndex = -1;
-		do {
-			++pathIndex;
-			fp->read(buffer + pathIndex, 1);
-		} while (buffer[pathIndex] != 0);
-
-		Int filenameIndex = pathIndex;
-		while ((filenameIndex >= 0) && (buffer[filenameIndex] != '\\') && (buffer[filenameIndex] != '/')) {
-			--filenameIndex;
-		}
-
-		fileInfo->m_filename = (char *)(buffer + filenameIndex + 1);
-		fileInfo->m_filename.toLower();
-		buffer[filenameIndex + 1] = 0;
-
-		AsciiString path;
-		path = buffer;
-
-		AsciiString debugpath;
-		debugpath = path;
-		debugpath.concat(fileInfo->m_filename);
-//		DEBUG_LOG(("StdBIGFileSystem::openArchiveFile - adding file %s to archive file %s, file number %d\n", debugpath.str(), fileInfo->m_archiveFilename.str(), i));
-
-		archiveFile->addFile(path, fileInfo);
-	}
-
 	archiveFile->attachFile(fp);
 
-	delete fileInfo;
-	fileInfo = NULL;
-
 	// leave fp open as the archive file will be using it.
 
 	return archiveFile;
@@ -196,6 +124,9 @@ void StdBIGFileSystem::closeArchiveFile(const Char *filename) {
 	
 	delete (it->second);
 	m_archiveFileMap.erase(it);
+
+	// the path index points into the archive we just deleted.
+	updatePathIndex();
 }
 
 void StdBIGFileSystem::closeAllArchiveFiles() {
@@ -225,5 +156,9 @@ Bool StdBIGFileSystem::loadBigFilesFromDirectory(AsciiString dir, AsciiString fi
 		it++;
 	}
 
+	if (actuallyAdded) {
+		updatePathIndex();
+	}
+
 	return actuallyAdded;
 }
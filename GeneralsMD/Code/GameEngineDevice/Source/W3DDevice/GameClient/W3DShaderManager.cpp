@@ -3114,7 +3114,18 @@ Bool W3DShaderManager::testMinimumRequirements(ChipsetType *videoChipType, CpuTy
 
 	if (intBenchIndex && floatBenchIndex && memBenchIndex)
 	{
-		RunBenchmark(0, NULL, floatBenchIndex, intBenchIndex, memBenchIndex);
+		// keep the results in the user data folder, so the benchmark only runs once per machine.
+		AsciiString cacheFile;
+		cacheFile.format("%sBenchmark.dat", TheGlobalData->getPath_UserData().str());
+		char cacheArg[] = "-cache";
+		char forceArg[] = "-force";
+		char *benchArgs[3];
+		Int numBenchArgs = 0;
+		benchArgs[numBenchArgs++] = cacheArg;
+		benchArgs[numBenchArgs++] = (char *)cacheFile.str();
+		if (TheGlobalData->m_forceBenchmark)
+			benchArgs[numBenchArgs++] = forceArg;
+		RunBenchmark(numBenchArgs, benchArgs, floatBenchIndex, intBenchIndex, memBenchIndex);
 	}
 
 	return TRUE;
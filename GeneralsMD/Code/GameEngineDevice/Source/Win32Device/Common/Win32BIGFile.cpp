@@ -38,7 +38,8 @@
 // Win32BIGFile::Win32BIGFile
 //============================================================================
 
-Win32BIGFile::Win32BIGFile()
+Win32BIGFile::Win32BIGFile() :
+	m_mappingFailed(FALSE)
 {
 
 }
@@ -64,6 +65,23 @@ File* Win32BIGFile::openFile( const Char *filename, Int access )
 		return NULL;
 	}
 
+	return openArchivedFile(fileInfo, filename, access);
+}
+
+//============================================================================
+// Win32BIGFile::openArchivedFile
+//============================================================================
+
+File* Win32BIGFile::openArchivedFile( const ArchivedFileInfo *fileInfo, const Char *filename, Int access )
+{
+	// big files that are only read are read in place, from a view of the mapped BIG file.
+	if (!BitIsSet(access, File::STREAMING) && !BitIsSet(access, File::WRITE) && fileInfo->m_size >= (UnsignedInt)MappedArchiveFile::MIN_MAPPED_SIZE) {
+		File *mappedFile = openMappedFile(fileInfo);
+		if (mappedFile != NULL) {
+			return mappedFile;
+		}
+	}
+
 	RAMFile *ramFile = NULL;
 	
 	if (BitIsSet(access, File::STREAMING)) 
@@ -97,6 +115,29 @@ File* Win32BIGFile::openFile( const Char *filename, Int access )
 	return localFile;
 }
 
+//============================================================================
+// Win32BIGFile::openMappedFile
+//============================================================================
+
+File* Win32BIGFile::openMappedFile( const ArchivedFileInfo *fileInfo )
+{
+	if (!m_mapping.isOpen()) {
+		if (m_mappingFailed || m_mapping.open(m_file->getName()) == FALSE) {
+			m_mappingFailed = TRUE;
+			return NULL;
+		}
+	}
+
+	MappedArchiveFile *mappedFile = newInstance( MappedArchiveFile );
+	mappedFile->deleteOnClose();
+	if (mappedFile->openFromMapping(m_mapping, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size) == FALSE) {
+		mappedFile->close();
+		return NULL;
+	}
+
+	return mappedFile;
+}
+
 //============================================================================
 // Win32BIGFile::closeAllFiles
 //============================================================================
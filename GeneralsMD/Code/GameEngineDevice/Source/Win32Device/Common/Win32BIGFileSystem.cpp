@@ -44,8 +44,6 @@
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
-static const char *BIGFileIdentifier = "BIGF";
-
 Win32BIGFileSystem::Win32BIGFileSystem() : ArchiveFileSystem() {
 }
 
@@ -58,6 +56,8 @@ void Win32BIGFileSystem::init() {
 		return;
 	}
 
+	loadArchiveIndex();
+
 	loadBigFilesFromDirectory("", "*.big");
 
     // load original Generals assets
@@ -71,6 +71,8 @@ void Win32BIGFileSystem::init() {
 #endif
     if (installPath!="")
       loadBigFilesFromDirectory(installPath, "*.big");
+
+	// the archive index is written by loadMods(), once the mod BIG files are in too.
 }
 
 void Win32BIGFileSystem::reset() {
@@ -84,13 +86,6 @@ void Win32BIGFileSystem::postProcessLoad() {
 
 ArchiveFile * Win32BIGFileSystem::openArchiveFile(const Char *filename) {
 	File *fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
-	AsciiString archiveFileName;
-	archiveFileName = filename;
-	archiveFileName.toLower();
-	Int archiveFileSize = 0;
-	Int numLittleFiles = 0;
-
-	ArchiveFile *archiveFile = NEW Win32BIGFile;
 
 	DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - opening BIG file %s\n", filename));
 
@@ -99,86 +94,19 @@ ArchiveFile * Win32BIGFileSystem::openArchiveFile(const Char *filename) {
 		return NULL;
 	}
 
-	AsciiString asciibuf;
-	char buffer[_MAX_PATH];
-	fp->read(buffer, 4); // read the "BIG" at the beginning of the file.
-	buffer[4] = 0;
-	if (strcmp(buffer, BIGFileIdentifier) != 0) {
-		DEBUG_CRASH(("Error reading BIG file identifier in file %s", filename));
+	ArchiveFile *archiveFile = NEW Win32BIGFile;
+
+	// read the whole directory in one go, or take it from the archive index.
+	if (loadBigFileDirectory(archiveFile, fp, filename) == FALSE) {
+		DEBUG_CRASH(("Error reading BIG file directory in file %s", filename));
+		delete archiveFile;
 		fp->close();
 		fp = NULL;
 		return NULL;
 	}
 
-	// read in the file size.
-	fp->read(&archiveFileSize, 4);
-
-	DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - size of archive file is %d bytes\n", archiveFileSize));
-
-//	char t;
-
-	// read in the number of files contained in this BIG file.
-	// change the order of the bytes cause the file size is in reverse byte order for some reason.
-	fp->read(&numLittleFiles, 4);
-	numLittleFiles = ntohl(numLittleFiles);
-
-	DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - %d are contained in archive\n", numLittleFiles));
-//	for (Int i = 0; i < 2; ++i) {
-//		t = buffer[i];
-//		buffer[i] = buffer[(4-i)-1];
-//		buffer[(4-i)-1] = t;
-//	}
-
-	// seek to the beginning of the directory listing.
-	fp->seek(0x10, File::START);
-	// read in each directory listing.
-	ArchivedFileInfo *fileInfo = NEW ArchivedFileInfo;
-
-	for (Int i = 0; i < numLittleFiles; ++i) {
-		Int filesize = 0;
-		Int fileOffset = 0;
-		fp->read(&fileOffset, 4);
-		fp->read(&filesize, 4);
-
-		filesize = ntohl(filesize);
-		fileOffset = ntohl(fileOffset);
-
-		fileInfo->m_archiveFilename = archiveFileName;
-		fileInfo->m_offset = fileOffset;
-		fileInfo->m_size = filesize;
-		
-		// read in the path name of the file.
-		Int pathIndex = -1;
-		do {
-			++pathIndex;
-			fp->read(buffer + pathIndex, 1);
-		} while (buffer[pathIndex] != 0);
-
-		Int filenameIndex = pathIndex;
-		while ((filenameIndex >= 0) && (buffer[filenameIndex] != '\\') && (buffer[filenameIndex] != '/')) {
-			--filenameIndex;
-		}
-
-		fileInfo->m_filename = (char *)(buffer + filenameIndex + 1);
-		fileInfo->m_filename.toLower();
-		buffer[filenameIndex + 1] = 0;
-
-		AsciiString path;
-		path = buffer;
-
-		AsciiString debugpath;
-		debugpath = path;
-		debugpath.concat(fileInfo->m_filename);
-//		DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - adding file %s to archive file %s, file number %d\n", debugpath.str(), fileInfo->m_archiveFilename.str(), i));
-
-		archiveFile->addFile(path, fileInfo);
-	}
-
 	archiveFile->attachFile(fp);
 
-	delete fileInfo;
-	fileInfo = NULL;
-
 	// leave fp open as the archive file will be using it.
 
 	return archiveFile;
@@ -203,6 +131,9 @@ void Win32BIGFileSystem::closeArchiveFile(const Char *filename) {
 	
 	delete (it->second);
 	m_archiveFileMap.erase(it);
+
+	// the path index points into the archive we just deleted.
+	updatePathIndex();
 }
 
 void Win32BIGFileSystem::closeAllArchiveFiles() {
@@ -232,5 +163,9 @@ Bool Win32BIGFileSystem::loadBigFilesFromDirectory(AsciiString dir, AsciiString
 		it++;
 	}
 
+	if (actuallyAdded) {
+		updatePathIndex();
+	}
+
 	return actuallyAdded;
 }